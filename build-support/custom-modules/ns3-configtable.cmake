@@ -158,6 +158,9 @@ macro(write_configtable)
   string(APPEND out "MPI Support                   : ")
   check_on_or_off("${NS3_MPI}" "${MPI_FOUND}")
 
+  string(APPEND out "Multithreaded simulation      : ")
+  check_on_or_off("${NS3_MTP}" "${NS3_MTP}")
+
   string(APPEND out "ns-3 Click Integration        : ")
   check_on_or_off("ON" "${NS3_CLICK}")
 
@@ -188,6 +191,9 @@ macro(write_configtable)
   string(APPEND out "Tests                         : ")
   check_on_or_off("${ENABLE_TESTS}" "${ENABLE_TESTS}")
 
+  string(APPEND out "zlib trace compression        : ")
+  check_on_or_off("ON" "${ZLIB_FOUND}")
+
   # string(APPEND out "Use sudo to set suid bit      : not enabled (option
   # --enable-sudo not selected) string(APPEND out "XmlIo : enabled
   string(APPEND out "\n\n")
@@ -0,0 +1 @@
+#include "/root/repo/src/lte/model/a2-a4-rsrq-handover-algorithm.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/propagation/model/channel-condition-model.h"
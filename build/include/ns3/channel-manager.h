@@ -0,0 +1 @@
+#include "/root/repo/src/wave/model/channel-manager.h"
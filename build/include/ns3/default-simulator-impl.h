@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+
+#ifndef DEFAULT_SIMULATOR_IMPL_H
+#define DEFAULT_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::DefaultSimulatorImpl declaration.
+ */
+
+namespace ns3
+{
+
+// Forward
+class EventProfiler;
+class Scheduler;
+
+/**
+ * \ingroup simulator
+ *
+ * The default single process simulator implementation.
+ *
+ * Events scheduled with ScheduleWithContext() by threads other than the
+ * main one are passed to the main thread through a bounded lock-free
+ * multiple-producer, single-consumer ring, whose size is set by the
+ * \c InjectionQueueSize attribute.  When the ring is full, the events are
+ * appended to a list protected by a mutex until the main thread drains it;
+ * in both cases the events scheduled by each thread are inserted in the
+ * event queue in the order in which they were scheduled.
+ *
+ * When the \c Profile attribute is set, the events are executed through an
+ * EventProfiler, and the profile is written at Simulator::Destroy() to the
+ * \c ProfileFile file, or to the standard output.
+ */
+class DefaultSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    DefaultSimulatorImpl();
+    /** Destructor. */
+    ~DefaultSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /** Counters of the events scheduled from other threads. */
+    struct InjectionStats
+    {
+        uint64_t queued;    //!< Events passed through the lock-free ring.
+        uint64_t overflows; //!< Events passed through the overflow list.
+        uint64_t retries;   //!< Attempts to claim a ring slot lost to another thread.
+    };
+
+    /**
+     * Get the counters of the events scheduled from other threads.
+     *
+     * The counters of the events still waiting to be moved to the event
+     * queue are not updated yet.
+     *
+     * \returns The counters.
+     */
+    InjectionStats GetInjectionStats() const;
+
+  protected:
+    void NotifyConstructionCompleted() override;
+
+  private:
+    void DoDispose() override;
+
+    /** Process the next event. */
+    void ProcessOneEvent();
+    /** Move events from a different context into the main event queue. */
+    void ProcessEventsWithContext();
+
+    /** Wrap an event with its execution context. */
+    struct EventWithContext
+    {
+        /** The event context. */
+        uint32_t context;
+        /** Event timestamp. */
+        uint64_t timestamp;
+        /** The event implementation. */
+        EventImpl* event;
+    };
+    /**
+     * Insert an event from a different thread in the main event queue.
+     *
+     * \param [in] event The event.
+     */
+    void InsertEventWithContext(const EventWithContext& event);
+    /**
+     * Append an event to the lock-free ring.
+     *
+     * Called by any thread other than the main one.
+     *
+     * \param [in] event The event.
+     * \returns \c false if the ring is full.
+     */
+    bool PushEventWithContext(const EventWithContext& event);
+    /**
+     * Remove the oldest event from the lock-free ring.
+     *
+     * Called by the main thread only.
+     *
+     * \param [out] event The event.
+     * \returns \c false if the ring is empty.
+     */
+    bool PopEventWithContext(EventWithContext& event);
+
+    /** A slot of the lock-free ring. */
+    struct RingCell
+    {
+        /**
+         * Position of the next push (if equal to the slot position) or
+         * pop (if equal to the slot position plus one) of this slot.
+         */
+        std::atomic<uint64_t> sequence;
+        /** The event. */
+        EventWithContext event;
+    };
+
+    /** Number of slots of the lock-free ring; a power of two. */
+    uint32_t m_ringSize;
+    /** The lock-free ring of events from a different thread. */
+    std::unique_ptr<RingCell[]> m_ring;
+    /** Position of the next push in the ring. */
+    alignas(64) std::atomic<uint64_t> m_ringPush;
+    /** Number of lost attempts to claim a ring slot. */
+    std::atomic<uint64_t> m_ringRetries;
+    /** Position of the next pop from the ring, only used by the main thread. */
+    alignas(64) uint64_t m_ringPop;
+    /** Number of events moved from the ring to the event queue. */
+    uint64_t m_ringEvents;
+    /** Number of events moved from the overflow list to the event queue. */
+    uint64_t m_overflowEvents;
+
+    /** Container type for the events from a different context. */
+    typedef std::list<struct EventWithContext> EventsWithContext;
+    /** The overflow list of events from a different thread. */
+    EventsWithContext m_eventsWithContext;
+    /**
+     * Flag \c true if the overflow list may not be empty. While set, all
+     * the events from other threads are appended to the list, so that the
+     * events of each thread stay in order.
+     */
+    std::atomic<bool> m_eventsWithContextOverflow;
+    /** Mutex to control access to the overflow list. */
+    std::mutex m_eventsWithContextMutex;
+
+    /** Container type for the events to run at Simulator::Destroy() */
+    typedef std::list<EventId> DestroyEvents;
+    /** The container of events to run at Destroy. */
+    DestroyEvents m_destroyEvents;
+    /** Flag calling for the end of the simulation. */
+    bool m_stop;
+    /** The event priority queue. */
+    Ptr<Scheduler> m_events;
+
+    /** Next event unique id. */
+    uint32_t m_uid;
+    /** Unique id of the current event. */
+    uint32_t m_currentUid;
+    /** Timestamp of the current event. */
+    uint64_t m_currentTs;
+    /** Execution context of the current event. */
+    uint32_t m_currentContext;
+    /** The event count. */
+    uint64_t m_eventCount;
+    /**
+     * Number of events that have been inserted but not yet scheduled,
+     *  not counting the Destroy events; this is used for validation
+     */
+    int m_unscheduledEvents;
+
+    /** Main execution thread. */
+    std::thread::id m_mainThreadId;
+
+    /** Profile the events. */
+    bool m_profile;
+    /** Time one event every this number of events. */
+    uint32_t m_profileSampling;
+    /** Wall-clock interval of the timeline of the profile. */
+    Time m_profileInterval;
+    /** File to write the profile to. */
+    std::string m_profileFile;
+    /** The event profiler, if profiling. */
+    std::unique_ptr<EventProfiler> m_profiler;
+};
+
+} // namespace ns3
+
+#endif /* DEFAULT_SIMULATOR_IMPL_H */
@@ -0,0 +1 @@
+#include "/root/repo/src/mesh/helper/dot11s/dot11s-installer.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/mesh/model/dot11s/dot11s-mac-header.h"
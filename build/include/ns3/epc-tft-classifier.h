@@ -0,0 +1 @@
+#include "/root/repo/src/lte/model/epc-tft-classifier.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/wifi/model/non-ht/erp-ofdm-ppdu.h"
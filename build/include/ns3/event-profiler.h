@@ -0,0 +1,173 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3
+{
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Wall-clock profile of the events executed by a simulator.
+ *
+ * The simulator implementation invokes its events through Invoke(),
+ * which times one event every \c sampling events with the steady clock and
+ * attributes its cost to the dynamic type of the event and to its context.
+ * The dynamic type of the events created by MakeEvent() (and thus by all the
+ * Simulator::Schedule methods) names the class and signature of the bound
+ * member function, or the function enclosing the bound lambda.
+ *
+ * The event rate, the mean cost per event and the number of pending events
+ * are also sampled every \c interval of wall-clock time.  Write() prints:
+ *  - a histogram of the cost of the timed events, in power of two buckets;
+ *  - the cost by event type, and by event type and context;
+ *  - the timeline of the event rate and of the queue depth.
+ *
+ * This class is used by DefaultSimulatorImpl when its \c Profile attribute
+ * is set.
+ */
+class EventProfiler
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] sampling Time one event every this number of events.
+     * \param [in] interval Wall-clock interval between the timeline samples.
+     */
+    EventProfiler(uint32_t sampling, std::chrono::nanoseconds interval);
+
+    /**
+     * Invoke an event, timing it if selected by the sampling.
+     *
+     * \param [in] event The event.
+     * \param [in] context The context of the event.
+     * \param [in] ts The timestamp of the event.
+     * \param [in] depth The number of pending events.
+     */
+    void Invoke(EventImpl* event, uint32_t context, uint64_t ts, uint64_t depth);
+
+    /**
+     * Print the profile.
+     *
+     * \param [in,out] os The output stream.
+     */
+    void Write(std::ostream& os) const;
+
+  private:
+    /** Event type and context of the events. */
+    struct Key
+    {
+        const std::type_info* type; //!< The dynamic type of the event.
+        uint32_t context;           //!< The context of the event.
+
+        /**
+         * Equality operator.
+         * \param [in] other The other key.
+         * \returns \c true if the keys are equal.
+         */
+        bool operator==(const Key& other) const;
+    };
+
+    /** Hash function of a Key. */
+    struct KeyHash
+    {
+        /**
+         * Hash a key.
+         * \param [in] key The key.
+         * \returns The hash of the key.
+         */
+        std::size_t operator()(const Key& key) const;
+    };
+
+    /** Cost of the events of one type, or of one type and context. */
+    struct Cost
+    {
+        uint64_t count; //!< Number of events timed.
+        uint64_t ns;    //!< Total time of the timed events, in ns.
+        uint64_t maxNs; //!< Maximum time of one event, in ns.
+    };
+
+    /** Sample of the timeline. */
+    struct Sample
+    {
+        double wall;    //!< Wall-clock time since the first event, in s.
+        uint64_t ts;    //!< Timestamp of the event.
+        uint64_t count; //!< Number of events executed since the first event.
+        uint64_t depth; //!< Number of pending events.
+    };
+
+    /** Clock used to time the events. */
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Get the demangled name of a type.
+     *
+     * \param [in] type The type.
+     * \returns The demangled type name.
+     */
+    static std::string GetTypeName(const std::type_info& type);
+
+    /**
+     * Print a cost table.
+     *
+     * \param [in,out] os The output stream.
+     * \param [in] costs The costs, sorted by decreasing total time.
+     * \param [in] total The total time of the timed events, in ns.
+     * \param [in] withContext Print the context of the costs.
+     */
+    static void WriteCosts(std::ostream& os,
+                           const std::vector<std::pair<Key, Cost>>& costs,
+                           uint64_t total,
+                           bool withContext);
+
+    /** Number of power of two buckets of the cost histogram. */
+    static const std::size_t HISTOGRAM_SIZE = 40;
+    /** Number of rows printed for the cost by event type and context. */
+    static const std::size_t TOP_CONTEXTS = 20;
+
+    uint32_t m_sampling;                            //!< Time one event every this number.
+    uint32_t m_countdown;                           //!< Events left before the next timed one.
+    std::chrono::nanoseconds m_interval;            //!< Wall-clock interval of the timeline.
+    uint64_t m_count;                               //!< Number of events executed.
+    bool m_started;                                 //!< Has the first event been executed?
+    Clock::time_point m_start;                      //!< Wall-clock time of the first event.
+    Clock::time_point m_last;                       //!< Wall-clock time of the last timed event.
+    Clock::time_point m_nextSample;                 //!< Wall-clock time of the next sample.
+    std::vector<uint64_t> m_histogram;              //!< Histogram of the event costs.
+    std::unordered_map<Key, Cost, KeyHash> m_costs; //!< Cost by event type and context.
+    std::vector<Sample> m_timeline;                 //!< Event rate and queue depth timeline.
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
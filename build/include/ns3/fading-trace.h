@@ -0,0 +1 @@
+#include "/root/repo/src/spectrum/model/fading-trace.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/mobility/helper/group-mobility-helper.h"
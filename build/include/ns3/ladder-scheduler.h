@@ -0,0 +1,189 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * The events are stored in three tiers:
+ *  - Top: an unsorted `std::vector` of the events beyond the time span
+ *    covered by the ladder.
+ *  - Ladder: up to eight rungs of buckets; each rung covers the time
+ *    span of one bucket of the rung above it.  Buckets are unsorted
+ *    `std::vector`s.
+ *  - Bottom: a short `std::vector` sorted in reverse order, from which the
+ *    next events are removed.
+ *
+ * When the bottom is empty it is refilled from the first non-empty bucket
+ * of the lowest rung.  Buckets with more than `Threshold` events are split
+ * in a new rung instead, and the top is spread on a new rung when the
+ * ladder is empty.  Buckets and rungs are recycled, so that once the
+ * queue has reached its steady state no memory is allocated when
+ * inserting or removing events.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Append to top or to a bucket
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | ~Constant       | Possible bottom refill
+ * Remove()     | ~Constant       | Search within bucket
+ * RemoveNext() | ~Constant       | Possible bottom refill
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 8 x 1024 x 3 x `sizeof (*)`<br/>(192 kbytes) | Buckets of all rungs, once used
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /** Event list type: a vector of Events. */
+    typedef std::vector<Scheduler::Event> EventList;
+
+    /** One rung of the ladder. */
+    struct Rung
+    {
+        uint64_t start;          //!< Timestamp of the start of the first bucket.
+        uint64_t width;          //!< Time span of each bucket.
+        std::size_t current;     //!< Index of the first bucket not yet dequeued.
+        std::size_t nBuckets;    //!< Number of buckets in use.
+        std::size_t count;       //!< Number of events in the rung.
+        std::vector<EventList> buckets; //!< The buckets; only the first nBuckets are used.
+    };
+
+    /**
+     * Get the timestamp of the start of the current bucket of a rung.
+     *
+     * Events with a timestamp not smaller than this belong to the rung.
+     *
+     * \param [in] rung The rung.
+     * \return The start of the current bucket.
+     */
+    static uint64_t CurrentStart(const Rung& rung);
+    /**
+     * Prepare an unused rung to spread events over a time span.
+     *
+     * \param [in] start The start of the time span.
+     * \param [in] span The length of the time span.
+     * \param [in] count The number of events which will be inserted.
+     * \return The new rung, which is the lowest one.
+     */
+    Rung& AddRung(uint64_t start, uint64_t span, std::size_t count);
+    /**
+     * Insert an event in a rung.
+     *
+     * \param [in] rung The rung.
+     * \param [in] ev The event.
+     */
+    void InsertInRung(Rung& rung, const Scheduler::Event& ev);
+    /**
+     * Insert an event in the bottom, keeping it sorted.
+     *
+     * \param [in] ev The event.
+     */
+    void InsertInBottom(const Scheduler::Event& ev);
+    /** Spread the bottom on a new rung when it is too long. */
+    void SpawnFromBottom();
+    /** Move the next events to the bottom, if it is empty. */
+    void RefillBottom();
+    /**
+     * Sort the bottom in reverse order, so that the next event is
+     * at the back.
+     */
+    void SortBottom();
+    /**
+     * Remove an event from an unsorted list.
+     *
+     * \param [in,out] list The list.
+     * \param [in] ev The event.
+     * \return \c true if the event was found.
+     */
+    static bool RemoveFrom(EventList& list, const Scheduler::Event& ev);
+
+    /** Maximum number of rungs. */
+    static const std::size_t MAX_RUNGS = 8;
+    /** Maximum number of buckets in a rung. */
+    static const std::size_t MAX_BUCKETS = 1024;
+
+    /** Unsorted events beyond the ladder. */
+    EventList m_top;
+    /** Smallest timestamp of the events in the top. */
+    uint64_t m_topMin;
+    /** Largest timestamp of the events in the top. */
+    uint64_t m_topMax;
+    /** Events with a timestamp not smaller than this belong to the top. */
+    uint64_t m_topStart;
+    /** The rungs; only the first m_nRungs are in use. */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    std::size_t m_nRungs;
+    /** Next events, sorted in reverse order. */
+    EventList m_bottom;
+    /** Number of events in the queue. */
+    std::size_t m_size;
+    /** Maximum number of events moved at once to the bottom. */
+    uint32_t m_threshold;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1 @@
+#include "/root/repo/src/lte/model/lte-fr-hard-algorithm.h"
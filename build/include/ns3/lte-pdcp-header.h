@@ -0,0 +1 @@
+#include "/root/repo/src/lte/model/lte-pdcp-header.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/mesh/model/mesh-point-device.h"
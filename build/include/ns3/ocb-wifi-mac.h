@@ -0,0 +1 @@
+#include "/root/repo/src/wave/model/ocb-wifi-mac.h"
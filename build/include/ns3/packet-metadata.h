@@ -0,0 +1,696 @@
+/*
+ * Copyright (c) 2006,2007 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef PACKET_METADATA_H
+#define PACKET_METADATA_H
+
+#include "buffer.h"
+
+#include "ns3/assert.h"
+#include "ns3/callback.h"
+#include "ns3/type-id.h"
+
+#include <limits>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+class Chunk;
+class Buffer;
+class Header;
+class Trailer;
+
+/**
+ * \ingroup packet
+ * \brief Handle packet metadata about packet headers and trailers
+ *
+ * This class is used by the Packet class to record every operation
+ * performed on the packet's buffer. This class also provides
+ * an implementation of the Packet::Print methods which uses
+ * the metadata to analyse the content of the packet's buffer.
+ *
+ * To achieve this, this class maintains an ordered array of so-called
+ * "items", each of which represents a header or a trailer, or
+ * payload, or a fragment of any of these.
+ *
+ * Each item maintains:
+ *   - its native size (the size it had when it was first added
+ *     to the packet)
+ *   - its type: identifies what kind of header, what kind of trailer,
+ *     if it is payload or not
+ *   - the uid of the packet to which it was first added
+ *   - the start and end of the area represented by a fragment
+ *     if it is one.
+ *
+ * The items are stored in struct PacketMetadata::Data, one array for
+ * each of these fields, such that iterating over the items reads
+ * contiguous memory. The storage is shared by the copies of a
+ * PacketMetadata and copied only when a shared item is modified or
+ * when an item is added next to the items of another copy; a storage
+ * holds 8 items by default and is reallocated with a larger capacity
+ * when it is full. The storages of the default capacity are recycled
+ * by a per-thread free list. No storage is allocated when the metadata
+ * is disabled.
+ */
+class PacketMetadata
+{
+  public:
+    /**
+     * \brief structure describing a packet metadata item
+     */
+    struct Item
+    {
+        /// Type of data in the packet
+        enum ItemType
+        {
+            PAYLOAD, //!< Payload
+            HEADER,  //!< Header
+            TRAILER  //!< Trailer
+        };
+
+        /**
+         * metadata type
+         */
+        ItemType type;
+
+        /**
+         * true: this is a fragmented header, trailer, or, payload.
+         * false: this is a whole header, trailer, or, payload.
+         */
+        bool isFragment;
+        /**
+         * TypeId of Header or Trailer. Valid only if type is
+         * header or trailer.
+         */
+        TypeId tid;
+        /**
+         * size of item. If fragment, size of fragment. Otherwise,
+         * size of original item.
+         */
+        uint32_t currentSize;
+        /**
+         * how many bytes were trimmed from the start of a fragment.
+         * if isFragment is true, this field is zero.
+         */
+        uint32_t currentTrimmedFromStart;
+        /**
+         * how many bytes were trimmed from the end of a fragment.
+         * if isFragment is true, this field is zero.
+         */
+        uint32_t currentTrimmedFromEnd;
+        /**
+         * an iterator which can be fed to Deserialize. Valid only
+         * if isFragment and isPayload are false.
+         */
+        Buffer::Iterator current;
+    };
+
+    /**
+     * \brief Iterator class for metadata items.
+     */
+    class ItemIterator
+    {
+      public:
+        /**
+         * \brief Constructor
+         * \param metadata a pointer to the metadata
+         * \param buffer the buffer the metadata refers to
+         */
+        ItemIterator(const PacketMetadata* metadata, Buffer buffer);
+        /**
+         * \brief Checks if there is another metadata item
+         * \returns true if there is another item
+         */
+        bool HasNext() const;
+        /**
+         * \brief Retrieve the next metadata item
+         * \returns the next metadata item
+         */
+        Item Next();
+
+      private:
+        const PacketMetadata* m_metadata; //!< pointer to the metadata
+        Buffer m_buffer;                  //!< buffer the metadata refers to
+        uint16_t m_current;               //!< index of the next item
+        uint32_t m_offset;                //!< offset of the next item in the buffer
+    };
+
+    /**
+     * \brief Enable the packet metadata
+     */
+    static void Enable();
+    /**
+     * \brief Enable the packet metadata checking
+     */
+    static void EnableChecking();
+
+    /**
+     * \brief Constructor
+     * \param uid packet uid
+     * \param size size of the header
+     */
+    inline PacketMetadata(uint64_t uid, uint32_t size);
+    /**
+     * \brief Copy constructor
+     * \param o the object to copy
+     */
+    inline PacketMetadata(const PacketMetadata& o);
+    /**
+     * \brief Basic assignment
+     * \param o the object to copy
+     * \return a copied object
+     */
+    inline PacketMetadata& operator=(const PacketMetadata& o);
+    inline ~PacketMetadata();
+
+    // Delete default constructor to avoid misuse
+    PacketMetadata() = delete;
+
+    /**
+     * \brief Add an header
+     * \param header header to add
+     * \param size header serialized size
+     */
+    void AddHeader(const Header& header, uint32_t size);
+    /**
+     * \brief Remove an header
+     * \param header header to remove
+     * \param size header serialized size
+     */
+    void RemoveHeader(const Header& header, uint32_t size);
+
+    /**
+     * Add a trailer
+     * \param trailer trailer to add
+     * \param size trailer serialized size
+     */
+    void AddTrailer(const Trailer& trailer, uint32_t size);
+    /**
+     * Remove a trailer
+     * \param trailer trailer to remove
+     * \param size trailer serialized size
+     */
+    void RemoveTrailer(const Trailer& trailer, uint32_t size);
+
+    /**
+     * \brief Creates a fragment.
+     *
+     * \param start the amount of stuff to remove from the start
+     * \param end the amount of stuff to remove from the end
+     * \return the fragment's metadata
+     *
+     * Calling this method is equivalent to calling RemoveAtStart (start)
+     * and then, RemoveAtEnd (end).
+     */
+    PacketMetadata CreateFragment(uint32_t start, uint32_t end) const;
+
+    /**
+     * \brief Add a metadata at the metadata start
+     * \param o the metadata to add
+     */
+    void AddAtEnd(const PacketMetadata& o);
+    /**
+     * \brief Add some padding at the end
+     * \param end size of padding
+     */
+    void AddPaddingAtEnd(uint32_t end);
+    /**
+     * \brief Remove a chunk of metadata at the metadata start
+     * \param start the size of metadata to remove
+     */
+    void RemoveAtStart(uint32_t start);
+    /**
+     * \brief Remove a chunk of metadata at the metadata end
+     * \param end the size of metadata to remove
+     */
+    void RemoveAtEnd(uint32_t end);
+
+    /**
+     * \brief Get the packet Uid
+     * \return the packet Uid
+     */
+    uint64_t GetUid() const;
+
+    /**
+     * \brief Get the metadata serialized size
+     * \return the serialized size
+     */
+    uint32_t GetSerializedSize() const;
+
+    /**
+     * \brief Initialize the item iterator to the buffer begin
+     * \param buffer buffer to initialize.
+     * \return the buffer iterator.
+     */
+    ItemIterator BeginItem(Buffer buffer) const;
+
+    /**
+     * \brief Serialization to raw uint8_t*
+     * \param buffer the buffer to serialize to
+     * \param maxSize the maximum serialization size
+     * \return 1 on success, 0 on failure
+     */
+    uint32_t Serialize(uint8_t* buffer, uint32_t maxSize) const;
+    /**
+     * \brief Deserialization from raw uint8_t*
+     * \param buffer the buffer to deserialize from
+     * \param size the size
+     * \return 1 on success, 0 on failure
+     */
+    uint32_t Deserialize(const uint8_t* buffer, uint32_t size);
+
+  private:
+    /**
+     * \brief Helper for the raw serialization.
+     *
+     * \param data the buffer to write to
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* AddToRawU8(const uint8_t& data,
+                               uint8_t* start,
+                               uint8_t* current,
+                               uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw serialization.
+     *
+     * \param data the buffer to write to
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* AddToRawU16(const uint16_t& data,
+                                uint8_t* start,
+                                uint8_t* current,
+                                uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw serialization.
+     *
+     * \param data the buffer to write to
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* AddToRawU32(const uint32_t& data,
+                                uint8_t* start,
+                                uint8_t* current,
+                                uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw serialization.
+     *
+     * \param data the buffer to write to
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* AddToRawU64(const uint64_t& data,
+                                uint8_t* start,
+                                uint8_t* current,
+                                uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw serialization.
+     *
+     * \param data the buffer to write to
+     * \param dataSize the data size to write to
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* AddToRaw(const uint8_t* data,
+                             uint32_t dataSize,
+                             uint8_t* start,
+                             uint8_t* current,
+                             uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw deserialization.
+     *
+     * \param data the buffer to read from
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* ReadFromRawU8(uint8_t& data,
+                                  const uint8_t* start,
+                                  const uint8_t* current,
+                                  uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw deserialization.
+     *
+     * \param data the buffer to read from
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* ReadFromRawU16(uint16_t& data,
+                                   const uint8_t* start,
+                                   const uint8_t* current,
+                                   uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw deserialization.
+     *
+     * \param data the buffer to read from
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* ReadFromRawU32(uint32_t& data,
+                                   const uint8_t* start,
+                                   const uint8_t* current,
+                                   uint32_t maxSize);
+
+    /**
+     * \brief Helper for the raw deserialization.
+     *
+     * \param data the buffer to read from
+     * \param start start index
+     * \param current current index
+     * \param maxSize maximum size
+     * \return updated current index
+     */
+    static uint8_t* ReadFromRawU64(uint64_t& data,
+                                   const uint8_t* start,
+                                   const uint8_t* current,
+                                   uint32_t maxSize);
+
+    /**
+     * \brief Storage of the items, shared by copy-on-write.
+     *
+     * The fields of the items are stored in separate arrays (a structure
+     * of arrays), allocated in the same memory block as this structure.
+     * The items of a PacketMetadata are the indexes [m_head, m_tail) of
+     * the arrays, so that headers are added in the free slots before
+     * m_head and trailers and concatenated items in the free slots
+     * after m_tail.
+     */
+    struct Data
+    {
+        /**
+         * The reference count of an instance of this data structure.
+         * Each PacketMetadata which references an instance holds a count.
+         */
+        uint32_t m_count;
+        /**
+         * the number of items which fit in the arrays.
+         */
+        uint16_t m_capacity;
+        /**
+         * index of the first item written in the arrays.
+         */
+        uint16_t m_dirtyStart;
+        /**
+         * index after the last item written in the arrays.
+         */
+        uint16_t m_dirtyEnd;
+        /**
+         * uid of the packet to which each item was first added.
+         */
+        uint64_t* m_packetUid;
+        /**
+         * native size of each item: the size it had when it was first
+         * added to a packet.
+         */
+        uint32_t* m_size;
+        /**
+         * offset, from the start of each item, of the start of the
+         * part of the item still present.
+         */
+        uint32_t* m_fragmentStart;
+        /**
+         * offset, from the start of each item, of the end of the
+         * part of the item still present.
+         */
+        uint32_t* m_fragmentEnd;
+        /**
+         * TypeId uid of the header or trailer represented by each item:
+         * the value zero represents payload.
+         */
+        uint16_t* m_typeUid;
+        /**
+         * uid of the header or trailer _instance_ of each item, used
+         * with the packet uid and the type uid to test whether two
+         * fragments are parts of the same header or trailer instance.
+         */
+        uint16_t* m_chunkUid;
+        /**
+         * PacketMetadata::Item::ItemType of each item.
+         */
+        uint8_t* m_type;
+    };
+
+    /**
+     * \brief The fields of one item.
+     */
+    struct ItemData
+    {
+        uint64_t packetUid;     //!< uid of the packet to which the item was first added
+        uint32_t size;          //!< native size of the item
+        uint32_t fragmentStart; //!< start of the part of the item still present
+        uint32_t fragmentEnd;   //!< end of the part of the item still present
+        uint16_t typeUid;       //!< TypeId uid of the item, zero for payload
+        uint16_t chunkUid;      //!< uid of the header or trailer instance
+        uint8_t type;           //!< PacketMetadata::Item::ItemType of the item
+    };
+
+    /// Friend class
+    friend class ItemIterator;
+
+    /**
+     * \brief Read an item.
+     * \param index the index of the item
+     * \param item the item fields
+     */
+    inline void ReadItem(uint16_t index, ItemData* item) const;
+    /**
+     * \brief Write an item.
+     * \param index the index of the item
+     * \param item the item fields
+     */
+    inline void WriteItem(uint16_t index, const ItemData& item);
+    /**
+     * \brief Make room to add items before the first item.
+     * \param n the number of items to add
+     */
+    void ReserveHead(uint16_t n);
+    /**
+     * \brief Make room to add items after the last item.
+     * \param n the number of items to add
+     */
+    void ReserveTail(uint16_t n);
+    /**
+     * \brief Make sure that the items are not shared, to modify them.
+     */
+    void Unshare();
+    /**
+     * \brief Copy the items in a new storage.
+     * \param head the number of free slots needed before the first item
+     * \param tail the number of free slots needed after the last item
+     */
+    void ReserveCopy(uint16_t head, uint16_t tail);
+    /**
+     * \brief Add an item after the last item.
+     * \param item the item to add
+     */
+    void AddItemAtEnd(const ItemData& item);
+
+    /**
+     * \brief Get the total size used by the metadata
+     * \return the metadata used size
+     */
+    uint32_t GetTotalSize() const;
+
+    /**
+     * \brief Add an header
+     * \param uid header's uid to add
+     * \param size header serialized size
+     * \param type the type of the item: header or payload
+     */
+    void DoAddHeader(uint16_t uid, uint32_t size, Item::ItemType type);
+    /**
+     * \brief Check if the metadata state is ok
+     * \return true if the internal state is ok
+     */
+    bool IsStateOk() const;
+
+    /**
+     * \brief Recycle the storage of the items
+     * \param data the storage
+     */
+    static void Recycle(struct PacketMetadata::Data* data);
+    /**
+     * \brief Create a storage for the items
+     * \param capacity the number of items
+     * \return the storage
+     */
+    static struct PacketMetadata::Data* Create(uint16_t capacity);
+    /**
+     * \brief Allocate a storage for the items
+     * \param capacity the number of items
+     * \return the storage
+     */
+    static struct PacketMetadata::Data* Allocate(uint16_t capacity);
+    /**
+     * \brief Deallocate the storage of the items
+     * \param data the storage
+     */
+    static void Deallocate(struct PacketMetadata::Data* data);
+    /**
+     * \brief Copy consecutive items between two storages
+     * \param from the source storage
+     * \param fromIndex the index of the first item to copy in the source
+     * \param to the destination storage
+     * \param toIndex the index of the first item copied in the destination
+     * \param n the number of items to copy
+     */
+    static void CopyItems(const struct PacketMetadata::Data* from,
+                          uint16_t fromIndex,
+                          struct PacketMetadata::Data* to,
+                          uint16_t toIndex,
+                          uint16_t n);
+
+    static bool m_enable;         //!< Enable the packet metadata
+    static bool m_enableChecking; //!< Enable the packet metadata checking
+
+    /**
+     * Set to true when any of the metadata operations is skipped because
+     * the metadata is disabled, to detect a call to Enable() too late.
+     */
+    static bool m_metadataSkipped;
+
+    static uint16_t m_chunkUid; //!< Chunk Uid
+
+    struct Data* m_data;  //!< Storage of the items, null if no item was ever added
+    uint16_t m_head;      //!< index of the first item
+    uint16_t m_tail;      //!< index after the last item
+    uint64_t m_packetUid; //!< packet Uid
+};
+
+} // namespace ns3
+
+namespace ns3
+{
+
+PacketMetadata::PacketMetadata(uint64_t uid, uint32_t size)
+    : m_data(nullptr),
+      m_head(0),
+      m_tail(0),
+      m_packetUid(uid)
+{
+    if (size > 0)
+    {
+        DoAddHeader(0, size, Item::PAYLOAD);
+    }
+}
+
+PacketMetadata::PacketMetadata(const PacketMetadata& o)
+    : m_data(o.m_data),
+      m_head(o.m_head),
+      m_tail(o.m_tail),
+      m_packetUid(o.m_packetUid)
+{
+    if (m_data != nullptr)
+    {
+        NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
+        m_data->m_count++;
+    }
+}
+
+PacketMetadata&
+PacketMetadata::operator=(const PacketMetadata& o)
+{
+    if (m_data != o.m_data)
+    {
+        // not self assignment
+        if (m_data != nullptr)
+        {
+            m_data->m_count--;
+            if (m_data->m_count == 0)
+            {
+                PacketMetadata::Recycle(m_data);
+            }
+        }
+        m_data = o.m_data;
+        if (m_data != nullptr)
+        {
+            m_data->m_count++;
+        }
+    }
+    m_head = o.m_head;
+    m_tail = o.m_tail;
+    m_packetUid = o.m_packetUid;
+    return *this;
+}
+
+PacketMetadata::~PacketMetadata()
+{
+    if (m_data != nullptr)
+    {
+        m_data->m_count--;
+        if (m_data->m_count == 0)
+        {
+            PacketMetadata::Recycle(m_data);
+        }
+    }
+}
+
+void
+PacketMetadata::ReadItem(uint16_t index, ItemData* item) const
+{
+    NS_ASSERT(m_data != nullptr && index < m_data->m_capacity);
+    item->packetUid = m_data->m_packetUid[index];
+    item->size = m_data->m_size[index];
+    item->fragmentStart = m_data->m_fragmentStart[index];
+    item->fragmentEnd = m_data->m_fragmentEnd[index];
+    item->typeUid = m_data->m_typeUid[index];
+    item->chunkUid = m_data->m_chunkUid[index];
+    item->type = m_data->m_type[index];
+}
+
+void
+PacketMetadata::WriteItem(uint16_t index, const ItemData& item)
+{
+    NS_ASSERT(m_data != nullptr && index < m_data->m_capacity);
+    m_data->m_packetUid[index] = item.packetUid;
+    m_data->m_size[index] = item.size;
+    m_data->m_fragmentStart[index] = item.fragmentStart;
+    m_data->m_fragmentEnd[index] = item.fragmentEnd;
+    m_data->m_typeUid[index] = item.typeUid;
+    m_data->m_chunkUid[index] = item.chunkUid;
+    m_data->m_type[index] = item.type;
+}
+
+} // namespace ns3
+
+#endif /* PACKET_METADATA_H */
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef PACKET_TAG_LIST_H
+#define PACKET_TAG_LIST_H
+
+/**
+\file   packet-tag-list.h
+\brief  Defines a list of Packet tags, including copy-on-write semantics.
+*/
+
+#include "ns3/type-id.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3
+{
+
+class Tag;
+
+/**
+ * \ingroup packet
+ *
+ * \brief List of the packet tags stored in a packet.
+ *
+ * This class is mostly private to the Packet implementation and users
+ * should never have to access it directly.
+ *
+ * \internal
+ *
+ *   - Tags are stored in serialized form, as consecutive TagData records
+ *     (aligned on 4 bytes), the most recent tag first.
+ *
+ *   - The records are stored in a small buffer within the PacketTagList
+ *     as long as they fit in #INLINE_SIZE bytes, which is enough for a few
+ *     small tags, so that most packets need no memory allocation for
+ *     their tags. Copying such a list copies the records.
+ *
+ *   - Larger lists are stored in a heap-allocated, reference-counted
+ *     block, which is shared by the copies of the list until one of them
+ *     is modified (copy-on-write).
+ *
+ *   - A 64-bit filter, with the bit of index <tt>uid % 64</tt> set for the
+ *     TypeId uid of each tag, makes #Peek, #Remove and #Replace return
+ *     without scanning the records when the tag type is absent, which is
+ *     the most frequent case of lookup.
+ */
+class PacketTagList
+{
+  public:
+    /**
+     * Serialized tag.
+     *
+     * \internal
+     * Unfortunately this has to be public, because
+     * PacketTagIterator::Item::GetTag() needs the data and size values.
+     * The Item nested class can't be forward declared, so friending isn't
+     * possible.
+     *
+     * A record is followed by the serialized tag, and padded to a multiple
+     * of 4 bytes.
+     */
+    struct TagData
+    {
+        uint32_t size;   //!< Size of the \c data buffer
+        TypeId tid;      //!< Type of the tag serialized into #data
+        uint8_t data[2]; //!< Serialization buffer
+    };
+
+    /**
+     * Create a new PacketTagList.
+     */
+    inline PacketTagList();
+    /**
+     * Copy constructor
+     *
+     * \param [in] o The PacketTagList to copy.
+     *
+     * This copies the records stored in the PacketTagList, or shares
+     * the heap-allocated records of \pname{o}.
+     */
+    inline PacketTagList(const PacketTagList& o);
+    /**
+     * Assignment
+     *
+     * \param [in] o The PacketTagList to copy.
+     * \returns the copied object
+     *
+     * This copies the records stored in the PacketTagList, or shares
+     * the heap-allocated records of \pname{o}.
+     */
+    inline PacketTagList& operator=(const PacketTagList& o);
+    /**
+     * Destructor
+     */
+    inline ~PacketTagList();
+
+    /**
+     * Add a tag to the head of this list.
+     *
+     * \param [in] tag The tag to add
+     */
+    void Add(const Tag& tag) const;
+    /**
+     * Remove (the first instance of) tag from the list.
+     *
+     * \param [in,out] tag The tag type to remove.  If found,
+     *          \pname{tag} is set to the value of the tag found.
+     * \returns True if \pname{tag} is found, false otherwise.
+     */
+    bool Remove(Tag& tag);
+    /**
+     * Replace the value of a tag.
+     *
+     * \param [in] tag The tag type to replace.  To get the old
+     *        value of the tag, use #Peek first.
+     * \returns True if \pname{tag} is found, false otherwise.
+     *        If \pname{tag} wasn't found, Add is performed instead (so
+     *        the list is guaranteed to have the new tag value either way).
+     */
+    bool Replace(Tag& tag);
+    /**
+     * Find a tag and return its value.
+     *
+     * \param [in,out] tag The tag type to find.  If found,
+     *          \pname{tag} is set to the value of the tag found.
+     * \returns True if \pname{tag} is found, false otherwise.
+     */
+    bool Peek(Tag& tag) const;
+    /**
+     * Remove all tags from this list.
+     */
+    inline void RemoveAll();
+    /**
+     * \returns pointer to the first tag of the list, or null if the list is empty
+     */
+    const struct PacketTagList::TagData* Head() const;
+    /**
+     * \param [in] data A tag of this list.
+     * \returns pointer to the tag after \pname{data}, or null if it is the last one
+     */
+    const struct PacketTagList::TagData* Next(const struct PacketTagList::TagData* data) const;
+    /**
+     * Returns number of bytes required for packet serialization.
+     *
+     * \returns number of bytes required for packet serialization
+     */
+    uint32_t GetSerializedSize() const;
+    /**
+     * Serialize the tag list into a byte buffer.
+     *
+     * \param [in,out] buffer The byte buffer to which the tag list will be serialized
+     * \param [in] maxSize Max The max size of the buffer for bounds checking
+     *
+     * \returns zero if complete tag list is not serialized
+     */
+    uint32_t Serialize(uint32_t* buffer, uint32_t maxSize) const;
+    /**
+     * Deserialize tag list from the provided buffer.
+     *
+     * \param [in] buffer The buffer to read from.
+     * \param [in] size The number of bytes to deserialize.
+     *
+     * \returns zero if complete tag list is not deserialized
+     */
+    uint32_t Deserialize(const uint32_t* buffer, uint32_t size);
+
+  private:
+    /**
+     * Heap-allocated records, shared by copy-on-write.
+     */
+    struct SharedData
+    {
+        uint32_t count;    //!< Number of PacketTagList using these records
+        uint32_t capacity; //!< Size of the \c data buffer
+        uint8_t data[8];   //!< The records
+    };
+
+    /** Size of the buffer of the records stored in the PacketTagList. */
+    static const uint32_t INLINE_SIZE = 64;
+
+    /**
+     * \returns The records.
+     */
+    inline const uint8_t* GetData() const;
+    /**
+     * Get the size of the record of a tag.
+     *
+     * \param [in] dataSize The serialized size of the tag.
+     * \returns The size of the record, including its padding.
+     */
+    static uint32_t GetRecordSize(uint32_t dataSize);
+    /**
+     * Get the bit of the filter of a tag type.
+     *
+     * \param [in] tid The tag type.
+     * \returns The bit of the filter.
+     */
+    static uint64_t GetFilterBit(TypeId tid);
+    /**
+     * Find the record of a tag type.
+     *
+     * \param [in] tid The tag type.
+     * \returns The offset of the record, or #m_used if absent.
+     */
+    uint32_t Find(TypeId tid) const;
+    /**
+     * Make sure that the records are not shared and that their
+     * storage can hold some bytes.
+     *
+     * \param [in] size The number of bytes needed.
+     * \returns The records.
+     */
+    uint8_t* Reserve(uint32_t size);
+    /**
+     * Remove a record.
+     *
+     * \param [in] offset The offset of the record.
+     */
+    void Erase(uint32_t offset);
+    /**
+     * Write a record.
+     *
+     * \param [in] offset The offset of the record.
+     * \param [in] tid The type of the tag.
+     * \param [in] dataSize The serialized size of the tag.
+     * \returns The record.
+     */
+    TagData* WriteRecord(uint32_t offset, TypeId tid, uint32_t dataSize);
+    /**
+     * Release the heap-allocated records, if any.
+     */
+    inline void Release();
+    /**
+     * Copy the records of another list.
+     *
+     * \param [in] o The other list.
+     */
+    inline void CopyFrom(const PacketTagList& o);
+
+    SharedData* m_shared;               //!< The heap-allocated records, or null if inline
+    uint64_t m_filter;                  //!< Bit filter of the tag types of the list
+    uint32_t m_used;                    //!< Number of bytes of the records
+    uint32_t m_inline[INLINE_SIZE / 4]; //!< The records, if they are not heap-allocated
+};
+
+} // namespace ns3
+
+/****************************************************
+ *  Implementation of inline methods for performance
+ ****************************************************/
+
+namespace ns3
+{
+
+PacketTagList::PacketTagList()
+    : m_shared(nullptr),
+      m_filter(0),
+      m_used(0)
+{
+}
+
+PacketTagList::PacketTagList(const PacketTagList& o)
+    : m_shared(nullptr)
+{
+    CopyFrom(o);
+}
+
+PacketTagList&
+PacketTagList::operator=(const PacketTagList& o)
+{
+    // self assignment
+    if (this == &o)
+    {
+        return *this;
+    }
+    Release();
+    CopyFrom(o);
+    return *this;
+}
+
+PacketTagList::~PacketTagList()
+{
+    Release();
+}
+
+void
+PacketTagList::RemoveAll()
+{
+    Release();
+    m_filter = 0;
+    m_used = 0;
+}
+
+const uint8_t*
+PacketTagList::GetData() const
+{
+    return m_shared != nullptr ? m_shared->data : reinterpret_cast<const uint8_t*>(m_inline);
+}
+
+void
+PacketTagList::Release()
+{
+    if (m_shared != nullptr)
+    {
+        m_shared->count--;
+        if (m_shared->count == 0)
+        {
+            std::free(m_shared);
+        }
+        m_shared = nullptr;
+    }
+}
+
+void
+PacketTagList::CopyFrom(const PacketTagList& o)
+{
+    m_filter = o.m_filter;
+    m_used = o.m_used;
+    m_shared = o.m_shared;
+    if (m_shared != nullptr)
+    {
+        m_shared->count++;
+    }
+    else
+    {
+        std::memcpy(m_inline, o.m_inline, m_used);
+    }
+}
+
+} // namespace ns3
+
+#endif /* PACKET_TAG_LIST_H */
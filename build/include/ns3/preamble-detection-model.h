@@ -0,0 +1 @@
+#include "/root/repo/src/wifi/model/preamble-detection-model.h"
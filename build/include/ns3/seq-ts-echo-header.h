@@ -0,0 +1 @@
+#include "/root/repo/src/applications/model/seq-ts-echo-header.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/uan/helper/uan-helper.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/uan/model/uan-mac-rc.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/wave/model/vendor-specific-action.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/wave/model/wave-frame-exchange-manager.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/wave/helper/wave-helper.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/wave/helper/wave-mac-helper.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/wave/model/wave-net-device.h"
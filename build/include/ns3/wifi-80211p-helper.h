@@ -0,0 +1 @@
+#include "/root/repo/src/wave/helper/wifi-80211p-helper.h"
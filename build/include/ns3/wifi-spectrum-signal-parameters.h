@@ -0,0 +1 @@
+#include "/root/repo/src/wifi/model/wifi-spectrum-signal-parameters.h"
@@ -19,12 +19,19 @@
 
 #include "default-simulator-impl.h"
 
+#include "abort.h"
 #include "assert.h"
+#include "boolean.h"
+#include "event-profiler.h"
 #include "log.h"
 #include "scheduler.h"
 #include "simulator.h"
+#include "string.h"
+#include "uinteger.h"
 
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 /**
  * \file
@@ -48,7 +55,40 @@ DefaultSimulatorImpl::GetTypeId()
     static TypeId tid = TypeId("ns3::DefaultSimulatorImpl")
                             .SetParent<SimulatorImpl>()
                             .SetGroupName("Core")
-                            .AddConstructor<DefaultSimulatorImpl>();
+                            .AddConstructor<DefaultSimulatorImpl>()
+                            .AddAttribute("InjectionQueueSize",
+                                          "Number of slots of the lock-free ring of the events "
+                                          "scheduled by other threads, rounded up to a power "
+                                          "of two. Events are appended to a locked list when "
+                                          "the ring is full.",
+                                          UintegerValue(4096),
+                                          MakeUintegerAccessor(&DefaultSimulatorImpl::m_ringSize),
+                                          MakeUintegerChecker<uint32_t>(1, 1U << 31))
+                            .AddAttribute("Profile",
+                                          "Time the execution of the events, and write their "
+                                          "profile at Simulator::Destroy.",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&DefaultSimulatorImpl::m_profile),
+                                          MakeBooleanChecker())
+                            .AddAttribute(
+                                "ProfileSampling",
+                                "When profiling, time one event every this number of events.",
+                                UintegerValue(1),
+                                MakeUintegerAccessor(&DefaultSimulatorImpl::m_profileSampling),
+                                MakeUintegerChecker<uint32_t>(1))
+                            .AddAttribute(
+                                "ProfileInterval",
+                                "When profiling, the wall-clock interval between the samples "
+                                "of the event rate and of the number of pending events.",
+                                TimeValue(Seconds(1)),
+                                MakeTimeAccessor(&DefaultSimulatorImpl::m_profileInterval),
+                                MakeTimeChecker(NanoSeconds(1)))
+                            .AddAttribute("ProfileFile",
+                                          "The file to write the profile to; if empty, the "
+                                          "profile is written to the standard output.",
+                                          StringValue(""),
+                                          MakeStringAccessor(&DefaultSimulatorImpl::m_profileFile),
+                                          MakeStringChecker());
     return tid;
 }
 
@@ -62,8 +102,16 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
     m_eventCount = 0;
-    m_eventsWithContextEmpty = true;
+    m_ringSize = 4096;
+    m_ringPush = 0;
+    m_ringRetries = 0;
+    m_ringPop = 0;
+    m_ringEvents = 0;
+    m_overflowEvents = 0;
+    m_eventsWithContextOverflow = false;
     m_mainThreadId = std::this_thread::get_id();
+    m_profile = false;
+    m_profileSampling = 1;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl()
@@ -71,6 +119,30 @@ DefaultSimulatorImpl::~DefaultSimulatorImpl()
     NS_LOG_FUNCTION(this);
 }
 
+void
+DefaultSimulatorImpl::NotifyConstructionCompleted()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t size = 1;
+    while (size < m_ringSize)
+    {
+        size <<= 1;
+    }
+    m_ringSize = size;
+    m_ring = std::make_unique<RingCell[]>(m_ringSize);
+    for (uint32_t i = 0; i < m_ringSize; ++i)
+    {
+        m_ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    if (m_profile)
+    {
+        m_profiler = std::make_unique<EventProfiler>(
+            m_profileSampling,
+            std::chrono::nanoseconds(m_profileInterval.GetNanoSeconds()));
+    }
+    SimulatorImpl::NotifyConstructionCompleted();
+}
+
 void
 DefaultSimulatorImpl::DoDispose()
 {
@@ -100,6 +172,20 @@ DefaultSimulatorImpl::Destroy()
             ev->Invoke();
         }
     }
+    if (m_profiler)
+    {
+        if (m_profileFile.empty())
+        {
+            m_profiler->Write(std::cout);
+        }
+        else
+        {
+            std::ofstream os(m_profileFile);
+            NS_ABORT_MSG_UNLESS(os.is_open(), "Cannot open the profile file " << m_profileFile);
+            m_profiler->Write(os);
+        }
+        m_profiler = nullptr;
+    }
 }
 
 void
@@ -141,7 +227,14 @@ DefaultSimulatorImpl::ProcessOneEvent()
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
-    next.impl->Invoke();
+    if (m_profiler)
+    {
+        m_profiler->Invoke(next.impl, m_currentContext, m_currentTs, m_unscheduledEvents);
+    }
+    else
+    {
+        next.impl->Invoke();
+    }
     next.impl->Unref();
 
     ProcessEventsWithContext();
@@ -153,11 +246,87 @@ DefaultSimulatorImpl::IsFinished() const
     return m_events->IsEmpty() || m_stop;
 }
 
+bool
+DefaultSimulatorImpl::PushEventWithContext(const EventWithContext& event)
+{
+    // Bounded queue of Dmitry Vyukov, with a single consumer
+    uint64_t mask = m_ringSize - 1;
+    uint64_t pos = m_ringPush.load(std::memory_order_relaxed);
+    RingCell* cell;
+    while (true)
+    {
+        cell = &m_ring[pos & mask];
+        uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<int64_t>(sequence - pos);
+        if (diff == 0)
+        {
+            if (m_ringPush.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+            m_ringRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds the event pushed one lap earlier
+            return false;
+        }
+        else
+        {
+            // Another thread claimed the slot
+            m_ringRetries.fetch_add(1, std::memory_order_relaxed);
+            pos = m_ringPush.load(std::memory_order_relaxed);
+        }
+    }
+    cell->event = event;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool
+DefaultSimulatorImpl::PopEventWithContext(EventWithContext& event)
+{
+    RingCell& cell = m_ring[m_ringPop & (m_ringSize - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != m_ringPop + 1)
+    {
+        return false;
+    }
+    event = cell.event;
+    cell.sequence.store(m_ringPop + m_ringSize, std::memory_order_release);
+    m_ringPop++;
+    return true;
+}
+
+void
+DefaultSimulatorImpl::InsertEventWithContext(const EventWithContext& event)
+{
+    Scheduler::Event ev;
+    ev.impl = event.event;
+    ev.key.m_ts = m_currentTs + event.timestamp;
+    ev.key.m_context = event.context;
+    ev.key.m_uid = m_uid;
+    m_uid++;
+    m_unscheduledEvents++;
+    m_events->Insert(ev);
+}
+
 void
 DefaultSimulatorImpl::ProcessEventsWithContext()
 {
-    if (m_eventsWithContextEmpty)
+    // The events pushed in the ring by a thread before it overflowed
+    // are inserted first, to keep the events of each thread in order
+    EventWithContext event;
+    while (PopEventWithContext(event))
     {
+        InsertEventWithContext(event);
+        m_ringEvents++;
+    }
+
+    if (!m_eventsWithContextOverflow.load(std::memory_order_acquire) ||
+        m_ringPush.load(std::memory_order_acquire) != m_ringPop)
+    {
+        // Also wait for the ring slots claimed but not written yet: they
+        // may hold events older than the overflow list
         return;
     }
 
@@ -166,21 +335,24 @@ DefaultSimulatorImpl::ProcessEventsWithContext()
     {
         std::unique_lock lock{m_eventsWithContextMutex};
         m_eventsWithContext.swap(eventsWithContext);
-        m_eventsWithContextEmpty = true;
+        m_eventsWithContextOverflow.store(false, std::memory_order_release);
     }
-    while (!eventsWithContext.empty())
+    for (const auto& ev : eventsWithContext)
     {
-        EventWithContext event = eventsWithContext.front();
-        eventsWithContext.pop_front();
-        Scheduler::Event ev;
-        ev.impl = event.event;
-        ev.key.m_ts = m_currentTs + event.timestamp;
-        ev.key.m_context = event.context;
-        ev.key.m_uid = m_uid;
-        m_uid++;
-        m_unscheduledEvents++;
-        m_events->Insert(ev);
+        InsertEventWithContext(ev);
     }
+    m_overflowEvents += eventsWithContext.size();
+}
+
+DefaultSimulatorImpl::InjectionStats
+DefaultSimulatorImpl::GetInjectionStats() const
+{
+    NS_LOG_FUNCTION(this);
+    InjectionStats stats;
+    stats.queued = m_ringEvents;
+    stats.overflows = m_overflowEvents;
+    stats.retries = m_ringRetries.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void
@@ -264,10 +436,12 @@ DefaultSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, E
         // Current time added in ProcessEventsWithContext()
         ev.timestamp = delay.GetTimeStep();
         ev.event = event;
+        if (m_eventsWithContextOverflow.load(std::memory_order_acquire) ||
+            !PushEventWithContext(ev))
         {
             std::unique_lock lock{m_eventsWithContextMutex};
             m_eventsWithContext.push_back(ev);
-            m_eventsWithContextEmpty = false;
+            m_eventsWithContextOverflow.store(true, std::memory_order_release);
         }
     }
 }
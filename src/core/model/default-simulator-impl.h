@@ -22,8 +22,11 @@
 
 #include "simulator-impl.h"
 
+#include <atomic>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 
 /**
@@ -36,12 +39,25 @@ namespace ns3
 {
 
 // Forward
+class EventProfiler;
 class Scheduler;
 
 /**
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * Events scheduled with ScheduleWithContext() by threads other than the
+ * main one are passed to the main thread through a bounded lock-free
+ * multiple-producer, single-consumer ring, whose size is set by the
+ * \c InjectionQueueSize attribute.  When the ring is full, the events are
+ * appended to a list protected by a mutex until the main thread drains it;
+ * in both cases the events scheduled by each thread are inserted in the
+ * event queue in the order in which they were scheduled.
+ *
+ * When the \c Profile attribute is set, the events are executed through an
+ * EventProfiler, and the profile is written at Simulator::Destroy() to the
+ * \c ProfileFile file, or to the standard output.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -78,6 +94,27 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
 
+    /** Counters of the events scheduled from other threads. */
+    struct InjectionStats
+    {
+        uint64_t queued;    //!< Events passed through the lock-free ring.
+        uint64_t overflows; //!< Events passed through the overflow list.
+        uint64_t retries;   //!< Attempts to claim a ring slot lost to another thread.
+    };
+
+    /**
+     * Get the counters of the events scheduled from other threads.
+     *
+     * The counters of the events still waiting to be moved to the event
+     * queue are not updated yet.
+     *
+     * \returns The counters.
+     */
+    InjectionStats GetInjectionStats() const;
+
+  protected:
+    void NotifyConstructionCompleted() override;
+
   private:
     void DoDispose() override;
 
@@ -96,16 +133,69 @@ class DefaultSimulatorImpl : public SimulatorImpl
         /** The event implementation. */
         EventImpl* event;
     };
+    /**
+     * Insert an event from a different thread in the main event queue.
+     *
+     * \param [in] event The event.
+     */
+    void InsertEventWithContext(const EventWithContext& event);
+    /**
+     * Append an event to the lock-free ring.
+     *
+     * Called by any thread other than the main one.
+     *
+     * \param [in] event The event.
+     * \returns \c false if the ring is full.
+     */
+    bool PushEventWithContext(const EventWithContext& event);
+    /**
+     * Remove the oldest event from the lock-free ring.
+     *
+     * Called by the main thread only.
+     *
+     * \param [out] event The event.
+     * \returns \c false if the ring is empty.
+     */
+    bool PopEventWithContext(EventWithContext& event);
+
+    /** A slot of the lock-free ring. */
+    struct RingCell
+    {
+        /**
+         * Position of the next push (if equal to the slot position) or
+         * pop (if equal to the slot position plus one) of this slot.
+         */
+        std::atomic<uint64_t> sequence;
+        /** The event. */
+        EventWithContext event;
+    };
+
+    /** Number of slots of the lock-free ring; a power of two. */
+    uint32_t m_ringSize;
+    /** The lock-free ring of events from a different thread. */
+    std::unique_ptr<RingCell[]> m_ring;
+    /** Position of the next push in the ring. */
+    alignas(64) std::atomic<uint64_t> m_ringPush;
+    /** Number of lost attempts to claim a ring slot. */
+    std::atomic<uint64_t> m_ringRetries;
+    /** Position of the next pop from the ring, only used by the main thread. */
+    alignas(64) uint64_t m_ringPop;
+    /** Number of events moved from the ring to the event queue. */
+    uint64_t m_ringEvents;
+    /** Number of events moved from the overflow list to the event queue. */
+    uint64_t m_overflowEvents;
+
     /** Container type for the events from a different context. */
     typedef std::list<struct EventWithContext> EventsWithContext;
-    /** The container of events from a different context. */
+    /** The overflow list of events from a different thread. */
     EventsWithContext m_eventsWithContext;
     /**
-     * Flag \c true if all events with context have been moved to the
-     * primary event queue.
+     * Flag \c true if the overflow list may not be empty. While set, all
+     * the events from other threads are appended to the list, so that the
+     * events of each thread stay in order.
      */
-    bool m_eventsWithContextEmpty;
-    /** Mutex to control access to the list of events with context. */
+    std::atomic<bool> m_eventsWithContextOverflow;
+    /** Mutex to control access to the overflow list. */
     std::mutex m_eventsWithContextMutex;
 
     /** Container type for the events to run at Simulator::Destroy() */
@@ -135,6 +225,17 @@ class DefaultSimulatorImpl : public SimulatorImpl
 
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
+
+    /** Profile the events. */
+    bool m_profile;
+    /** Time one event every this number of events. */
+    uint32_t m_profileSampling;
+    /** Wall-clock interval of the timeline of the profile. */
+    Time m_profileInterval;
+    /** File to write the profile to. */
+    std::string m_profileFile;
+    /** The event profiler, if profiling. */
+    std::unique_ptr<EventProfiler> m_profiler;
 };
 
 } // namespace ns3
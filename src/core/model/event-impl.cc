@@ -21,6 +21,8 @@
 
 #include "log.h"
 
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -32,6 +34,142 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+#if defined(__SANITIZE_ADDRESS__)
+#define NS3_EVENT_POOL_DISABLED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NS3_EVENT_POOL_DISABLED
+#endif
+#endif
+
+namespace
+{
+
+/** Size granularity of the event pool size classes. */
+constexpr std::size_t POOL_GRANULARITY = 16;
+/** Number of size classes of the event pool. */
+constexpr std::size_t POOL_CLASSES = 16;
+/** Maximum number of free blocks kept by a thread for each size class. */
+constexpr std::size_t POOL_MAX_CACHED = 65536;
+
+/**
+ * \ingroup events
+ * Per-thread free lists of event memory blocks.
+ */
+class EventPool
+{
+  public:
+    /** Release all the cached blocks. */
+    ~EventPool();
+    /**
+     * Allocate a block.
+     *
+     * \param [in] size The requested size.
+     * \returns The block.
+     */
+    void* Allocate(std::size_t size);
+    /**
+     * Release a block.
+     *
+     * \param [in] ptr The block.
+     * \param [in] size The size given to Allocate().
+     */
+    void Release(void* ptr, std::size_t size);
+    /**
+     * Get the pool statistics.
+     *
+     * \returns The pool statistics.
+     */
+    EventImpl::PoolStats GetStats() const;
+
+  private:
+    /** A free block, linked in the free list of its size class. */
+    struct FreeBlock
+    {
+        FreeBlock* next; //!< The next free block.
+    };
+
+    FreeBlock* m_free[POOL_CLASSES]{};    //!< Free list of each size class.
+    std::size_t m_cached[POOL_CLASSES]{}; //!< Length of each free list.
+    EventImpl::PoolStats m_stats{};       //!< Pool statistics.
+};
+
+/**
+ * Has the pool of this thread been destroyed?
+ *
+ * Events released by the destructors of static objects, after the pool of
+ * the main thread, are returned to the global allocator.
+ */
+thread_local bool g_poolDestroyed = false;
+/** The event pool of this thread. */
+thread_local EventPool g_pool;
+
+EventPool::~EventPool()
+{
+    for (std::size_t i = 0; i < POOL_CLASSES; ++i)
+    {
+        while (m_free[i] != nullptr)
+        {
+            FreeBlock* block = m_free[i];
+            m_free[i] = block->next;
+            ::operator delete(block);
+        }
+    }
+    g_poolDestroyed = true;
+}
+
+void*
+EventPool::Allocate(std::size_t size)
+{
+    std::size_t index = (size - 1) / POOL_GRANULARITY;
+    if (index >= POOL_CLASSES)
+    {
+        m_stats.misses++;
+        return ::operator new(size);
+    }
+    FreeBlock* block = m_free[index];
+    if (block == nullptr)
+    {
+        m_stats.misses++;
+        return ::operator new((index + 1) * POOL_GRANULARITY);
+    }
+    m_free[index] = block->next;
+    m_cached[index]--;
+    m_stats.hits++;
+    return block;
+}
+
+void
+EventPool::Release(void* ptr, std::size_t size)
+{
+    std::size_t index = (size - 1) / POOL_GRANULARITY;
+    if (index >= POOL_CLASSES || m_cached[index] >= POOL_MAX_CACHED)
+    {
+        m_stats.frees++;
+        ::operator delete(ptr);
+        return;
+    }
+    auto block = static_cast<FreeBlock*>(ptr);
+    block->next = m_free[index];
+    m_free[index] = block;
+    m_cached[index]++;
+    m_stats.releases++;
+}
+
+EventImpl::PoolStats
+EventPool::GetStats() const
+{
+    EventImpl::PoolStats stats = m_stats;
+    stats.cached = 0;
+    for (std::size_t i = 0; i < POOL_CLASSES; ++i)
+    {
+        stats.cached += m_cached[i];
+    }
+    return stats;
+}
+
+} // unnamed namespace
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -67,4 +205,42 @@ EventImpl::IsCancelled()
     return m_cancel;
 }
 
+EventImpl::PoolStats
+EventImpl::GetPoolStats()
+{
+    NS_LOG_FUNCTION_NOARGS();
+#ifndef NS3_EVENT_POOL_DISABLED
+    if (!g_poolDestroyed)
+    {
+        return g_pool.GetStats();
+    }
+#endif
+    return PoolStats{};
+}
+
+void*
+EventImpl::operator new(std::size_t size)
+{
+#ifndef NS3_EVENT_POOL_DISABLED
+    if (!g_poolDestroyed)
+    {
+        return g_pool.Allocate(size);
+    }
+#endif
+    return ::operator new(size);
+}
+
+void
+EventImpl::operator delete(void* ptr, std::size_t size)
+{
+#ifndef NS3_EVENT_POOL_DISABLED
+    if (!g_poolDestroyed)
+    {
+        g_pool.Release(ptr, size);
+        return;
+    }
+#endif
+    ::operator delete(ptr);
+}
+
 } // namespace ns3
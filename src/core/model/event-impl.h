@@ -21,6 +21,7 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -67,6 +68,38 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /** Statistics of the event memory pool of one thread. */
+    struct PoolStats
+    {
+        uint64_t hits;     //!< Allocations served by the pool.
+        uint64_t misses;   //!< Allocations forwarded to the global allocator.
+        uint64_t releases; //!< Deallocations kept in the pool.
+        uint64_t frees;    //!< Deallocations forwarded to the global allocator.
+        uint64_t cached;   //!< Blocks currently held by the pool.
+    };
+
+    /**
+     * Get the statistics of the event memory pool of the calling thread.
+     *
+     * \returns The pool statistics.
+     */
+    static PoolStats GetPoolStats();
+
+    /**
+     * Allocate the memory of an event, from the pool if possible.
+     *
+     * \param [in] size The size of the event.
+     * \returns The allocated memory.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Release the memory of an event, to the pool if possible.
+     *
+     * \param [in] ptr The memory of the event.
+     * \param [in] size The size of the event, as given to operator new.
+     */
+    static void operator delete(void* ptr, std::size_t size);
+
   protected:
     /**
      * Implementation for Invoke().
@@ -0,0 +1,277 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+
+#include "event-impl.h"
+#include "log.h"
+#include "nstime.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+bool
+EventProfiler::Key::operator==(const Key& other) const
+{
+    return *type == *other.type && context == other.context;
+}
+
+std::size_t
+EventProfiler::KeyHash::operator()(const Key& key) const
+{
+    return key.type->hash_code() ^ (std::size_t(key.context) * 0x9e3779b97f4a7c15ULL);
+}
+
+EventProfiler::EventProfiler(uint32_t sampling, std::chrono::nanoseconds interval)
+    : m_sampling(std::max<uint32_t>(sampling, 1)),
+      m_countdown(m_sampling),
+      m_interval(interval),
+      m_count(0),
+      m_started(false),
+      m_histogram(HISTOGRAM_SIZE, 0)
+{
+    NS_LOG_FUNCTION(this << sampling << interval.count());
+}
+
+void
+EventProfiler::Invoke(EventImpl* event, uint32_t context, uint64_t ts, uint64_t depth)
+{
+    m_count++;
+    if (--m_countdown > 0)
+    {
+        event->Invoke();
+        return;
+    }
+    m_countdown = m_sampling;
+
+    Clock::time_point begin = Clock::now();
+    event->Invoke();
+    Clock::time_point end = Clock::now();
+
+    if (!m_started)
+    {
+        m_started = true;
+        m_start = begin;
+        m_nextSample = begin;
+    }
+    m_last = end;
+
+    auto ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    std::size_t bucket = 0;
+    while (bucket + 1 < HISTOGRAM_SIZE && (ns >> (bucket + 1)) != 0)
+    {
+        bucket++;
+    }
+    m_histogram[bucket]++;
+
+    Cost& cost = m_costs[{&typeid(*event), context}];
+    cost.count++;
+    cost.ns += ns;
+    cost.maxNs = std::max(cost.maxNs, ns);
+
+    if (end >= m_nextSample)
+    {
+        double wall = std::chrono::duration<double>(end - m_start).count();
+        m_timeline.push_back({wall, ts, m_count, depth});
+        m_nextSample += m_interval;
+        if (m_nextSample <= end)
+        {
+            m_nextSample = end + m_interval;
+        }
+    }
+}
+
+std::string
+EventProfiler::GetTypeName(const std::type_info& type)
+{
+    std::string name = type.name();
+#if (__GNUC__ >= 3)
+    int status;
+    char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+    if (status == 0 && demangled)
+    {
+        name = demangled;
+    }
+    std::free(demangled);
+#endif
+    // Keep only the bound function of the events created by MakeEvent,
+    // i.e., its first template argument
+    const std::string prefix = "ns3::MakeEvent<";
+    if (name.compare(0, prefix.size(), prefix) != 0)
+    {
+        return name;
+    }
+    int depth = 0;
+    for (std::size_t i = prefix.size(); i < name.size(); ++i)
+    {
+        char c = name[i];
+        if (c == '<' || c == '(' || c == '{' || c == '[')
+        {
+            depth++;
+        }
+        else if (depth > 0 && (c == '>' || c == ')' || c == '}' || c == ']'))
+        {
+            depth--;
+        }
+        else if (depth == 0 && (c == ',' || c == '>'))
+        {
+            return name.substr(prefix.size(), i - prefix.size());
+        }
+    }
+    return name;
+}
+
+void
+EventProfiler::WriteCosts(std::ostream& os,
+                          const std::vector<std::pair<Key, Cost>>& costs,
+                          uint64_t total,
+                          bool withContext)
+{
+    os << std::setw(12) << "total ms" << std::setw(8) << "share" << std::setw(12) << "events"
+       << std::setw(10) << "ns/event" << std::setw(12) << "max ns"
+       << (withContext ? "  context type" : "  type") << std::endl;
+    for (const auto& [key, cost] : costs)
+    {
+        double share = 100.0 * cost.ns / std::max<uint64_t>(total, 1);
+        os << std::fixed << std::setprecision(3) << std::setw(12) << cost.ns / 1e6
+           << std::setprecision(1) << std::setw(7) << share << "%" << std::setw(12) << cost.count
+           << std::setw(10) << cost.ns / std::max<uint64_t>(cost.count, 1) << std::setw(12)
+           << cost.maxNs << "  ";
+        if (withContext)
+        {
+            if (key.context == Simulator::NO_CONTEXT)
+            {
+                os << "-";
+            }
+            else
+            {
+                os << key.context;
+            }
+            os << " ";
+        }
+        os << GetTypeName(*key.type) << std::endl;
+    }
+}
+
+void
+EventProfiler::Write(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this);
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    uint64_t timed = 0;
+    uint64_t total = 0;
+    for (const auto& [key, cost] : m_costs)
+    {
+        timed += cost.count;
+        total += cost.ns;
+    }
+    double wall = m_started ? std::chrono::duration<double>(m_last - m_start).count() : 0;
+
+    os << "Event profile: " << m_count << " events in " << std::fixed << std::setprecision(3)
+       << wall << " s of wall-clock time";
+    if (wall > 0)
+    {
+        os << " (" << std::setprecision(0) << m_count / wall << " events/s)";
+    }
+    os << ", " << timed << " events timed (1 in " << m_sampling << ")" << std::endl;
+
+    os << std::endl << "Histogram of the event cost:" << std::endl;
+    for (std::size_t i = 0; i < HISTOGRAM_SIZE; ++i)
+    {
+        if (m_histogram[i] == 0)
+        {
+            continue;
+        }
+        os << std::setw(14) << (i == 0 ? 0 : uint64_t(1) << i) << " - " << std::setw(14)
+           << (uint64_t(1) << (i + 1)) << " ns" << std::setw(12) << m_histogram[i]
+           << std::setprecision(1) << std::setw(7)
+           << 100.0 * m_histogram[i] / std::max<uint64_t>(timed, 1) << "%" << std::endl;
+    }
+
+    std::unordered_map<Key, Cost, KeyHash> byType;
+    for (const auto& [key, cost] : m_costs)
+    {
+        Cost& typeCost = byType[{key.type, 0}];
+        typeCost.count += cost.count;
+        typeCost.ns += cost.ns;
+        typeCost.maxNs = std::max(typeCost.maxNs, cost.maxNs);
+    }
+    auto byTotal = [](const std::pair<Key, Cost>& a, const std::pair<Key, Cost>& b) {
+        return a.second.ns > b.second.ns;
+    };
+
+    std::vector<std::pair<Key, Cost>> costs(byType.begin(), byType.end());
+    std::sort(costs.begin(), costs.end(), byTotal);
+    os << std::endl << "Cost by event type:" << std::endl;
+    WriteCosts(os, costs, total, false);
+
+    costs.assign(m_costs.begin(), m_costs.end());
+    std::sort(costs.begin(), costs.end(), byTotal);
+    if (costs.size() > TOP_CONTEXTS)
+    {
+        costs.resize(TOP_CONTEXTS);
+    }
+    os << std::endl << "Cost by event type and context (top " << TOP_CONTEXTS << "):" << std::endl;
+    WriteCosts(os, costs, total, true);
+
+    os << std::endl
+       << "Timeline:" << std::endl
+       << std::setw(10) << "wall s" << std::setw(14) << "sim s" << std::setw(14) << "events/s"
+       << std::setw(10) << "ns/event" << std::setw(14) << "queue depth" << std::endl;
+    for (std::size_t i = 0; i < m_timeline.size(); ++i)
+    {
+        const Sample& sample = m_timeline[i];
+        os << std::setprecision(3) << std::setw(10) << sample.wall << std::setprecision(6)
+           << std::setw(14) << TimeStep(sample.ts).GetSeconds();
+        if (i > 0)
+        {
+            const Sample& previous = m_timeline[i - 1];
+            double elapsed = sample.wall - previous.wall;
+            uint64_t events = sample.count - previous.count;
+            os << std::setprecision(0) << std::setw(14) << events / elapsed << std::setw(10)
+               << 1e9 * elapsed / std::max<uint64_t>(events, 1);
+        }
+        else
+        {
+            os << std::setw(14) << "-" << std::setw(10) << "-";
+        }
+        os << std::setw(14) << sample.depth << std::endl;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+} // namespace ns3
@@ -0,0 +1,336 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+namespace
+{
+
+/**
+ * \ingroup scheduler
+ * Compare two events, for keeping the bottom sorted in reverse order.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a > \c b
+ */
+inline bool
+IsLater(const Scheduler::Event& a, const Scheduler::Event& b)
+{
+    return a.key > b.key;
+}
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LadderScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<LadderScheduler>()
+            .AddAttribute("Threshold",
+                          "Maximum number of events moved at once from a bucket to the "
+                          "sorted bottom list; larger buckets are split in a new rung.",
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&LadderScheduler::m_threshold),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_topStart(0),
+      m_rungs(MAX_RUNGS),
+      m_nRungs(0),
+      m_size(0),
+      m_threshold(50)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart(const Rung& rung)
+{
+    return rung.start + rung.current * rung.width;
+}
+
+LadderScheduler::Rung&
+LadderScheduler::AddRung(uint64_t start, uint64_t span, std::size_t count)
+{
+    NS_LOG_FUNCTION(this << start << span << count);
+    NS_ASSERT(m_nRungs < MAX_RUNGS);
+    // m_rungs never grows, so references to the other rungs stay valid
+    Rung& rung = m_rungs[m_nRungs];
+    m_nRungs++;
+    rung.nBuckets = std::max<std::size_t>(std::min(count, MAX_BUCKETS), 1);
+    rung.width = std::max<uint64_t>((span + rung.nBuckets - 1) / rung.nBuckets, 1);
+    rung.start = start;
+    rung.current = 0;
+    rung.count = 0;
+    if (rung.buckets.size() < rung.nBuckets)
+    {
+        rung.buckets.resize(rung.nBuckets);
+    }
+    return rung;
+}
+
+void
+LadderScheduler::InsertInRung(Rung& rung, const Scheduler::Event& ev)
+{
+    std::size_t bucket = (ev.key.m_ts - rung.start) / rung.width;
+    NS_ASSERT(bucket >= rung.current && bucket < rung.nBuckets);
+    rung.buckets[bucket].push_back(ev);
+    rung.count++;
+}
+
+void
+LadderScheduler::InsertInBottom(const Scheduler::Event& ev)
+{
+    auto pos = std::lower_bound(m_bottom.begin(), m_bottom.end(), ev, IsLater);
+    m_bottom.insert(pos, ev);
+    if (m_bottom.size() > m_threshold && m_nRungs < MAX_RUNGS)
+    {
+        SpawnFromBottom();
+    }
+}
+
+void
+LadderScheduler::SpawnFromBottom()
+{
+    // The new rung must cover all the timestamps routed below the lowest
+    // rung (or the top), so that later insertions land in a valid bucket.
+    uint64_t end = m_nRungs > 0 ? CurrentStart(m_rungs[m_nRungs - 1]) : m_topStart;
+    uint64_t start = m_bottom.back().key.m_ts;
+    if (end - start <= 1)
+    {
+        // All the events have the same timestamp and cannot be split
+        return;
+    }
+    NS_LOG_FUNCTION(this << m_bottom.size());
+    Rung& rung = AddRung(start, end - start, m_bottom.size());
+    for (const auto& ev : m_bottom)
+    {
+        InsertInRung(rung, ev);
+    }
+    m_bottom.clear();
+}
+
+void
+LadderScheduler::SortBottom()
+{
+    std::sort(m_bottom.begin(), m_bottom.end(), IsLater);
+}
+
+void
+LadderScheduler::RefillBottom()
+{
+    if (!m_bottom.empty() || m_size == 0)
+    {
+        return;
+    }
+    while (true)
+    {
+        if (m_nRungs == 0)
+        {
+            NS_ASSERT(!m_top.empty());
+            if (m_top.size() <= m_threshold)
+            {
+                m_bottom.swap(m_top);
+                SortBottom();
+                m_topStart = m_topMax + 1;
+            }
+            else
+            {
+                Rung& rung = AddRung(m_topMin, m_topMax - m_topMin + 1, m_top.size());
+                m_topStart = rung.start + rung.nBuckets * rung.width;
+                for (const auto& ev : m_top)
+                {
+                    InsertInRung(rung, ev);
+                }
+                m_top.clear();
+            }
+            m_topMin = std::numeric_limits<uint64_t>::max();
+            m_topMax = 0;
+            if (!m_bottom.empty())
+            {
+                return;
+            }
+            continue;
+        }
+
+        Rung& rung = m_rungs[m_nRungs - 1];
+        while (rung.current < rung.nBuckets && rung.buckets[rung.current].empty())
+        {
+            rung.current++;
+        }
+        if (rung.current == rung.nBuckets)
+        {
+            NS_ASSERT(rung.count == 0);
+            m_nRungs--;
+            continue;
+        }
+
+        EventList& bucket = rung.buckets[rung.current];
+        uint64_t bucketStart = CurrentStart(rung);
+        rung.current++;
+        rung.count -= bucket.size();
+        if (bucket.size() > m_threshold && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+            Rung& child = AddRung(bucketStart, rung.width, bucket.size());
+            for (const auto& ev : bucket)
+            {
+                InsertInRung(child, ev);
+            }
+            bucket.clear();
+            continue;
+        }
+
+        // Swap to keep the storage of both lists for later use
+        m_bottom.swap(bucket);
+        SortBottom();
+        return;
+    }
+}
+
+bool
+LadderScheduler::RemoveFrom(EventList& list, const Scheduler::Event& ev)
+{
+    for (auto& i : list)
+    {
+        if (i.key == ev.key)
+        {
+            NS_ASSERT(ev.impl == i.impl);
+            i = list.back();
+            list.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+LadderScheduler::Insert(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_size++;
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        m_top.push_back(ev);
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+        return;
+    }
+    for (std::size_t i = 0; i < m_nRungs; ++i)
+    {
+        if (ts >= CurrentStart(m_rungs[i]))
+        {
+            InsertInRung(m_rungs[i], ev);
+            return;
+        }
+    }
+    InsertInBottom(ev);
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    // Refilling the bottom does not change the content of the queue
+    const_cast<LadderScheduler*>(this)->RefillBottom();
+    return m_bottom.back();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    RefillBottom();
+    Scheduler::Event ev = m_bottom.back();
+    m_bottom.pop_back();
+    m_size--;
+    NS_LOG_DEBUG(this << ": " << ev.impl << ", " << ev.key.m_ts << ", " << ev.key.m_uid);
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    NS_ASSERT(!IsEmpty());
+    m_size--;
+    // Events are located with the same rules used to insert them
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        bool found [[maybe_unused]] = RemoveFrom(m_top, ev);
+        NS_ASSERT(found);
+        return;
+    }
+    for (std::size_t i = 0; i < m_nRungs; ++i)
+    {
+        Rung& rung = m_rungs[i];
+        if (ts >= CurrentStart(rung))
+        {
+            bool found [[maybe_unused]] =
+                RemoveFrom(rung.buckets[(ts - rung.start) / rung.width], ev);
+            NS_ASSERT(found);
+            rung.count--;
+            return;
+        }
+    }
+    auto pos = std::lower_bound(m_bottom.begin(), m_bottom.end(), ev, IsLater);
+    NS_ASSERT(pos != m_bottom.end() && pos->key == ev.key);
+    m_bottom.erase(pos);
+}
+
+} // namespace ns3
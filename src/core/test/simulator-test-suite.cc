@@ -17,13 +17,19 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/calendar-scheduler.h"
+#include "ns3/event-profiler.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
+#include <set>
+#include <sstream>
+
 using namespace ns3;
 
 /**
@@ -717,6 +723,232 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that a scheduler returns the events in the same order as
+ * a sorted reference container, under a random mix of Insert(),
+ * RemoveNext() and Remove() calls.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param schedulerFactory Scheduler factory.
+     */
+    SchedulerOrderTestCase(ObjectFactory schedulerFactory);
+    void DoRun() override;
+
+  private:
+    ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase(ObjectFactory schedulerFactory)
+    : TestCase("Check the event order with random operations on " +
+               schedulerFactory.GetTypeId().GetName()),
+      m_schedulerFactory(schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun()
+{
+    Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    auto compare = [](const Scheduler::Event& a, const Scheduler::Event& b) {
+        return a.key < b.key;
+    };
+    std::set<Scheduler::Event, decltype(compare)> reference(compare);
+
+    uint64_t now = 0;
+    uint32_t uid = 4;
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        uint32_t action = rng->GetInteger(0, 9);
+        if (action < 5 || reference.empty())
+        {
+            Scheduler::Event ev;
+            ev.impl = nullptr;
+            // Mix of simultaneous, close and far away events
+            uint32_t kind = rng->GetInteger(0, 3);
+            uint64_t delay = kind == 0   ? 0
+                             : kind == 1 ? rng->GetInteger(0, 100)
+                             : kind == 2 ? rng->GetInteger(0, 100000)
+                                         : rng->GetInteger(0, 100000000);
+            ev.key.m_ts = now + delay;
+            ev.key.m_uid = uid++;
+            ev.key.m_context = 0;
+            scheduler->Insert(ev);
+            reference.insert(ev);
+        }
+        else if (action < 9)
+        {
+            Scheduler::Event expected = *reference.begin();
+            reference.erase(reference.begin());
+            NS_TEST_ASSERT_MSG_EQ(scheduler->PeekNext().key.m_uid,
+                                  expected.key.m_uid,
+                                  "Wrong next event");
+            Scheduler::Event next = scheduler->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ(next.key.m_uid, expected.key.m_uid, "Wrong removed event");
+            NS_TEST_ASSERT_MSG_EQ(next.key.m_ts, expected.key.m_ts, "Wrong removed event");
+            now = next.key.m_ts;
+        }
+        else
+        {
+            auto it = reference.begin();
+            std::advance(it, rng->GetInteger(0, std::min<uint32_t>(reference.size() - 1, 50)));
+            scheduler->Remove(*it);
+            reference.erase(it);
+        }
+        NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), reference.empty(), "Wrong queue state");
+    }
+    while (!reference.empty())
+    {
+        Scheduler::Event next = scheduler->RemoveNext();
+        NS_TEST_ASSERT_MSG_EQ(next.key.m_uid, reference.begin()->key.m_uid, "Wrong event");
+        reference.erase(reference.begin());
+    }
+    NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), true, "Scheduler not empty");
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that the memory of the events is recycled by the event pool.
+ */
+class SimulatorEventPoolTestCase : public TestCase
+{
+  public:
+    SimulatorEventPoolTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Schedule the next event of the chain.
+     * \param remaining The number of events still to schedule.
+     * \param value An argument bound to the events.
+     */
+    void Chain(uint32_t remaining, uint64_t value);
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase()
+    : TestCase("Check the event memory pool")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Chain(uint32_t remaining, uint64_t value)
+{
+    if (remaining > 0)
+    {
+        Simulator::Schedule(NanoSeconds(1),
+                            &SimulatorEventPoolTestCase::Chain,
+                            this,
+                            remaining - 1,
+                            value + 1);
+        Simulator::ScheduleNow([]() {});
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun()
+{
+#if !defined(__SANITIZE_ADDRESS__)
+    // Warm up the pool
+    Simulator::ScheduleNow(&SimulatorEventPoolTestCase::Chain, this, 10, 0);
+    Simulator::Run();
+
+    EventImpl::PoolStats before = EventImpl::GetPoolStats();
+    Simulator::ScheduleNow(&SimulatorEventPoolTestCase::Chain, this, 1000, 0);
+    Simulator::Run();
+    EventImpl::PoolStats after = EventImpl::GetPoolStats();
+
+    NS_TEST_ASSERT_MSG_EQ(after.misses, before.misses, "Events allocated out of the pool");
+    NS_TEST_ASSERT_MSG_EQ(after.frees, before.frees, "Events released out of the pool");
+    NS_TEST_ASSERT_MSG_EQ(after.hits - before.hits, 2001, "Wrong number of pool hits");
+    NS_TEST_ASSERT_MSG_EQ(after.releases - before.releases, 2001, "Wrong number of releases");
+    NS_TEST_ASSERT_MSG_EQ(after.cached, before.cached, "Events leaked out of the pool");
+#endif
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that EventProfiler attributes the events to their type and
+ * context.
+ */
+class EventProfilerTestCase : public TestCase
+{
+  public:
+    EventProfilerTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * First event type.
+     * \param value An argument bound to the event.
+     */
+    void First(uint32_t value);
+    /**
+     * Second event type.
+     * \param value An argument bound to the event.
+     */
+    void Second(double value);
+
+    uint32_t m_calls; //!< Number of events executed.
+};
+
+EventProfilerTestCase::EventProfilerTestCase()
+    : TestCase("Check the event profiler"),
+      m_calls(0)
+{
+}
+
+void
+EventProfilerTestCase::First(uint32_t value)
+{
+    m_calls++;
+}
+
+void
+EventProfilerTestCase::Second(double value)
+{
+    m_calls++;
+}
+
+void
+EventProfilerTestCase::DoRun()
+{
+    EventProfiler profiler(2, std::chrono::nanoseconds(1));
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        Ptr<EventImpl> first(MakeEvent(&EventProfilerTestCase::First, this, i), false);
+        profiler.Invoke(PeekPointer(first), 7, i, 10 - i);
+        Ptr<EventImpl> second(MakeEvent(&EventProfilerTestCase::Second, this, 1.0), false);
+        profiler.Invoke(PeekPointer(second), 8, i, 10 - i);
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_calls, 20, "Events not executed");
+
+    std::ostringstream oss;
+    profiler.Write(oss);
+    std::string profile = oss.str();
+    NS_TEST_ASSERT_MSG_NE(profile.find("20 events in"), std::string::npos, "Wrong event count");
+    NS_TEST_ASSERT_MSG_NE(profile.find("10 events timed (1 in 2)"),
+                          std::string::npos,
+                          "Wrong timed event count");
+    // Every second event is timed, which are all the Second events
+    NS_TEST_ASSERT_MSG_EQ(profile.find("(EventProfilerTestCase::*)(unsigned int)"),
+                          std::string::npos,
+                          "Untimed event type reported");
+    NS_TEST_ASSERT_MSG_NE(profile.find("8 void (EventProfilerTestCase::*)(double)"),
+                          std::string::npos,
+                          "Timed event type and context not reported");
+}
+
 /**
  * \ingroup simulator-tests
  *
@@ -740,6 +972,11 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorEventPoolTestCase(), TestCase::QUICK);
+        AddTestCase(new EventProfilerTestCase(), TestCase::QUICK);
     }
 };
 
@@ -18,18 +18,22 @@
  */
 #include "ns3/calendar-scheduler.h"
 #include "ns3/config.h"
+#include "ns3/default-simulator-impl.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/simulator.h"
 #include "ns3/string.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
 
+#include <atomic>
 #include <chrono> // seconds, milliseconds
 #include <ctime>
 #include <list>
 #include <thread> // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -278,6 +282,120 @@ ThreadedSimulatorEventsTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ(m_a, m_d, "Bad scheduling");
 }
 
+/**
+ * \ingroup threaded-tests
+ *
+ * \brief Check that the events scheduled by other threads in
+ * DefaultSimulatorImpl are executed in order, when the lock-free ring
+ * overflows.
+ */
+class ThreadedInjectionTestCase : public TestCase
+{
+  public:
+    ThreadedInjectionTestCase();
+
+  private:
+    void DoRun() override;
+    void DoTeardown() override;
+    /**
+     * Event scheduled by the threads.
+     * \param threadno The thread number.
+     * \param seq The sequence number of the event in its thread.
+     */
+    void Receive(unsigned int threadno, uint32_t seq);
+    /** Keep the simulation running until all the threads are done. */
+    void Poll();
+
+    /// Number of threads.
+    static constexpr unsigned int THREADS = 4;
+    /// Number of events scheduled by each thread.
+    static constexpr uint32_t EVENTS = 20000;
+
+    std::vector<uint32_t> m_last;     //!< Last sequence number received from each thread.
+    uint32_t m_errors;                //!< Number of events out of order.
+    uint64_t m_received;              //!< Number of events received.
+    std::atomic<unsigned int> m_done; //!< Number of threads done.
+};
+
+ThreadedInjectionTestCase::ThreadedInjectionTestCase()
+    : TestCase("Check the order of the events from other threads when the injection ring "
+               "overflows"),
+      m_last(THREADS, 0),
+      m_errors(0),
+      m_received(0),
+      m_done(0)
+{
+}
+
+void
+ThreadedInjectionTestCase::Receive(unsigned int threadno, uint32_t seq)
+{
+    if (seq != m_last[threadno] + 1)
+    {
+        m_errors++;
+    }
+    m_last[threadno] = seq;
+    m_received++;
+}
+
+void
+ThreadedInjectionTestCase::Poll()
+{
+    if (m_done < THREADS)
+    {
+        Simulator::Schedule(MicroSeconds(1), &ThreadedInjectionTestCase::Poll, this);
+    }
+}
+
+void
+ThreadedInjectionTestCase::DoRun()
+{
+    Config::SetDefault("ns3::DefaultSimulatorImpl::InjectionQueueSize", UintegerValue(16));
+    Simulator::Schedule(MicroSeconds(1), &ThreadedInjectionTestCase::Poll, this);
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < THREADS; ++i)
+    {
+        threads.emplace_back([this, i]() {
+            for (uint32_t seq = 1; seq <= EVENTS; ++seq)
+            {
+                Simulator::ScheduleWithContext(i,
+                                               MicroSeconds(1),
+                                               &ThreadedInjectionTestCase::Receive,
+                                               this,
+                                               i,
+                                               seq);
+            }
+            m_done++;
+        });
+    }
+    Simulator::Run();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    // Move the last events to the event queue, and run them
+    Simulator::Schedule(MicroSeconds(1), &ThreadedInjectionTestCase::Poll, this);
+    Simulator::Run();
+
+    Ptr<DefaultSimulatorImpl> impl =
+        DynamicCast<DefaultSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "Wrong simulator implementation");
+    DefaultSimulatorImpl::InjectionStats stats = impl->GetInjectionStats();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_errors, 0, "Events from a thread out of order");
+    NS_TEST_EXPECT_MSG_EQ(m_received, THREADS * EVENTS, "Events lost");
+    NS_TEST_EXPECT_MSG_EQ(stats.queued + stats.overflows, THREADS * EVENTS, "Wrong counters");
+    NS_TEST_EXPECT_MSG_GT(stats.overflows, 0, "The ring did not overflow");
+}
+
+void
+ThreadedInjectionTestCase::DoTeardown()
+{
+    Config::SetDefault("ns3::DefaultSimulatorImpl::InjectionQueueSize", UintegerValue(4096));
+}
+
 /**
  * \ingroup threaded-tests
  *
@@ -298,6 +416,7 @@ class ThreadedSimulatorTestSuite : public TestSuite
             "ns3::HeapScheduler",
             "ns3::MapScheduler",
             "ns3::CalendarScheduler",
+            "ns3::LadderScheduler",
         };
         unsigned int threadCounts[] = {0, 2, 10, 20};
         ObjectFactory factory;
@@ -315,6 +434,7 @@ class ThreadedSimulatorTestSuite : public TestSuite
                 }
             }
         }
+        AddTestCase(new ThreadedInjectionTestCase(), TestCase::QUICK);
     }
 };
 
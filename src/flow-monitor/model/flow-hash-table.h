@@ -0,0 +1,368 @@
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef FLOW_HASH_TABLE_H
+#define FLOW_HASH_TABLE_H
+
+#include <cstddef>
+#include <functional>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup flow-monitor
+ * \brief A hash table with open addressing, used for the per-packet lookups
+ * of the flow monitor.
+ *
+ * The entries are stored in a single array (linear probing), whose capacity
+ * is a power of two and which is grown when it is more than 70% full.  The
+ * hash of the keys is mixed with a Fibonacci multiplication, so that
+ * sequential keys (e.g., flow and packet identifiers) are spread over the
+ * table.  Erasing an entry shifts the following entries of its cluster
+ * backwards, hence no tombstones accumulate in the table.
+ *
+ * Unlike a std::map, inserting or erasing an entry invalidates the pointers
+ * to the other entries.
+ *
+ * \tparam Key the type of the keys, which must be default constructible and
+ *         comparable with operator==
+ * \tparam Value the type of the values, which must be default constructible
+ * \tparam Hash the hash function of the keys
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlowHashTable
+{
+  public:
+    FlowHashTable();
+
+    /**
+     * Make room for a number of entries, so that the table is not grown
+     * before it holds them.
+     * \param n the number of entries
+     */
+    void Reserve(std::size_t n);
+
+    /**
+     * \return the number of entries of the table
+     */
+    std::size_t GetSize() const;
+
+    /**
+     * \param key the key to search for
+     * \return a pointer to the value of the key, or nullptr if the key is not
+     *         in the table
+     */
+    Value* Find(const Key& key);
+
+    /**
+     * \param key the key to search for
+     * \return a pointer to the value of the key, or nullptr if the key is not
+     *         in the table
+     */
+    const Value* Find(const Key& key) const;
+
+    /**
+     * Insert an entry, unless the key is already in the table.
+     * \param key the key
+     * \param value the value
+     * \return a pointer to the value of the key, and true if the entry was
+     *         inserted or false if the key was already in the table
+     */
+    std::pair<Value*, bool> Insert(const Key& key, const Value& value);
+
+    /**
+     * \param key the key of the entry to erase
+     * \return true if the entry was erased, false if the key was not found
+     */
+    bool Erase(const Key& key);
+
+    /**
+     * Erase the entries for which a predicate returns true.  The predicate
+     * may be called more than once for the entries which are kept.
+     * \param pred the predicate, called with the key and the value of the
+     *        entries
+     * \return the number of entries erased
+     */
+    template <typename Predicate>
+    std::size_t EraseIf(Predicate pred);
+
+    /**
+     * Call a function for each entry of the table, in no particular order.
+     * \param f the function, called with the key and the value of the entries
+     */
+    template <typename Function>
+    void ForEach(Function f) const;
+
+    /**
+     * Erase all the entries, keeping the capacity of the table.
+     */
+    void Clear();
+
+  private:
+    /// An entry of the table
+    struct Slot
+    {
+        Key key;           //!< Key of the entry
+        Value value;       //!< Value of the entry
+        bool used = false; //!< True if the slot holds an entry
+    };
+
+    /**
+     * \param key a key
+     * \return the index of the first slot probed for the key
+     */
+    std::size_t GetHome(const Key& key) const;
+
+    /**
+     * \param key a key
+     * \return the index of the slot of the key, or the capacity of the table
+     *         if the key is not found
+     */
+    std::size_t Lookup(const Key& key) const;
+
+    /**
+     * Move the entries to a new array.
+     * \param capacity the capacity of the new array, a power of two
+     */
+    void Rehash(std::size_t capacity);
+
+    /**
+     * Erase the entry of a slot, shifting the following entries of its
+     * cluster backwards.
+     * \param i the index of the slot
+     */
+    void EraseSlot(std::size_t i);
+
+    std::vector<Slot> m_slots; //!< Entries, indexed by the hash of the keys
+    std::size_t m_size;        //!< Number of entries
+    unsigned m_shift;          //!< Shift of the mixed hash giving the index of the slots
+    Hash m_hash;               //!< Hash function
+};
+
+} // namespace ns3
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+namespace ns3
+{
+
+template <typename Key, typename Value, typename Hash>
+FlowHashTable<Key, Value, Hash>::FlowHashTable()
+    : m_size(0),
+      m_shift(64)
+{
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::Reserve(std::size_t n)
+{
+    std::size_t capacity = m_slots.empty() ? 16 : m_slots.size();
+    while (n * 10 > capacity * 7)
+    {
+        capacity *= 2;
+    }
+    if (capacity > m_slots.size())
+    {
+        Rehash(capacity);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+std::size_t
+FlowHashTable<Key, Value, Hash>::GetSize() const
+{
+    return m_size;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::size_t
+FlowHashTable<Key, Value, Hash>::GetHome(const Key& key) const
+{
+    uint64_t h = static_cast<uint64_t>(m_hash(key)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(h >> m_shift);
+}
+
+template <typename Key, typename Value, typename Hash>
+std::size_t
+FlowHashTable<Key, Value, Hash>::Lookup(const Key& key) const
+{
+    if (m_size == 0)
+    {
+        return m_slots.size();
+    }
+    std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = GetHome(key); m_slots[i].used; i = (i + 1) & mask)
+    {
+        if (m_slots[i].key == key)
+        {
+            return i;
+        }
+    }
+    return m_slots.size();
+}
+
+template <typename Key, typename Value, typename Hash>
+Value*
+FlowHashTable<Key, Value, Hash>::Find(const Key& key)
+{
+    std::size_t i = Lookup(key);
+    return i < m_slots.size() ? &m_slots[i].value : nullptr;
+}
+
+template <typename Key, typename Value, typename Hash>
+const Value*
+FlowHashTable<Key, Value, Hash>::Find(const Key& key) const
+{
+    std::size_t i = Lookup(key);
+    return i < m_slots.size() ? &m_slots[i].value : nullptr;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::pair<Value*, bool>
+FlowHashTable<Key, Value, Hash>::Insert(const Key& key, const Value& value)
+{
+    Reserve(m_size + 1);
+    std::size_t mask = m_slots.size() - 1;
+    std::size_t i = GetHome(key);
+    for (; m_slots[i].used; i = (i + 1) & mask)
+    {
+        if (m_slots[i].key == key)
+        {
+            return std::make_pair(&m_slots[i].value, false);
+        }
+    }
+    m_slots[i].key = key;
+    m_slots[i].value = value;
+    m_slots[i].used = true;
+    m_size++;
+    return std::make_pair(&m_slots[i].value, true);
+}
+
+template <typename Key, typename Value, typename Hash>
+bool
+FlowHashTable<Key, Value, Hash>::Erase(const Key& key)
+{
+    std::size_t i = Lookup(key);
+    if (i == m_slots.size())
+    {
+        return false;
+    }
+    EraseSlot(i);
+    return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+template <typename Predicate>
+std::size_t
+FlowHashTable<Key, Value, Hash>::EraseIf(Predicate pred)
+{
+    std::size_t erased = 0;
+    for (std::size_t i = 0; i < m_slots.size();)
+    {
+        if (m_slots[i].used && pred(m_slots[i].key, m_slots[i].value))
+        {
+            // another entry may have been shifted to this slot
+            EraseSlot(i);
+            erased++;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    return erased;
+}
+
+template <typename Key, typename Value, typename Hash>
+template <typename Function>
+void
+FlowHashTable<Key, Value, Hash>::ForEach(Function f) const
+{
+    for (const Slot& slot : m_slots)
+    {
+        if (slot.used)
+        {
+            f(slot.key, slot.value);
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::Clear()
+{
+    for (Slot& slot : m_slots)
+    {
+        slot = Slot();
+    }
+    m_size = 0;
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::Rehash(std::size_t capacity)
+{
+    std::vector<Slot> slots(capacity);
+    m_slots.swap(slots);
+    m_shift = 64;
+    for (std::size_t c = capacity; c > 1; c >>= 1)
+    {
+        m_shift--;
+    }
+    std::size_t mask = capacity - 1;
+    for (Slot& slot : slots)
+    {
+        if (slot.used)
+        {
+            std::size_t i = GetHome(slot.key);
+            while (m_slots[i].used)
+            {
+                i = (i + 1) & mask;
+            }
+            m_slots[i] = std::move(slot);
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::EraseSlot(std::size_t i)
+{
+    std::size_t mask = m_slots.size() - 1;
+    for (std::size_t j = (i + 1) & mask; m_slots[j].used; j = (j + 1) & mask)
+    {
+        std::size_t home = GetHome(m_slots[j].key);
+        // the entry stays if its home is cyclically in (i, j]
+        bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!stays)
+        {
+            m_slots[i] = std::move(m_slots[j]);
+            i = j;
+        }
+    }
+    m_slots[i] = Slot();
+    m_size--;
+}
+
+} // namespace ns3
+
+#endif /* FLOW_HASH_TABLE_H */
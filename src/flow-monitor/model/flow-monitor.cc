@@ -19,9 +19,12 @@
 
 #include "flow-monitor.h"
 
+#include "ns3/abort.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
 
 #include <fstream>
 #include <sstream>
@@ -80,7 +83,41 @@ FlowMonitor::GetTypeId()
                 ("The minimum inter-arrival time that is considered a flow interruption."),
                 TimeValue(Seconds(0.5)),
                 MakeTimeAccessor(&FlowMonitor::m_flowInterruptionsMinTime),
-                MakeTimeChecker());
+                MakeTimeChecker())
+            .AddAttribute("ExpectedFlows",
+                          "The number of flows expected, for which the flow and packet tables "
+                          "are allocated when the monitor is created.  The tables grow on demand "
+                          "beyond this number.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&FlowMonitor::m_expectedFlows),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("SamplingInterval",
+                          "Track about one packet in N, and account for each tracked packet "
+                          "as N packets in the statistics (1 to track all the packets). "
+                          "The jitter and the flow interruptions are not measured when N > 1.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&FlowMonitor::m_samplingInterval),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("ExportFileName",
+                          "The name of the CSV file in which the changes of the statistics of "
+                          "the flows are written every ExportInterval (empty to disable).  It "
+                          "must be set when the monitor is created.",
+                          StringValue(""),
+                          MakeStringAccessor(&FlowMonitor::m_exportFileName),
+                          MakeStringChecker())
+            .AddAttribute("ExportInterval",
+                          "The time between two exports of the statistics of the flows.",
+                          TimeValue(Seconds(1.0)),
+                          MakeTimeAccessor(&FlowMonitor::m_exportInterval),
+                          MakeTimeChecker())
+            .AddAttribute("FlowIdleTimeout",
+                          "When the statistics are exported, the time after its last export "
+                          "after which the statistics of a flow which did not change are "
+                          "released (0 to keep all the flows).  It should be larger than the "
+                          "delay of the packets.",
+                          TimeValue(Seconds(0.0)),
+                          MakeTimeAccessor(&FlowMonitor::m_flowIdleTimeout),
+                          MakeTimeChecker());
     return tid;
 }
 
@@ -91,7 +128,9 @@ FlowMonitor::GetInstanceTypeId() const
 }
 
 FlowMonitor::FlowMonitor()
-    : m_enabled(false)
+    : m_expectedFlows(0),
+      m_samplingInterval(1),
+      m_enabled(false)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -102,6 +141,10 @@ FlowMonitor::DoDispose()
     NS_LOG_FUNCTION(this);
     Simulator::Cancel(m_startEvent);
     Simulator::Cancel(m_stopEvent);
+    Simulator::Cancel(m_exportEvent);
+    Simulator::Cancel(m_exportDestroyEvent);
+    // the stream is already closed if the simulator was destroyed
+    FinishExport();
     for (std::list<Ptr<FlowClassifier>>::iterator iter = m_classifiers.begin();
          iter != m_classifiers.end();
          iter++)
@@ -120,11 +163,28 @@ inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow(FlowId flowId)
 {
     NS_LOG_FUNCTION(this);
+    if (m_exportStream)
+    {
+        NotifyFlowChanged(flowId);
+    }
+    if (flowId < m_flowStatsIndex.size() && m_flowStatsIndex[flowId])
+    {
+        return *m_flowStatsIndex[flowId];
+    }
     FlowStatsContainerI iter;
     iter = m_flowStats.find(flowId);
     if (iter == m_flowStats.end())
     {
         FlowMonitor::FlowStats& ref = m_flowStats[flowId];
+        // the classifiers assign sequential identifiers, index them unless they are sparse
+        if (flowId < 2 * m_flowStats.size() + 1024)
+        {
+            if (flowId >= m_flowStatsIndex.size())
+            {
+                m_flowStatsIndex.resize(flowId + 1, nullptr);
+            }
+            m_flowStatsIndex[flowId] = &ref;
+        }
         ref.delaySum = Seconds(0);
         ref.jitterSum = Seconds(0);
         ref.lastDelay = Seconds(0);
@@ -146,6 +206,25 @@ FlowMonitor::GetStatsForFlow(FlowId flowId)
     }
 }
 
+uint64_t
+FlowMonitor::GetTrackedPacketKey(FlowId flowId, FlowPacketId packetId)
+{
+    return (static_cast<uint64_t>(flowId) << 32) | packetId;
+}
+
+bool
+FlowMonitor::IsSampled(FlowId flowId, FlowPacketId packetId) const
+{
+    if (m_samplingInterval == 1)
+    {
+        return true;
+    }
+    // hash the identifiers rather than taking every Nth packet, which could be
+    // in phase with the traffic pattern
+    uint64_t h = GetTrackedPacketKey(flowId, packetId) * 0x9E3779B97F4A7C15ULL;
+    return (h >> 32) % m_samplingInterval == 0;
+}
+
 void
 FlowMonitor::ReportFirstTx(Ptr<FlowProbe> probe,
                            uint32_t flowId,
@@ -158,23 +237,33 @@ FlowMonitor::ReportFirstTx(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
+    if (!IsSampled(flowId, packetId))
+    {
+        return;
+    }
     Time now = Simulator::Now();
-    TrackedPacket& tracked = m_trackedPackets[std::make_pair(flowId, packetId)];
+    TrackedPacket tracked;
     tracked.firstSeenTime = now;
     tracked.lastSeenTime = tracked.firstSeenTime;
     tracked.timesForwarded = 0;
+    std::pair<TrackedPacket*, bool> insert =
+        m_trackedPackets.Insert(GetTrackedPacketKey(flowId, packetId), tracked);
+    if (!insert.second)
+    {
+        *insert.first = tracked;
+    }
     NS_LOG_DEBUG("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId="
                                                                  << packetId << ").");
 
-    probe->AddPacketStats(flowId, packetSize, Seconds(0));
+    probe->AddPacketStats(flowId, packetSize, Seconds(0), m_samplingInterval);
 
     FlowStats& stats = GetStatsForFlow(flowId);
-    stats.txBytes += packetSize;
-    stats.txPackets++;
-    if (stats.txPackets == 1)
+    if (stats.txPackets == 0)
     {
         stats.timeFirstTxPacket = now;
     }
+    stats.txBytes += static_cast<uint64_t>(packetSize) * m_samplingInterval;
+    stats.txPackets += m_samplingInterval;
     stats.timeLastTxPacket = now;
 }
 
@@ -190,20 +279,23 @@ FlowMonitor::ReportForwarding(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
-    std::pair<FlowId, FlowPacketId> key(flowId, packetId);
-    TrackedPacketMap::iterator tracked = m_trackedPackets.find(key);
-    if (tracked == m_trackedPackets.end())
+    if (!IsSampled(flowId, packetId))
+    {
+        return;
+    }
+    TrackedPacket* tracked = m_trackedPackets.Find(GetTrackedPacketKey(flowId, packetId));
+    if (!tracked)
     {
         NS_LOG_WARN("Received packet forward report (flowId="
                     << flowId << ", packetId=" << packetId << ") but not known to be transmitted.");
         return;
     }
 
-    tracked->second.timesForwarded++;
-    tracked->second.lastSeenTime = Simulator::Now();
+    tracked->timesForwarded++;
+    tracked->lastSeenTime = Simulator::Now();
 
-    Time delay = (Simulator::Now() - tracked->second.firstSeenTime);
-    probe->AddPacketStats(flowId, packetSize, delay);
+    Time delay = (Simulator::Now() - tracked->firstSeenTime);
+    probe->AddPacketStats(flowId, packetSize, delay, m_samplingInterval);
 }
 
 void
@@ -218,45 +310,54 @@ FlowMonitor::ReportLastRx(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
-    TrackedPacketMap::iterator tracked = m_trackedPackets.find(std::make_pair(flowId, packetId));
-    if (tracked == m_trackedPackets.end())
+    if (!IsSampled(flowId, packetId))
+    {
+        return;
+    }
+    uint64_t key = GetTrackedPacketKey(flowId, packetId);
+    TrackedPacket* tracked = m_trackedPackets.Find(key);
+    if (!tracked)
     {
         NS_LOG_WARN("Received packet last-tx report (flowId="
                     << flowId << ", packetId=" << packetId << ") but not known to be transmitted.");
         return;
     }
 
+    // each sampled packet stands for m_samplingInterval packets
+    uint32_t weight = m_samplingInterval;
     Time now = Simulator::Now();
-    Time delay = (now - tracked->second.firstSeenTime);
-    probe->AddPacketStats(flowId, packetSize, delay);
+    Time delay = (now - tracked->firstSeenTime);
+    probe->AddPacketStats(flowId, packetSize, delay, weight);
 
     FlowStats& stats = GetStatsForFlow(flowId);
-    stats.delaySum += delay;
-    stats.delayHistogram.AddValue(delay.GetSeconds());
-    if (stats.rxPackets > 0)
+    stats.delaySum += delay * weight;
+    stats.delayHistogram.AddValue(delay.GetSeconds(), weight);
+    // the jitter and the interruptions are measured between consecutive
+    // packets, which cannot be estimated from the sampled packets alone
+    bool consecutive = (m_samplingInterval == 1);
+    if (consecutive && stats.rxPackets > 0)
     {
         Time jitter = stats.lastDelay - delay;
         if (jitter > Seconds(0))
         {
-            stats.jitterSum += jitter;
-            stats.jitterHistogram.AddValue(jitter.GetSeconds());
+            stats.jitterSum += jitter * weight;
+            stats.jitterHistogram.AddValue(jitter.GetSeconds(), weight);
         }
         else
         {
-            stats.jitterSum -= jitter;
-            stats.jitterHistogram.AddValue(-jitter.GetSeconds());
+            stats.jitterSum -= jitter * weight;
+            stats.jitterHistogram.AddValue(-jitter.GetSeconds(), weight);
         }
     }
     stats.lastDelay = delay;
 
-    stats.rxBytes += packetSize;
-    stats.packetSizeHistogram.AddValue((double)packetSize);
-    stats.rxPackets++;
-    if (stats.rxPackets == 1)
+    stats.rxBytes += static_cast<uint64_t>(packetSize) * weight;
+    stats.packetSizeHistogram.AddValue((double)packetSize, weight);
+    if (stats.rxPackets == 0)
     {
         stats.timeFirstRxPacket = now;
     }
-    else
+    else if (consecutive)
     {
         // measure possible flow interruptions
         Time interArrivalTime = now - stats.timeLastRxPacket;
@@ -265,13 +366,14 @@ FlowMonitor::ReportLastRx(Ptr<FlowProbe> probe,
             stats.flowInterruptionsHistogram.AddValue(interArrivalTime.GetSeconds());
         }
     }
+    stats.rxPackets += weight;
     stats.timeLastRxPacket = now;
-    stats.timesForwarded += tracked->second.timesForwarded;
+    stats.timesForwarded += tracked->timesForwarded * weight;
 
     NS_LOG_DEBUG("ReportLastTx: removing tracked packet (flowId=" << flowId << ", packetId="
                                                                   << packetId << ").");
 
-    m_trackedPackets.erase(tracked); // we don't need to track this packet anymore
+    m_trackedPackets.Erase(key); // we don't need to track this packet anymore
 }
 
 void
@@ -287,29 +389,31 @@ FlowMonitor::ReportDrop(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
+    if (!IsSampled(flowId, packetId))
+    {
+        return;
+    }
 
-    probe->AddPacketDropStats(flowId, packetSize, reasonCode);
+    probe->AddPacketDropStats(flowId, packetSize, reasonCode, m_samplingInterval);
 
     FlowStats& stats = GetStatsForFlow(flowId);
-    stats.lostPackets++;
+    stats.lostPackets += m_samplingInterval;
     if (stats.packetsDropped.size() < reasonCode + 1)
     {
         stats.packetsDropped.resize(reasonCode + 1, 0);
         stats.bytesDropped.resize(reasonCode + 1, 0);
     }
-    ++stats.packetsDropped[reasonCode];
-    stats.bytesDropped[reasonCode] += packetSize;
-    NS_LOG_DEBUG("++stats.packetsDropped["
-                 << reasonCode << "]; // becomes: " << stats.packetsDropped[reasonCode]);
+    stats.packetsDropped[reasonCode] += m_samplingInterval;
+    stats.bytesDropped[reasonCode] += static_cast<uint64_t>(packetSize) * m_samplingInterval;
+    NS_LOG_DEBUG("stats.packetsDropped["
+                 << reasonCode << "] becomes: " << stats.packetsDropped[reasonCode]);
 
-    TrackedPacketMap::iterator tracked = m_trackedPackets.find(std::make_pair(flowId, packetId));
-    if (tracked != m_trackedPackets.end())
+    if (m_trackedPackets.Erase(GetTrackedPacketKey(flowId, packetId)))
     {
         // we don't need to track this packet anymore
         // FIXME: this will not necessarily be true with broadcast/multicast
         NS_LOG_DEBUG("ReportDrop: removing tracked packet (flowId=" << flowId << ", packetId="
                                                                     << packetId << ").");
-        m_trackedPackets.erase(tracked);
     }
 }
 
@@ -325,24 +429,19 @@ FlowMonitor::CheckForLostPackets(Time maxDelay)
     NS_LOG_FUNCTION(this << maxDelay.As(Time::S));
     Time now = Simulator::Now();
 
-    for (TrackedPacketMap::iterator iter = m_trackedPackets.begin();
-         iter != m_trackedPackets.end();)
-    {
-        if (now - iter->second.lastSeenTime >= maxDelay)
+    m_trackedPackets.EraseIf([this, now, maxDelay](uint64_t key, const TrackedPacket& tracked) {
+        if (now - tracked.lastSeenTime < maxDelay)
         {
-            // packet is considered lost, add it to the loss statistics
-            FlowStatsContainerI flow = m_flowStats.find(iter->first.first);
-            NS_ASSERT(flow != m_flowStats.end());
-            flow->second.lostPackets++;
-
-            // we won't track it anymore
-            m_trackedPackets.erase(iter++);
+            return false;
         }
-        else
-        {
-            iter++;
-        }
-    }
+        // packet is considered lost, add it to the loss statistics (of a
+        // new flow entry if the flow was released)
+        FlowId flowId = key >> 32;
+        GetStatsForFlow(flowId).lostPackets += m_samplingInterval;
+
+        // we won't track it anymore
+        return true;
+    });
 }
 
 void
@@ -362,7 +461,125 @@ void
 FlowMonitor::NotifyConstructionCompleted()
 {
     Object::NotifyConstructionCompleted();
+    m_trackedPackets.Reserve(m_expectedFlows);
+    m_flowStatsIndex.reserve(m_expectedFlows + 1);
     Simulator::Schedule(PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
+
+    if (!m_exportFileName.empty())
+    {
+        NS_ABORT_MSG_UNLESS(m_exportInterval.IsStrictlyPositive(),
+                            "The ExportInterval must be positive");
+        m_exportStream = Create<OutputStreamWrapper>(m_exportFileName, std::ios::out);
+        NS_ABORT_MSG_IF(m_exportStream->GetStream()->fail(),
+                        "Unable to open " << m_exportFileName);
+        m_exportedStats.Reserve(m_expectedFlows);
+        // times in nanoseconds, counters as changes since the previous row of the flow
+        *m_exportStream->GetStream() << "time,flowId,txPackets,txBytes,rxPackets,rxBytes,"
+                                        "lostPackets,timesForwarded,delaySum,jitterSum\n";
+        m_exportEvent = Simulator::Schedule(m_exportInterval, &FlowMonitor::PeriodicExport, this);
+        m_exportDestroyEvent = Simulator::ScheduleDestroy(&FlowMonitor::FinishExport, this);
+    }
+}
+
+void
+FlowMonitor::NotifyFlowChanged(FlowId flowId)
+{
+    ExportedStats* exported = m_exportedStats.Insert(flowId, ExportedStats()).first;
+    if (!exported->changed)
+    {
+        exported->changed = true;
+        m_changedFlows.push_back(flowId);
+    }
+}
+
+void
+FlowMonitor::PeriodicExport()
+{
+    ExportWindow();
+    m_exportEvent = Simulator::Schedule(m_exportInterval, &FlowMonitor::PeriodicExport, this);
+}
+
+void
+FlowMonitor::FinishExport()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_exportStream)
+    {
+        ExportWindow();
+        m_exportStream = nullptr;
+    }
+}
+
+void
+FlowMonitor::ExportWindow()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_exportStream)
+    {
+        return;
+    }
+    std::ostream& os = *m_exportStream->GetStream();
+    Time now = Simulator::Now();
+    int64_t nowNs = now.GetNanoSeconds();
+    for (FlowId flowId : m_changedFlows)
+    {
+        ExportedStats* exported = m_exportedStats.Find(flowId);
+        FlowStatsContainerCI flow = m_flowStats.find(flowId);
+        NS_ASSERT(exported && flow != m_flowStats.end());
+        const FlowStats& stats = flow->second;
+        os << nowNs << ',' << flowId << ',' << stats.txPackets - exported->txPackets << ','
+           << stats.txBytes - exported->txBytes << ',' << stats.rxPackets - exported->rxPackets
+           << ',' << stats.rxBytes - exported->rxBytes << ','
+           << stats.lostPackets - exported->lostPackets << ','
+           << stats.timesForwarded - exported->timesForwarded << ','
+           << (stats.delaySum - exported->delaySum).GetNanoSeconds() << ','
+           << (stats.jitterSum - exported->jitterSum).GetNanoSeconds() << '\n';
+
+        exported->delaySum = stats.delaySum;
+        exported->jitterSum = stats.jitterSum;
+        exported->txBytes = stats.txBytes;
+        exported->rxBytes = stats.rxBytes;
+        exported->txPackets = stats.txPackets;
+        exported->rxPackets = stats.rxPackets;
+        exported->lostPackets = stats.lostPackets;
+        exported->timesForwarded = stats.timesForwarded;
+        exported->lastExportTime = now;
+        exported->changed = false;
+        if (m_flowIdleTimeout.IsStrictlyPositive())
+        {
+            m_exportedFlows.emplace_back(now, flowId);
+        }
+    }
+    NS_LOG_DEBUG("Exported " << m_changedFlows.size() << " flows");
+    m_changedFlows.clear();
+
+    // the flows exported later, or changed since their export, are not idle
+    while (!m_exportedFlows.empty() && now - m_exportedFlows.front().first >= m_flowIdleTimeout)
+    {
+        std::pair<Time, FlowId> entry = m_exportedFlows.front();
+        m_exportedFlows.pop_front();
+        ExportedStats* exported = m_exportedStats.Find(entry.second);
+        if (exported && !exported->changed && exported->lastExportTime == entry.first)
+        {
+            ReleaseFlow(entry.second);
+        }
+    }
+}
+
+void
+FlowMonitor::ReleaseFlow(FlowId flowId)
+{
+    NS_LOG_FUNCTION(this << flowId);
+    m_flowStats.erase(flowId);
+    if (flowId < m_flowStatsIndex.size())
+    {
+        m_flowStatsIndex[flowId] = nullptr;
+    }
+    m_exportedStats.Erase(flowId);
+    for (auto& probe : m_flowProbes)
+    {
+        probe->ReleaseFlow(flowId);
+    }
 }
 
 void
@@ -423,6 +640,7 @@ FlowMonitor::StopRightNow()
     }
     m_enabled = false;
     CheckForLostPackets();
+    ExportWindow();
 }
 
 void
@@ -440,7 +658,12 @@ FlowMonitor::SerializeToXmlStream(std::ostream& os,
     NS_LOG_FUNCTION(this << indent << enableHistograms << enableProbes);
     CheckForLostPackets();
 
-    os << std::string(indent, ' ') << "<FlowMonitor>\n";
+    os << std::string(indent, ' ') << "<FlowMonitor";
+    if (m_samplingInterval > 1)
+    {
+        os << " samplingInterval=\"" << m_samplingInterval << "\"";
+    }
+    os << ">\n";
     indent += 2;
     os << std::string(indent, ' ') << "<FlowStats>\n";
     indent += 2;
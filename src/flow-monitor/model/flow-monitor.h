@@ -22,12 +22,15 @@
 
 #include "ns3/event-id.h"
 #include "ns3/flow-classifier.h"
+#include "ns3/flow-hash-table.h"
 #include "ns3/flow-probe.h"
 #include "ns3/histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
+#include "ns3/output-stream-wrapper.h"
 #include "ns3/ptr.h"
 
+#include <deque>
 #include <map>
 #include <vector>
 
@@ -46,6 +49,17 @@ namespace ns3
  * The FlowMonitor class is responsible for coordinating efforts
  * regarding probes, and collects end-to-end flow statistics.
  *
+ * When the "SamplingInterval" attribute is N > 1, only about one packet
+ * in N is tracked, and each sampled packet is accounted for N packets in
+ * the statistics of the flows and of the probes, which are thus estimates
+ * of the statistics of all the packets. The jitter and the flow
+ * interruptions, which are measured between consecutive packets, are not
+ * measured in that case.
+ *
+ * When the "ExportFileName" attribute is set, the changes of the statistics
+ * of the flows are written in a CSV file every "ExportInterval" during the
+ * simulation, and the flows which have been idle for "FlowIdleTimeout" after
+ * their last export are released.
  */
 class FlowMonitor : public Object
 {
@@ -82,7 +96,8 @@ class FlowMonitor : public Object
         /// relatively to the last packet of the stream,
         /// i.e. \f$Jitter\left\{P_N\right\} = \left|Delay\left\{P_N\right\} -
         /// Delay\left\{P_{N-1}\right\}\right|\f$. This definition is in accordance with the
-        /// Type-P-One-way-ipdv as defined in IETF \RFC{3393}.
+        /// Type-P-One-way-ipdv as defined in IETF \RFC{3393}.  It is
+        /// zero when the packets are sampled (SamplingInterval > 1).
         Time jitterSum; // jitterCount == rxPackets - 1
 
         /// Contains the last measured delay of a packet
@@ -273,6 +288,13 @@ class FlowMonitor : public Object
     /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
     void SerializeToXmlFile(std::string fileName, bool enableHistograms, bool enableProbes);
 
+    /// Write in the export file (see the ExportFileName attribute) a row per flow whose
+    /// statistics changed since the previous export, with the changes of its counters, and
+    /// release the flows which have been idle for longer than the FlowIdleTimeout attribute.
+    /// This method is called every ExportInterval, when the monitor is stopped and at the end
+    /// of the simulation.
+    void ExportWindow();
+
   protected:
     void NotifyConstructionCompleted() override;
     void DoDispose() override;
@@ -286,14 +308,34 @@ class FlowMonitor : public Object
         uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
     };
 
+    /// Counters of a flow at its last export, from which the changes written in the export
+    /// file are computed
+    struct ExportedStats
+    {
+        Time delaySum;               //!< delaySum at the last export
+        Time jitterSum;              //!< jitterSum at the last export
+        uint64_t txBytes = 0;        //!< txBytes at the last export
+        uint64_t rxBytes = 0;        //!< rxBytes at the last export
+        uint32_t txPackets = 0;      //!< txPackets at the last export
+        uint32_t rxPackets = 0;      //!< rxPackets at the last export
+        uint32_t lostPackets = 0;    //!< lostPackets at the last export
+        uint32_t timesForwarded = 0; //!< timesForwarded at the last export
+        Time lastExportTime;         //!< time of the last export
+        bool changed = false;        //!< true if the flow changed since the last export
+    };
+
     /// FlowId --> FlowStats
     FlowStatsContainer m_flowStats;
+    /// FlowId --> FlowStats of m_flowStats, for the flows whose identifiers are not too large
+    std::vector<FlowStats*> m_flowStatsIndex;
 
     /// (FlowId,PacketId) --> TrackedPacket
-    typedef std::map<std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
-    TrackedPacketMap m_trackedPackets; //!< Tracked packets
-    Time m_maxPerHopDelay;             //!< Minimum per-hop delay
-    FlowProbeContainer m_flowProbes;   //!< all the FlowProbes
+    typedef FlowHashTable<uint64_t, TrackedPacket> TrackedPacketTable;
+    TrackedPacketTable m_trackedPackets; //!< Tracked packets
+    Time m_maxPerHopDelay;               //!< Minimum per-hop delay
+    FlowProbeContainer m_flowProbes;     //!< all the FlowProbes
+    uint32_t m_expectedFlows;            //!< Number of flows for which the tables are sized
+    uint32_t m_samplingInterval;         //!< One packet in m_samplingInterval is tracked
 
     // note: this is needed only for serialization
     std::list<Ptr<FlowClassifier>> m_classifiers; //!< the FlowClassifiers
@@ -307,13 +349,50 @@ class FlowMonitor : public Object
     double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
     Time m_flowInterruptionsMinTime;    //!< Flow interruptions minimum time
 
+    std::string m_exportFileName;            //!< Name of the export file, empty if disabled
+    Time m_exportInterval;                   //!< Time between two exports
+    Time m_flowIdleTimeout;                  //!< Idle time after which a flow is released
+    Ptr<OutputStreamWrapper> m_exportStream; //!< Export file
+    EventId m_exportEvent;                   //!< Next periodic export
+    EventId m_exportDestroyEvent;            //!< Last export, at Simulator::Destroy
+    std::vector<FlowId> m_changedFlows;      //!< Flows changed since the last export
+    /// FlowId --> counters at the last export
+    FlowHashTable<FlowId, ExportedStats> m_exportedStats;
+    /// (export time, FlowId) of the exported flows, in export order, to find the idle flows
+    std::deque<std::pair<Time, FlowId>> m_exportedFlows;
+
     /// Get the stats for a given flow
     /// \param flowId the Flow identification
     /// \returns the stats of the flow
     FlowStats& GetStatsForFlow(FlowId flowId);
 
+    /// \param flowId the Flow identification
+    /// \param packetId the Packet identification
+    /// \returns the key of the packet in m_trackedPackets
+    static uint64_t GetTrackedPacketKey(FlowId flowId, FlowPacketId packetId);
+
+    /// Tell whether a packet is tracked, according to the SamplingInterval attribute
+    /// \param flowId the Flow identification
+    /// \param packetId the Packet identification
+    /// \returns true if the packet is sampled
+    bool IsSampled(FlowId flowId, FlowPacketId packetId) const;
+
     /// Periodic function to check for lost packets and prune statistics
     void PeriodicCheckForLostPackets();
+
+    /// Record that the statistics of a flow changed, to export them
+    /// \param flowId the Flow identification
+    void NotifyFlowChanged(FlowId flowId);
+
+    /// Periodic function to export the statistics of the flows
+    void PeriodicExport();
+
+    /// Export the last changes and close the export file
+    void FinishExport();
+
+    /// Forget the statistics of a flow
+    /// \param flowId the Flow identification
+    void ReleaseFlow(FlowId flowId);
 };
 
 } // namespace ns3
@@ -53,16 +53,22 @@ FlowProbe::DoDispose()
 }
 
 void
-FlowProbe::AddPacketStats(FlowId flowId, uint32_t packetSize, Time delayFromFirstProbe)
+FlowProbe::AddPacketStats(FlowId flowId,
+                          uint32_t packetSize,
+                          Time delayFromFirstProbe,
+                          uint32_t count)
 {
     FlowStats& flow = m_stats[flowId];
-    flow.delayFromFirstProbeSum += delayFromFirstProbe;
-    flow.bytes += packetSize;
-    ++flow.packets;
+    flow.delayFromFirstProbeSum += delayFromFirstProbe * count;
+    flow.bytes += static_cast<uint64_t>(packetSize) * count;
+    flow.packets += count;
 }
 
 void
-FlowProbe::AddPacketDropStats(FlowId flowId, uint32_t packetSize, uint32_t reasonCode)
+FlowProbe::AddPacketDropStats(FlowId flowId,
+                              uint32_t packetSize,
+                              uint32_t reasonCode,
+                              uint32_t count)
 {
     FlowStats& flow = m_stats[flowId];
 
@@ -71,8 +77,8 @@ FlowProbe::AddPacketDropStats(FlowId flowId, uint32_t packetSize, uint32_t reaso
         flow.packetsDropped.resize(reasonCode + 1, 0);
         flow.bytesDropped.resize(reasonCode + 1, 0);
     }
-    ++flow.packetsDropped[reasonCode];
-    flow.bytesDropped[reasonCode] += packetSize;
+    flow.packetsDropped[reasonCode] += count;
+    flow.bytesDropped[reasonCode] += static_cast<uint64_t>(packetSize) * count;
 }
 
 FlowProbe::Stats
@@ -81,6 +87,12 @@ FlowProbe::GetStats() const
     return m_stats;
 }
 
+void
+FlowProbe::ReleaseFlow(FlowId flowId)
+{
+    m_stats.erase(flowId);
+}
+
 void
 FlowProbe::SerializeToXmlStream(std::ostream& os, uint16_t indent, uint32_t index) const
 {
@@ -85,12 +85,22 @@ class FlowProbe : public Object
     /// \param flowId the flow Identifier
     /// \param packetSize the packet size
     /// \param delayFromFirstProbe packet delay
-    void AddPacketStats(FlowId flowId, uint32_t packetSize, Time delayFromFirstProbe);
+    /// \param count the number of packets accounted for (more than one when the packets are
+    /// sampled)
+    void AddPacketStats(FlowId flowId,
+                        uint32_t packetSize,
+                        Time delayFromFirstProbe,
+                        uint32_t count = 1);
     /// Add a packet drop data to the flow stats
     /// \param flowId the flow Identifier
     /// \param packetSize the packet size
     /// \param reasonCode reason code for the drop
-    void AddPacketDropStats(FlowId flowId, uint32_t packetSize, uint32_t reasonCode);
+    /// \param count the number of packets accounted for (more than one when the packets are
+    /// sampled)
+    void AddPacketDropStats(FlowId flowId,
+                            uint32_t packetSize,
+                            uint32_t reasonCode,
+                            uint32_t count = 1);
 
     /// Get the partial flow statistics stored in this probe.  With this
     /// information you can, for example, find out what is the delay
@@ -98,6 +108,11 @@ class FlowProbe : public Object
     /// \returns the partial flow statistics
     Stats GetStats() const;
 
+    /// Forget the partial statistics of a flow, which has been released by
+    /// the FlowMonitor
+    /// \param flowId the flow Identifier
+    void ReleaseFlow(FlowId flowId);
+
     /// Serializes the results to an std::ostream in XML format
     /// \param os the output stream
     /// \param indent number of spaces to use as base indentation level
@@ -21,10 +21,12 @@
 #define IPV4_FLOW_CLASSIFIER_H
 
 #include "ns3/flow-classifier.h"
+#include "ns3/flow-hash-table.h"
 #include "ns3/ipv4-header.h"
 
 #include <map>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
@@ -48,8 +50,21 @@ class Ipv4FlowClassifier : public FlowClassifier
         uint16_t destinationPort;       //!< Destination port
     };
 
+    /// Hash function of the FiveTuple
+    struct FiveTupleHash
+    {
+        /// \param t the FiveTuple
+        /// \return the hash of the FiveTuple
+        std::size_t operator()(const FiveTuple& t) const;
+    };
+
     Ipv4FlowClassifier();
 
+    /// Allocate the flow tables for a number of flows, which are grown on
+    /// demand beyond this number
+    /// \param nFlows the number of flows expected
+    void Reserve(uint32_t nFlows);
+
     /// \brief try to classify the packet into flow-id and packet-id
     ///
     /// \warning: it must be called only once per packet, from SendOutgoingLogger.
@@ -93,11 +108,13 @@ class Ipv4FlowClassifier : public FlowClassifier
 
   private:
     /// Map to Flows Identifiers to FlowIds
-    std::map<FiveTuple, FlowId> m_flowMap;
-    /// Map to FlowIds to FlowPacketId
-    std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-    /// Map FlowIds to (DSCP value, packet count) pairs
-    std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t>> m_flowDscpMap;
+    FlowHashTable<FiveTuple, FlowId, FiveTupleHash> m_flowMap;
+    /// FiveTuple of each flow, indexed by FlowId - 1
+    std::vector<FiveTuple> m_flows;
+    /// Last FlowPacketId of each flow, indexed by FlowId - 1
+    std::vector<FlowPacketId> m_flowPktIds;
+    /// (DSCP value, packet count) pairs of each flow, indexed by FlowId - 1
+    std::vector<std::map<Ipv4Header::DscpType, uint32_t>> m_flowDscps;
 };
 
 /**
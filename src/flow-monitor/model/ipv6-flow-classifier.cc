@@ -25,6 +25,7 @@
 #include "ns3/udp-header.h"
 
 #include <algorithm>
+#include <cstring>
 
 namespace ns3
 {
@@ -92,10 +93,36 @@ operator==(const Ipv6FlowClassifier::FiveTuple& t1, const Ipv6FlowClassifier::Fi
             t1.sourcePort == t2.sourcePort && t1.destinationPort == t2.destinationPort);
 }
 
+std::size_t
+Ipv6FlowClassifier::FiveTupleHash::operator()(const FiveTuple& t) const
+{
+    uint64_t h = (static_cast<uint64_t>(t.sourcePort) << 24) |
+                 (static_cast<uint64_t>(t.destinationPort) << 8) | t.protocol;
+    uint8_t buf[32];
+    t.sourceAddress.GetBytes(buf);
+    t.destinationAddress.GetBytes(buf + 16);
+    for (uint32_t i = 0; i < sizeof(buf); i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, buf + i, sizeof(word));
+        h = (h ^ word) * 0xff51afd7ed558ccdULL;
+    }
+    return h;
+}
+
 Ipv6FlowClassifier::Ipv6FlowClassifier()
 {
 }
 
+void
+Ipv6FlowClassifier::Reserve(uint32_t nFlows)
+{
+    m_flowMap.Reserve(nFlows);
+    m_flows.reserve(nFlows);
+    m_flowPktIds.reserve(nFlows);
+    m_flowDscps.reserve(nFlows);
+}
+
 bool
 Ipv6FlowClassifier::Classify(const Ipv6Header& ipHeader,
                              Ptr<const Packet> ipPayload,
@@ -146,36 +173,30 @@ Ipv6FlowClassifier::Classify(const Ipv6Header& ipHeader,
     tuple.destinationPort = dstPort;
 
     // try to insert the tuple, but check if it already exists
-    std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert =
-        m_flowMap.insert(std::pair<FiveTuple, FlowId>(tuple, 0));
+    std::pair<FlowId*, bool> insert = m_flowMap.Insert(tuple, 0);
 
     // if the insertion succeeded, we need to assign this tuple a new flow identifier
+    FlowId flowId;
     if (insert.second)
     {
-        FlowId newFlowId = GetNewFlowId();
-        insert.first->second = newFlowId;
-        m_flowPktIdMap[newFlowId] = 0;
-        m_flowDscpMap[newFlowId];
+        flowId = GetNewFlowId();
+        *insert.first = flowId;
+        NS_ASSERT(flowId == m_flows.size() + 1);
+        m_flows.push_back(tuple);
+        m_flowPktIds.push_back(0);
+        m_flowDscps.emplace_back();
     }
     else
     {
-        m_flowPktIdMap[insert.first->second]++;
+        flowId = *insert.first;
+        m_flowPktIds[flowId - 1]++;
     }
 
     // increment the counter of packets with the same DSCP value
-    Ipv6Header::DscpType dscp = ipHeader.GetDscp();
-    std::pair<std::map<Ipv6Header::DscpType, uint32_t>::iterator, bool> dscpInserter =
-        m_flowDscpMap[insert.first->second].insert(
-            std::pair<Ipv6Header::DscpType, uint32_t>(dscp, 1));
+    m_flowDscps[flowId - 1][ipHeader.GetDscp()]++;
 
-    // if the insertion did not succeed, we need to increment the counter
-    if (!dscpInserter.second)
-    {
-        m_flowDscpMap[insert.first->second][dscp]++;
-    }
-
-    *out_flowId = insert.first->second;
-    *out_packetId = m_flowPktIdMap[*out_flowId];
+    *out_flowId = flowId;
+    *out_packetId = m_flowPktIds[flowId - 1];
 
     return true;
 }
@@ -183,18 +204,11 @@ Ipv6FlowClassifier::Classify(const Ipv6Header& ipHeader,
 Ipv6FlowClassifier::FiveTuple
 Ipv6FlowClassifier::FindFlow(FlowId flowId) const
 {
-    for (std::map<FiveTuple, FlowId>::const_iterator iter = m_flowMap.begin();
-         iter != m_flowMap.end();
-         iter++)
+    if (flowId == 0 || flowId > m_flows.size())
     {
-        if (iter->second == flowId)
-        {
-            return iter->first;
-        }
+        NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
     }
-    NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
-    FiveTuple retval = {Ipv6Address::GetZero(), Ipv6Address::GetZero(), 0, 0, 0};
-    return retval;
+    return m_flows[flowId - 1];
 }
 
 bool
@@ -207,16 +221,13 @@ Ipv6FlowClassifier::SortByCount::operator()(std::pair<Ipv6Header::DscpType, uint
 std::vector<std::pair<Ipv6Header::DscpType, uint32_t>>
 Ipv6FlowClassifier::GetDscpCounts(FlowId flowId) const
 {
-    std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t>>::const_iterator flow =
-        m_flowDscpMap.find(flowId);
-
-    if (flow == m_flowDscpMap.end())
+    if (flowId == 0 || flowId > m_flowDscps.size())
     {
         NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
     }
 
-    std::vector<std::pair<Ipv6Header::DscpType, uint32_t>> v(flow->second.begin(),
-                                                             flow->second.end());
+    const std::map<Ipv6Header::DscpType, uint32_t>& dscps = m_flowDscps[flowId - 1];
+    std::vector<std::pair<Ipv6Header::DscpType, uint32_t>> v(dscps.begin(), dscps.end());
     std::sort(v.begin(), v.end(), SortByCount());
     return v;
 }
@@ -228,32 +239,23 @@ Ipv6FlowClassifier::SerializeToXmlStream(std::ostream& os, uint16_t indent) cons
     os << "<Ipv6FlowClassifier>\n";
 
     indent += 2;
-    for (std::map<FiveTuple, FlowId>::const_iterator iter = m_flowMap.begin();
-         iter != m_flowMap.end();
-         iter++)
+    for (FlowId flowId = 1; flowId <= m_flows.size(); flowId++)
     {
+        const FiveTuple& tuple = m_flows[flowId - 1];
         Indent(os, indent);
-        os << "<Flow flowId=\"" << iter->second << "\""
-           << " sourceAddress=\"" << iter->first.sourceAddress << "\""
-           << " destinationAddress=\"" << iter->first.destinationAddress << "\""
-           << " protocol=\"" << int(iter->first.protocol) << "\""
-           << " sourcePort=\"" << iter->first.sourcePort << "\""
-           << " destinationPort=\"" << iter->first.destinationPort << "\">\n";
+        os << "<Flow flowId=\"" << flowId << "\""
+           << " sourceAddress=\"" << tuple.sourceAddress << "\""
+           << " destinationAddress=\"" << tuple.destinationAddress << "\""
+           << " protocol=\"" << int(tuple.protocol) << "\""
+           << " sourcePort=\"" << tuple.sourcePort << "\""
+           << " destinationPort=\"" << tuple.destinationPort << "\">\n";
 
         indent += 2;
-        std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t>>::const_iterator flow =
-            m_flowDscpMap.find(iter->second);
-
-        if (flow != m_flowDscpMap.end())
+        for (const auto& dscp : m_flowDscps[flowId - 1])
         {
-            for (std::map<Ipv6Header::DscpType, uint32_t>::const_iterator i = flow->second.begin();
-                 i != flow->second.end();
-                 i++)
-            {
-                Indent(os, indent);
-                os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t>(i->first) << "\""
-                   << " packets=\"" << std::dec << i->second << "\" />\n";
-            }
+            Indent(os, indent);
+            os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t>(dscp.first) << "\""
+               << " packets=\"" << std::dec << dscp.second << "\" />\n";
         }
 
         indent -= 2;
@@ -0,0 +1,622 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/config.h"
+#include "ns3/enum.h"
+#include "ns3/flow-hash-table.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/global-value.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \defgroup flow-monitor-tests Tests for flow-monitor
+ * \ingroup flow-monitor
+ * \ingroup tests
+ */
+
+/**
+ * \ingroup flow-monitor-tests
+ *
+ * \brief FlowHashTable test: the table is compared to a std::map while
+ * entries are inserted and erased.
+ */
+class FlowHashTableTestCase : public TestCase
+{
+  public:
+    FlowHashTableTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check that the table and the reference map hold the same entries.
+     * \param table the table
+     * \param reference the reference map
+     */
+    void CheckEqual(const FlowHashTable<uint64_t, uint32_t>& table,
+                    const std::map<uint64_t, uint32_t>& reference);
+};
+
+FlowHashTableTestCase::FlowHashTableTestCase()
+    : TestCase("FlowHashTable insertions and erasures")
+{
+}
+
+void
+FlowHashTableTestCase::CheckEqual(const FlowHashTable<uint64_t, uint32_t>& table,
+                                  const std::map<uint64_t, uint32_t>& reference)
+{
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), reference.size(), "Wrong number of entries");
+    uint32_t n = 0;
+    table.ForEach([&](uint64_t key, uint32_t value) {
+        auto it = reference.find(key);
+        NS_TEST_EXPECT_MSG_EQ((it != reference.end()), true, "Unexpected key " << key);
+        if (it != reference.end())
+        {
+            NS_TEST_EXPECT_MSG_EQ(value, it->second, "Wrong value of key " << key);
+        }
+        n++;
+    });
+    NS_TEST_EXPECT_MSG_EQ(n, reference.size(), "Wrong number of entries visited");
+    for (const auto& entry : reference)
+    {
+        const uint32_t* value = table.Find(entry.first);
+        NS_TEST_ASSERT_MSG_EQ((value != nullptr), true, "Key " << entry.first << " not found");
+        NS_TEST_EXPECT_MSG_EQ(*value, entry.second, "Wrong value of key " << entry.first);
+    }
+}
+
+void
+FlowHashTableTestCase::DoRun()
+{
+    FlowHashTable<uint64_t, uint32_t> table;
+    std::map<uint64_t, uint32_t> reference;
+
+    NS_TEST_EXPECT_MSG_EQ((table.Find(1) == nullptr), true, "Empty table");
+    NS_TEST_EXPECT_MSG_EQ(table.Erase(1), false, "Empty table");
+
+    // keys of the flow monitor: (flowId << 32) | packetId
+    for (uint64_t flowId = 1; flowId <= 40; flowId++)
+    {
+        for (uint64_t packetId = 0; packetId < 100; packetId++)
+        {
+            uint64_t key = (flowId << 32) | packetId;
+            uint32_t value = flowId * 1000 + packetId;
+            std::pair<uint32_t*, bool> insert = table.Insert(key, value);
+            NS_TEST_EXPECT_MSG_EQ(insert.second, true, "Key " << key << " inserted twice");
+            reference[key] = value;
+        }
+    }
+    std::pair<uint32_t*, bool> insert = table.Insert(1ULL << 32, 0);
+    NS_TEST_EXPECT_MSG_EQ(insert.second, false, "Existing key inserted");
+    NS_TEST_EXPECT_MSG_EQ(*insert.first, 1000, "Existing value overwritten");
+    CheckEqual(table, reference);
+
+    // random erasures and insertions, with a simple linear congruential generator
+    uint64_t x = 12345;
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t key = ((1 + (x >> 59)) << 32) | ((x >> 40) & 0xff);
+        if ((x >> 33) & 1)
+        {
+            bool erased = table.Erase(key);
+            NS_TEST_EXPECT_MSG_EQ(erased, (reference.erase(key) == 1), "Erase " << key);
+        }
+        else
+        {
+            table.Insert(key, i);
+            reference.insert(std::make_pair(key, i));
+        }
+    }
+    CheckEqual(table, reference);
+
+    std::size_t erased = table.EraseIf([](uint64_t key, uint32_t) { return key % 3 == 0; });
+    std::size_t expected = 0;
+    for (auto it = reference.begin(); it != reference.end();)
+    {
+        if (it->first % 3 == 0)
+        {
+            it = reference.erase(it);
+            expected++;
+        }
+        else
+        {
+            it++;
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(erased, expected, "Wrong number of entries erased");
+    CheckEqual(table, reference);
+
+    table.Clear();
+    reference.clear();
+    CheckEqual(table, reference);
+}
+
+/**
+ * \ingroup flow-monitor-tests
+ *
+ * \brief Ipv4FlowClassifier test: flow and packet identifiers assigned to
+ * the packets of a few flows.
+ */
+class Ipv4FlowClassifierTestCase : public TestCase
+{
+  public:
+    Ipv4FlowClassifierTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv4FlowClassifierTestCase::Ipv4FlowClassifierTestCase()
+    : TestCase("Ipv4FlowClassifier flow and packet identifiers")
+{
+}
+
+void
+Ipv4FlowClassifierTestCase::DoRun()
+{
+    Ptr<Ipv4FlowClassifier> classifier = Create<Ipv4FlowClassifier>();
+    classifier->Reserve(4);
+
+    const uint32_t nFlows = 100;
+    for (uint32_t round = 0; round < 3; round++)
+    {
+        for (uint32_t i = 0; i < nFlows; i++)
+        {
+            Ipv4Header ipHeader;
+            ipHeader.SetSource(Ipv4Address(0x0a000001 + i % 7));
+            ipHeader.SetDestination(Ipv4Address(0x0a010001));
+            ipHeader.SetProtocol(17);
+            ipHeader.SetDscp(round == 2 ? Ipv4Header::DSCP_EF : Ipv4Header::DscpDefault);
+            // UDP ports
+            uint16_t srcPort = 1000 + i;
+            uint8_t ports[8] = {uint8_t(srcPort >> 8), uint8_t(srcPort), 0, 9, 0, 8, 0, 0};
+            Ptr<Packet> payload = Create<Packet>(ports, sizeof(ports));
+
+            uint32_t flowId;
+            uint32_t packetId;
+            bool classified = classifier->Classify(ipHeader, payload, &flowId, &packetId);
+            NS_TEST_ASSERT_MSG_EQ(classified, true, "UDP packet not classified");
+            NS_TEST_EXPECT_MSG_EQ(flowId, i + 1, "Wrong flow identifier");
+            NS_TEST_EXPECT_MSG_EQ(packetId, round, "Wrong packet identifier");
+        }
+    }
+
+    for (uint32_t i = 0; i < nFlows; i++)
+    {
+        Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow(i + 1);
+        NS_TEST_EXPECT_MSG_EQ(tuple.sourceAddress, Ipv4Address(0x0a000001 + i % 7), "Source");
+        NS_TEST_EXPECT_MSG_EQ(tuple.sourcePort, 1000 + i, "Source port");
+        NS_TEST_EXPECT_MSG_EQ(tuple.destinationPort, 9, "Destination port");
+        NS_TEST_EXPECT_MSG_EQ(uint32_t(tuple.protocol), 17, "Protocol");
+    }
+
+    std::vector<std::pair<Ipv4Header::DscpType, uint32_t>> dscps = classifier->GetDscpCounts(1);
+    NS_TEST_ASSERT_MSG_EQ(dscps.size(), 2, "Wrong number of DSCP values");
+    NS_TEST_EXPECT_MSG_EQ(dscps[0].first, Ipv4Header::DscpDefault, "Most frequent DSCP");
+    NS_TEST_EXPECT_MSG_EQ(dscps[0].second, 2, "Packets with the default DSCP");
+    NS_TEST_EXPECT_MSG_EQ(dscps[1].second, 1, "Packets with the EF DSCP");
+}
+
+/**
+ * \ingroup flow-monitor-tests
+ *
+ * \brief A FlowProbe reporting the packets of the test directly.
+ */
+class FlowMonitorTestProbe : public FlowProbe
+{
+  public:
+    /**
+     * Constructor
+     * \param monitor the FlowMonitor of the probe
+     */
+    FlowMonitorTestProbe(Ptr<FlowMonitor> monitor)
+        : FlowProbe(monitor)
+    {
+    }
+};
+
+/**
+ * \ingroup flow-monitor-tests
+ *
+ * \brief FlowMonitor test: statistics of the flows with and without packet
+ * sampling.
+ */
+class FlowMonitorSamplingTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     * \param samplingInterval the SamplingInterval attribute of the monitor
+     */
+    FlowMonitorSamplingTestCase(uint32_t samplingInterval);
+
+  private:
+    void DoRun() override;
+
+    uint32_t m_samplingInterval; //!< One packet in m_samplingInterval is tracked
+};
+
+FlowMonitorSamplingTestCase::FlowMonitorSamplingTestCase(uint32_t samplingInterval)
+    : TestCase("FlowMonitor statistics with a sampling interval of " +
+               std::to_string(samplingInterval)),
+      m_samplingInterval(samplingInterval)
+{
+}
+
+void
+FlowMonitorSamplingTestCase::DoRun()
+{
+    Ptr<FlowMonitor> monitor = CreateObjectWithAttributes<FlowMonitor>(
+        "SamplingInterval",
+        UintegerValue(m_samplingInterval),
+        "ExpectedFlows",
+        UintegerValue(10));
+    Ptr<FlowMonitorTestProbe> probe = CreateObject<FlowMonitorTestProbe>(monitor);
+    monitor->StartRightNow();
+
+    // 10 flows of 4000 packets, of which 1000 are dropped and 500 are lost
+    const uint32_t nFlows = 10;
+    const uint32_t nPackets = 4000;
+    const uint32_t packetSize = 100;
+    for (FlowId flowId = 1; flowId <= nFlows; flowId++)
+    {
+        for (FlowPacketId packetId = 0; packetId < nPackets; packetId++)
+        {
+            monitor->ReportFirstTx(probe, flowId, packetId, packetSize);
+            if (packetId % 4 == 0)
+            {
+                monitor->ReportDrop(probe, flowId, packetId, packetSize, 2);
+            }
+            else if (packetId % 8 != 1)
+            {
+                monitor->ReportForwarding(probe, flowId, packetId, packetSize);
+                monitor->ReportLastRx(probe, flowId, packetId, packetSize);
+            }
+        }
+    }
+    monitor->CheckForLostPackets(Seconds(0));
+
+    // the estimates of the sampled statistics are within 15% of the actual values
+    double tolerance = (m_samplingInterval == 1) ? 0 : 0.15;
+    const FlowMonitor::FlowStatsContainer& stats = monitor->GetFlowStats();
+    NS_TEST_ASSERT_MSG_EQ(stats.size(), nFlows, "Wrong number of flows");
+    for (const auto& flow : stats)
+    {
+        const FlowMonitor::FlowStats& s = flow.second;
+        NS_TEST_EXPECT_MSG_EQ(s.txPackets % m_samplingInterval, 0, "Unscaled packet count");
+        NS_TEST_EXPECT_MSG_EQ(s.txBytes, uint64_t(s.txPackets) * packetSize, "Bytes sent");
+        NS_TEST_EXPECT_MSG_EQ(s.rxBytes, uint64_t(s.rxPackets) * packetSize, "Bytes received");
+        NS_TEST_EXPECT_MSG_EQ(s.txPackets, s.rxPackets + s.lostPackets, "Lost packets");
+        NS_TEST_EXPECT_MSG_EQ(s.timesForwarded, s.rxPackets, "Forwardings");
+        NS_TEST_EXPECT_MSG_EQ_TOL(double(s.txPackets),
+                                  double(nPackets),
+                                  tolerance * nPackets,
+                                  "Packets sent by flow " << flow.first);
+        NS_TEST_EXPECT_MSG_EQ_TOL(double(s.rxPackets),
+                                  0.625 * nPackets,
+                                  tolerance * nPackets,
+                                  "Packets received by flow " << flow.first);
+        NS_TEST_ASSERT_MSG_EQ(s.packetsDropped.size(), 3, "Drop reason codes");
+        NS_TEST_EXPECT_MSG_EQ_TOL(double(s.packetsDropped[2]),
+                                  0.25 * nPackets,
+                                  tolerance * nPackets,
+                                  "Packets dropped by flow " << flow.first);
+        Histogram delays = s.delayHistogram;
+        NS_TEST_EXPECT_MSG_EQ(delays.GetBinCount(0), s.rxPackets, "Delay histogram");
+    }
+
+    FlowProbe::Stats probeStats = probe->GetStats();
+    for (const auto& flow : stats)
+    {
+        // the first transmission, the forwarding and the reception of the
+        // packets are reported by the probe
+        NS_TEST_EXPECT_MSG_EQ(probeStats[flow.first].packets,
+                              flow.second.txPackets + 2 * flow.second.rxPackets,
+                              "Packets seen by the probe");
+    }
+
+    std::string xml = monitor->SerializeToXmlString(0, false, false);
+    bool sampled = xml.find("samplingInterval=\"") != std::string::npos;
+    NS_TEST_EXPECT_MSG_EQ(sampled, (m_samplingInterval > 1), "Sampling interval in the XML");
+
+    monitor->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup flow-monitor-tests
+ *
+ * \brief FlowMonitor test: jitter and flow interruptions of packets spaced in
+ * time, which are only measured when all the packets are tracked.
+ */
+class FlowMonitorSamplingSpacingTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     * \param samplingInterval the SamplingInterval attribute of the monitor
+     */
+    FlowMonitorSamplingSpacingTestCase(uint32_t samplingInterval);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Report the transmission of a packet, and schedule its reception
+     * \param packetId the packet identifier
+     * \param delay the delay of the packet
+     */
+    void Send(FlowPacketId packetId, Time delay);
+    /**
+     * Report the reception of a packet
+     * \param packetId the packet identifier
+     */
+    void Receive(FlowPacketId packetId);
+
+    uint32_t m_samplingInterval;             //!< One packet in m_samplingInterval is tracked
+    Ptr<FlowMonitor> m_monitor;              //!< The monitor
+    Ptr<FlowMonitorTestProbe> m_probe;       //!< The probe reporting the packets
+    static const uint32_t PACKET_SIZE = 100; //!< Size of the packets
+};
+
+FlowMonitorSamplingSpacingTestCase::FlowMonitorSamplingSpacingTestCase(uint32_t samplingInterval)
+    : TestCase("FlowMonitor jitter and interruptions with a sampling interval of " +
+               std::to_string(samplingInterval)),
+      m_samplingInterval(samplingInterval)
+{
+}
+
+void
+FlowMonitorSamplingSpacingTestCase::Send(FlowPacketId packetId, Time delay)
+{
+    m_monitor->ReportFirstTx(m_probe, 1, packetId, PACKET_SIZE);
+    Simulator::Schedule(delay, &FlowMonitorSamplingSpacingTestCase::Receive, this, packetId);
+}
+
+void
+FlowMonitorSamplingSpacingTestCase::Receive(FlowPacketId packetId)
+{
+    m_monitor->ReportLastRx(m_probe, 1, packetId, PACKET_SIZE);
+}
+
+void
+FlowMonitorSamplingSpacingTestCase::DoRun()
+{
+    m_monitor =
+        CreateObjectWithAttributes<FlowMonitor>("SamplingInterval",
+                                                UintegerValue(m_samplingInterval));
+    m_probe = CreateObject<FlowMonitorTestProbe>(m_monitor);
+    m_monitor->StartRightNow();
+
+    // a packet every 3 ms with a delay alternating between 10 and 11 ms, and
+    // a single interruption of 1 s in the middle of the flow
+    const uint32_t nPackets = 2000;
+    for (FlowPacketId packetId = 0; packetId < nPackets; packetId++)
+    {
+        Time sendTime = MilliSeconds(3 * packetId);
+        if (packetId >= nPackets / 2)
+        {
+            sendTime += Seconds(1);
+        }
+        Simulator::Schedule(sendTime,
+                            &FlowMonitorSamplingSpacingTestCase::Send,
+                            this,
+                            packetId,
+                            MilliSeconds(10 + packetId % 2));
+    }
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    const FlowMonitor::FlowStatsContainer& stats = m_monitor->GetFlowStats();
+    NS_TEST_ASSERT_MSG_EQ(stats.size(), 1, "Wrong number of flows");
+    FlowMonitor::FlowStats s = stats.begin()->second;
+    uint32_t jitters = 0;
+    for (uint32_t i = 0; i < s.jitterHistogram.GetNBins(); i++)
+    {
+        jitters += s.jitterHistogram.GetBinCount(i);
+    }
+    uint32_t interruptions = 0;
+    for (uint32_t i = 0; i < s.flowInterruptionsHistogram.GetNBins(); i++)
+    {
+        interruptions += s.flowInterruptionsHistogram.GetBinCount(i);
+    }
+    if (m_samplingInterval == 1)
+    {
+        NS_TEST_EXPECT_MSG_EQ(s.rxPackets, nPackets, "Packets received");
+        NS_TEST_EXPECT_MSG_EQ(s.jitterSum, MilliSeconds(nPackets - 1), "Jitter sum");
+        NS_TEST_EXPECT_MSG_EQ(jitters, nPackets - 1, "Jitter histogram");
+        NS_TEST_EXPECT_MSG_EQ(interruptions, 1, "Flow interruptions");
+    }
+    else
+    {
+        // the sampled packets are not consecutive: their inter-arrival times
+        // and delay variations are neither the jitter nor interruptions
+        NS_TEST_EXPECT_MSG_EQ_TOL(double(s.rxPackets),
+                                  double(nPackets),
+                                  0.15 * nPackets,
+                                  "Packets received");
+        NS_TEST_EXPECT_MSG_EQ(s.jitterSum, Time(0), "Jitter sum");
+        NS_TEST_EXPECT_MSG_EQ(jitters, 0, "Jitter histogram");
+        NS_TEST_EXPECT_MSG_EQ(interruptions, 0, "Flow interruptions");
+    }
+    NS_TEST_EXPECT_MSG_EQ_TOL(s.delaySum.GetSeconds() / s.rxPackets,
+                              0.0105,
+                              0.0005,
+                              "Mean delay");
+
+    m_monitor->Dispose();
+    m_monitor = nullptr;
+    m_probe = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup flow-monitor-tests
+ *
+ * \brief FlowMonitor test: periodic export of the statistics of the flows,
+ * and release of the idle flows.
+ */
+class FlowMonitorExportTestCase : public TestCase
+{
+  public:
+    FlowMonitorExportTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Report a packet sent, then received or dropped.
+     * \param flowId the flow of the packet
+     * \param packetId the identifier of the packet
+     * \param dropped true if the packet is dropped
+     */
+    void SendPacket(FlowId flowId, FlowPacketId packetId, bool dropped);
+
+    /**
+     * Check the flows whose statistics are held by the monitor.
+     * \param nFlows the expected number of flows
+     */
+    void CheckFlows(uint32_t nFlows);
+
+    Ptr<FlowMonitor> m_monitor;        //!< Flow monitor
+    Ptr<FlowMonitorTestProbe> m_probe; //!< Probe reporting the packets
+};
+
+FlowMonitorExportTestCase::FlowMonitorExportTestCase()
+    : TestCase("FlowMonitor periodic export")
+{
+}
+
+void
+FlowMonitorExportTestCase::SendPacket(FlowId flowId, FlowPacketId packetId, bool dropped)
+{
+    m_monitor->ReportFirstTx(m_probe, flowId, packetId, 100);
+    if (dropped)
+    {
+        m_monitor->ReportDrop(m_probe, flowId, packetId, 100, 0);
+    }
+    else
+    {
+        m_monitor->ReportLastRx(m_probe, flowId, packetId, 100);
+    }
+}
+
+void
+FlowMonitorExportTestCase::CheckFlows(uint32_t nFlows)
+{
+    NS_TEST_EXPECT_MSG_EQ(m_monitor->GetFlowStats().size(),
+                          nFlows,
+                          "Wrong number of flows at " << Simulator::Now().As(Time::S));
+    NS_TEST_EXPECT_MSG_EQ(m_probe->GetStats().size(),
+                          nFlows,
+                          "Wrong number of probe flows at " << Simulator::Now().As(Time::S));
+}
+
+void
+FlowMonitorExportTestCase::DoRun()
+{
+    // the export file is read back, hence it must not be compressed
+    EnumValue compression;
+    GlobalValue::GetValueByName("TraceCompression", compression);
+    Config::SetGlobal("TraceCompression", StringValue("None"));
+
+    std::string fileName = CreateTempDirFilename("flow-monitor-export.csv");
+    m_monitor = CreateObjectWithAttributes<FlowMonitor>("ExportFileName",
+                                                        StringValue(fileName),
+                                                        "ExportInterval",
+                                                        TimeValue(Seconds(1)),
+                                                        "FlowIdleTimeout",
+                                                        TimeValue(Seconds(2)));
+    m_probe = CreateObject<FlowMonitorTestProbe>(m_monitor);
+    m_monitor->StartRightNow();
+
+    // flow 2 is exported at 1 s and released at 3 s, flow 1 is exported at
+    // 1 s and 2 s and released at 4 s
+    for (FlowPacketId packetId = 0; packetId < 3; packetId++)
+    {
+        Simulator::Schedule(Seconds(0.5),
+                            &FlowMonitorExportTestCase::SendPacket,
+                            this,
+                            1,
+                            packetId,
+                            false);
+    }
+    Simulator::Schedule(Seconds(0.5), &FlowMonitorExportTestCase::SendPacket, this, 2, 0, false);
+    Simulator::Schedule(Seconds(0.5), &FlowMonitorExportTestCase::SendPacket, this, 2, 1, false);
+    Simulator::Schedule(Seconds(0.7), &FlowMonitorExportTestCase::SendPacket, this, 2, 2, true);
+    Simulator::Schedule(Seconds(1.5), &FlowMonitorExportTestCase::SendPacket, this, 1, 3, false);
+    Simulator::Schedule(Seconds(2.5), &FlowMonitorExportTestCase::CheckFlows, this, 2);
+    Simulator::Schedule(Seconds(3.5), &FlowMonitorExportTestCase::CheckFlows, this, 1);
+    Simulator::Schedule(Seconds(4.5), &FlowMonitorExportTestCase::CheckFlows, this, 0);
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    std::ifstream file(fileName);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    NS_TEST_EXPECT_MSG_EQ(contents.str(),
+                          "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,"
+                          "timesForwarded,delaySum,jitterSum\n"
+                          "1000000000,1,3,300,3,300,0,0,0,0\n"
+                          "1000000000,2,3,300,2,200,1,0,0,0\n"
+                          "2000000000,1,1,100,1,100,0,0,0,0\n",
+                          "Wrong export file");
+
+    m_monitor->Dispose();
+    m_monitor = nullptr;
+    m_probe = nullptr;
+    Config::SetGlobal("TraceCompression", compression);
+}
+
+/**
+ * \ingroup flow-monitor-tests
+ *
+ * \brief FlowMonitor TestSuite
+ */
+class FlowMonitorTestSuite : public TestSuite
+{
+  public:
+    FlowMonitorTestSuite();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite()
+    : TestSuite("flow-monitor", UNIT)
+{
+    AddTestCase(new FlowHashTableTestCase(), TestCase::QUICK);
+    AddTestCase(new Ipv4FlowClassifierTestCase(), TestCase::QUICK);
+    AddTestCase(new FlowMonitorSamplingTestCase(1), TestCase::QUICK);
+    AddTestCase(new FlowMonitorSamplingTestCase(8), TestCase::QUICK);
+    AddTestCase(new FlowMonitorSamplingSpacingTestCase(1), TestCase::QUICK);
+    AddTestCase(new FlowMonitorSamplingSpacingTestCase(8), TestCase::QUICK);
+    AddTestCase(new FlowMonitorExportTestCase(), TestCase::QUICK);
+}
+
+static FlowMonitorTestSuite g_flowMonitorTestSuite; //!< Static variable for test initialization
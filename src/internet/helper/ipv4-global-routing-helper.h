@@ -86,6 +86,9 @@ class Ipv4GlobalRoutingHelper : public Ipv4RoutingHelper
      * Users must first call PopulateRoutingTables() and then may subsequently
      * call RecomputeRoutingTables() at any later time in the simulation.
      *
+     * If the "GlobalRoutingIncremental" global value is true, only the routes
+     * of the routers which may be affected by the changes of the topology are
+     * removed and recomputed.
      */
     static void RecomputeRoutingTables();
 };
@@ -672,6 +672,14 @@ class GlobalRouteManagerLSDB
      */
     uint32_t GetNumExtLSAs() const;
 
+    /**
+     * @brief Get the Link State Advertisements of the routers and of the
+     * networks, in the order of their link state IDs.
+     *
+     * @returns the Link State Advertisements, except the external ones.
+     */
+    std::vector<GlobalRoutingLSA*> GetLSAs() const;
+
   private:
     typedef std::map<Ipv4Address, GlobalRoutingLSA*>
         LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +689,7 @@ class GlobalRouteManagerLSDB
     LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
     std::vector<GlobalRoutingLSA*>
         m_extdatabase; //!< database of External Link State Advertisements
+    LSDBMap_t m_linkDataIndex; //!< LSAs by the link data of their TransitNetwork records
 };
 
 /**
@@ -725,6 +734,17 @@ class GlobalRouteManagerImpl
      */
     virtual void InitializeRoutes();
 
+    /**
+     * @brief Rebuild the routing database and recompute the routes.
+     *
+     * If the GlobalRoutingIncremental global value is true, only the routes of
+     * the routers which depend on a changed Link State Advertisement are deleted
+     * and computed again; the routes of the other routers are kept.  Otherwise,
+     * this is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+     * and InitializeRoutes ().
+     */
+    virtual void RecomputeRoutes();
+
     /**
      * @brief Debugging routine; allow client code to supply a pre-built LSDB
      * @param lsdb the pre-built LSDB
@@ -738,8 +758,132 @@ class GlobalRouteManagerImpl
     void DebugSPFCalculate(Ipv4Address root);
 
   private:
+    /**
+     * @brief A route computed for the router at the root of the SPF tree.
+     */
+    struct SPFRoute
+    {
+        /// The routing table of the route
+        enum Type
+        {
+            HOST,     //!< host route
+            NETWORK,  //!< network route
+            EXTERNAL, //!< AS external route
+        };
+
+        Type type;           //!< routing table of the route
+        Ipv4Address dest;    //!< destination host or network
+        Ipv4Mask mask;       //!< mask of the destination network
+        Ipv4Address nextHop; //!< next hop
+        uint32_t outIf;      //!< outgoing interface
+    };
+
+    /**
+     * @brief A router whose routes are computed.
+     *
+     * The interface addresses of the router are collected before the SPF
+     * calculation, and the routes are installed after it, such that the
+     * calculation only reads the LSDB and can be run by several threads.
+     */
+    struct SPFRoot
+    {
+        Ipv4Address routerId; //!< router ID of the root
+        Ptr<Node> node;       //!< node of the router, if any
+        std::vector<std::pair<Ipv4Address, uint32_t>>
+            addresses;               //!< interface addresses of the node and their interfaces
+        std::vector<SPFRoute> routes; //!< routes computed for the router
+        bool stub;                    //!< whether the calculation stopped at the stub node check
+        std::vector<Ipv4Address> lsas; //!< link state IDs of the LSAs read by the stub check
+    };
+
+    /**
+     * @brief The Link State Advertisements which the routes of a router depend on.
+     */
+    struct SPFDependencies
+    {
+        bool stub; //!< whether the routes only depend on the LSAs read by the stub check
+        std::vector<Ipv4Address> lsas; //!< link state IDs of the LSAs read by the stub check
+    };
+
+    /**
+     * @brief Construct a worker which computes routes from the LSDB of another
+     * instance, and does not own it.
+     * @param lsdb the LSDB
+     */
+    GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb);
+
     SPFVertex* m_spfroot;           //!< the root node
     GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+    bool m_lsdbOwner;               //!< whether the LSDB is deleted with this object
+    SPFRoot* m_root;                //!< the router whose routes are being computed
+    /// SPF status of the LSAs in the current calculation
+    std::map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_lsaStatus;
+    /// Dependencies of the routes of the routers, by node ID
+    std::map<uint32_t, SPFDependencies> m_dependencies;
+
+    /**
+     * \brief Get the SPF status of a LSA in the current calculation
+     * \param lsa the LSA
+     * \returns the status
+     */
+    GlobalRoutingLSA::SPFStatus GetLSAStatus(const GlobalRoutingLSA* lsa) const;
+
+    /**
+     * \brief Set the SPF status of a LSA in the current calculation
+     * \param lsa the LSA
+     * \param status the status
+     */
+    void SetLSAStatus(const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
+
+    /**
+     * \brief Set the node of a router whose routes are computed, and collect the
+     * addresses of its interfaces
+     * \param root the router
+     * \param node the node of the router
+     */
+    void SetRootNode(SPFRoot& root, Ptr<Node> node);
+
+    /**
+     * \brief Compute the routes of routers and install them
+     *
+     * The SPF calculations are spread over the number of threads given by the
+     * GlobalRoutingThreads global value.  The routes are installed by the calling
+     * thread, in the order of the routers.
+     *
+     * \param roots the routers
+     */
+    void CalculateRoutes(std::vector<SPFRoot>& roots);
+
+    /**
+     * \brief Install the computed routes of a router in its routing table
+     * \param root the router
+     */
+    void InstallRoutes(SPFRoot& root);
+
+    /**
+     * \brief Delete the routes of a node, if it has a GlobalRouter interface
+     * \param node the node
+     */
+    void DeleteRoutes(Ptr<Node> node);
+
+    /**
+     * \brief Test if two LSAs have the same content
+     * \param a the first LSA
+     * \param b the second LSA
+     * \returns true if the LSAs are the same, except for their SPF status
+     */
+    static bool IsSameLSA(const GlobalRoutingLSA* a, const GlobalRoutingLSA* b);
+
+    /**
+     * \brief Find the connected components of the graph of the router and
+     * network LSAs
+     *
+     * The SPF tree of a router only contains LSAs of its component.
+     *
+     * \param lsdb the LSDB
+     * \returns the component of each LSA, by link state ID
+     */
+    static std::map<Ipv4Address, uint32_t> GetComponents(const GlobalRouteManagerLSDB* lsdb);
 
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
@@ -756,10 +900,11 @@ class GlobalRouteManagerImpl
     /**
      * \brief Calculate the shortest path first (SPF) tree
      *
-     * Equivalent to quagga ospf_spf_calculate
-     * \param root the root node
+     * Equivalent to quagga ospf_spf_calculate.  The routes are stored in
+     * \p root, and not installed.
+     * \param root the root router
      */
-    void SPFCalculate(Ipv4Address root);
+    void SPFCalculate(SPFRoot& root);
 
     /**
      * \brief Process Stub nodes
@@ -866,8 +1011,8 @@ class GlobalRouteManagerImpl
      *
      * This method is derived from quagga ospf_intra_add_router ()
      *
-     * This is where we are actually going to add the host routes to the routing
-     * tables of the individual nodes.
+     * This is where we are actually going to add the host routes to the routes
+     * of the router at the root of the SPF tree.
      *
      * The vertex passed as a parameter has just been added to the SPF tree.
      * This vertex must have a valid m_root_oid, corresponding to the outgoing
@@ -910,10 +1055,10 @@ class GlobalRouteManagerImpl
     /**
      * \brief Return the interface number corresponding to a given IP address and mask
      *
-     * This is a wrapper around GetInterfaceForPrefix(), but we first
-     * have to find the right node pointer to pass to that function.
-     * If no such interface is found, return -1 (note:  unit test framework
-     * for routing assumes -1 to be a legal return value)
+     * This is equivalent to GetInterfaceForPrefix() on the node at the root of
+     * the SPF tree, but uses the interface addresses collected before the
+     * calculation.  If no such interface is found, return -1 (note:  unit test
+     * framework for routing assumes -1 to be a legal return value)
      *
      * \param a the target IP address
      * \param amask the target subnet mask
@@ -70,6 +70,17 @@ class GlobalRouteManager
      * per-node forwarding tables
      */
     static void InitializeRoutes();
+
+    /**
+     * @brief Rebuild the routing database and recompute the routes.
+     *
+     * Unless the "GlobalRoutingIncremental" global value is true, this is the
+     * same as DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+     * InitializeRoutes ().  Otherwise only the routes of the routers which may
+     * be affected by the changes of the Link State Advertisements are
+     * recomputed.
+     */
+    static void RecomputeRoutes();
 };
 
 } // namespace ns3
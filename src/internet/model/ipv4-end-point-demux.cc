@@ -24,6 +24,9 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace ns3
 {
 
@@ -46,27 +49,87 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux()
         delete endPoint;
     }
     m_endPoints.clear();
+    m_index.clear();
+    m_ports.clear();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+Ipv4EndPointDemux::Key::operator==(const Key& other) const
 {
-    NS_LOG_FUNCTION(this << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    return localAddress == other.localAddress && localPort == other.localPort &&
+           peerAddress == other.peerAddress && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv4EndPointDemux::KeyHash::operator()(const Key& key) const
+{
+    uint64_t addresses =
+        (static_cast<uint64_t>(key.localAddress.Get()) << 32) | key.peerAddress.Get();
+    uint64_t ports = (static_cast<uint32_t>(key.localPort) << 16) | key.peerPort;
+    return std::hash<uint64_t>()(addresses ^ (ports * 0x9e3779b97f4a7c15ULL));
+}
+
+void
+Ipv4EndPointDemux::Insert(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Position position;
+    position.endPoint = m_endPoints.insert(m_endPoints.end(), endPoint);
+    EndPoints& port = m_ports[endPoint->GetLocalPort()];
+    position.port = port.insert(port.end(), endPoint);
+    Key key = {endPoint->GetLocalAddress(),
+               endPoint->GetLocalPort(),
+               endPoint->GetPeerAddress(),
+               endPoint->GetPeerPort()};
+    m_index.emplace(key, position);
+    endPoint->m_demux = this;
+}
+
+void
+Ipv4EndPointDemux::Reindex(Ipv4EndPoint* endPoint,
+                           Ipv4Address localAddress,
+                           Ipv4Address peerAddress,
+                           uint16_t peerPort)
+{
+    NS_LOG_FUNCTION(this << endPoint << localAddress << peerAddress << peerPort);
+    Key key = {endPoint->GetLocalAddress(),
+               endPoint->GetLocalPort(),
+               endPoint->GetPeerAddress(),
+               endPoint->GetPeerPort()};
+    auto range = m_index.equal_range(key);
+    for (auto i = range.first; i != range.second; i++)
     {
-        if ((*i)->GetLocalPort() == port)
+        if (*i->second.endPoint == endPoint)
         {
-            return true;
+            Position position = i->second;
+            m_index.erase(i);
+            key.localAddress = localAddress;
+            key.peerAddress = peerAddress;
+            key.peerPort = peerPort;
+            m_index.emplace(key, position);
+            return;
         }
     }
-    return false;
+    NS_ASSERT_MSG(false, "End point " << endPoint << " not found in the index");
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_ports.find(port);
+    if (endPoints == m_ports.end())
+    {
+        return false;
+    }
+    for (EndPointsI i = endPoints->second.begin(); i != endPoints->second.end(); i++)
     {
         if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
             (*i)->GetBoundNetDevice() == boundNetDevice)
@@ -88,7 +151,7 @@ Ipv4EndPointDemux::Allocate()
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(Ipv4Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -104,7 +167,7 @@ Ipv4EndPointDemux::Allocate(Ipv4Address address)
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -127,7 +190,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv4Address address,
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -140,11 +203,12 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    Key key = {localAddress, localPort, peerAddress, peerPort};
+    auto range = m_index.equal_range(key);
+    for (auto i = range.first; i != range.second; i++)
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        Ipv4EndPoint* endPoint = *i->second.endPoint;
+        if (endPoint->GetBoundNetDevice() == boundNetDevice || !endPoint->GetBoundNetDevice())
         {
             NS_LOG_WARN("Duplicated endpoint.");
             return nullptr;
@@ -152,7 +216,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -163,12 +227,24 @@ void
 Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this << endPoint);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    Key key = {endPoint->GetLocalAddress(),
+               endPoint->GetLocalPort(),
+               endPoint->GetPeerAddress(),
+               endPoint->GetPeerPort()};
+    auto range = m_index.equal_range(key);
+    for (auto i = range.first; i != range.second; i++)
     {
-        if (*i == endPoint)
+        if (*i->second.endPoint == endPoint)
         {
+            auto port = m_ports.find(endPoint->GetLocalPort());
+            port->second.erase(i->second.port);
+            if (port->second.empty())
+            {
+                m_ports.erase(port);
+            }
+            m_endPoints.erase(i->second.endPoint);
+            m_index.erase(i);
             delete endPoint;
-            m_endPoints.erase(i);
             break;
         }
     }
@@ -211,7 +287,47 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     EndPoints retval4; // Exact match on all 4
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+
+    // The endpoints which may match have the destination port as local port,
+    // the destination address, the wildcard address or a subnet-directed
+    // address of the incoming interface as local address, and either the
+    // source or the wildcard as peer.  Look them up in the index.
+    std::vector<Ipv4Address> localAddresses = {daddr, Ipv4Address::GetAny()};
+    if (incomingInterface)
+    {
+        for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
+        {
+            Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
+            Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
+            if (daddr.CombineMask(addr.GetMask()) == addrNetpart)
+            {
+                localAddresses.push_back(addrNetpart);
+            }
+        }
+    }
+    std::vector<Key> keys;
+    for (const auto& localAddress : localAddresses)
+    {
+        for (const Key& key : {Key{localAddress, dport, saddr, sport},
+                               Key{localAddress, dport, Ipv4Address::GetAny(), 0}})
+        {
+            if (std::find(keys.begin(), keys.end(), key) == keys.end())
+            {
+                keys.push_back(key);
+            }
+        }
+    }
+    EndPoints candidates;
+    for (const auto& key : keys)
+    {
+        auto range = m_index.equal_range(key);
+        for (auto i = range.first; i != range.second; i++)
+        {
+            candidates.push_back(*i->second.endPoint);
+        }
+    }
+
+    for (EndPointsI i = candidates.begin(); i != candidates.end(); i++)
     {
         Ipv4EndPoint* endP = *i;
 
@@ -376,7 +492,12 @@ Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
     // function.
     uint32_t genericity = 3;
     Ipv4EndPoint* generic = nullptr;
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_ports.find(dport);
+    if (endPoints == m_ports.end())
+    {
+        return nullptr;
+    }
+    for (EndPointsI i = endPoints->second.begin(); i != endPoints->second.end(); i++)
     {
         if ((*i)->GetLocalPort() != dport)
         {
@@ -32,6 +32,7 @@ namespace ns3
 {
 
 class Header;
+class Ipv4EndPointDemux;
 class Packet;
 
 /**
@@ -234,6 +235,13 @@ class Ipv4EndPoint
      * \brief true if the endpoint can receive packets.
      */
     bool m_rxEnabled;
+
+    /**
+     * \brief The demux which indexes the endpoint by its four-tuple, if any.
+     */
+    Ipv4EndPointDemux* m_demux;
+
+    friend class Ipv4EndPointDemux;
 };
 
 } // namespace ns3
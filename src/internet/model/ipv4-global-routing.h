@@ -19,6 +19,8 @@
 #ifndef IPV4_GLOBAL_ROUTING_H
 #define IPV4_GLOBAL_ROUTING_H
 
+#include "prefix-trie.h"
+
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -265,6 +267,23 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
     typedef std::list<Ipv4RoutingTableEntry*>::iterator ASExternalRoutesI;
 
+    /// index of Ipv4RoutingTableEntry by destination
+    typedef PrefixTrie<4, Ipv4RoutingTableEntry*> RoutesTrie;
+
+    /**
+     * \brief Add a route to an index.
+     * \param trie the index
+     * \param route the route
+     */
+    static void IndexRoute(RoutesTrie& trie, Ipv4RoutingTableEntry* route);
+
+    /**
+     * \brief Remove a route from an index.
+     * \param trie the index
+     * \param route the route
+     */
+    static void UnindexRoute(RoutesTrie& trie, Ipv4RoutingTableEntry* route);
+
     /**
      * \brief Lookup in the forwarding table for destination.
      * \param dest destination address
@@ -277,6 +296,10 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    RoutesTrie m_hostRoutesTrie;       //!< Index of the routes to hosts
+    RoutesTrie m_networkRoutesTrie;    //!< Index of the routes to networks
+    RoutesTrie m_ASexternalRoutesTrie; //!< Index of the external routes
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -37,6 +37,8 @@
 #include "ns3/simulator.h"
 
 #include <iomanip>
+#include <iterator>
+#include <vector>
 
 using std::make_pair;
 
@@ -79,7 +81,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
     if (!LookupRoute(route, metric))
     {
         Ipv4RoutingTableEntry* routePtr = new Ipv4RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AppendNetworkRoute(routePtr, metric);
     }
 }
 
@@ -96,8 +98,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
     if (!LookupRoute(route, metric))
     {
         Ipv4RoutingTableEntry* routePtr = new Ipv4RoutingTableEntry(route);
-
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AppendNetworkRoute(routePtr, metric);
     }
 }
 
@@ -152,7 +153,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv4Address network = Ipv4Address("224.0.0.0");
     Ipv4Mask networkMask = Ipv4Mask("240.0.0.0");
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
-    m_networkRoutes.emplace_back(route, 0);
+    AppendNetworkRoute(route, 0);
 }
 
 uint32_t
@@ -221,10 +222,34 @@ Ipv4StaticRouting::RemoveMulticastRoute(uint32_t index)
     }
 }
 
+void
+Ipv4StaticRouting::AppendNetworkRoute(Ipv4RoutingTableEntry* route, uint32_t metric)
+{
+    m_networkRoutes.emplace_back(route, metric);
+    m_networkRoutesTrie.Insert(NetworkRoutesTrie::GetBytes(route->GetDestNetwork()),
+                               NetworkRoutesTrie::GetBytes(route->GetDestNetworkMask()),
+                               std::prev(m_networkRoutes.end()));
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseNetworkRoute(NetworkRoutesI route)
+{
+    m_networkRoutesTrie.Remove(NetworkRoutesTrie::GetBytes(route->first->GetDestNetwork()),
+                               NetworkRoutesTrie::GetBytes(route->first->GetDestNetworkMask()),
+                               route);
+    delete route->first;
+    return m_networkRoutes.erase(route);
+}
+
 bool
 Ipv4StaticRouting::LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metric)
 {
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    // only the routes to the same network can be equal
+    std::vector<NetworkRoutesI> routes;
+    m_networkRoutesTrie.Get(NetworkRoutesTrie::GetBytes(route.GetDestNetwork()),
+                            NetworkRoutesTrie::GetBytes(route.GetDestNetworkMask()),
+                            routes);
+    for (NetworkRoutesI j : routes)
     {
         Ipv4RoutingTableEntry* rtentry = j->first;
 
@@ -261,7 +286,10 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
         return rtentry;
     }
 
-    for (NetworkRoutesI i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
+    // the routes to the networks of dest, in the order of the table
+    std::vector<NetworkRoutesI> routes;
+    m_networkRoutesTrie.Match(NetworkRoutesTrie::GetBytes(dest), routes);
+    for (NetworkRoutesI i : routes)
     {
         Ipv4RoutingTableEntry* j = i->first;
         uint32_t metric = i->second;
@@ -385,7 +413,10 @@ Ipv4StaticRouting::GetDefaultRoute()
     Ipv4Address dest("0.0.0.0");
     uint32_t shortest_metric = 0xffffffff;
     Ipv4RoutingTableEntry* result = nullptr;
-    for (NetworkRoutesI i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
+    // the routes to the networks of dest, in the order of the table
+    std::vector<NetworkRoutesI> routes;
+    m_networkRoutesTrie.Match(NetworkRoutesTrie::GetBytes(dest), routes);
+    for (NetworkRoutesI i : routes)
     {
         Ipv4RoutingTableEntry* j = i->first;
         uint32_t metric = i->second;
@@ -457,8 +488,7 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
-            delete j->first;
-            m_networkRoutes.erase(j);
+            EraseNetworkRoute(j);
             return;
         }
         tmp++;
@@ -588,6 +618,7 @@ void
 Ipv4StaticRouting::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    m_networkRoutesTrie.Clear();
     for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end();
          j = m_networkRoutes.erase(j))
     {
@@ -632,8 +663,7 @@ Ipv4StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
@@ -677,8 +707,7 @@ Ipv4StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkMask() == networkMask)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
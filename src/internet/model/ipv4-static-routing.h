@@ -21,6 +21,8 @@
 #ifndef IPV4_STATIC_ROUTING_H
 #define IPV4_STATIC_ROUTING_H
 
+#include "prefix-trie.h"
+
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -380,6 +382,23 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
     /// Iterator for container for the multicast routes
     typedef std::list<Ipv4MulticastRoutingTableEntry*>::iterator MulticastRoutesI;
 
+    /// Index of the network routes by destination
+    typedef PrefixTrie<4, NetworkRoutesI> NetworkRoutesTrie;
+
+    /**
+     * \brief Append a route to the forwarding table.
+     * \param route route
+     * \param metric metric of route
+     */
+    void AppendNetworkRoute(Ipv4RoutingTableEntry* route, uint32_t metric);
+
+    /**
+     * \brief Remove a route from the forwarding table, and delete it.
+     * \param route route
+     * \return the route following the removed route
+     */
+    NetworkRoutesI EraseNetworkRoute(NetworkRoutesI route);
+
     /**
      * \brief Checks if a route is already present in the forwarding table.
      * \param route route
@@ -410,6 +429,11 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * \brief the index of the forwarding table for network.
+     */
+    NetworkRoutesTrie m_networkRoutesTrie;
+
     /**
      * \brief the forwarding table for multicast.
      */
@@ -23,6 +23,9 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace ns3
 {
 
@@ -45,27 +48,88 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux()
         delete endPoint;
     }
     m_endPoints.clear();
+    m_index.clear();
+    m_ports.clear();
 }
 
 bool
-Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+Ipv6EndPointDemux::Key::operator==(const Key& other) const
 {
-    NS_LOG_FUNCTION(this << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    return localAddress == other.localAddress && localPort == other.localPort &&
+           peerAddress == other.peerAddress && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv6EndPointDemux::KeyHash::operator()(const Key& key) const
+{
+    Ipv6AddressHash addressHash;
+    uint64_t ports = (static_cast<uint32_t>(key.localPort) << 16) | key.peerPort;
+    std::size_t hash = addressHash(key.localAddress);
+    hash ^= addressHash(key.peerAddress) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash ^ std::hash<uint64_t>()(ports * 0x9e3779b97f4a7c15ULL);
+}
+
+void
+Ipv6EndPointDemux::Insert(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Position position;
+    position.endPoint = m_endPoints.insert(m_endPoints.end(), endPoint);
+    EndPoints& port = m_ports[endPoint->GetLocalPort()];
+    position.port = port.insert(port.end(), endPoint);
+    Key key = {endPoint->GetLocalAddress(),
+               endPoint->GetLocalPort(),
+               endPoint->GetPeerAddress(),
+               endPoint->GetPeerPort()};
+    m_index.emplace(key, position);
+    endPoint->m_demux = this;
+}
+
+void
+Ipv6EndPointDemux::Reindex(Ipv6EndPoint* endPoint,
+                           Ipv6Address localAddress,
+                           Ipv6Address peerAddress,
+                           uint16_t peerPort)
+{
+    NS_LOG_FUNCTION(this << endPoint << localAddress << peerAddress << peerPort);
+    Key key = {endPoint->GetLocalAddress(),
+               endPoint->GetLocalPort(),
+               endPoint->GetPeerAddress(),
+               endPoint->GetPeerPort()};
+    auto range = m_index.equal_range(key);
+    for (auto i = range.first; i != range.second; i++)
     {
-        if ((*i)->GetLocalPort() == port)
+        if (*i->second.endPoint == endPoint)
         {
-            return true;
+            Position position = i->second;
+            m_index.erase(i);
+            key.localAddress = localAddress;
+            key.peerAddress = peerAddress;
+            key.peerPort = peerPort;
+            m_index.emplace(key, position);
+            return;
         }
     }
-    return false;
+    NS_ASSERT_MSG(false, "End point " << endPoint << " not found in the index");
+}
+
+bool
+Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv6EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_ports.find(port);
+    if (endPoints == m_ports.end())
+    {
+        return false;
+    }
+    for (EndPointsI i = endPoints->second.begin(); i != endPoints->second.end(); i++)
     {
         if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
             (*i)->GetBoundNetDevice() == boundNetDevice)
@@ -87,7 +151,7 @@ Ipv6EndPointDemux::Allocate()
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(Ipv6Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -103,7 +167,7 @@ Ipv6EndPointDemux::Allocate(Ipv6Address address)
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -126,7 +190,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv6Address address,
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -139,11 +203,12 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    Key key = {localAddress, localPort, peerAddress, peerPort};
+    auto range = m_index.equal_range(key);
+    for (auto i = range.first; i != range.second; i++)
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        Ipv6EndPoint* endPoint = *i->second.endPoint;
+        if (endPoint->GetBoundNetDevice() == boundNetDevice || !endPoint->GetBoundNetDevice())
         {
             NS_LOG_WARN("Duplicated endpoint.");
             return nullptr;
@@ -151,7 +216,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -162,12 +227,24 @@ void
 Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    Key key = {endPoint->GetLocalAddress(),
+               endPoint->GetLocalPort(),
+               endPoint->GetPeerAddress(),
+               endPoint->GetPeerPort()};
+    auto range = m_index.equal_range(key);
+    for (auto i = range.first; i != range.second; i++)
     {
-        if (*i == endPoint)
+        if (*i->second.endPoint == endPoint)
         {
+            auto port = m_ports.find(endPoint->GetLocalPort());
+            port->second.erase(i->second.port);
+            if (port->second.empty())
+            {
+                m_ports.erase(port);
+            }
+            m_endPoints.erase(i->second.endPoint);
+            m_index.erase(i);
             delete endPoint;
-            m_endPoints.erase(i);
             break;
         }
     }
@@ -193,7 +270,33 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     EndPoints retval4; /* Exact match on all 4 */
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+
+    // The endpoints which may match have the destination port as local port,
+    // the destination or the wildcard address as local address, and either the
+    // source or the wildcard as peer.  Look them up in the index.
+    std::vector<Key> keys;
+    for (const auto& localAddress : {daddr, Ipv6Address::GetAny()})
+    {
+        for (const Key& key : {Key{localAddress, dport, saddr, sport},
+                               Key{localAddress, dport, Ipv6Address::GetAny(), 0}})
+        {
+            if (std::find(keys.begin(), keys.end(), key) == keys.end())
+            {
+                keys.push_back(key);
+            }
+        }
+    }
+    EndPoints candidates;
+    for (const auto& key : keys)
+    {
+        auto range = m_index.equal_range(key);
+        for (auto i = range.first; i != range.second; i++)
+        {
+            candidates.push_back(*i->second.endPoint);
+        }
+    }
+
+    for (EndPointsI i = candidates.begin(); i != candidates.end(); i++)
     {
         Ipv6EndPoint* endP = *i;
 
@@ -312,8 +415,13 @@ Ipv6EndPointDemux::SimpleLookup(Ipv6Address dst, uint16_t dport, Ipv6Address src
 {
     uint32_t genericity = 3;
     Ipv6EndPoint* generic = nullptr;
+    auto endPoints = m_ports.find(dport);
+    if (endPoints == m_ports.end())
+    {
+        return nullptr;
+    }
 
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    for (EndPointsI i = endPoints->second.begin(); i != endPoints->second.end(); i++)
     {
         uint32_t tmp = 0;
 
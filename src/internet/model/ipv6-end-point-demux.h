@@ -26,6 +26,7 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
 
 namespace ns3
 {
@@ -36,6 +37,10 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed by their four-tuple, and by their local port, such
+ * that a lookup only visits the endpoints which may match the packet.  The
+ * endpoints keep the index up to date when their addresses change.
  */
 class Ipv6EndPointDemux
 {
@@ -167,6 +172,73 @@ class Ipv6EndPointDemux
      */
     uint16_t AllocateEphemeralPort();
 
+    /**
+     * \brief Add an endpoint to the demux.
+     * \param endPoint the endpoint
+     */
+    void Insert(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Move an endpoint to its new four-tuple in the index.
+     *
+     * Called by the endpoint before its addresses change.
+     *
+     * \param endPoint the endpoint
+     * \param localAddress the new local address
+     * \param peerAddress the new peer address
+     * \param peerPort the new peer port
+     */
+    void Reindex(Ipv6EndPoint* endPoint,
+                 Ipv6Address localAddress,
+                 Ipv6Address peerAddress,
+                 uint16_t peerPort);
+
+    /**
+     * \brief Four-tuple of an endpoint.
+     */
+    struct Key
+    {
+        Ipv6Address localAddress; //!< Local address
+        uint16_t localPort;       //!< Local port
+        Ipv6Address peerAddress;  //!< Peer address
+        uint16_t peerPort;        //!< Peer port
+
+        /**
+         * \brief Compare two four-tuples.
+         * \param other the other four-tuple
+         * \return true if the four-tuples are equal
+         */
+        bool operator==(const Key& other) const;
+    };
+
+    /**
+     * \brief Hash of a four-tuple.
+     */
+    struct KeyHash
+    {
+        /**
+         * \brief Hash a four-tuple.
+         * \param key the four-tuple
+         * \return the hash
+         */
+        std::size_t operator()(const Key& key) const;
+    };
+
+    /**
+     * \brief Position of an endpoint in the list of endpoints and in the list
+     * of the endpoints of its local port.
+     */
+    struct Position
+    {
+        EndPointsI endPoint; //!< Position in m_endPoints
+        EndPointsI port;     //!< Position in the list of the local port in m_ports
+    };
+
+    /**
+     * \brief Container of the endpoints indexed by four-tuple.
+     */
+    typedef std::unordered_multimap<Key, Position, KeyHash> Index;
+
     /**
      * \brief The ephemeral port.
      */
@@ -186,6 +258,18 @@ class Ipv6EndPointDemux
      * \brief A list of IPv6 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The IPv6 end points, indexed by four-tuple.
+     */
+    Index m_index;
+
+    /**
+     * \brief The IPv6 end points of each local port, in the order of m_endPoints.
+     */
+    std::unordered_map<uint16_t, EndPoints> m_ports;
+
+    friend class Ipv6EndPoint;
 };
 
 } /* namespace ns3 */
@@ -32,6 +32,7 @@ namespace ns3
 {
 
 class Header;
+class Ipv6EndPointDemux;
 class Packet;
 
 /**
@@ -238,6 +239,13 @@ class Ipv6EndPoint
      * \brief true if the endpoint can receive packets.
      */
     bool m_rxEnabled;
+
+    /**
+     * \brief The demux which indexes the endpoint by its four-tuple, if any.
+     */
+    Ipv6EndPointDemux* m_demux;
+
+    friend class Ipv6EndPointDemux;
 };
 
 } /* namespace ns3 */
@@ -30,6 +30,8 @@
 #include "ns3/simulator.h"
 
 #include <iomanip>
+#include <iterator>
+#include <vector>
 
 namespace ns3
 {
@@ -182,7 +184,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
     if (!LookupRoute(route, metric))
     {
         Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AppendNetworkRoute(routePtr, metric);
     }
 }
 
@@ -209,7 +211,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
     if (!LookupRoute(route, metric))
     {
         Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AppendNetworkRoute(routePtr, metric);
     }
 }
 
@@ -226,7 +228,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
     if (!LookupRoute(route, metric))
     {
         Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AppendNetworkRoute(routePtr, metric);
     }
 }
 
@@ -268,7 +270,7 @@ Ipv6StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv6Address network = Ipv6Address("ff00::"); /* RFC 3513 */
     Ipv6Prefix networkMask = Ipv6Prefix(8);
     *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
-    m_networkRoutes.emplace_back(route, 0);
+    AppendNetworkRoute(route, 0);
 }
 
 uint32_t
@@ -344,7 +346,9 @@ Ipv6StaticRouting::HasNetworkDest(Ipv6Address network, uint32_t interfaceIndex)
     NS_LOG_FUNCTION(this << network << interfaceIndex);
 
     /* in the network table */
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    std::vector<NetworkRoutesI> routes;
+    m_networkRoutesTrie.Match(NetworkRoutesTrie::GetBytes(network), routes);
+    for (NetworkRoutesI j : routes)
     {
         Ipv6RoutingTableEntry* rtentry = j->first;
         Ipv6Prefix prefix = rtentry->GetDestNetworkPrefix();
@@ -360,10 +364,34 @@ Ipv6StaticRouting::HasNetworkDest(Ipv6Address network, uint32_t interfaceIndex)
     return false;
 }
 
+void
+Ipv6StaticRouting::AppendNetworkRoute(Ipv6RoutingTableEntry* route, uint32_t metric)
+{
+    m_networkRoutes.emplace_back(route, metric);
+    m_networkRoutesTrie.Insert(NetworkRoutesTrie::GetBytes(route->GetDestNetwork()),
+                               NetworkRoutesTrie::GetBytes(route->GetDestNetworkPrefix()),
+                               std::prev(m_networkRoutes.end()));
+}
+
+Ipv6StaticRouting::NetworkRoutesI
+Ipv6StaticRouting::EraseNetworkRoute(NetworkRoutesI route)
+{
+    m_networkRoutesTrie.Remove(NetworkRoutesTrie::GetBytes(route->first->GetDestNetwork()),
+                               NetworkRoutesTrie::GetBytes(route->first->GetDestNetworkPrefix()),
+                               route);
+    delete route->first;
+    return m_networkRoutes.erase(route);
+}
+
 bool
 Ipv6StaticRouting::LookupRoute(const Ipv6RoutingTableEntry& route, uint32_t metric)
 {
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    // only the routes to the same network can be equal
+    std::vector<NetworkRoutesI> routes;
+    m_networkRoutesTrie.Get(NetworkRoutesTrie::GetBytes(route.GetDestNetwork()),
+                            NetworkRoutesTrie::GetBytes(route.GetDestNetworkPrefix()),
+                            routes);
+    for (NetworkRoutesI j : routes)
     {
         Ipv6RoutingTableEntry* rtentry = j->first;
 
@@ -402,7 +430,10 @@ Ipv6StaticRouting::LookupStatic(Ipv6Address dst, Ptr<NetDevice> interface)
         return rtentry;
     }
 
-    for (NetworkRoutesI it = m_networkRoutes.begin(); it != m_networkRoutes.end(); it++)
+    // the routes to the networks of dst, in the order of the table
+    std::vector<NetworkRoutesI> routes;
+    m_networkRoutesTrie.Match(NetworkRoutesTrie::GetBytes(dst), routes);
+    for (NetworkRoutesI it : routes)
     {
         Ipv6RoutingTableEntry* j = it->first;
         uint32_t metric = it->second;
@@ -485,6 +516,7 @@ Ipv6StaticRouting::DoDispose()
 {
     NS_LOG_FUNCTION(this);
 
+    m_networkRoutesTrie.Clear();
     for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end();
          j = m_networkRoutes.erase(j))
     {
@@ -569,7 +601,10 @@ Ipv6StaticRouting::GetDefaultRoute()
     uint32_t shortestMetric = 0xffffffff;
     Ipv6RoutingTableEntry* result = nullptr;
 
-    for (NetworkRoutesI it = m_networkRoutes.begin(); it != m_networkRoutes.end(); it++)
+    // the routes to the networks of dst, in the order of the table
+    std::vector<NetworkRoutesI> routes;
+    m_networkRoutesTrie.Match(NetworkRoutesTrie::GetBytes(dst), routes);
+    for (NetworkRoutesI it : routes)
     {
         Ipv6RoutingTableEntry* j = it->first;
         uint32_t metric = it->second;
@@ -648,8 +683,7 @@ Ipv6StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
-            delete it->first;
-            m_networkRoutes.erase(it);
+            EraseNetworkRoute(it);
             return;
         }
         tmp++;
@@ -671,8 +705,7 @@ Ipv6StaticRouting::RemoveRoute(Ipv6Address network,
         if (network == rtentry->GetDest() && rtentry->GetInterface() == ifIndex &&
             rtentry->GetPrefixToUse() == prefixToUse)
         {
-            delete it->first;
-            m_networkRoutes.erase(it);
+            EraseNetworkRoute(it);
             return;
         }
     }
@@ -813,8 +846,7 @@ Ipv6StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
@@ -851,8 +883,7 @@ Ipv6StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv6InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkPrefix() == networkMask)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
@@ -909,8 +940,7 @@ Ipv6StaticRouting::NotifyRemoveRoute(Ipv6Address dst,
 
             if (dst == entry && prefix == mask && rtentry->GetInterface() == interface)
             {
-                delete j->first;
-                j = m_networkRoutes.erase(j);
+                j = EraseNetworkRoute(j);
             }
             else
             {
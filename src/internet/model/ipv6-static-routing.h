@@ -20,6 +20,8 @@
 #ifndef IPV6_STATIC_ROUTING_H
 #define IPV6_STATIC_ROUTING_H
 
+#include "prefix-trie.h"
+
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
@@ -305,6 +307,23 @@ class Ipv6StaticRouting : public Ipv6RoutingProtocol
     /// Iterator for container for the multicast routes
     typedef std::list<Ipv6MulticastRoutingTableEntry*>::iterator MulticastRoutesI;
 
+    /// Index of the network routes by destination
+    typedef PrefixTrie<16, NetworkRoutesI> NetworkRoutesTrie;
+
+    /**
+     * \brief Append a route to the forwarding table.
+     * \param route route
+     * \param metric metric of route
+     */
+    void AppendNetworkRoute(Ipv6RoutingTableEntry* route, uint32_t metric);
+
+    /**
+     * \brief Remove a route from the forwarding table, and delete it.
+     * \param route route
+     * \return the route following the removed route
+     */
+    NetworkRoutesI EraseNetworkRoute(NetworkRoutesI route);
+
     /**
      * \brief Checks if a route is already present in the forwarding table.
      * \param route route
@@ -335,6 +354,11 @@ class Ipv6StaticRouting : public Ipv6RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * \brief the index of the forwarding table for network.
+     */
+    NetworkRoutesTrie m_networkRoutesTrie;
+
     /**
      * \brief the forwarding table for multicast.
      */
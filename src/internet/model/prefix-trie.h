@@ -0,0 +1,625 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup ipv4Routing
+ * ns3::PrefixTrie declaration and implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Index of the routes of a routing table by destination prefix.
+ *
+ * The trie finds all the routes whose destination matches an address in
+ * O(address length), instead of a scan of the routing table.  It is a
+ * binary trie on the bits of the destination prefixes, in which the
+ * nodes with a single child and without routes are compressed away, such
+ * that it has less than two nodes per destination prefix.  All the routes
+ * to the same prefix are stored in the same node, e.g., the equal-cost
+ * routes of ECMP.
+ *
+ * Match() returns the matching routes in the order they were inserted,
+ * which is the order of the routing table when the routes are appended to
+ * the table and inserted at the same time.  The routing protocols thus
+ * select the route among the matches exactly as they did among all the
+ * routes of the table.
+ *
+ * Routes with a non-contiguous mask, which are seldom used, are not stored
+ * in the trie but checked by each Match().
+ *
+ * \tparam N The size of the addresses, in bytes.
+ * \tparam T The type of the routes, which must be equality comparable.
+ */
+template <std::size_t N, class T>
+class PrefixTrie
+{
+  public:
+    /** Address or mask bytes, in network order. */
+    typedef std::array<uint8_t, N> Bytes;
+
+    PrefixTrie();
+
+    /**
+     * Insert a route.
+     *
+     * \param [in] prefix The destination of the route.
+     * \param [in] mask The mask of the destination.
+     * \param [in] route The route.
+     */
+    void Insert(const Bytes& prefix, const Bytes& mask, const T& route);
+
+    /**
+     * Remove a route.
+     *
+     * \param [in] prefix The destination of the route.
+     * \param [in] mask The mask of the destination.
+     * \param [in] route The route.
+     * \returns true if the route was found and removed.
+     */
+    bool Remove(const Bytes& prefix, const Bytes& mask, const T& route);
+
+    /**
+     * Get the routes to a destination prefix.
+     *
+     * \param [in] prefix The destination.
+     * \param [in] mask The mask of the destination.
+     * \param [out] routes The routes to exactly this prefix are appended to this vector,
+     *              in insertion order.
+     */
+    void Get(const Bytes& prefix, const Bytes& mask, std::vector<T>& routes) const;
+
+    /**
+     * Find the routes whose destination matches an address.
+     *
+     * \param [in] address The address.
+     * \param [out] routes The matching routes are appended to this vector, in insertion order.
+     */
+    void Match(const Bytes& address, std::vector<T>& routes) const;
+
+    /**
+     * Remove all the routes.
+     */
+    void Clear();
+
+    /**
+     * \returns The number of routes.
+     */
+    std::size_t GetSize() const;
+
+    /**
+     * \param [in] address An IPv4 address.
+     * \returns The bytes of the address.
+     */
+    static std::array<uint8_t, 4> GetBytes(Ipv4Address address);
+    /**
+     * \param [in] mask An IPv4 mask.
+     * \returns The bytes of the mask.
+     */
+    static std::array<uint8_t, 4> GetBytes(Ipv4Mask mask);
+    /**
+     * \param [in] address An IPv6 address.
+     * \returns The bytes of the address.
+     */
+    static std::array<uint8_t, 16> GetBytes(Ipv6Address address);
+    /**
+     * \param [in] prefix An IPv6 prefix.
+     * \returns The bytes of the prefix.
+     */
+    static std::array<uint8_t, 16> GetBytes(Ipv6Prefix prefix);
+
+  private:
+    /** Route and its insertion rank. */
+    struct Item
+    {
+        uint64_t order; //!< Insertion rank
+        T route;        //!< The route
+    };
+
+    /** Route with a non-contiguous mask. */
+    struct IrregularItem
+    {
+        Bytes prefix; //!< The masked destination
+        Bytes mask;   //!< The mask
+        Item item;    //!< The route
+    };
+
+    /** Node of the trie. */
+    struct Node
+    {
+        Bytes prefix;                   //!< The prefix, with zero bits after its length
+        uint32_t length;                //!< The length of the prefix, in bits
+        std::unique_ptr<Node> child[2]; //!< The children, by the bit after the prefix
+        std::vector<Item> items;        //!< The routes to this prefix
+    };
+
+    /** The number of bits of the addresses. */
+    static const uint32_t BITS = N * 8;
+
+    /**
+     * Get the length of a contiguous mask.
+     *
+     * \param [in] mask The mask.
+     * \param [out] length The number of leading ones of the mask.
+     * \returns false if the mask is not contiguous.
+     */
+    static bool GetLength(const Bytes& mask, uint32_t& length);
+    /**
+     * \param [in] bytes Some bytes.
+     * \param [in] i The index of a bit, from the most significant bit.
+     * \returns The bit.
+     */
+    static uint32_t GetBit(const Bytes& bytes, uint32_t i);
+    /**
+     * \param [in] a Some bytes.
+     * \param [in] b Some bytes.
+     * \param [in] length The maximum length.
+     * \returns The number of leading bits of \pname{a} and \pname{b} which are equal,
+     *          up to \pname{length}.
+     */
+    static uint32_t GetCommonLength(const Bytes& a, const Bytes& b, uint32_t length);
+    /**
+     * \param [in] bytes Some bytes.
+     * \param [in] mask A mask.
+     * \returns The bytes masked by the mask.
+     */
+    static Bytes ApplyMask(const Bytes& bytes, const Bytes& mask);
+    /**
+     * \param [in] bytes Some bytes.
+     * \param [in] length A number of bits.
+     * \returns The bytes with the bits after \pname{length} cleared.
+     */
+    static Bytes Truncate(const Bytes& bytes, uint32_t length);
+    /**
+     * Create a node.
+     *
+     * \param [in] prefix The prefix.
+     * \param [in] length The length of the prefix.
+     * \returns The node.
+     */
+    static std::unique_ptr<Node> CreateNode(const Bytes& prefix, uint32_t length);
+    /**
+     * Find the node of a prefix.
+     *
+     * \param [in] prefix The prefix.
+     * \param [in] length The length of the prefix.
+     * \returns The node, or null if the prefix is not in the trie.
+     */
+    const Node* FindNode(const Bytes& prefix, uint32_t length) const;
+
+    std::unique_ptr<Node> m_root;           //!< The root of the trie
+    std::vector<IrregularItem> m_irregular; //!< The routes with a non-contiguous mask
+    uint64_t m_order;                       //!< Insertion rank of the next route
+    std::size_t m_size;                     //!< Number of routes
+};
+
+/*************************************************
+ *  Implementation of the templates
+ *************************************************/
+
+template <std::size_t N, class T>
+PrefixTrie<N, T>::PrefixTrie()
+    : m_order(0),
+      m_size(0)
+{
+}
+
+template <std::size_t N, class T>
+bool
+PrefixTrie<N, T>::GetLength(const Bytes& mask, uint32_t& length)
+{
+    length = 0;
+    std::size_t i = 0;
+    while (i < N && mask[i] == 0xff)
+    {
+        length += 8;
+        i++;
+    }
+    if (i < N)
+    {
+        uint8_t byte = mask[i];
+        while (byte & 0x80)
+        {
+            length++;
+            byte <<= 1;
+        }
+        if (byte != 0)
+        {
+            return false;
+        }
+        for (i++; i < N; i++)
+        {
+            if (mask[i] != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <std::size_t N, class T>
+uint32_t
+PrefixTrie<N, T>::GetBit(const Bytes& bytes, uint32_t i)
+{
+    return (bytes[i / 8] >> (7 - i % 8)) & 1;
+}
+
+template <std::size_t N, class T>
+uint32_t
+PrefixTrie<N, T>::GetCommonLength(const Bytes& a, const Bytes& b, uint32_t length)
+{
+    uint32_t common = 0;
+    std::size_t i = 0;
+    while (common < length && a[i] == b[i])
+    {
+        common += 8;
+        i++;
+    }
+    if (common < length)
+    {
+        uint8_t diff = a[i] ^ b[i];
+        while ((diff & 0x80) == 0)
+        {
+            common++;
+            diff <<= 1;
+        }
+    }
+    return std::min(common, length);
+}
+
+template <std::size_t N, class T>
+typename PrefixTrie<N, T>::Bytes
+PrefixTrie<N, T>::ApplyMask(const Bytes& bytes, const Bytes& mask)
+{
+    Bytes masked;
+    for (std::size_t i = 0; i < N; i++)
+    {
+        masked[i] = bytes[i] & mask[i];
+    }
+    return masked;
+}
+
+template <std::size_t N, class T>
+typename PrefixTrie<N, T>::Bytes
+PrefixTrie<N, T>::Truncate(const Bytes& bytes, uint32_t length)
+{
+    Bytes truncated = bytes;
+    for (std::size_t i = length / 8; i < N; i++)
+    {
+        uint32_t kept = i * 8 < length ? length - i * 8 : 0;
+        truncated[i] &= static_cast<uint8_t>(0xff00 >> kept);
+    }
+    return truncated;
+}
+
+template <std::size_t N, class T>
+std::unique_ptr<typename PrefixTrie<N, T>::Node>
+PrefixTrie<N, T>::CreateNode(const Bytes& prefix, uint32_t length)
+{
+    std::unique_ptr<Node> node(new Node);
+    node->prefix = prefix;
+    node->length = length;
+    return node;
+}
+
+template <std::size_t N, class T>
+void
+PrefixTrie<N, T>::Insert(const Bytes& prefix, const Bytes& mask, const T& route)
+{
+    Bytes key = ApplyMask(prefix, mask);
+    Item item = {m_order++, route};
+    m_size++;
+    uint32_t length;
+    if (!GetLength(mask, length))
+    {
+        m_irregular.push_back({key, mask, item});
+        return;
+    }
+
+    std::unique_ptr<Node>* link = &m_root;
+    while (true)
+    {
+        Node* node = link->get();
+        if (node == nullptr)
+        {
+            *link = CreateNode(key, length);
+            (*link)->items.push_back(item);
+            return;
+        }
+        uint32_t common = GetCommonLength(node->prefix, key, std::min(node->length, length));
+        if (common == node->length)
+        {
+            if (node->length == length)
+            {
+                node->items.push_back(item);
+                return;
+            }
+            // the prefix is below this node
+            link = &node->child[GetBit(key, node->length)];
+            continue;
+        }
+        // the prefix diverges from this node, or is above it: split the link
+        std::unique_ptr<Node> below = std::move(*link);
+        if (common == length)
+        {
+            *link = CreateNode(key, length);
+            (*link)->items.push_back(item);
+        }
+        else
+        {
+            *link = CreateNode(Truncate(key, common), common);
+            std::unique_ptr<Node> leaf = CreateNode(key, length);
+            leaf->items.push_back(item);
+            (*link)->child[GetBit(key, common)] = std::move(leaf);
+        }
+        (*link)->child[GetBit(below->prefix, common)] = std::move(below);
+        return;
+    }
+}
+
+template <std::size_t N, class T>
+bool
+PrefixTrie<N, T>::Remove(const Bytes& prefix, const Bytes& mask, const T& route)
+{
+    Bytes key = ApplyMask(prefix, mask);
+    uint32_t length;
+    if (!GetLength(mask, length))
+    {
+        for (auto it = m_irregular.begin(); it != m_irregular.end(); it++)
+        {
+            if (it->prefix == key && it->mask == mask && it->item.route == route)
+            {
+                m_irregular.erase(it);
+                m_size--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // find the node, and the link to its parent
+    std::unique_ptr<Node>* parentLink = nullptr;
+    std::unique_ptr<Node>* link = &m_root;
+    while (*link && (*link)->length < length &&
+           GetCommonLength((*link)->prefix, key, (*link)->length) == (*link)->length)
+    {
+        parentLink = link;
+        link = &(*link)->child[GetBit(key, (*link)->length)];
+    }
+    Node* node = link->get();
+    if (node == nullptr || node->length != length || node->prefix != key)
+    {
+        return false;
+    }
+    auto it = node->items.begin();
+    while (it != node->items.end() && !(it->route == route))
+    {
+        it++;
+    }
+    if (it == node->items.end())
+    {
+        return false;
+    }
+    node->items.erase(it);
+    m_size--;
+    if (!node->items.empty())
+    {
+        return true;
+    }
+
+    // compress the node, and its parent if it becomes useless
+    for (uint32_t level = 0; level < 2 && link != nullptr; level++)
+    {
+        node = link->get();
+        if (!node->items.empty() || (node->child[0] && node->child[1]))
+        {
+            break;
+        }
+        std::unique_ptr<Node> child = std::move(node->child[node->child[0] ? 0 : 1]);
+        *link = std::move(child);
+        link = parentLink;
+    }
+    return true;
+}
+
+template <std::size_t N, class T>
+const typename PrefixTrie<N, T>::Node*
+PrefixTrie<N, T>::FindNode(const Bytes& prefix, uint32_t length) const
+{
+    const Node* node = m_root.get();
+    while (node != nullptr && node->length < length &&
+           GetCommonLength(node->prefix, prefix, node->length) == node->length)
+    {
+        node = node->child[GetBit(prefix, node->length)].get();
+    }
+    if (node == nullptr || node->length != length || node->prefix != prefix)
+    {
+        return nullptr;
+    }
+    return node;
+}
+
+template <std::size_t N, class T>
+void
+PrefixTrie<N, T>::Get(const Bytes& prefix, const Bytes& mask, std::vector<T>& routes) const
+{
+    Bytes key = ApplyMask(prefix, mask);
+    uint32_t length;
+    if (!GetLength(mask, length))
+    {
+        for (const auto& irregular : m_irregular)
+        {
+            if (irregular.prefix == key && irregular.mask == mask)
+            {
+                routes.push_back(irregular.item.route);
+            }
+        }
+        return;
+    }
+    const Node* node = FindNode(key, length);
+    if (node != nullptr)
+    {
+        for (const auto& item : node->items)
+        {
+            routes.push_back(item.route);
+        }
+    }
+}
+
+template <std::size_t N, class T>
+void
+PrefixTrie<N, T>::Match(const Bytes& address, std::vector<T>& routes) const
+{
+    // The routes of each matching node are sorted by insertion rank:
+    // merge them, along with the matching irregular routes.
+    const std::vector<Item>* matches[BITS + 2];
+    std::size_t next[BITS + 2];
+    std::size_t nMatches = 0;
+    for (const Node* node = m_root.get(); node != nullptr;)
+    {
+        if (GetCommonLength(node->prefix, address, node->length) < node->length)
+        {
+            break;
+        }
+        if (!node->items.empty())
+        {
+            matches[nMatches] = &node->items;
+            next[nMatches] = 0;
+            nMatches++;
+        }
+        if (node->length == BITS)
+        {
+            break;
+        }
+        node = node->child[GetBit(address, node->length)].get();
+    }
+    std::vector<Item> irregular;
+    for (const auto& candidate : m_irregular)
+    {
+        if (ApplyMask(address, candidate.mask) == candidate.prefix)
+        {
+            irregular.push_back(candidate.item);
+        }
+    }
+    if (!irregular.empty())
+    {
+        matches[nMatches] = &irregular;
+        next[nMatches] = 0;
+        nMatches++;
+    }
+
+    if (nMatches == 1)
+    {
+        for (const auto& item : *matches[0])
+        {
+            routes.push_back(item.route);
+        }
+        return;
+    }
+    while (true)
+    {
+        std::size_t first = nMatches;
+        for (std::size_t i = 0; i < nMatches; i++)
+        {
+            if (next[i] < matches[i]->size() &&
+                (first == nMatches ||
+                 (*matches[i])[next[i]].order < (*matches[first])[next[first]].order))
+            {
+                first = i;
+            }
+        }
+        if (first == nMatches)
+        {
+            return;
+        }
+        routes.push_back((*matches[first])[next[first]].route);
+        next[first]++;
+    }
+}
+
+template <std::size_t N, class T>
+void
+PrefixTrie<N, T>::Clear()
+{
+    m_root.reset();
+    m_irregular.clear();
+    m_size = 0;
+}
+
+template <std::size_t N, class T>
+std::size_t
+PrefixTrie<N, T>::GetSize() const
+{
+    return m_size;
+}
+
+template <std::size_t N, class T>
+std::array<uint8_t, 4>
+PrefixTrie<N, T>::GetBytes(Ipv4Address address)
+{
+    std::array<uint8_t, 4> bytes;
+    address.Serialize(bytes.data());
+    return bytes;
+}
+
+template <std::size_t N, class T>
+std::array<uint8_t, 4>
+PrefixTrie<N, T>::GetBytes(Ipv4Mask mask)
+{
+    uint32_t value = mask.Get();
+    return {static_cast<uint8_t>(value >> 24),
+            static_cast<uint8_t>(value >> 16),
+            static_cast<uint8_t>(value >> 8),
+            static_cast<uint8_t>(value)};
+}
+
+template <std::size_t N, class T>
+std::array<uint8_t, 16>
+PrefixTrie<N, T>::GetBytes(Ipv6Address address)
+{
+    std::array<uint8_t, 16> bytes;
+    address.GetBytes(bytes.data());
+    return bytes;
+}
+
+template <std::size_t N, class T>
+std::array<uint8_t, 16>
+PrefixTrie<N, T>::GetBytes(Ipv6Prefix prefix)
+{
+    std::array<uint8_t, 16> bytes;
+    prefix.GetBytes(bytes.data());
+    return bytes;
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -61,7 +61,10 @@ TcpTxBuffer::TcpTxBuffer(uint32_t n)
     : m_maxBuffer(32768),
       m_size(0),
       m_sentSize(0),
-      m_firstByteSeq(n)
+      m_firstByteSeq(n),
+      m_lostFrontier(n),
+      m_nextSegFrom(n),
+      m_nextLostFrom(n)
 {
     m_rWndCallback = MakeNullCallback<uint32_t>();
 }
@@ -177,6 +180,9 @@ TcpTxBuffer::SetHeadSequence(const SequenceNumber32& seq)
     // if you change the head with data already sent, something bad will happen
     NS_ASSERT(m_sentList.empty());
     m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_lostFrontier = seq;
+    m_nextSegFrom = seq;
+    m_nextLostFrom = seq;
 }
 
 bool
@@ -297,7 +303,7 @@ TcpTxBuffer::GetNewSegment(uint32_t numBytes)
     NS_ASSERT(it != m_appList.end());
 
     m_appList.erase(it);
-    m_sentList.insert(m_sentList.end(), item);
+    m_sentIndex[item->m_startSeq] = m_sentList.insert(m_sentList.end(), item);
     m_sentSize += item->m_packet->GetSize();
 
     return item;
@@ -311,37 +317,34 @@ TcpTxBuffer::GetTransmittedSegment(uint32_t numBytes, const SequenceNumber32& se
     NS_ASSERT(numBytes <= m_sentSize);
     NS_ASSERT(!m_sentList.empty());
 
-    auto it = m_sentList.begin();
     bool listEdited = false;
     uint32_t s = numBytes;
 
     // Avoid to merge different packet for this retransmission if flags are
     // different.
-    for (; it != m_sentList.end(); ++it)
+    auto indexIt = m_sentIndex.find(seq);
+    if (indexIt != m_sentIndex.end())
     {
-        if ((*it)->m_startSeq == seq)
+        auto it = indexIt->second;
+        auto next = it;
+        next++;
+        if (next != m_sentList.end())
         {
-            auto next = it;
-            next++;
-            if (next != m_sentList.end())
+            // Next is not sacked and have the same value for m_lost ... there is the
+            // possibility to merge
+            if ((!(*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-                // Next is not sacked and have the same value for m_lost ... there is the
-                // possibility to merge
-                if ((!(*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                    s = std::min(s, (*it)->m_packet->GetSize() + (*next)->m_packet->GetSize());
-                }
-                else
-                {
-                    // Next is sacked... better to retransmit only the first segment
-                    s = std::min(s, (*it)->m_packet->GetSize());
-                }
+                s = std::min(s, (*it)->m_packet->GetSize() + (*next)->m_packet->GetSize());
             }
             else
             {
+                // Next is sacked... better to retransmit only the first segment
                 s = std::min(s, (*it)->m_packet->GetSize());
             }
-            break;
+        }
+        else
+        {
+            s = std::min(s, (*it)->m_packet->GetSize());
         }
     }
 
@@ -378,6 +381,48 @@ TcpTxBuffer::FindHighestSacked() const
     return ret;
 }
 
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindSentItem(const SequenceNumber32& seq) const
+{
+    auto it = m_sentIndex.lower_bound(seq);
+    if (it == m_sentIndex.end())
+    {
+        return m_sentList.end();
+    }
+    return it->second;
+}
+
+void
+TcpTxBuffer::ResetNextSegHints(const SequenceNumber32& seq) const
+{
+    if (seq < m_nextSegFrom)
+    {
+        m_nextSegFrom = seq;
+    }
+    if (seq < m_nextLostFrom)
+    {
+        m_nextLostFrom = seq;
+    }
+}
+
+void
+TcpTxBuffer::ClampScoreboardHints()
+{
+    SequenceNumber32 head = m_firstByteSeq;
+    SequenceNumber32 tail = m_firstByteSeq + m_sentSize;
+    for (SequenceNumber32* hint : {&m_lostFrontier, &m_nextSegFrom, &m_nextLostFrom})
+    {
+        if (*hint < head)
+        {
+            *hint = head;
+        }
+        else if (*hint > tail)
+        {
+            *hint = tail;
+        }
+    }
+}
+
 void
 TcpTxBuffer::SplitItems(TcpTxItem* t1, TcpTxItem* t2, uint32_t size) const
 {
@@ -403,7 +448,7 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
                                const SequenceNumber32& listStartFrom,
                                uint32_t numBytes,
                                const SequenceNumber32& seq,
-                               bool* listEdited) const
+                               bool* listEdited)
 {
     NS_LOG_FUNCTION(this << numBytes << seq);
 
@@ -439,12 +484,25 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
     TcpTxItem* outItem = nullptr;
     PacketList::iterator it = list.begin();
     SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+    bool isSentList = (&list == &m_sentList);
+
+    if (isSentList)
+    {
+        // Start from the item which contains seq
+        auto indexIt = m_sentIndex.upper_bound(seq);
+        if (indexIt != m_sentIndex.begin())
+        {
+            --indexIt;
+            it = indexIt->second;
+            beginOfCurrentPacket = indexIt->first;
+        }
+    }
 
     while (it != list.end())
     {
         currentItem = *it;
         currentPacket = currentItem->m_packet;
-        NS_ASSERT_MSG(list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+        NS_ASSERT_MSG(!isSentList || currentItem->m_startSeq >= m_firstByteSeq,
                       "start: " << m_firstByteSeq
                                 << " currentItem start: " << currentItem->m_startSeq);
 
@@ -473,7 +531,12 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
                 SplitItems(firstPart, currentItem, seq - beginOfCurrentPacket);
 
                 // insert firstPart before currentItem
-                list.insert(it, firstPart);
+                auto firstPartIt = list.insert(it, firstPart);
+                if (isSentList)
+                {
+                    m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                    m_sentIndex[currentItem->m_startSeq] = it;
+                }
                 if (listEdited)
                 {
                     *listEdited = true;
@@ -519,6 +582,11 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
                     NS_ASSERT(it != list.begin());
                     TcpTxItem* previous = *(--it);
 
+                    if (isSentList)
+                    {
+                        m_sentIndex.erase(previous->m_startSeq);
+                        ResetNextSegHints(previous->m_startSeq);
+                    }
                     list.erase(it);
 
                     MergeItems(previous, currentItem);
@@ -539,7 +607,12 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
                 SplitItems(firstPart, currentItem, numBytes);
 
                 // insert firstPart before currentItem
-                list.insert(it, firstPart);
+                auto firstPartIt = list.insert(it, firstPart);
+                if (isSentList)
+                {
+                    m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                    m_sentIndex[currentItem->m_startSeq] = it;
+                }
                 if (listEdited)
                 {
                     *listEdited = true;
@@ -568,6 +641,12 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
                                      // in the previous if
 
             MergeItems(currentItem, next);
+            if (isSentList)
+            {
+                // The merge may have removed the retransmitted flag
+                m_sentIndex.erase(next->m_startSeq);
+                ResetNextSegHints(currentItem->m_startSeq);
+            }
             list.erase(it);
 
             delete next;
@@ -652,16 +731,16 @@ bool
 TcpTxBuffer::IsRetransmittedDataAcked(const SequenceNumber32& ack) const
 {
     NS_LOG_FUNCTION(this);
-    for (const auto& it : m_sentList)
+    // Only the item which precedes ack can end at ack
+    auto it = m_sentIndex.lower_bound(ack);
+    if (it == m_sentIndex.begin())
     {
-        TcpTxItem* item = it;
-        Ptr<Packet> p = item->m_packet;
-        if (item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans)
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+    --it;
+    TcpTxItem* item = *(it->second);
+    Ptr<Packet> p = item->m_packet;
+    return (item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans);
 }
 
 void
@@ -709,6 +788,7 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
 
             RemoveFromCounts(item, pktSize);
 
+            m_sentIndex.erase(item->m_startSeq);
             i = m_sentList.erase(i);
             NS_LOG_INFO("Removed " << *item << " lost: " << m_lostOut << " retrans: " << m_retrans
                                    << " sacked: " << m_sackedOut << ". Remaining data " << m_size);
@@ -727,7 +807,9 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
             NS_LOG_INFO(*item);
             // PacketTags are preserved when fragmenting
             item->m_packet = item->m_packet->CreateFragment(offset, pktSize);
+            m_sentIndex.erase(item->m_startSeq);
             item->m_startSeq += offset;
+            m_sentIndex[item->m_startSeq] = i;
             m_size -= offset;
             m_sentSize -= offset;
             m_firstByteSeq += offset;
@@ -771,6 +853,7 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
     {
         m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
     }
+    ClampScoreboardHints();
 
     NS_LOG_DEBUG("Discarded up to " << seq << " lost: " << m_lostOut << " retrans: " << m_retrans
                                     << " sacked: " << m_sackedOut);
@@ -790,15 +873,20 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
 
     for (auto option_it = list.begin(); option_it != list.end(); ++option_it)
     {
-        PacketList::iterator item_it = m_sentList.begin();
-        SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
         if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
             NS_LOG_INFO("Not updating scoreboard, the option block is outside the sent list");
             return bytesSacked;
         }
 
+        // The items which start before the block cannot be sacked by it
+        PacketList::const_iterator item_it = FindSentItem((*option_it).first);
+        if (item_it == m_sentList.end())
+        {
+            continue;
+        }
+        SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
+
         while (item_it != m_sentList.end())
         {
             uint32_t pktSize = (*item_it)->m_packet->GetSize();
@@ -891,7 +979,13 @@ TcpTxBuffer::UpdateLostCount()
                                                  << *(*m_highestSack.first));
     }
 
-    for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+    // The items before m_lostFrontier have already been examined: each of them
+    // is either sacked or lost, so the walk stops there.
+    SequenceNumber32 frontier = m_lostFrontier;
+    bool isFrontierFound = false;
+    for (auto it = m_highestSack.first;
+         it != m_sentList.begin() && (*it)->m_startSeq >= m_lostFrontier;
+         --it)
     {
         TcpTxItem* item = *it;
         if (item->m_sacked)
@@ -901,10 +995,17 @@ TcpTxBuffer::UpdateLostCount()
 
         if (sacked >= m_dupAckThresh)
         {
+            if (!isFrontierFound)
+            {
+                // The items below this one are now examined
+                frontier = item->m_startSeq;
+                isFrontierFound = true;
+            }
             if (!item->m_sacked && !item->m_lost)
             {
                 item->m_lost = true;
                 m_lostOut += item->m_packet->GetSize();
+                ResetNextSegHints(item->m_startSeq);
             }
         }
         beginOfCurrentPacket -= item->m_packet->GetSize();
@@ -917,7 +1018,9 @@ TcpTxBuffer::UpdateLostCount()
         {
             item->m_lost = true;
             m_lostOut += item->m_packet->GetSize();
+            ResetNextSegHints(item->m_startSeq);
         }
+        m_lostFrontier = frontier;
     }
     NS_LOG_INFO("Status after the update: " << *this);
     ConsistencyCheck();
@@ -928,35 +1031,24 @@ TcpTxBuffer::IsLost(const SequenceNumber32& seq) const
 {
     NS_LOG_FUNCTION(this << seq);
 
-    SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-    PacketList::const_iterator it;
-
     if (seq >= m_highestSack.second)
     {
         return false;
     }
 
-    // In theory, using a map and hints when inserting elements can improve
-    // performance
-    for (it = m_sentList.begin(); it != m_sentList.end(); ++it)
+    for (auto it = FindSentItem(seq); it != m_sentList.end(); ++it)
     {
-        // Search for the right iterator before calling IsLost()
-        if (beginOfCurrentPacket >= seq)
+        if ((*it)->m_lost == true)
         {
-            if ((*it)->m_lost == true)
-            {
-                NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
-                return true;
-            }
-
-            if ((*it)->m_sacked == true)
-            {
-                NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
-                return false;
-            }
+            NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
+            return true;
         }
 
-        beginOfCurrentPacket += (*it)->m_packet->GetSize();
+        if ((*it)->m_sacked == true)
+        {
+            NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
+            return false;
+        }
     }
 
     return false;
@@ -980,36 +1072,59 @@ TcpTxBuffer::NextSeg(SequenceNumber32* seq, SequenceNumber32* seqHigh, bool isRe
      *
      *     (1.c) IsLost (S2) returns true.
      */
-    PacketList::const_iterator it;
-    TcpTxItem* item;
     SequenceNumber32 seqPerRule3;
     bool isSeqPerRule3Valid = false;
-    SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-    for (it = m_sentList.begin(); it != m_sentList.end(); ++it)
+    // Skip the items which are retransmitted or sacked, up to the first
+    // candidate for the transmission
+    PacketList::const_iterator it = FindSentItem(m_nextSegFrom);
+    while (it != m_sentList.end() && ((*it)->m_retrans || (*it)->m_sacked))
     {
-        item = *it;
+        ++it;
+    }
+    m_nextSegFrom =
+        (it == m_sentList.end()) ? m_firstByteSeq.Get() + m_sentSize : (*it)->m_startSeq;
 
+    if (it != m_sentList.end())
+    {
         // Condition 1.a , 1.b , and 1.c
-        if (item->m_retrans == false && item->m_sacked == false)
+        if ((*it)->m_lost)
+        {
+            NS_LOG_INFO("IsLost, returning" << (*it)->m_startSeq);
+            *seq = (*it)->m_startSeq;
+            *seqHigh = *seq + m_segmentSize;
+            return true;
+        }
+        else if (isRecovery)
         {
-            if (item->m_lost)
+            NS_LOG_INFO("Saving for rule 3 the seq " << (*it)->m_startSeq);
+            isSeqPerRule3Valid = true;
+            seqPerRule3 = (*it)->m_startSeq;
+        }
+
+        // Look for a lost item after the candidate, skipping the items that
+        // the previous calls already examined
+        if (m_nextLostFrom > (*it)->m_startSeq)
+        {
+            it = FindSentItem(m_nextLostFrom);
+        }
+        else
+        {
+            ++it;
+        }
+        for (; it != m_sentList.end(); ++it)
+        {
+            TcpTxItem* item = *it;
+            if (item->m_retrans == false && item->m_sacked == false && item->m_lost)
             {
-                NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-                *seq = beginOfCurrentPkt;
+                NS_LOG_INFO("IsLost, returning" << item->m_startSeq);
+                m_nextLostFrom = item->m_startSeq;
+                *seq = item->m_startSeq;
                 *seqHigh = *seq + m_segmentSize;
                 return true;
             }
-            else if (seqPerRule3.GetValue() == 0 && isRecovery)
-            {
-                NS_LOG_INFO("Saving for rule 3 the seq " << beginOfCurrentPkt);
-                isSeqPerRule3Valid = true;
-                seqPerRule3 = beginOfCurrentPkt;
-            }
         }
-
-        // Nothing found, iterate
-        beginOfCurrentPkt += item->m_packet->GetSize();
+        m_nextLostFrom = m_firstByteSeq + m_sentSize;
     }
 
     /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1226,6 +1341,8 @@ TcpTxBuffer::ResetRenoSack()
     }
 
     m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_lostFrontier = m_firstByteSeq;
+    ResetNextSegHints(m_firstByteSeq);
 }
 
 void
@@ -1250,11 +1367,14 @@ TcpTxBuffer::ResetSentList()
         m_sentList.pop_back();
     }
 
+    m_sentIndex.clear();
     m_sentSize = 0;
     m_lostOut = 0;
     m_retrans = 0;
     m_sackedOut = 0;
     m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_lostFrontier = m_firstByteSeq;
+    ResetNextSegHints(m_firstByteSeq);
 }
 
 void
@@ -1265,6 +1385,7 @@ TcpTxBuffer::ResetLastSegmentSent()
     {
         TcpTxItem* item = m_sentList.back();
 
+        m_sentIndex.erase(item->m_startSeq);
         m_sentList.pop_back();
         m_sentSize -= item->m_packet->GetSize();
         if (item->m_retrans)
@@ -1272,6 +1393,7 @@ TcpTxBuffer::ResetLastSegmentSent()
             m_retrans -= item->m_packet->GetSize();
         }
         m_appList.insert(m_appList.begin(), item);
+        ClampScoreboardHints();
     }
     ConsistencyCheck();
 }
@@ -1317,6 +1439,7 @@ TcpTxBuffer::SetSentListLost(bool resetSack)
 
         (*it)->m_retrans = false;
     }
+    ResetNextSegHints(m_firstByteSeq);
 
     NS_LOG_INFO("Set sent list lost, status: " << *this);
     NS_ASSERT_MSG(m_sentSize >= m_sackedOut + m_lostOut, *this);
@@ -1350,6 +1473,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead()
     {
         m_sentList.front()->m_retrans = false;
         m_retrans -= m_sentList.front()->m_packet->GetSize();
+        ResetNextSegHints(m_firstByteSeq);
     }
     ConsistencyCheck();
 }
@@ -1379,6 +1503,7 @@ TcpTxBuffer::MarkHeadAsLost()
             m_sentList.front()->m_lost = true;
             m_lostOut += m_sentList.front()->m_packet->GetSize();
         }
+        ResetNextSegHints(m_firstByteSeq);
     }
     ConsistencyCheck();
 }
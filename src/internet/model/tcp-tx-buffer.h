@@ -27,6 +27,9 @@
 #include "ns3/tcp-tx-item.h"
 #include "ns3/traced-value.h"
 
+#include <list>
+#include <map>
+
 namespace ns3
 {
 class Packet;
@@ -105,6 +108,13 @@ class Packet;
  * of the methods. To have a look how the calculations are made, please see
  * BytesInFlight method.
  *
+ * The sent segments are also indexed by their starting sequence number, such
+ * that the SACK blocks, the retransmissions and the loss queries start from
+ * the right segment instead of walking the list from SND.UNA. The segments
+ * marked as lost, and the segments that NextSeg already skipped, are
+ * remembered as sequence numbers: each new SACK block only examines the
+ * segments that were not already examined.
+ *
  * Lost segments
  * -------------
  *
@@ -563,7 +573,7 @@ class TcpTxBuffer : public Object
                                  const SequenceNumber32& startingSeq,
                                  uint32_t numBytes,
                                  const SequenceNumber32& requestedSeq,
-                                 bool* listEdited = nullptr) const;
+                                 bool* listEdited = nullptr);
 
     /**
      * \brief Merge two TcpTxItem
@@ -601,6 +611,29 @@ class TcpTxBuffer : public Object
      */
     std::pair<TcpTxBuffer::PacketList::const_iterator, SequenceNumber32> FindHighestSacked() const;
 
+    /**
+     * \brief Find the first sent item which starts at or after a sequence
+     * \param seq the sequence
+     * \return an iterator inside m_sentList, or the end of m_sentList
+     */
+    PacketList::const_iterator FindSentItem(const SequenceNumber32& seq) const;
+
+    /**
+     * \brief Tell NextSeg that an item may have become a candidate for the
+     * transmission, because it has been marked as lost or because its retransmitted
+     * or sacked flag has been removed
+     * \param seq the starting sequence of the item
+     */
+    void ResetNextSegHints(const SequenceNumber32& seq) const;
+
+    /**
+     * \brief Bring the sequences which are remembered to speed up the scoreboard
+     * back between SND.UNA and the end of the sent list
+     */
+    void ClampScoreboardHints();
+
+    typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< Sent items by sequence
+
     PacketList m_appList;              //!< Buffer for application data
     PacketList m_sentList;             //!< Buffer for sent (but not acked) data
     uint32_t m_maxBuffer;              //!< Max number of data bytes in buffer (SND.WND)
@@ -612,6 +645,11 @@ class TcpTxBuffer : public Object
         m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
     std::pair<PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+    SentIndex m_sentIndex;                   //!< Items of m_sentList by starting sequence
+    SequenceNumber32 m_lostFrontier;         //!< The items before it are either sacked or lost
+    mutable SequenceNumber32 m_nextSegFrom;  //!< The items before it are retransmitted or sacked
+    mutable SequenceNumber32 m_nextLostFrom; //!< No item before it is lost and still to retransmit
+
     uint32_t m_lostOut{0};   //!< Number of lost bytes
     uint32_t m_sackedOut{0}; //!< Number of sacked bytes
     uint32_t m_retrans{0};   //!< Number of retransmitted bytes
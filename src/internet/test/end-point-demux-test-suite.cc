@@ -0,0 +1,279 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Ipv4EndPointDemux test: the lookups find the most specific endpoint
+ * while endpoints are allocated, connected and deallocated.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+  public:
+    Ipv4EndPointDemuxTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Check the result of a lookup.
+     * \param demux The demux.
+     * \param daddr The destination address.
+     * \param dport The destination port.
+     * \param saddr The source address.
+     * \param sport The source port.
+     * \param expected The expected endpoint, or nullptr if none.
+     */
+    void CheckLookup(Ipv4EndPointDemux& demux,
+                     Ipv4Address daddr,
+                     uint16_t dport,
+                     Ipv4Address saddr,
+                     uint16_t sport,
+                     Ipv4EndPoint* expected);
+
+    Ptr<Ipv4Interface> m_interface; //!< Incoming interface
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase()
+    : TestCase("Lookup of IPv4 endpoints")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::CheckLookup(Ipv4EndPointDemux& demux,
+                                       Ipv4Address daddr,
+                                       uint16_t dport,
+                                       Ipv4Address saddr,
+                                       uint16_t sport,
+                                       Ipv4EndPoint* expected)
+{
+    Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup(daddr, dport, saddr, sport, m_interface);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(),
+                          (expected ? 1 : 0),
+                          "Wrong number of endpoints for " << saddr << ":" << sport << " -> "
+                                                           << daddr << ":" << dport);
+    if (expected)
+    {
+        NS_TEST_EXPECT_MSG_EQ(endPoints.front(),
+                              expected,
+                              "Wrong endpoint for " << saddr << ":" << sport << " -> " << daddr
+                                                    << ":" << dport);
+    }
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun()
+{
+    m_interface = CreateObject<Ipv4Interface>();
+    m_interface->AddAddress(Ipv4InterfaceAddress("10.0.0.1", "255.255.255.0"));
+
+    Ipv4Address local("10.0.0.1");
+    Ipv4Address peer("10.0.0.2");
+    Ipv4EndPointDemux demux;
+
+    // Listening endpoints
+    Ipv4EndPoint* any = demux.Allocate(nullptr, 80);
+    NS_TEST_ASSERT_MSG_NE(any, nullptr, "Allocation failed");
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, 80), nullptr, "Duplicated endpoint allocated");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(80), true, "Port not found");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(81), false, "Unused port found");
+    CheckLookup(demux, local, 80, peer, 1000, any);
+    CheckLookup(demux, local, 81, peer, 1000, nullptr);
+
+    Ipv4EndPoint* exact = demux.Allocate(nullptr, local, 80);
+    CheckLookup(demux, local, 80, peer, 1000, exact);
+    CheckLookup(demux, Ipv4Address("10.0.0.3"), 80, peer, 1000, any);
+
+    // Connected endpoints
+    std::vector<Ipv4EndPoint*> connections;
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        connections.push_back(demux.Allocate(nullptr, local, 80, peer, 1000 + i));
+    }
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, local, 80, peer, 1000),
+                          nullptr,
+                          "Duplicated connection allocated");
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        CheckLookup(demux, local, 80, peer, 1000 + i, connections[i]);
+        NS_TEST_EXPECT_MSG_EQ(demux.SimpleLookup(local, 80, peer, 1000 + i),
+                              connections[i],
+                              "Wrong simple lookup");
+    }
+    CheckLookup(demux, local, 80, peer, 2000, exact);
+
+    // Endpoints which are connected after their allocation
+    Ipv4EndPoint* client = demux.Allocate();
+    uint16_t port = client->GetLocalPort();
+    CheckLookup(demux, local, port, peer, 80, client);
+    client->SetPeer(peer, 80);
+    CheckLookup(demux, local, port, peer, 80, client);
+    CheckLookup(demux, local, port, peer, 81, nullptr);
+    client->SetLocalAddress(local);
+    CheckLookup(demux, local, port, peer, 80, client);
+    CheckLookup(demux, Ipv4Address("10.0.0.3"), port, peer, 80, nullptr);
+
+    // Endpoints which do not receive
+    connections[0]->SetRxEnabled(false);
+    CheckLookup(demux, local, 80, peer, 1000, exact);
+    connections[0]->SetRxEnabled(true);
+
+    // Subnet-directed broadcast
+    Ipv4EndPoint* subnet = demux.Allocate(nullptr, Ipv4Address("10.0.0.0"), 67);
+    CheckLookup(demux, Ipv4Address("10.0.0.255"), 67, peer, 68, subnet);
+    CheckLookup(demux, Ipv4Address("10.0.1.255"), 67, peer, 68, nullptr);
+
+    // Deallocation
+    demux.DeAllocate(connections[1]);
+    CheckLookup(demux, local, 80, peer, 1001, exact);
+    CheckLookup(demux, local, 80, peer, 1002, connections[2]);
+    demux.DeAllocate(exact);
+    CheckLookup(demux, local, 80, peer, 1001, any);
+    demux.DeAllocate(client);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(port), false, "Deallocated port found");
+    NS_TEST_EXPECT_MSG_EQ(demux.GetAllEndPoints().size(), 101, "Wrong number of endpoints");
+
+    m_interface = nullptr;
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Ipv6EndPointDemux test: the lookups find the most specific endpoint
+ * while endpoints are allocated, connected and deallocated.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+  public:
+    Ipv6EndPointDemuxTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Check the result of a lookup.
+     * \param demux The demux.
+     * \param daddr The destination address.
+     * \param dport The destination port.
+     * \param saddr The source address.
+     * \param sport The source port.
+     * \param expected The expected endpoint, or nullptr if none.
+     */
+    void CheckLookup(Ipv6EndPointDemux& demux,
+                     Ipv6Address daddr,
+                     uint16_t dport,
+                     Ipv6Address saddr,
+                     uint16_t sport,
+                     Ipv6EndPoint* expected);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase()
+    : TestCase("Lookup of IPv6 endpoints")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::CheckLookup(Ipv6EndPointDemux& demux,
+                                       Ipv6Address daddr,
+                                       uint16_t dport,
+                                       Ipv6Address saddr,
+                                       uint16_t sport,
+                                       Ipv6EndPoint* expected)
+{
+    Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup(daddr, dport, saddr, sport, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(),
+                          (expected ? 1 : 0),
+                          "Wrong number of endpoints for " << saddr << ":" << sport << " -> "
+                                                           << daddr << ":" << dport);
+    if (expected)
+    {
+        NS_TEST_EXPECT_MSG_EQ(endPoints.front(),
+                              expected,
+                              "Wrong endpoint for " << saddr << ":" << sport << " -> " << daddr
+                                                    << ":" << dport);
+    }
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun()
+{
+    Ipv6Address local("2001:db8::1");
+    Ipv6Address peer("2001:db8::2");
+    Ipv6EndPointDemux demux;
+
+    Ipv6EndPoint* any = demux.Allocate(nullptr, 80);
+    Ipv6EndPoint* exact = demux.Allocate(nullptr, local, 80);
+    CheckLookup(demux, local, 80, peer, 1000, exact);
+    CheckLookup(demux, Ipv6Address("2001:db8::3"), 80, peer, 1000, any);
+
+    std::vector<Ipv6EndPoint*> connections;
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        connections.push_back(demux.Allocate(nullptr, local, 80, peer, 1000 + i));
+    }
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        CheckLookup(demux, local, 80, peer, 1000 + i, connections[i]);
+    }
+    CheckLookup(demux, local, 80, peer, 2000, exact);
+
+    Ipv6EndPoint* client = demux.Allocate();
+    uint16_t port = client->GetLocalPort();
+    client->SetPeer(peer, 80);
+    CheckLookup(demux, local, port, peer, 80, client);
+    CheckLookup(demux, local, port, peer, 81, nullptr);
+    client->SetLocalAddress(local);
+    CheckLookup(demux, local, port, peer, 80, client);
+    NS_TEST_EXPECT_MSG_EQ(demux.SimpleLookup(local, port, peer, 80), client, "Wrong lookup");
+
+    demux.DeAllocate(connections[1]);
+    CheckLookup(demux, local, 80, peer, 1001, exact);
+    demux.DeAllocate(exact);
+    CheckLookup(demux, local, 80, peer, 1001, any);
+    demux.DeAllocate(client);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(port), false, "Deallocated port found");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+  public:
+    EndPointDemuxTestSuite();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite()
+    : TestSuite("end-point-demux", UNIT)
+{
+    AddTestCase(new Ipv4EndPointDemuxTestCase(), TestCase::QUICK);
+    AddTestCase(new Ipv6EndPointDemuxTestCase(), TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -41,6 +41,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <sstream>
+#include <string>
 #include <vector>
 
 using namespace ns3;
@@ -1313,6 +1315,189 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting test of the computation of the routes on several
+ * threads, and of their incremental recomputation.
+ *
+ * The routing tables computed on several threads, and the tables recomputed
+ * incrementally after interfaces are set down or up, must be the same as the
+ * tables computed on a single thread from scratch.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingRecomputeTestCase();
+
+  private:
+    void DoSetup() override;
+    void DoRun() override;
+
+    /**
+     * \brief Get the routing tables of the nodes.
+     * \returns The routes of each node, in the order of the routing tables.
+     */
+    std::vector<std::string> GetRoutingTables() const;
+
+    /**
+     * \brief Recompute the routing tables incrementally and from scratch, and
+     * check that they are the same.
+     * \param step Description of the last change of the topology.
+     */
+    void CheckRecompute(std::string step);
+
+    NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase()
+    : TestCase("Global routing computed on several threads and recomputed incrementally")
+{
+}
+
+// Topology:
+//
+//       n1
+//      /  \    LAN
+//    n0 -- n2 ==+== n3 -- n4 -- n6
+//     \         |          |
+//      \        n5         |
+//       +-------------------+
+//
+// n2, n3 and n5 are on the LAN 10.1.10.0/24, n6 is a stub host, and the
+// other links are point-to-point links.
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoSetup()
+{
+    m_nodes.Create(7);
+
+    InternetStackHelper internet;
+    Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+    internet.SetRoutingHelper(ipv4RoutingHelper);
+    internet.Install(m_nodes);
+
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper ipv4;
+    std::vector<std::pair<uint32_t, uint32_t>> links =
+        {{0, 1}, {1, 2}, {0, 2}, {3, 4}, {0, 4}, {4, 6}};
+    uint32_t subnet = 1;
+    for (const auto& link : links)
+    {
+        Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+        NetDeviceContainer net = simpleHelper.Install(m_nodes.Get(link.first), channel);
+        net.Add(simpleHelper.Install(m_nodes.Get(link.second), channel));
+        std::string base = "10.1." + std::to_string(subnet++) + ".0";
+        ipv4.SetBase(base.c_str(), "255.255.255.252");
+        ipv4.Assign(net);
+    }
+
+    SimpleNetDeviceHelper lanHelper;
+    Ptr<SimpleChannel> lan = CreateObject<SimpleChannel>();
+    NetDeviceContainer lanNet = lanHelper.Install(m_nodes.Get(2), lan);
+    lanNet.Add(lanHelper.Install(m_nodes.Get(3), lan));
+    lanNet.Add(lanHelper.Install(m_nodes.Get(5), lan));
+    ipv4.SetBase("10.1.10.0", "255.255.255.0");
+    ipv4.Assign(lanNet);
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutingTables() const
+{
+    std::vector<std::string> tables;
+    for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+    {
+        Ptr<Ipv4RoutingProtocol> routing = m_nodes.Get(i)->GetObject<Ipv4>()->GetRoutingProtocol();
+        Ptr<Ipv4GlobalRouting> globalRouting = routing->GetObject<Ipv4GlobalRouting>();
+        std::ostringstream table;
+        for (uint32_t j = 0; j < globalRouting->GetNRoutes(); j++)
+        {
+            table << *globalRouting->GetRoute(j) << "\n";
+        }
+        tables.push_back(table.str());
+    }
+    return tables;
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::CheckRecompute(std::string step)
+{
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(true));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    std::vector<std::string> incremental = GetRoutingTables();
+
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(false));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    std::vector<std::string> full = GetRoutingTables();
+
+    for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(incremental[i],
+                              full[i],
+                              "Wrong incremental routes of node " << i << " " << step);
+    }
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun()
+{
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    std::vector<std::string> single = GetRoutingTables();
+    NS_TEST_ASSERT_MSG_NE(single[0], "", "No routes computed");
+
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(3));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    std::vector<std::string> threads = GetRoutingTables();
+    for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(threads[i], single[i], "Wrong routes of node " << i);
+    }
+
+    // The first recomputation does not change anything
+    CheckRecompute("without change");
+
+    // Interfaces of the node, in the order of the devices (the loopback is 0)
+    Ptr<Ipv4> ipv4n0 = m_nodes.Get(0)->GetObject<Ipv4>();
+    Ptr<Ipv4> ipv4n2 = m_nodes.Get(2)->GetObject<Ipv4>();
+    Ptr<Ipv4> ipv4n4 = m_nodes.Get(4)->GetObject<Ipv4>();
+    Ptr<Ipv4> ipv4n5 = m_nodes.Get(5)->GetObject<Ipv4>();
+
+    // Chord n0-n2 down
+    ipv4n0->SetDown(2);
+    ipv4n2->SetDown(2);
+    CheckRecompute("after the chord went down");
+
+    // n4-n6 down: n6 is isolated
+    ipv4n4->SetDown(3);
+    CheckRecompute("after the stub link went down");
+
+    // n5 leaves the LAN
+    ipv4n5->SetDown(1);
+    CheckRecompute("after n5 left the LAN");
+
+    // n0-n4 down: the network is split in two
+    ipv4n0->SetDown(3);
+    CheckRecompute("after the network was split");
+
+    // Everything up again
+    ipv4n0->SetUp(2);
+    ipv4n2->SetUp(2);
+    ipv4n4->SetUp(3);
+    ipv4n5->SetUp(1);
+    ipv4n0->SetUp(3);
+    CheckRecompute("after all interfaces went up");
+
+    std::vector<std::string> tables = GetRoutingTables();
+    for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(tables[i], single[i], "Wrong final routes of node " << i);
+    }
+
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1335,6 +1520,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
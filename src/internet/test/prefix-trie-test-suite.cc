@@ -0,0 +1,223 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief PrefixTrie test: the matches of random addresses are compared to a
+ * scan of all the routes, while routes are inserted and removed.
+ */
+class PrefixTrieRandomTest : public TestCase
+{
+  public:
+    PrefixTrieRandomTest();
+
+  private:
+    void DoRun() override;
+
+    /** Route of the reference table. */
+    struct Route
+    {
+        Ipv4Address dest; //!< Destination
+        Ipv4Mask mask;    //!< Mask
+        int id;           //!< Route identifier
+    };
+
+    /**
+     * Check the matches of an address.
+     * \param trie The trie.
+     * \param routes The reference table.
+     * \param address The address.
+     */
+    void CheckMatch(const PrefixTrie<4, int>& trie,
+                    const std::list<Route>& routes,
+                    Ipv4Address address);
+};
+
+PrefixTrieRandomTest::PrefixTrieRandomTest()
+    : TestCase("Match random addresses against random IPv4 routes")
+{
+}
+
+void
+PrefixTrieRandomTest::CheckMatch(const PrefixTrie<4, int>& trie,
+                                 const std::list<Route>& routes,
+                                 Ipv4Address address)
+{
+    typedef PrefixTrie<4, int> Trie;
+    std::vector<int> expected;
+    for (const auto& route : routes)
+    {
+        if (route.mask.IsMatch(address, route.dest))
+        {
+            expected.push_back(route.id);
+        }
+    }
+    std::vector<int> matches;
+    trie.Match(Trie::GetBytes(address), matches);
+    NS_TEST_ASSERT_MSG_EQ(matches.size(), expected.size(), "Wrong matches of " << address);
+    for (std::size_t i = 0; i < matches.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(matches[i], expected[i], "Wrong match order for " << address);
+    }
+}
+
+void
+PrefixTrieRandomTest::DoRun()
+{
+    typedef PrefixTrie<4, int> Trie;
+    Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable>();
+    // Few distinct prefixes, such that routes share their prefixes and nodes
+    auto randomAddress = [rand]() {
+        return Ipv4Address((rand->GetInteger(0, 3) << 30) | (rand->GetInteger(0, 15) << 20) |
+                           (rand->GetInteger(0, 3) << 8) | rand->GetInteger(0, 3));
+    };
+
+    Trie trie;
+    std::list<Route> routes;
+    int id = 0;
+    for (uint32_t step = 0; step < 2000; step++)
+    {
+        if (routes.empty() || rand->GetValue() < 0.6)
+        {
+            Route route;
+            route.dest = randomAddress();
+            if (rand->GetValue() < 0.05)
+            {
+                // non-contiguous mask
+                route.mask = Ipv4Mask(0xff00ff00);
+            }
+            else
+            {
+                route.mask = Ipv4Mask(("/" + std::to_string(rand->GetInteger(0, 32))).c_str());
+            }
+            route.id = id++;
+            routes.push_back(route);
+            trie.Insert(Trie::GetBytes(route.dest), Trie::GetBytes(route.mask), route.id);
+        }
+        else
+        {
+            auto it = routes.begin();
+            std::advance(it, rand->GetInteger(0, routes.size() - 1));
+            bool removed = trie.Remove(Trie::GetBytes(it->dest), Trie::GetBytes(it->mask), it->id);
+            NS_TEST_ASSERT_MSG_EQ(removed, true, "Route not found");
+            routes.erase(it);
+        }
+        NS_TEST_ASSERT_MSG_EQ(trie.GetSize(), routes.size(), "Wrong number of routes");
+        CheckMatch(trie, routes, randomAddress());
+    }
+
+    // Routes which are not in the trie
+    bool removed = trie.Remove(Trie::GetBytes(Ipv4Address("10.0.0.0")),
+                               Trie::GetBytes(Ipv4Mask("255.0.0.0")),
+                               id);
+    NS_TEST_EXPECT_MSG_EQ(removed, false, "Removed a missing route");
+
+    while (!routes.empty())
+    {
+        const Route& route = routes.front();
+        std::vector<int> ids;
+        trie.Get(Trie::GetBytes(route.dest), Trie::GetBytes(route.mask), ids);
+        NS_TEST_ASSERT_MSG_EQ((std::find(ids.begin(), ids.end(), route.id) != ids.end()),
+                              true,
+                              "Route not found by prefix");
+        trie.Remove(Trie::GetBytes(route.dest), Trie::GetBytes(route.mask), route.id);
+        routes.pop_front();
+        CheckMatch(trie, routes, randomAddress());
+    }
+    NS_TEST_EXPECT_MSG_EQ(trie.GetSize(), 0, "Routes left in the trie");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief PrefixTrie test with IPv6 routes.
+ */
+class PrefixTrieIpv6Test : public TestCase
+{
+  public:
+    PrefixTrieIpv6Test();
+
+  private:
+    void DoRun() override;
+};
+
+PrefixTrieIpv6Test::PrefixTrieIpv6Test()
+    : TestCase("Match IPv6 addresses")
+{
+}
+
+void
+PrefixTrieIpv6Test::DoRun()
+{
+    typedef PrefixTrie<16, int> Trie;
+    Trie trie;
+    trie.Insert(Trie::GetBytes(Ipv6Address("::")), Trie::GetBytes(Ipv6Prefix::GetZero()), 0);
+    trie.Insert(Trie::GetBytes(Ipv6Address("2001:db8::")), Trie::GetBytes(Ipv6Prefix(32)), 1);
+    trie.Insert(Trie::GetBytes(Ipv6Address("2001:db8:1::")), Trie::GetBytes(Ipv6Prefix(48)), 2);
+    trie.Insert(Trie::GetBytes(Ipv6Address("2001:db8:1::1")), Trie::GetBytes(Ipv6Prefix(128)), 3);
+    // equal-cost route
+    trie.Insert(Trie::GetBytes(Ipv6Address("2001:db8::")), Trie::GetBytes(Ipv6Prefix(32)), 4);
+
+    std::vector<int> matches;
+    trie.Match(Trie::GetBytes(Ipv6Address("2001:db8:1::1")), matches);
+    NS_TEST_EXPECT_MSG_EQ((matches == std::vector<int>{0, 1, 2, 3, 4}), true, "Wrong matches");
+
+    matches.clear();
+    trie.Match(Trie::GetBytes(Ipv6Address("2001:db8:2::1")), matches);
+    NS_TEST_EXPECT_MSG_EQ((matches == std::vector<int>{0, 1, 4}), true, "Wrong matches");
+
+    matches.clear();
+    trie.Remove(Trie::GetBytes(Ipv6Address("2001:db8::")), Trie::GetBytes(Ipv6Prefix(32)), 1);
+    trie.Match(Trie::GetBytes(Ipv6Address("2001:db8:1::2")), matches);
+    NS_TEST_EXPECT_MSG_EQ((matches == std::vector<int>{0, 2, 4}), true, "Wrong matches");
+
+    matches.clear();
+    trie.Match(Trie::GetBytes(Ipv6Address("fe80::1")), matches);
+    NS_TEST_EXPECT_MSG_EQ((matches == std::vector<int>{0}), true, "Wrong matches");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+  public:
+    PrefixTrieTestSuite();
+};
+
+PrefixTrieTestSuite::PrefixTrieTestSuite()
+    : TestSuite("prefix-trie", UNIT)
+{
+    AddTestCase(new PrefixTrieRandomTest(), TestCase::QUICK);
+    AddTestCase(new PrefixTrieIpv6Test(), TestCase::QUICK);
+}
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
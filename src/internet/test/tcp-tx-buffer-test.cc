@@ -16,11 +16,13 @@
 
 #include "ns3/log.h"
 #include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
 #include "ns3/tcp-tx-buffer.h"
 #include "ns3/test.h"
 
 #include <limits>
+#include <vector>
 
 using namespace ns3;
 
@@ -430,6 +432,411 @@ TcpTxBufferTestCase::DoTeardown()
 {
 }
 
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief TcpTxBuffer scoreboard test: random sequences of transmissions,
+ * SACKs, ACKs, retransmissions and RTOs are applied to a TcpTxBuffer and to a
+ * reference scoreboard, which walks all the segments for every query. The
+ * results of NextSeg, IsLost and of the lost count maintained by
+ * UpdateLostCount are compared after each step.
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+  public:
+    /** \brief Constructor */
+    TcpTxBufferScoreboardTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** \brief A segment of the reference scoreboard */
+    struct Segment
+    {
+        bool sacked{false};  //!< The segment is sacked
+        bool lost{false};    //!< The segment is lost
+        bool retrans{false}; //!< The segment is retransmitted
+    };
+
+    /**
+     * \brief Get the first sequence number of a segment of the reference
+     * \param index the index of the segment
+     * \returns the first sequence number of the segment
+     */
+    SequenceNumber32 SegmentStart(uint32_t index) const;
+    /**
+     * \brief Reference NextSeg, as defined by RFC 6675
+     * \param seq the first sequence number to send
+     * \param isRecovery whether the sender is in recovery
+     * \returns true if a segment can be sent
+     */
+    bool RefNextSeg(SequenceNumber32* seq, bool isRecovery) const;
+    /**
+     * \brief Reference IsLost
+     * \param seq the sequence number
+     * \returns true if the first segment starting at or after seq is lost
+     */
+    bool RefIsLost(const SequenceNumber32& seq) const;
+    /** \brief Reference UpdateLostCount, walking down from the highest sack */
+    void RefUpdateLostCount();
+    /**
+     * \brief Get the bytes of the reference segments matching a predicate
+     * \param flag the flag of the segments to count
+     * \returns the number of bytes
+     */
+    uint32_t RefBytes(bool Segment::*flag) const;
+
+    /** \brief Send the segment returned by NextSeg, if any */
+    void Transmit();
+    /** \brief Receive up to three random SACK blocks */
+    void Sack();
+    /** \brief Receive a cumulative ACK for a few segments */
+    void Ack();
+    /** \brief Compare the buffer with the reference */
+    void Check();
+
+    /**
+     * \brief Callback to provide a value of receiver window
+     * \returns the receiver window size
+     */
+    uint32_t GetRWnd() const;
+
+    static const uint32_t SEGMENT_SIZE = 100; //!< Segment size
+    static const uint32_t DUP_THRESH = 3;     //!< Duplicate ACK threshold
+    static const uint32_t MAX_SEGMENTS = 200; //!< Maximum number of segments in flight
+
+    Ptr<TcpTxBuffer> m_txBuf;            //!< The buffer under test
+    Ptr<UniformRandomVariable> m_random; //!< Random variable
+    std::vector<Segment> m_segments;     //!< Reference sent segments, from SND.UNA
+    SequenceNumber32 m_head;             //!< Reference SND.UNA
+    uint32_t m_unsent;                   //!< Reference number of unsent segments
+    int32_t m_highestSack;               //!< Index of the highest sacked segment, or -1
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase()
+    : TestCase("TcpTxBuffer scoreboard against a linear reference"),
+      m_head(1),
+      m_unsent(0),
+      m_highestSack(-1)
+{
+}
+
+uint32_t
+TcpTxBufferScoreboardTestCase::GetRWnd() const
+{
+    return std::numeric_limits<uint32_t>::max();
+}
+
+SequenceNumber32
+TcpTxBufferScoreboardTestCase::SegmentStart(uint32_t index) const
+{
+    return m_head + index * SEGMENT_SIZE;
+}
+
+bool
+TcpTxBufferScoreboardTestCase::RefNextSeg(SequenceNumber32* seq, bool isRecovery) const
+{
+    int32_t rule3 = -1;
+    for (uint32_t i = 0; i < m_segments.size(); ++i)
+    {
+        const Segment& segment = m_segments[i];
+        if (!segment.retrans && !segment.sacked)
+        {
+            if (segment.lost)
+            {
+                *seq = SegmentStart(i);
+                return true;
+            }
+            else if (rule3 < 0 && isRecovery)
+            {
+                rule3 = static_cast<int32_t>(i);
+            }
+        }
+    }
+    if (m_unsent > 0)
+    {
+        *seq = SegmentStart(m_segments.size());
+        return true;
+    }
+    if (rule3 >= 0)
+    {
+        *seq = SegmentStart(rule3);
+        return true;
+    }
+    return false;
+}
+
+bool
+TcpTxBufferScoreboardTestCase::RefIsLost(const SequenceNumber32& seq) const
+{
+    if (m_highestSack < 0 || seq >= SegmentStart(m_highestSack))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < m_segments.size(); ++i)
+    {
+        if (SegmentStart(i) >= seq)
+        {
+            if (m_segments[i].lost)
+            {
+                return true;
+            }
+            if (m_segments[i].sacked)
+            {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+void
+TcpTxBufferScoreboardTestCase::RefUpdateLostCount()
+{
+    uint32_t sacked = 0;
+    for (int32_t i = m_highestSack; i > 0; --i)
+    {
+        Segment& segment = m_segments[i];
+        if (segment.sacked)
+        {
+            sacked++;
+        }
+        if (sacked >= DUP_THRESH && !segment.sacked)
+        {
+            segment.lost = true;
+        }
+    }
+    if (sacked >= DUP_THRESH)
+    {
+        m_segments.front().lost = true;
+    }
+}
+
+uint32_t
+TcpTxBufferScoreboardTestCase::RefBytes(bool Segment::*flag) const
+{
+    uint32_t bytes = 0;
+    for (const auto& segment : m_segments)
+    {
+        if (segment.*flag)
+        {
+            bytes += SEGMENT_SIZE;
+        }
+    }
+    return bytes;
+}
+
+void
+TcpTxBufferScoreboardTestCase::Transmit()
+{
+    SequenceNumber32 seq;
+    SequenceNumber32 seqHigh;
+    bool isRecovery = m_random->GetInteger(0, 1) == 1;
+    if (!m_txBuf->NextSeg(&seq, &seqHigh, isRecovery))
+    {
+        return;
+    }
+    uint32_t index = (seq - m_head) / SEGMENT_SIZE;
+    if (index == m_segments.size())
+    {
+        if (m_segments.size() >= MAX_SEGMENTS)
+        {
+            return;
+        }
+        m_segments.emplace_back();
+        m_unsent--;
+    }
+    else
+    {
+        m_segments[index].retrans = true;
+    }
+    m_txBuf->CopyFromSequence(SEGMENT_SIZE, seq);
+}
+
+void
+TcpTxBufferScoreboardTestCase::Sack()
+{
+    if (m_segments.size() < 2)
+    {
+        return;
+    }
+    TcpOptionSack::SackList list;
+    uint32_t nBlocks = m_random->GetInteger(1, 3);
+    for (uint32_t b = 0; b < nBlocks; ++b)
+    {
+        // The head is never sacked: it would have been acknowledged
+        uint32_t first = m_random->GetInteger(1, m_segments.size() - 1);
+        uint32_t last = std::min<uint32_t>(first + m_random->GetInteger(1, 3), m_segments.size());
+        list.emplace_back(SegmentStart(first), SegmentStart(last));
+    }
+
+    uint32_t newlySacked = 0;
+    for (const auto& block : list)
+    {
+        for (uint32_t i = 0; i < m_segments.size(); ++i)
+        {
+            Segment& segment = m_segments[i];
+            if (SegmentStart(i) >= block.first && SegmentStart(i + 1) <= block.second &&
+                !segment.sacked)
+            {
+                segment.lost = false;
+                segment.sacked = true;
+                newlySacked++;
+                // Same rule as TcpTxBuffer::Update, which compares the start
+                // of the highest sacked segment with the end of this one
+                if (m_highestSack < 0 || SegmentStart(m_highestSack) <= SegmentStart(i + 1))
+                {
+                    m_highestSack = static_cast<int32_t>(i);
+                }
+            }
+        }
+    }
+    if (newlySacked > 0)
+    {
+        RefUpdateLostCount();
+    }
+    m_txBuf->Update(list);
+}
+
+void
+TcpTxBufferScoreboardTestCase::Ack()
+{
+    if (m_segments.empty())
+    {
+        return;
+    }
+    // The new head cannot be sacked
+    uint32_t acked = m_random->GetInteger(1, std::min<uint32_t>(m_segments.size(), 3));
+    while (acked < m_segments.size() && m_segments[acked].sacked)
+    {
+        acked++;
+    }
+    SequenceNumber32 ack = SegmentStart(acked);
+    m_segments.erase(m_segments.begin(), m_segments.begin() + acked);
+    m_head = ack;
+    m_highestSack -= static_cast<int32_t>(acked);
+    if (m_highestSack <= 0)
+    {
+        m_highestSack = -1;
+    }
+    m_txBuf->DiscardUpTo(ack);
+}
+
+void
+TcpTxBufferScoreboardTestCase::Check()
+{
+    for (bool isRecovery : {false, true})
+    {
+        SequenceNumber32 seq;
+        SequenceNumber32 seqHigh;
+        SequenceNumber32 refSeq;
+        bool found = m_txBuf->NextSeg(&seq, &seqHigh, isRecovery);
+        NS_TEST_ASSERT_MSG_EQ(found, RefNextSeg(&refSeq, isRecovery), "NextSeg result");
+        if (found)
+        {
+            NS_TEST_ASSERT_MSG_EQ(seq, refSeq, "NextSeg sequence");
+            NS_TEST_ASSERT_MSG_EQ(seqHigh, refSeq + SEGMENT_SIZE, "NextSeg high sequence");
+        }
+    }
+    for (uint32_t i = 0; i <= m_segments.size(); ++i)
+    {
+        SequenceNumber32 seq = SegmentStart(i);
+        NS_TEST_ASSERT_MSG_EQ(m_txBuf->IsLost(seq), RefIsLost(seq), "IsLost(" << seq << ")");
+        seq += static_cast<uint32_t>(m_random->GetInteger(1, SEGMENT_SIZE - 1));
+        NS_TEST_ASSERT_MSG_EQ(m_txBuf->IsLost(seq), RefIsLost(seq), "IsLost(" << seq << ")");
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_txBuf->GetLost(), RefBytes(&Segment::lost), "Lost bytes");
+    NS_TEST_ASSERT_MSG_EQ(m_txBuf->GetSacked(), RefBytes(&Segment::sacked), "Sacked bytes");
+    NS_TEST_ASSERT_MSG_EQ(m_txBuf->GetRetransmitsCount(),
+                          RefBytes(&Segment::retrans),
+                          "Retransmitted bytes");
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun()
+{
+    m_random = CreateObject<UniformRandomVariable>();
+    m_random->SetStream(1);
+    m_txBuf = CreateObject<TcpTxBuffer>();
+    m_txBuf->SetRWndCallback(MakeCallback(&TcpTxBufferScoreboardTestCase::GetRWnd, this));
+    m_txBuf->SetHeadSequence(m_head);
+    m_txBuf->SetSegmentSize(SEGMENT_SIZE);
+    m_txBuf->SetDupAckThresh(DUP_THRESH);
+
+    m_txBuf->SetMaxBufferSize(1000 * SEGMENT_SIZE);
+
+    for (uint32_t step = 0; step < 20000; ++step)
+    {
+        uint32_t action = m_random->GetInteger(0, 99);
+        if (action < 3)
+        {
+            uint32_t segments = m_random->GetInteger(1, 100);
+            if (m_txBuf->Add(Create<Packet>(segments * SEGMENT_SIZE)))
+            {
+                m_unsent += segments;
+            }
+        }
+        else if (action < 43)
+        {
+            for (uint32_t i = m_random->GetInteger(1, 4); i > 0; --i)
+            {
+                Transmit();
+            }
+        }
+        else if (action < 73)
+        {
+            Sack();
+        }
+        else if (action < 83)
+        {
+            Ack();
+        }
+        else if (action < 85)
+        {
+            // RTO, with or without discarding the SACK information
+            bool resetSack = m_random->GetInteger(0, 1) == 1;
+            for (auto& segment : m_segments)
+            {
+                segment.lost = resetSack || !segment.sacked;
+                segment.sacked = segment.sacked && !resetSack;
+                segment.retrans = false;
+            }
+            if (resetSack)
+            {
+                m_highestSack = -1;
+            }
+            m_txBuf->SetSentListLost(resetSack);
+        }
+        else if (action < 90)
+        {
+            // NewReno partial ACK
+            if (!m_segments.empty())
+            {
+                m_segments.front() = {false, true, false};
+            }
+            m_txBuf->MarkHeadAsLost();
+        }
+        else if (action < 95)
+        {
+            if (!m_segments.empty())
+            {
+                m_segments.front().retrans = false;
+            }
+            m_txBuf->DeleteRetransmittedFlagFromHead();
+        }
+        else if (action < 96)
+        {
+            m_unsent += m_segments.size();
+            m_segments.clear();
+            m_highestSack = -1;
+            m_txBuf->ResetSentList();
+        }
+        Check();
+    }
+    m_txBuf = nullptr;
+}
+
 /**
  * \ingroup internet-test
  *
@@ -442,6 +849,7 @@ class TcpTxBufferTestSuite : public TestSuite
         : TestSuite("tcp-tx-buffer", UNIT)
     {
         AddTestCase(new TcpTxBufferTestCase, TestCase::QUICK);
+        AddTestCase(new TcpTxBufferScoreboardTestCase, TestCase::QUICK);
     }
 };
 
@@ -197,9 +197,13 @@ LteInterference::ConditionallyEvaluateChunk()
         NS_LOG_LOGIC(this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals
                           << " noise = " << *m_noise);
 
-        SpectrumValue interf = (*m_allSignals) - (*m_rxSignal) + (*m_noise);
+        // in-place operations, to avoid the temporaries of the binary operators
+        SpectrumValue interf = *m_allSignals;
+        interf -= *m_rxSignal;
+        interf += *m_noise;
 
-        SpectrumValue sinr = (*m_rxSignal) / interf;
+        SpectrumValue sinr = *m_rxSignal;
+        sinr /= interf;
         Time duration = Now() - m_lastChangeTime;
         for (std::list<Ptr<LteChunkProcessor>>::const_iterator it =
                  m_sinrChunkProcessorList.begin();
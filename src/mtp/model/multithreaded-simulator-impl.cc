@@ -0,0 +1,913 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3
+{
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::LogicalProcess* MultithreadedSimulatorImpl::m_currentLp =
+    nullptr;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Mtp")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("ThreadCount",
+                          "The number of threads executing the logical processes, "
+                          "including the main thread. 0 uses the hardware concurrency.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_threadCount),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("LookAhead",
+                          "Upper bound on the lookahead. The lookahead actually used is "
+                          "further bounded by the delay of the point-to-point channels "
+                          "between the logical processes.",
+                          TimeValue(Time::Max()),
+                          MakeTimeAccessor(&MultithreadedSimulatorImpl::m_lookAhead),
+                          MakeTimeChecker(Time(1)));
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = false;
+    m_currentTs = 0;
+    m_uid = EventId::UID::VALID;
+    m_running = false;
+    m_inWindow = false;
+    m_windowEnd = 0;
+    m_windowCount = 0;
+    m_lookAhead = Time::Max();
+    m_threadCount = 0;
+    m_nextActiveLp = 0;
+    m_generation = 0;
+    m_busyWorkers = 0;
+    m_shutdown = false;
+    m_mainThreadId = std::this_thread::get_id();
+
+    // The public logical process; its scheduler is set by SetScheduler()
+    auto lp = new LogicalProcess;
+    lp->uid = EventId::UID::VALID;
+    lp->currentUid = EventId::UID::INVALID;
+    lp->currentTs = 0;
+    lp->currentContext = Simulator::NO_CONTEXT;
+    lp->eventCount = 0;
+    lp->unscheduledEvents = 0;
+    lp->inRun = false;
+    m_lps.push_back(lp);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    StopWorkers();
+    MergeOutboxes();
+
+    for (auto lp : m_lps)
+    {
+        while (lp->events && !lp->events->IsEmpty())
+        {
+            Scheduler::Event next = lp->events->RemoveNext();
+            next.impl->Unref();
+        }
+        lp->events = nullptr;
+        delete lp;
+    }
+    m_lps.clear();
+    m_contextLp.clear();
+    m_contextGroup.clear();
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    NS_ABORT_MSG_IF(m_inWindow, "Cannot change the scheduler while a window is executing");
+    m_schedulerFactory = schedulerFactory;
+
+    for (auto lp : m_lps)
+    {
+        Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+        if (lp->events)
+        {
+            while (!lp->events->IsEmpty())
+            {
+                Scheduler::Event next = lp->events->RemoveNext();
+                scheduler->Insert(next);
+            }
+        }
+        lp->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+MultithreadedSimulatorImpl::LogicalProcess*
+MultithreadedSimulatorImpl::GetCurrentLp() const
+{
+    if (m_currentLp != nullptr)
+    {
+        return m_currentLp;
+    }
+    if (m_mainThreadId == std::this_thread::get_id())
+    {
+        return m_lps.front();
+    }
+    return nullptr;
+}
+
+MultithreadedSimulatorImpl::LogicalProcess*
+MultithreadedSimulatorImpl::FindLp(uint32_t context) const
+{
+    if (context == Simulator::NO_CONTEXT)
+    {
+        return m_lps.front();
+    }
+    auto it = m_contextLp.find(context);
+    if (it == m_contextLp.end())
+    {
+        it = m_contextLp.find(GetGroup(context));
+        if (it == m_contextLp.end())
+        {
+            return nullptr;
+        }
+    }
+    return it->second;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetGroup(uint32_t context) const
+{
+    auto it = m_contextGroup.find(context);
+    return it == m_contextGroup.end() ? context : it->second;
+}
+
+MultithreadedSimulatorImpl::LogicalProcess*
+MultithreadedSimulatorImpl::GetOrCreateLp(uint32_t context)
+{
+    NS_ASSERT(!m_inWindow);
+    LogicalProcess* lp = FindLp(context);
+    if (lp != nullptr)
+    {
+        if (context != Simulator::NO_CONTEXT)
+        {
+            m_contextLp.emplace(context, lp);
+        }
+        return lp;
+    }
+    lp = new LogicalProcess;
+    lp->events = m_schedulerFactory.Create<Scheduler>();
+    lp->uid = EventId::UID::VALID;
+    lp->currentUid = EventId::UID::INVALID;
+    // A new logical process starts at the current global time, so that
+    // IsExpired() and Now() behave as in the other logical processes.
+    lp->currentTs = m_currentTs;
+    lp->currentContext = context;
+    lp->eventCount = 0;
+    lp->unscheduledEvents = 0;
+    lp->inRun = m_running;
+    m_contextLp[context] = lp;
+    m_contextLp[GetGroup(context)] = lp;
+    m_lps.push_back(lp);
+    return lp;
+}
+
+void
+MultithreadedSimulatorImpl::PartitionNodes()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!m_inWindow);
+    // Union-find of the node ids, each set being rooted at its smallest id
+    std::vector<uint32_t> parent(NodeList::GetNNodes());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](uint32_t id) {
+        while (parent[id] != id)
+        {
+            parent[id] = parent[parent[id]];
+            id = parent[id];
+        }
+        return id;
+    };
+    for (auto it = ChannelList::Begin(); it != ChannelList::End(); ++it)
+    {
+        Ptr<Channel> channel = *it;
+        if (DynamicCast<PointToPointChannel>(channel))
+        {
+            continue;
+        }
+        uint32_t root = std::numeric_limits<uint32_t>::max();
+        for (std::size_t i = 0; i < channel->GetNDevices(); ++i)
+        {
+            Ptr<Node> node = channel->GetDevice(i)->GetNode();
+            if (!node)
+            {
+                continue;
+            }
+            uint32_t other = find(node->GetId());
+            if (root == std::numeric_limits<uint32_t>::max())
+            {
+                root = other;
+            }
+            else if (other != root)
+            {
+                parent[std::max(root, other)] = std::min(root, other);
+                root = std::min(root, other);
+            }
+        }
+    }
+    m_contextGroup.clear();
+    for (uint32_t id = 0; id < parent.size(); ++id)
+    {
+        if (find(id) != id)
+        {
+            m_contextGroup[id] = find(id);
+        }
+    }
+
+    // Merge the logical processes of the nodes of each group, in context order
+    std::vector<uint32_t> contexts;
+    for (const auto& entry : m_contextLp)
+    {
+        contexts.push_back(entry.first);
+    }
+    std::sort(contexts.begin(), contexts.end());
+    for (auto context : contexts)
+    {
+        LogicalProcess* lp = m_contextLp[context];
+        auto group = m_contextLp.find(GetGroup(context));
+        if (group == m_contextLp.end())
+        {
+            m_contextLp[GetGroup(context)] = lp;
+        }
+        else if (group->second != lp)
+        {
+            MergeLps(group->second, lp);
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::MergeLps(LogicalProcess* dst, LogicalProcess* src)
+{
+    NS_LOG_FUNCTION(this << dst << src);
+    if (src->inRun && !dst->inRun)
+    {
+        std::swap(dst, src);
+    }
+    if (src->inRun)
+    {
+        NS_FATAL_ERROR("Nodes whose events were executed by different logical processes "
+                       "share a channel: attach the nodes to their channels before the "
+                       "first Simulator::Run()");
+    }
+    NS_ASSERT(src->outbox.empty());
+    // The uids of the events inserted outside Run() are unique among the LPs
+    while (!src->events->IsEmpty())
+    {
+        dst->events->Insert(src->events->RemoveNext());
+    }
+    if (!dst->inRun)
+    {
+        dst->currentTs = std::min(dst->currentTs, src->currentTs);
+        dst->currentUid = std::min(dst->currentUid, src->currentUid);
+    }
+    dst->eventCount += src->eventCount;
+    dst->unscheduledEvents += src->unscheduledEvents;
+    for (auto& entry : m_contextLp)
+    {
+        if (entry.second == src)
+        {
+            entry.second = dst;
+        }
+    }
+    m_lps.erase(std::find(m_lps.begin(), m_lps.end(), src));
+    delete src;
+}
+
+EventId
+MultithreadedSimulatorImpl::Insert(LogicalProcess* lp,
+                                   uint64_t ts,
+                                   uint32_t context,
+                                   EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    // Outside Run(), the uids are unique among the LPs, which may be merged
+    ev.key.m_uid = m_running ? lp->uid++ : m_uid++;
+    lp->unscheduledEvents++;
+    lp->events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent(LogicalProcess* lp)
+{
+    Scheduler::Event next = lp->events->RemoveNext();
+
+    PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= lp->currentTs);
+    lp->unscheduledEvents--;
+    lp->eventCount++;
+
+    lp->currentTs = next.key.m_ts;
+    lp->currentContext = next.key.m_context;
+    lp->currentUid = next.key.m_uid;
+    next.impl->Invoke();
+    next.impl->Unref();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow(LogicalProcess* lp)
+{
+    m_currentLp = lp;
+    while (!lp->events->IsEmpty() && lp->events->PeekNext().key.m_ts < m_windowEnd)
+    {
+        ProcessOneEvent(lp);
+    }
+    m_currentLp = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessActiveLps()
+{
+    const auto count = static_cast<uint32_t>(m_activeLps.size());
+    for (uint32_t i = m_nextActiveLp++; i < count; i = m_nextActiveLp++)
+    {
+        ProcessWindow(m_activeLps[i]);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::MergeOutboxes()
+{
+    NS_ASSERT(!m_inWindow);
+    // Iterate by index: new logical processes may be appended to m_lps
+    for (std::size_t i = 0; i < m_lps.size(); ++i)
+    {
+        RemoteEvents outbox;
+        m_lps[i]->outbox.swap(outbox);
+        for (const auto& ev : outbox)
+        {
+            Insert(GetOrCreateLp(ev.context), ev.timestamp, ev.context, ev.event);
+        }
+    }
+
+    RemoteEvents foreignEvents;
+    {
+        std::unique_lock lock{m_foreignEventsMutex};
+        m_foreignEvents.swap(foreignEvents);
+    }
+    for (const auto& ev : foreignEvents)
+    {
+        // Current time added here, as in DefaultSimulatorImpl
+        Insert(GetOrCreateLp(ev.context), m_currentTs + ev.timestamp, ev.context, ev.event);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead()
+{
+    NS_LOG_FUNCTION(this);
+    // The other channels share their state among the nodes they connect, which
+    // PartitionNodes() has placed in a single logical process
+    for (auto it = ChannelList::Begin(); it != ChannelList::End(); ++it)
+    {
+        Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel>(*it);
+        if (!channel || channel->GetNDevices() < 2)
+        {
+            continue;
+        }
+        Ptr<Node> first = channel->GetDevice(0)->GetNode();
+        Ptr<Node> second = channel->GetDevice(1)->GetNode();
+        if (GetGroup(first->GetId()) == GetGroup(second->GetId()))
+        {
+            continue;
+        }
+
+        TimeValue delay;
+        channel->GetAttribute("Delay", delay);
+        if (!delay.Get().IsStrictlyPositive())
+        {
+            NS_FATAL_ERROR("Channel " << channel->GetId() << " between nodes " << first->GetId()
+                                      << " and " << second->GetId()
+                                      << " has a zero delay, which leaves no lookahead "
+                                         "between their logical processes");
+        }
+        m_lookAhead = Min(m_lookAhead, delay.Get());
+    }
+    NS_LOG_INFO("lookahead " << m_lookAhead);
+}
+
+void
+MultithreadedSimulatorImpl::BoundLookAhead(const Time lookAhead)
+{
+    if (lookAhead > Time(0))
+    {
+        NS_LOG_FUNCTION(this << lookAhead);
+        m_lookAhead = Min(m_lookAhead, lookAhead);
+    }
+    else
+    {
+        NS_LOG_WARN("attempted to set lookahead to a non-positive time: " << lookAhead);
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead() const
+{
+    return m_lookAhead;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetLogicalProcessCount() const
+{
+    return static_cast<uint32_t>(m_lps.size());
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetWindowCount() const
+{
+    return m_windowCount;
+}
+
+void
+MultithreadedSimulatorImpl::StartWorkers()
+{
+    uint32_t threads = m_threadCount;
+    if (threads == 0)
+    {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    NS_LOG_FUNCTION(this << threads);
+    m_shutdown = false;
+    // The generation is read here rather than by the workers, which may only
+    // start running after the first window has been posted
+    for (uint32_t i = 1; i < threads; ++i)
+    {
+        m_workers.emplace_back(&MultithreadedSimulatorImpl::WorkerLoop, this, m_generation);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StopWorkers()
+{
+    if (m_workers.empty())
+    {
+        return;
+    }
+    {
+        std::unique_lock lock{m_poolMutex};
+        m_shutdown = true;
+    }
+    m_windowStart.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void
+MultithreadedSimulatorImpl::WorkerLoop(uint64_t generation)
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock{m_poolMutex};
+            m_windowStart.wait(lock, [this, generation] {
+                return m_shutdown || m_generation != generation;
+            });
+            if (m_shutdown)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+        ProcessActiveLps();
+        {
+            std::unique_lock lock{m_poolMutex};
+            if (--m_busyWorkers == 0)
+            {
+                m_windowDone.notify_one();
+            }
+        }
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    for (auto lp : m_lps)
+    {
+        if (!lp->events->IsEmpty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    // Set the current threadId as the main threadId
+    m_mainThreadId = std::this_thread::get_id();
+    m_stop = false;
+    PartitionNodes();
+    CalculateLookAhead();
+    for (auto lp : m_lps)
+    {
+        lp->uid = std::max(lp->uid, m_uid);
+        lp->inRun = true;
+    }
+    m_running = true;
+    StartWorkers();
+
+    const auto maxTs = std::numeric_limits<uint64_t>::max();
+    const auto lookAhead = static_cast<uint64_t>(std::max<int64_t>(m_lookAhead.GetTimeStep(), 1));
+    LogicalProcess* publicLp = m_lps.front();
+
+    while (!m_stop)
+    {
+        MergeOutboxes();
+
+        uint64_t next = maxTs;
+        for (auto lp : m_lps)
+        {
+            if (!lp->events->IsEmpty())
+            {
+                next = std::min(next, lp->events->PeekNext().key.m_ts);
+            }
+        }
+        if (next == maxTs)
+        {
+            break;
+        }
+
+        // Events without context may touch any node: run them alone
+        uint64_t publicNext =
+            publicLp->events->IsEmpty() ? maxTs : publicLp->events->PeekNext().key.m_ts;
+        if (publicNext == next)
+        {
+            ProcessOneEvent(publicLp);
+            m_currentTs = std::max(m_currentTs, next);
+            continue;
+        }
+
+        m_windowEnd = (next > maxTs - lookAhead) ? maxTs : next + lookAhead;
+        m_windowEnd = std::min(m_windowEnd, publicNext);
+        m_activeLps.clear();
+        for (std::size_t i = 1; i < m_lps.size(); ++i)
+        {
+            LogicalProcess* lp = m_lps[i];
+            if (!lp->events->IsEmpty() && lp->events->PeekNext().key.m_ts < m_windowEnd)
+            {
+                m_activeLps.push_back(lp);
+            }
+        }
+
+        m_inWindow = true;
+        m_windowCount++;
+        m_nextActiveLp = 0;
+        if (m_workers.empty() || m_activeLps.size() == 1)
+        {
+            ProcessActiveLps();
+        }
+        else
+        {
+            {
+                std::unique_lock lock{m_poolMutex};
+                m_busyWorkers = static_cast<uint32_t>(m_workers.size());
+                m_generation++;
+            }
+            m_windowStart.notify_all();
+            ProcessActiveLps();
+            std::unique_lock lock{m_poolMutex};
+            m_windowDone.wait(lock, [this] { return m_busyWorkers == 0; });
+        }
+        m_inWindow = false;
+
+        for (auto lp : m_activeLps)
+        {
+            m_currentTs = std::max(m_currentTs, lp->currentTs);
+        }
+    }
+
+    MergeOutboxes();
+    StopWorkers();
+    m_running = false;
+    for (auto lp : m_lps)
+    {
+        m_uid = std::max(m_uid, lp->uid);
+    }
+    publicLp->currentTs = std::max(publicLp->currentTs, m_currentTs);
+
+#ifdef NS3_ASSERT_ENABLE
+    // If the simulator stopped naturally by lack of events, make a
+    // consistency test to check that we didn't lose any events along the way.
+    int unscheduledEvents = 0;
+    bool empty = true;
+    for (auto lp : m_lps)
+    {
+        unscheduledEvents += lp->unscheduledEvents;
+        empty = empty && lp->events->IsEmpty();
+    }
+    NS_ASSERT(!empty || unscheduledEvents == 0);
+#endif
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    Simulator::Schedule(delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    LogicalProcess* lp = GetCurrentLp();
+    NS_ASSERT_MSG(lp != nullptr, "Simulator::Schedule Thread-unsafe invocation!");
+
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+    Time tAbsolute = delay + TimeStep(lp->currentTs);
+    return Insert(lp, (uint64_t)tAbsolute.GetTimeStep(), lp->currentContext, event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+    LogicalProcess* lp = GetCurrentLp();
+
+    if (lp == nullptr)
+    {
+        RemoteEvent ev;
+        ev.context = context;
+        // Current time added in MergeOutboxes()
+        ev.timestamp = delay.GetTimeStep();
+        ev.event = event;
+        std::unique_lock lock{m_foreignEventsMutex};
+        m_foreignEvents.push_back(ev);
+        return;
+    }
+
+    Time tAbsolute = delay + TimeStep(lp->currentTs);
+    auto ts = (uint64_t)tAbsolute.GetTimeStep();
+    if (!m_inWindow)
+    {
+        Insert(GetOrCreateLp(context), ts, context, event);
+        return;
+    }
+
+    if (FindLp(context) == lp)
+    {
+        Insert(lp, ts, context, event);
+        return;
+    }
+
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "Event scheduled from context " << lp->currentContext << " to context "
+                                                    << context << " with a delay of " << delay
+                                                    << ", which is less than the lookahead "
+                                                    << m_lookAhead);
+    RemoteEvent ev;
+    ev.context = context;
+    ev.timestamp = ts;
+    ev.event = event;
+    lp->outbox.push_back(ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    std::unique_lock lock{m_destroyEventsMutex};
+    EventId id(Ptr<EventImpl>(event, false), Now().GetTimeStep(), 0xffffffff, 2);
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    LogicalProcess* lp = GetCurrentLp();
+    return TimeStep(lp != nullptr ? lp->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    else
+    {
+        return TimeStep(id.GetTs()) - Now();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        std::unique_lock lock{m_destroyEventsMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    if (IsExpired(id))
+    {
+        return;
+    }
+    LogicalProcess* lp = FindLp(id.GetContext());
+    NS_ABORT_MSG_IF(m_inWindow && lp != GetCurrentLp(),
+                    "Cannot remove an event of context " << id.GetContext()
+                                                         << " from another context");
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    lp->events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+
+    lp->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        std::unique_lock lock{m_destroyEventsMutex};
+        return std::find(m_destroyEvents.begin(), m_destroyEvents.end(), id) ==
+               m_destroyEvents.end();
+    }
+    LogicalProcess* lp = FindLp(id.GetContext());
+    if (lp == nullptr || id.PeekEventImpl() == nullptr || id.GetTs() < lp->currentTs ||
+        (id.GetTs() == lp->currentTs && id.GetUid() <= lp->currentUid) ||
+        id.PeekEventImpl()->IsCancelled())
+    {
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    LogicalProcess* lp = GetCurrentLp();
+    return lp != nullptr ? lp->currentContext : Simulator::NO_CONTEXT;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t eventCount = 0;
+    for (auto lp : m_lps)
+    {
+        eventCount += lp->eventCount;
+    }
+    return eventCount;
+}
+
+} // namespace ns3
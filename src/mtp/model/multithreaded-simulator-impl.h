@@ -0,0 +1,346 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator-impl.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3
+{
+
+// Forward
+class Scheduler;
+
+/**
+ * \ingroup mtp
+ *
+ * \brief Conservative shared-memory parallel simulator implementation.
+ *
+ * Every event context (normally a node id) is mapped to a logical
+ * process (LP) with a private event queue. Events without a context
+ * (Simulator::NO_CONTEXT) live in a dedicated public LP which is always
+ * executed serially by the main thread.
+ *
+ * The nodes are partitioned when Run() is called: the nodes attached to
+ * the same channel are mapped to the same LP, unless the channel is a
+ * PointToPointChannel. Unlike a point-to-point channel, whose state is
+ * held by its two devices, the other channels (e.g., CSMA or wireless
+ * channels) share mutable state among all their nodes, such as the
+ * state of the medium or the propagation models.
+ *
+ * The simulation advances in time windows. Given the earliest pending
+ * timestamp \f$t\f$ over all LPs, every LP with events in
+ * \f$[t, t + L)\f$, where \f$L\f$ is the lookahead, is executed
+ * concurrently by a pool of worker threads. Events scheduled by an LP
+ * towards another LP are buffered in the sender outbox and merged
+ * into the destination queues at the window barrier, in LP order, so
+ * that the resulting event order does not depend on the number of
+ * threads nor on the operating system scheduling.
+ *
+ * The lookahead is the minimum of the \c LookAhead attribute, of the
+ * values passed to BoundLookAhead() and of the \c Delay attribute of
+ * every point-to-point channel connecting nodes of different LPs.
+ * Scheduling an event on another LP with a delay smaller than the
+ * lookahead is a fatal error.
+ *
+ * This implementation is only built when ns-3 is configured with
+ * NS3_MTP, which makes the state shared by the packets and the objects
+ * of the core (reference counts, packet uid counter, etc.) thread-safe.
+ * As with the distributed simulator, the models attached to nodes of
+ * different LPs must not share any other mutable state, except through
+ * events scheduled with Simulator::ScheduleWithContext.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Add a user-specified upper bound on the lookahead.
+     *
+     * \param [in] lookAhead The maximum lookahead; must be > 0.
+     */
+    void BoundLookAhead(const Time lookAhead);
+
+    /**
+     * Get the lookahead used to compute the time windows.
+     *
+     * The value is only meaningful once Run() has been called.
+     *
+     * \return The current lookahead.
+     */
+    Time GetLookAhead() const;
+
+    /**
+     * Get the number of logical processes currently allocated,
+     * including the public one. The logical processes of the nodes
+     * attached to the same channel are merged by Run().
+     *
+     * \return The number of logical processes.
+     */
+    uint32_t GetLogicalProcessCount() const;
+
+    /**
+     * Get the number of synchronization windows executed so far.
+     *
+     * \return The number of windows.
+     */
+    uint64_t GetWindowCount() const;
+
+  private:
+    void DoDispose() override;
+
+    /** An event sent to another logical process. */
+    struct RemoteEvent
+    {
+        /** The event context. */
+        uint32_t context;
+        /** Absolute event timestamp. */
+        uint64_t timestamp;
+        /** The event implementation. */
+        EventImpl* event;
+    };
+
+    /** Container type for the events sent to other logical processes. */
+    typedef std::vector<RemoteEvent> RemoteEvents;
+
+    /** The state of one logical process. */
+    struct LogicalProcess
+    {
+        /** The event priority queue. */
+        Ptr<Scheduler> events;
+        /** Events sent to other logical processes in the current window. */
+        RemoteEvents outbox;
+        /** Next event unique id, during Run(). */
+        uint32_t uid;
+        /** Unique id of the current event. */
+        uint32_t currentUid;
+        /** Timestamp of the current event. */
+        uint64_t currentTs;
+        /** Execution context of the current event. */
+        uint32_t currentContext;
+        /** The event count. */
+        uint64_t eventCount;
+        /** Number of events that have been inserted but not yet executed. */
+        int unscheduledEvents;
+        /**
+         * \c true if the LP existed during a Run(): the uids of its events
+         * may then be equal to the uids of the events of other LPs.
+         */
+        bool inRun;
+    };
+
+    /**
+     * Get the logical process of the calling thread.
+     *
+     * \return The logical process, or \c nullptr if called by a thread
+     *         which is neither the main thread nor a worker executing
+     *         an event.
+     */
+    LogicalProcess* GetCurrentLp() const;
+    /**
+     * Get the logical process owning a context, allocating it if needed.
+     *
+     * Must only be called while no window is executing.
+     *
+     * \param [in] context The event context.
+     * \return The logical process.
+     */
+    LogicalProcess* GetOrCreateLp(uint32_t context);
+    /**
+     * Get the logical process owning a context without allocating it.
+     *
+     * \param [in] context The event context.
+     * \return The logical process, or \c nullptr if none exists yet.
+     */
+    LogicalProcess* FindLp(uint32_t context) const;
+    /**
+     * Get the group of a context.
+     *
+     * \param [in] context The event context.
+     * \return The smallest node id of the nodes which share a channel
+     *         with the node of the context, or the context itself.
+     */
+    uint32_t GetGroup(uint32_t context) const;
+    /**
+     * Group the nodes attached to the same channel, except the
+     * point-to-point channels, and merge their logical processes.
+     *
+     * Must only be called while no window is executing.
+     */
+    void PartitionNodes();
+    /**
+     * Move the events of a logical process to another one and delete it.
+     *
+     * \param [in] dst The logical process which is kept.
+     * \param [in] src The logical process which is deleted.
+     */
+    void MergeLps(LogicalProcess* dst, LogicalProcess* src);
+    /**
+     * Insert an event in the queue of a logical process.
+     *
+     * \param [in] lp The logical process.
+     * \param [in] ts The absolute event timestamp.
+     * \param [in] context The event context.
+     * \param [in] event The event implementation.
+     * \return The EventId of the new event.
+     */
+    EventId Insert(LogicalProcess* lp, uint64_t ts, uint32_t context, EventImpl* event);
+    /**
+     * Process the next event of a logical process.
+     *
+     * \param [in] lp The logical process.
+     */
+    void ProcessOneEvent(LogicalProcess* lp);
+    /**
+     * Process all the events of a logical process up to the end of the
+     * current window.
+     *
+     * \param [in] lp The logical process.
+     */
+    void ProcessWindow(LogicalProcess* lp);
+    /** Process the logical processes of the current window not yet claimed. */
+    void ProcessActiveLps();
+    /** Move remote and foreign-thread events into their destination queues. */
+    void MergeOutboxes();
+    /** Compute the lookahead from the channels connecting different LPs. */
+    void CalculateLookAhead();
+    /** Start the worker threads. */
+    void StartWorkers();
+    /** Stop and join the worker threads. */
+    void StopWorkers();
+    /**
+     * Main loop of a worker thread.
+     *
+     * \param [in] generation The window generation when the worker is started.
+     */
+    void WorkerLoop(uint64_t generation);
+
+    /** All the logical processes; index 0 is the public one. */
+    std::vector<LogicalProcess*> m_lps;
+    /** Logical process of each context. */
+    std::unordered_map<uint32_t, LogicalProcess*> m_contextLp;
+    /** Group of the nodes which share a channel, if not the node itself. */
+    std::unordered_map<uint32_t, uint32_t> m_contextGroup;
+    /** The scheduler factory used for each new logical process. */
+    ObjectFactory m_schedulerFactory;
+
+    /** Container type for the events to run at Simulator::Destroy() */
+    typedef std::list<EventId> DestroyEvents;
+    /** The container of events to run at Destroy. */
+    DestroyEvents m_destroyEvents;
+    /** Mutex protecting m_destroyEvents during a window. */
+    mutable std::mutex m_destroyEventsMutex;
+
+    /** Events scheduled by foreign threads. */
+    RemoteEvents m_foreignEvents;
+    /** Mutex protecting m_foreignEvents. */
+    std::mutex m_foreignEventsMutex;
+
+    /** Flag calling for the end of the simulation. */
+    std::atomic<bool> m_stop;
+    /** Largest timestamp processed so far. */
+    uint64_t m_currentTs;
+    /** Next event unique id, outside Run(), shared by all the LPs. */
+    uint32_t m_uid;
+    /** \c true during Run(). */
+    bool m_running;
+    /** \c true while a window is being executed. */
+    bool m_inWindow;
+    /** End (exclusive) of the current window. */
+    uint64_t m_windowEnd;
+    /** Number of windows executed. */
+    uint64_t m_windowCount;
+    /** Current lookahead. */
+    Time m_lookAhead;
+    /** Requested number of threads, 0 for the hardware concurrency. */
+    uint32_t m_threadCount;
+
+    /** Logical processes with events in the current window. */
+    std::vector<LogicalProcess*> m_activeLps;
+    /** Index of the next active logical process to claim. */
+    std::atomic<uint32_t> m_nextActiveLp;
+    /** Worker threads. */
+    std::vector<std::thread> m_workers;
+    /** Mutex protecting the worker pool state. */
+    std::mutex m_poolMutex;
+    /** Signals the start of a window to the workers. */
+    std::condition_variable m_windowStart;
+    /** Signals the completion of a window to the main thread. */
+    std::condition_variable m_windowDone;
+    /** Window generation, incremented at the start of each window. */
+    uint64_t m_generation;
+    /** Number of workers still busy in the current window. */
+    uint32_t m_busyWorkers;
+    /** Flag asking the workers to exit. */
+    bool m_shutdown;
+
+    /** Main execution thread. */
+    std::thread::id m_mainThreadId;
+    /** The logical process whose event is executed by the calling thread. */
+    static thread_local LogicalProcess* m_currentLp;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,382 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/csma-helper.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * MultithreadedSimulatorImpl test suite
+ */
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-tests Multithreaded simulator tests
+ */
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Check that the multithreaded simulator executes the events of
+ * each context in the same order and at the same time as the default
+ * simulator.
+ */
+class MtpEventOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param threads Number of threads of the multithreaded simulator.
+     */
+    MtpEventOrderTestCase(uint32_t threads);
+    void DoRun() override;
+
+  private:
+    /** Record of one executed event: timestamp and hop number. */
+    typedef std::vector<std::pair<int64_t, uint32_t>> Trace;
+
+    /**
+     * Run the test scenario with the current simulator implementation.
+     * \return The per-context traces.
+     */
+    std::vector<Trace> RunScenario();
+    /**
+     * Event forwarded from one context to the next one.
+     * \param context The context of the event.
+     * \param hop The number of times the event has been forwarded.
+     */
+    void Forward(uint32_t context, uint32_t hop);
+    /**
+     * Event local to a context.
+     * \param context The context of the event.
+     * \param hop The hop number of the parent event.
+     */
+    void Local(uint32_t context, uint32_t hop);
+
+    static const uint32_t N_CONTEXTS = 8; //!< Number of contexts.
+    static const uint32_t N_HOPS = 200;   //!< Number of hops of each token.
+    uint32_t m_threads;                   //!< Number of threads.
+    std::vector<Trace> m_traces;          //!< Per-context traces.
+    std::vector<uint32_t> m_wrongContext; //!< Per-context wrong GetContext() count.
+};
+
+MtpEventOrderTestCase::MtpEventOrderTestCase(uint32_t threads)
+    : TestCase("Check event ordering with " + std::to_string(threads) + " threads"),
+      m_threads(threads)
+{
+}
+
+void
+MtpEventOrderTestCase::Forward(uint32_t context, uint32_t hop)
+{
+    m_traces[context].emplace_back(Simulator::Now().GetTimeStep(), hop);
+    if (Simulator::GetContext() != context)
+    {
+        m_wrongContext[context]++;
+    }
+    Simulator::Schedule(MicroSeconds(300 + 100 * (hop % 4)),
+                        &MtpEventOrderTestCase::Local,
+                        this,
+                        context,
+                        hop);
+    if (hop < N_HOPS)
+    {
+        uint32_t next = (context + 1) % N_CONTEXTS;
+        Simulator::ScheduleWithContext(next,
+                                       MilliSeconds(1 + (context + hop) % 3),
+                                       &MtpEventOrderTestCase::Forward,
+                                       this,
+                                       next,
+                                       hop + 1);
+    }
+}
+
+void
+MtpEventOrderTestCase::Local(uint32_t context, uint32_t hop)
+{
+    m_traces[context].emplace_back(-Simulator::Now().GetTimeStep(), hop);
+    if (Simulator::GetContext() != context)
+    {
+        m_wrongContext[context]++;
+    }
+}
+
+std::vector<MtpEventOrderTestCase::Trace>
+MtpEventOrderTestCase::RunScenario()
+{
+    m_traces.assign(N_CONTEXTS, Trace());
+    m_wrongContext.assign(N_CONTEXTS, 0);
+    for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+        Simulator::ScheduleWithContext(i,
+                                       MilliSeconds(i),
+                                       &MtpEventOrderTestCase::Forward,
+                                       this,
+                                       i,
+                                       0);
+    }
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+    return m_traces;
+}
+
+void
+MtpEventOrderTestCase::DoRun()
+{
+    Simulator::SetImplementation(CreateObject<DefaultSimulatorImpl>());
+    std::vector<Trace> expected = RunScenario();
+    uint64_t expectedEvents = Simulator::GetEventCount();
+    Simulator::Destroy();
+
+    Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl>();
+    impl->SetAttribute("ThreadCount", UintegerValue(m_threads));
+    impl->BoundLookAhead(MilliSeconds(1));
+    Simulator::SetImplementation(impl);
+    std::vector<Trace> actual = RunScenario();
+
+    NS_TEST_ASSERT_MSG_EQ(impl->GetLookAhead(), MilliSeconds(1), "Unexpected lookahead");
+    NS_TEST_ASSERT_MSG_EQ(impl->GetLogicalProcessCount(),
+                          N_CONTEXTS + 1,
+                          "Unexpected number of logical processes");
+    NS_TEST_ASSERT_MSG_GT(impl->GetWindowCount(), 0, "No window executed");
+    NS_TEST_ASSERT_MSG_EQ(Simulator::GetEventCount(), expectedEvents, "Wrong event count");
+    for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_wrongContext[i], 0, "Wrong context reported in context " << i);
+        NS_TEST_ASSERT_MSG_EQ(actual[i].size(), expected[i].size(), "Wrong event count " << i);
+        NS_TEST_ASSERT_MSG_EQ((actual[i] == expected[i]), true, "Event order differs " << i);
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Check that a point-to-point ring with a CSMA segment gives the same
+ * packet receptions with the multithreaded simulator as with the default
+ * simulator.
+ *
+ * The packets are forwarded from node to node, which grow them at each hop,
+ * so that their buffers are shared by the copies made by the channels across
+ * the logical processes.
+ */
+class MtpPacketTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param threads Number of threads of the multithreaded simulator.
+     */
+    MtpPacketTestCase(uint32_t threads);
+    void DoRun() override;
+
+  private:
+    /** Record of one reception: timestamp, origin, sequence number and size. */
+    typedef std::vector<std::tuple<int64_t, uint32_t, uint32_t, uint32_t>> Trace;
+
+    /**
+     * Run the test scenario with the current simulator implementation.
+     * \return The per-node traces.
+     */
+    std::vector<Trace> RunScenario();
+    /**
+     * Send a new packet.
+     * \param device The sending device.
+     * \param seq The sequence number of the packet.
+     */
+    void SendNew(Ptr<NetDevice> device, uint32_t seq);
+    /**
+     * Send a packet to the next node of a device channel.
+     * \param device The sending device.
+     * \param packet The packet.
+     * \param hop The number of times the packet has been forwarded.
+     */
+    void Send(Ptr<NetDevice> device, Ptr<Packet> packet, uint32_t hop);
+    /**
+     * Receive a packet and forward it through the next device of the node.
+     * \param device The receiving device.
+     * \param packet The packet.
+     * \param protocol The protocol number.
+     * \param from The source address.
+     * \return true
+     */
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from);
+
+    static const uint32_t N_PACKETS = 10;    //!< Number of packets sent by each device.
+    static const uint32_t N_HOPS = 40;       //!< Number of hops of each packet.
+    static const uint32_t PACKET_SIZE = 100; //!< Size of the new packets.
+    uint32_t m_threads;                      //!< Number of threads.
+    std::vector<Trace> m_traces;             //!< Per-node traces.
+};
+
+MtpPacketTestCase::MtpPacketTestCase(uint32_t threads)
+    : TestCase("Check point-to-point and CSMA packets with " + std::to_string(threads) +
+               " threads"),
+      m_threads(threads)
+{
+}
+
+void
+MtpPacketTestCase::SendNew(Ptr<NetDevice> device, uint32_t seq)
+{
+    uint8_t buffer[PACKET_SIZE] = {};
+    buffer[0] = static_cast<uint8_t>(device->GetNode()->GetId());
+    buffer[1] = static_cast<uint8_t>(device->GetIfIndex());
+    buffer[2] = static_cast<uint8_t>(seq);
+    Send(device, Create<Packet>(buffer, PACKET_SIZE), 0);
+}
+
+void
+MtpPacketTestCase::Send(Ptr<NetDevice> device, Ptr<Packet> packet, uint32_t hop)
+{
+    Ptr<Channel> channel = device->GetChannel();
+    std::size_t n = channel->GetNDevices();
+    std::size_t self = 0;
+    while (channel->GetDevice(self) != device)
+    {
+        self++;
+    }
+    Ptr<NetDevice> next = channel->GetDevice((self + 1 + hop % (n - 1)) % n);
+    device->Send(packet, next->GetAddress(), 0x0800);
+}
+
+bool
+MtpPacketTestCase::Receive(Ptr<NetDevice> device,
+                           Ptr<const Packet> packet,
+                           uint16_t protocol,
+                           const Address& from)
+{
+    uint8_t buffer[3];
+    packet->CopyData(buffer, 3);
+    Ptr<Node> node = device->GetNode();
+    m_traces[node->GetId()].emplace_back(Simulator::Now().GetTimeStep(),
+                                         buffer[0] << 8 | buffer[1],
+                                         buffer[2],
+                                         packet->GetSize());
+    uint32_t hop = packet->GetSize() - PACKET_SIZE;
+    if (hop < N_HOPS)
+    {
+        Ptr<Packet> copy = packet->Copy();
+        copy->AddPaddingAtEnd(1);
+        Send(node->GetDevice((device->GetIfIndex() + 1) % node->GetNDevices()), copy, hop + 1);
+    }
+    return true;
+}
+
+std::vector<MtpPacketTestCase::Trace>
+MtpPacketTestCase::RunScenario()
+{
+    // Nodes 0 to 3 form a ring of point-to-point links; nodes 3 to 5 share a
+    // CSMA channel and are thus executed by the same logical process
+    NodeContainer nodes;
+    nodes.Create(6);
+    PointToPointHelper p2p;
+    const uint32_t delays[] = {2000, 3000, 1500, 2500};
+    NetDeviceContainer devices;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        p2p.SetDeviceAttribute("DataRate", DataRateValue(DataRate((5 + i) * 1000000)));
+        p2p.SetChannelAttribute("Delay", TimeValue(MicroSeconds(delays[i])));
+        devices.Add(p2p.Install(nodes.Get(i), nodes.Get((i + 1) % 4)));
+    }
+    CsmaHelper csma;
+    csma.SetChannelAttribute("DataRate", DataRateValue(DataRate(10000000)));
+    csma.SetChannelAttribute("Delay", TimeValue(MicroSeconds(3)));
+    NetDeviceContainer csmaDevices =
+        csma.Install(NodeContainer(nodes.Get(3), nodes.Get(4), nodes.Get(5)));
+    csma.AssignStreams(csmaDevices, 0);
+    devices.Add(csmaDevices);
+
+    m_traces.assign(nodes.GetN(), Trace());
+    for (uint32_t i = 0; i < devices.GetN(); ++i)
+    {
+        Ptr<NetDevice> device = devices.Get(i);
+        device->SetReceiveCallback(MakeCallback(&MtpPacketTestCase::Receive, this));
+        for (uint32_t seq = 0; seq < N_PACKETS; ++seq)
+        {
+            Simulator::ScheduleWithContext(device->GetNode()->GetId(),
+                                           MicroSeconds(1000 * seq + 137 * i + 11),
+                                           &MtpPacketTestCase::SendNew,
+                                           this,
+                                           device,
+                                           seq);
+        }
+    }
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+    return m_traces;
+}
+
+void
+MtpPacketTestCase::DoRun()
+{
+    Simulator::SetImplementation(CreateObject<DefaultSimulatorImpl>());
+    std::vector<Trace> expected = RunScenario();
+    Simulator::Destroy();
+
+    Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl>();
+    impl->SetAttribute("ThreadCount", UintegerValue(m_threads));
+    Simulator::SetImplementation(impl);
+    std::vector<Trace> actual = RunScenario();
+
+    NS_TEST_ASSERT_MSG_EQ(impl->GetLookAhead(), MicroSeconds(1500), "Unexpected lookahead");
+    NS_TEST_ASSERT_MSG_EQ(impl->GetLogicalProcessCount(),
+                          5,
+                          "Unexpected number of logical processes");
+    for (uint32_t i = 0; i < expected.size(); ++i)
+    {
+        NS_TEST_ASSERT_MSG_GT(expected[i].size(), 0, "No packet received by node " << i);
+        NS_TEST_ASSERT_MSG_EQ(actual[i].size(), expected[i].size(), "Wrong count " << i);
+        NS_TEST_ASSERT_MSG_EQ((actual[i] == expected[i]), true, "Receptions differ " << i);
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief The multithreaded simulator Test Suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    MtpTestSuite()
+        : TestSuite("mtp", UNIT)
+    {
+        AddTestCase(new MtpEventOrderTestCase(1), TestCase::QUICK);
+        AddTestCase(new MtpEventOrderTestCase(4), TestCase::QUICK);
+        AddTestCase(new MtpPacketTestCase(1), TestCase::QUICK);
+        AddTestCase(new MtpPacketTestCase(4), TestCase::QUICK);
+    }
+};
+
+static MtpTestSuite g_mtpTestSuite; //!< Static variable for test initialization
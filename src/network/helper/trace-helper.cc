@@ -24,6 +24,7 @@
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/ptr.h"
 
 #include <fstream>
@@ -35,6 +36,13 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("TraceHelper");
 
+/**
+ * The pcapng file in which PcapHelper::CreateFile adds an interface instead of
+ * creating a pcap file, while PcapHelperForDevice enables the pcap output of a
+ * device in a pcapng file.
+ */
+static Ptr<PcapngFileWrapper> g_pcapngFile;
+
 PcapHelper::PcapHelper()
 {
     NS_LOG_FUNCTION_NOARGS();
@@ -54,6 +62,21 @@ PcapHelper::CreateFile(std::string filename,
 {
     NS_LOG_FUNCTION(filename << filemode << dataLinkType << snapLen << tzCorrection);
 
+    if (g_pcapngFile)
+    {
+        std::string name = filename;
+        const std::string extension = ".pcap";
+        if (name.size() > extension.size() &&
+            name.compare(name.size() - extension.size(), extension.size(), extension) == 0)
+        {
+            name.erase(name.size() - extension.size());
+        }
+        Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper>();
+        file->SetPcapngInterface(g_pcapngFile,
+                                 g_pcapngFile->AddInterface(dataLinkType, name, snapLen));
+        return file;
+    }
+
     Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper>();
     file->Open(filename, filemode);
     NS_ABORT_MSG_IF(file->Fail(), "Unable to Open " << filename << " for mode " << filemode);
@@ -75,6 +98,17 @@ PcapHelper::CreateFile(std::string filename,
     return file;
 }
 
+Ptr<PcapngFileWrapper>
+PcapHelper::CreatePcapngFile(std::string filename)
+{
+    NS_LOG_FUNCTION(filename);
+
+    Ptr<PcapngFileWrapper> file = CreateObject<PcapngFileWrapper>();
+    file->Open(filename);
+    NS_ABORT_MSG_IF(file->Fail(), "Unable to Open " << filename);
+    return file;
+}
+
 std::string
 PcapHelper::GetFilenameFromDevice(std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -490,6 +524,61 @@ PcapHelperForDevice::EnablePcap(std::string prefix,
     }
 }
 
+void
+PcapHelperForDevice::EnablePcap(Ptr<PcapngFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+    NS_ABORT_MSG_IF(g_pcapngFile, "PcapHelperForDevice::EnablePcap(): called recursively");
+    // the prefix of the names of the interfaces is the name of the file
+    std::string prefix = file->GetFilename();
+    std::string::size_type slash = prefix.find_last_of('/');
+    if (slash != std::string::npos)
+    {
+        prefix.erase(0, slash + 1);
+    }
+    prefix = prefix.substr(0, prefix.find_last_of('.'));
+    if (prefix.empty())
+    {
+        prefix = "pcapng";
+    }
+
+    g_pcapngFile = file;
+    EnablePcapInternal(prefix, nd, promiscuous, false);
+    g_pcapngFile = nullptr;
+}
+
+void
+PcapHelperForDevice::EnablePcap(Ptr<PcapngFileWrapper> file,
+                                NetDeviceContainer d,
+                                bool promiscuous)
+{
+    for (NetDeviceContainer::Iterator i = d.Begin(); i != d.End(); ++i)
+    {
+        Ptr<NetDevice> dev = *i;
+        EnablePcap(file, dev, promiscuous);
+    }
+}
+
+void
+PcapHelperForDevice::EnablePcap(Ptr<PcapngFileWrapper> file, NodeContainer n, bool promiscuous)
+{
+    NetDeviceContainer devs;
+    for (NodeContainer::Iterator i = n.Begin(); i != n.End(); ++i)
+    {
+        Ptr<Node> node = *i;
+        for (uint32_t j = 0; j < node->GetNDevices(); ++j)
+        {
+            devs.Add(node->GetDevice(j));
+        }
+    }
+    EnablePcap(file, devs, promiscuous);
+}
+
+void
+PcapHelperForDevice::EnablePcapAll(Ptr<PcapngFileWrapper> file, bool promiscuous)
+{
+    EnablePcap(file, NodeContainer::GetGlobal(), promiscuous);
+}
+
 //
 // Public API
 //
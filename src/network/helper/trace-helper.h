@@ -23,6 +23,7 @@
 #include "ns3/node-container.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/simulator.h"
 
 namespace ns3
@@ -115,6 +116,18 @@ class PcapHelper
                                     DataLinkType dataLinkType,
                                     uint32_t snapLen = std::numeric_limits<uint32_t>::max(),
                                     int32_t tzCorrection = 0);
+
+    /**
+     * @brief Create a pcapng file, in which the packets of many devices can be
+     * written.
+     *
+     * @param filename file name
+     * @returns a smart pointer to the pcapng file
+     *
+     * @see PcapHelperForDevice::EnablePcapAll(Ptr<PcapngFileWrapper>, bool)
+     */
+    Ptr<PcapngFileWrapper> CreatePcapngFile(std::string filename);
+
     /**
      * @brief Hook a trace source to the default trace sink
      *
@@ -718,6 +731,53 @@ class PcapHelperForDevice
      * @param promiscuous If true capture all possible packets available at the device.
      */
     void EnablePcapAll(std::string prefix, bool promiscuous = false);
+
+    /**
+     * @brief Enable pcap output of the indicated net device in a pcapng file.
+     *
+     * The packets of the device are written to a new interface of the file,
+     * named like the pcap file which would be created with the name of the
+     * pcapng file (without its extension) as prefix.
+     *
+     * @param file pcapng file to write the packets to.
+     * @param nd Net device for which you want to enable tracing.
+     * @param promiscuous If true capture all possible packets available at the device.
+     */
+    void EnablePcap(Ptr<PcapngFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous = false);
+
+    /**
+     * @brief Enable pcap output in a pcapng file on each device in the
+     * container which is of the appropriate type.
+     *
+     * @param file pcapng file to write the packets to.
+     * @param d container of devices
+     * @param promiscuous If true capture all possible packets available at the device.
+     */
+    void EnablePcap(Ptr<PcapngFileWrapper> file, NetDeviceContainer d, bool promiscuous = false);
+
+    /**
+     * @brief Enable pcap output in a pcapng file on each device (which is of
+     * the appropriate type) in the nodes provided in the container.
+     *
+     * @param file pcapng file to write the packets to.
+     * @param n container of nodes.
+     * @param promiscuous If true capture all possible packets available at the device.
+     */
+    void EnablePcap(Ptr<PcapngFileWrapper> file, NodeContainer n, bool promiscuous = false);
+
+    /**
+     * @brief Enable pcap output in a single pcapng file on each device (which
+     * is of the appropriate type) in the set of all nodes created in the
+     * simulation.
+     *
+     * Instead of a pcap file per device, the packets are written to a single
+     * file, with an interface per device.  The same file can be passed to the
+     * helpers of different types of devices.
+     *
+     * @param file pcapng file to write the packets to.
+     * @param promiscuous If true capture all possible packets available at the device.
+     */
+    void EnablePcapAll(Ptr<PcapngFileWrapper> file, bool promiscuous = false);
 };
 
 /**
@@ -21,6 +21,8 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <atomic>
+
 #define LOG_INTERNAL_STATE(y)                                                                      \
     NS_LOG_LOGIC(y << "start=" << m_start << ", end=" << m_end                                     \
                    << ", zero start=" << m_zeroAreaStart << ", zero end=" << m_zeroAreaEnd         \
@@ -54,95 +56,176 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Buffer");
 
+#ifdef NS3_MTP
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
+
+constexpr uint32_t ALLOC_OVER_PROVISION = 100; //!< Additional bytes to over-provision.
+
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy
- * constructor orderings.
+namespace
+{
+
+/// Log2 of the size of the smallest pooled block.
+constexpr uint32_t POOL_MIN_SHIFT = 7;
+/// Number of block sizes, from 2^POOL_MIN_SHIFT to 2^31 bytes.
+constexpr uint32_t POOL_CLASSES = 32 - POOL_MIN_SHIFT;
+
+/// Size of the largest pooled block.
+std::atomic<uint32_t> g_poolMaxBlockSize{65536};
+/// Maximum number of bytes held by the pool of each thread.
+std::atomic<uint64_t> g_poolMaxCachedBytes{64 * 1024 * 1024};
+
+/**
+ * \ingroup packet
+ * \brief Per-thread free lists of buffer data blocks, one for each
+ * power of two block size.
  */
-#define MAGIC_DESTROYED (~(long)0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED(x) && !IS_DESTROYED(x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList* Buffer::g_freeList = nullptr;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor()
+struct BufferPool
 {
-    NS_LOG_FUNCTION(this);
-    if (IS_INITIALIZED(g_freeList))
+    /// Release the cached blocks.
+    ~BufferPool();
+
+    /// A free block, linked in the free list of its size.
+    struct FreeBlock
+    {
+        FreeBlock* next; //!< The next free block.
+    };
+
+    FreeBlock* freeLists[POOL_CLASSES]{}; //!< Free list of each block size.
+    uint64_t cachedBytes{0};              //!< Bytes held by the free lists.
+    Buffer::PoolStats stats{};            //!< Pool statistics.
+};
+
+/**
+ * Has the pool of this thread been destroyed?
+ *
+ * Buffers released by the destructors of static objects, after the pool of
+ * the main thread, are returned to the global allocator.
+ */
+thread_local bool g_bufferPoolDestroyed = false;
+/// The buffer data pool of this thread.
+thread_local BufferPool g_bufferPool;
+
+BufferPool::~BufferPool()
+{
+    for (uint32_t i = 0; i < POOL_CLASSES; ++i)
     {
-        for (Buffer::FreeList::iterator i = g_freeList->begin(); i != g_freeList->end(); i++)
+        while (freeLists[i] != nullptr)
         {
-            Buffer::Deallocate(*i);
+            FreeBlock* block = freeLists[i];
+            freeLists[i] = block->next;
+            delete[] reinterpret_cast<uint8_t*>(block);
         }
-        delete g_freeList;
-        g_freeList = DESTROYED;
     }
+    g_bufferPoolDestroyed = true;
 }
 
+} // namespace
+
 void
 Buffer::Recycle(struct Buffer::Data* data)
 {
     NS_LOG_FUNCTION(data);
     NS_ASSERT(data->m_count == 0);
-    NS_ASSERT(!IS_UNINITIALIZED(g_freeList));
-    g_maxSize = std::max(g_maxSize, data->m_size);
-    /* feed into free list */
-    if (data->m_size < g_maxSize || IS_DESTROYED(g_freeList) || g_freeList->size() > 1000)
+    uint64_t blockSize = data->m_size - 1 + sizeof(struct Buffer::Data);
+    if (g_bufferPoolDestroyed)
     {
         Buffer::Deallocate(data);
+        return;
     }
-    else
+    BufferPool& pool = g_bufferPool;
+    /* only the blocks allocated by Create() are pooled */
+    bool pooled = (blockSize & (blockSize - 1)) == 0 && blockSize >= (1U << POOL_MIN_SHIFT) &&
+                  blockSize <= g_poolMaxBlockSize.load(std::memory_order_relaxed);
+    if (!pooled ||
+        pool.cachedBytes + blockSize > g_poolMaxCachedBytes.load(std::memory_order_relaxed))
     {
-        NS_ASSERT(IS_INITIALIZED(g_freeList));
-        g_freeList->push_back(data);
+        pool.stats.frees++;
+        Buffer::Deallocate(data);
+        return;
+    }
+    uint32_t index = 0;
+    while ((uint64_t(1) << (index + POOL_MIN_SHIFT)) < blockSize)
+    {
+        index++;
     }
+    auto block = reinterpret_cast<BufferPool::FreeBlock*>(data);
+    block->next = pool.freeLists[index];
+    pool.freeLists[index] = block;
+    pool.cachedBytes += blockSize;
+    pool.stats.cached++;
+    pool.stats.releases++;
 }
 
 Buffer::Data*
 Buffer::Create(uint32_t dataSize)
 {
     NS_LOG_FUNCTION(dataSize);
-    /* try to find a buffer correctly sized. */
-    if (IS_UNINITIALIZED(g_freeList))
+    /* find the smallest block size which can hold the over-provisioned data */
+    uint64_t dataBytes = std::max<uint32_t>(dataSize, 1) + ALLOC_OVER_PROVISION;
+    uint64_t bytes = dataBytes - 1 + sizeof(struct Buffer::Data);
+    uint32_t index = 0;
+    while ((uint64_t(1) << (index + POOL_MIN_SHIFT)) < bytes)
     {
-        g_freeList = new Buffer::FreeList();
+        index++;
     }
-    else if (IS_INITIALIZED(g_freeList))
+    uint64_t blockSize = uint64_t(1) << (index + POOL_MIN_SHIFT);
+    if (g_bufferPoolDestroyed || blockSize > g_poolMaxBlockSize.load(std::memory_order_relaxed))
     {
-        while (!g_freeList->empty())
+        if (!g_bufferPoolDestroyed)
         {
-            struct Buffer::Data* data = g_freeList->back();
-            g_freeList->pop_back();
-            if (data->m_size >= dataSize)
-            {
-                data->m_count = 1;
-                return data;
-            }
-            Buffer::Deallocate(data);
+            g_bufferPool.stats.misses++;
         }
+        struct Buffer::Data* data = Buffer::Allocate(dataSize);
+        NS_ASSERT(data->m_count == 1);
+        return data;
     }
-    struct Buffer::Data* data = Buffer::Allocate(dataSize);
-    NS_ASSERT(data->m_count == 1);
+
+    BufferPool& pool = g_bufferPool;
+    uint8_t* b;
+    if (pool.freeLists[index] != nullptr)
+    {
+        BufferPool::FreeBlock* block = pool.freeLists[index];
+        pool.freeLists[index] = block->next;
+        pool.cachedBytes -= blockSize;
+        pool.stats.cached--;
+        pool.stats.hits++;
+        b = reinterpret_cast<uint8_t*>(block);
+    }
+    else
+    {
+        pool.stats.misses++;
+        b = new uint8_t[blockSize];
+    }
+    struct Buffer::Data* data = reinterpret_cast<struct Buffer::Data*>(b);
+    data->m_size = blockSize + 1 - sizeof(struct Buffer::Data);
+    data->m_count = 1;
     return data;
 }
+
+Buffer::PoolStats
+Buffer::GetPoolStats()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    if (g_bufferPoolDestroyed)
+    {
+        return PoolStats{};
+    }
+    PoolStats stats = g_bufferPool.stats;
+    stats.cachedBytes = g_bufferPool.cachedBytes;
+    return stats;
+}
+
+void
+Buffer::SetPoolLimits(uint32_t maxBlockSize, uint64_t maxCachedBytes)
+{
+    NS_LOG_FUNCTION(maxBlockSize << maxCachedBytes);
+    g_poolMaxBlockSize.store(maxBlockSize, std::memory_order_relaxed);
+    g_poolMaxCachedBytes.store(maxCachedBytes, std::memory_order_relaxed);
+}
 #else  /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle(struct Buffer::Data* data)
@@ -158,9 +241,20 @@ Buffer::Create(uint32_t size)
     NS_LOG_FUNCTION(size);
     return Allocate(size);
 }
-#endif /* BUFFER_FREE_LIST */
 
-constexpr uint32_t ALLOC_OVER_PROVISION = 100; //!< Additional bytes to over-provision.
+Buffer::PoolStats
+Buffer::GetPoolStats()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    return PoolStats{};
+}
+
+void
+Buffer::SetPoolLimits(uint32_t maxBlockSize, uint64_t maxCachedBytes)
+{
+    NS_LOG_FUNCTION(maxBlockSize << maxCachedBytes);
+}
+#endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data*
 Buffer::Allocate(uint32_t reqSize)
@@ -225,7 +319,7 @@ Buffer::CheckInternalState() const
     m_zeroAreaEnd <= m_end;
   bool dirtyOk =
     m_start >= m_data->m_dirtyStart &&
-    m_end <= m_data->m_dirtyEnd;
+    GetInternalEnd () <= m_data->m_dirtyEnd;
   bool internalSizeOk = m_end - (m_zeroAreaEnd - m_zeroAreaStart) <= m_data->m_size &&
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
@@ -255,7 +349,7 @@ Buffer::Initialize(uint32_t zeroSize)
     m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
     m_end = m_zeroAreaEnd;
     m_data->m_dirtyStart = m_start;
-    m_data->m_dirtyEnd = m_end;
+    m_data->m_dirtyEnd = GetInternalEnd();
     NS_ASSERT(CheckInternalState());
 }
 
@@ -266,8 +360,7 @@ Buffer::operator=(const Buffer& o)
     if (m_data != o.m_data)
     {
         // not assignment to self.
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Recycle(m_data);
         }
@@ -289,8 +382,7 @@ Buffer::~Buffer()
     NS_LOG_FUNCTION(this);
     NS_ASSERT(CheckInternalState());
     g_recommendedStart = std::max(g_recommendedStart, m_maxZeroAreaStart);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         Recycle(m_data);
     }
@@ -310,31 +402,72 @@ Buffer::GetInternalEnd() const
     return m_end - (m_zeroAreaEnd - m_zeroAreaStart);
 }
 
+bool
+Buffer::ExtendDirtyStart(uint32_t start)
+{
+    NS_LOG_FUNCTION(this << start);
+    if (m_data->m_count == 1)
+    {
+        m_data->m_dirtyStart = start;
+        return true;
+    }
+#ifdef NS3_MTP
+    // The buffers which share the data may extend its dirty area concurrently
+    uint32_t expected = m_start;
+    return m_data->m_dirtyStart.compare_exchange_strong(expected, start);
+#else
+    if (m_start == m_data->m_dirtyStart)
+    {
+        m_data->m_dirtyStart = start;
+        return true;
+    }
+    return false;
+#endif
+}
+
+bool
+Buffer::ExtendDirtyEnd(uint32_t end)
+{
+    NS_LOG_FUNCTION(this << end);
+    if (m_data->m_count == 1)
+    {
+        m_data->m_dirtyEnd = end;
+        return true;
+    }
+#ifdef NS3_MTP
+    // The buffers which share the data may extend its dirty area concurrently
+    uint32_t expected = GetInternalEnd();
+    return m_data->m_dirtyEnd.compare_exchange_strong(expected, end);
+#else
+    if (GetInternalEnd() == m_data->m_dirtyEnd)
+    {
+        m_data->m_dirtyEnd = end;
+        return true;
+    }
+    return false;
+#endif
+}
+
 void
 Buffer::AddAtStart(uint32_t start)
 {
     NS_LOG_FUNCTION(this << start);
     NS_ASSERT(CheckInternalState());
-    bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
-    if (m_start >= start && !isDirty)
+    if (m_start >= start && ExtendDirtyStart(m_start - start))
     {
         /* enough space in the buffer and not dirty.
          * To add: |..|
          * Before: |*****---------***|
          * After:  |***..---------***|
          */
-        NS_ASSERT(m_data->m_count == 1 || m_start == m_data->m_dirtyStart);
         m_start -= start;
-        // update dirty area
-        m_data->m_dirtyStart = m_start;
     }
     else
     {
         uint32_t newSize = GetInternalSize() + start;
         struct Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data + start, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
@@ -349,7 +482,7 @@ Buffer::AddAtStart(uint32_t start)
 
         // update dirty area
         m_data->m_dirtyStart = m_start;
-        m_data->m_dirtyEnd = m_end;
+        m_data->m_dirtyEnd = GetInternalEnd();
     }
     m_maxZeroAreaStart = std::max(m_maxZeroAreaStart, m_zeroAreaStart);
     LOG_INTERNAL_STATE("add start=" << start << ", ");
@@ -361,26 +494,21 @@ Buffer::AddAtEnd(uint32_t end)
 {
     NS_LOG_FUNCTION(this << end);
     NS_ASSERT(CheckInternalState());
-    bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
-    if (GetInternalEnd() + end <= m_data->m_size && !isDirty)
+    if (GetInternalEnd() + end <= m_data->m_size && ExtendDirtyEnd(GetInternalEnd() + end))
     {
         /* enough space in buffer and not dirty
          * Add:    |...|
          * Before: |**----*****|
          * After:  |**----...**|
          */
-        NS_ASSERT(m_data->m_count == 1 || m_end == m_data->m_dirtyEnd);
         m_end += end;
-        // update dirty area.
-        m_data->m_dirtyEnd = m_end;
     }
     else
     {
         uint32_t newSize = GetInternalSize() + end;
         struct Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
@@ -395,7 +523,7 @@ Buffer::AddAtEnd(uint32_t end)
 
         // update dirty area
         m_data->m_dirtyStart = m_start;
-        m_data->m_dirtyEnd = m_end;
+        m_data->m_dirtyEnd = GetInternalEnd();
     }
     m_maxZeroAreaStart = std::max(m_maxZeroAreaStart, m_zeroAreaStart);
     LOG_INTERNAL_STATE("add end=" << end << ", ");
@@ -407,14 +535,15 @@ Buffer::AddAtEnd(const Buffer& o)
 {
     NS_LOG_FUNCTION(this << &o);
 
-    if (m_data->m_count == 1 && (m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
-        m_end == m_data->m_dirtyEnd && o.m_start == o.m_zeroAreaStart &&
-        o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
+    if ((m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
+        o.m_start == o.m_zeroAreaStart && o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
     {
         /**
          * This is an optimization which kicks in when
          * we attempt to aggregate two buffers which contain
-         * adjacent zero areas.
+         * adjacent zero areas. Growing the zero area does not
+         * touch the data, so that it is also valid when the data
+         * is shared: only the end data of o is copied, by AddAtEnd.
          */
         if (m_zeroAreaStart == m_zeroAreaEnd)
         {
@@ -423,7 +552,6 @@ Buffer::AddAtEnd(const Buffer& o)
         uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
         m_zeroAreaEnd = m_end + zeroSize;
         m_end = m_zeroAreaEnd;
-        m_data->m_dirtyEnd = m_zeroAreaEnd;
         uint32_t endData = o.m_end - o.m_zeroAreaEnd;
         AddAtEnd(endData);
         Buffer::Iterator dst = End();
@@ -435,7 +563,6 @@ Buffer::AddAtEnd(const Buffer& o)
         return;
     }
 
-    *this = CreateFullCopy();
     AddAtEnd(o.GetSize());
     Buffer::Iterator destStart = End();
     destStart.Prev(o.GetSize());
@@ -835,30 +962,39 @@ Buffer::Iterator::Write(Iterator start, Iterator end)
     NS_ASSERT(start.m_current <= end.m_current);
     NS_ASSERT(start.m_zeroStart == end.m_zeroStart);
     NS_ASSERT(start.m_zeroEnd == end.m_zeroEnd);
-    NS_ASSERT(m_data != start.m_data);
     uint32_t size = end.m_current - start.m_current;
     NS_ASSERT_MSG(CheckNoZero(m_current, m_current + size), GetWriteErrorMessage());
+    // the written bytes are either all before or all after the zero area
+    uint8_t* to = &m_data[m_current];
+    if (m_current >= m_zeroEnd)
+    {
+        to -= m_zeroEnd - m_zeroStart;
+    }
+    // The source may share the data of this buffer, when a buffer is
+    // appended to another copy of itself: the bytes written are then after
+    // the end of the source, in the area reserved by Buffer::AddAtEnd.
+    NS_ASSERT(m_data != start.m_data ||
+              to >= &start.m_data[start.m_dataEnd - (start.m_zeroEnd - start.m_zeroStart)]);
+    m_current += size;
     if (start.m_current <= start.m_zeroStart)
     {
         uint32_t toCopy = std::min(size, start.m_zeroStart - start.m_current);
-        memcpy(&m_data[m_current], &start.m_data[start.m_current], toCopy);
+        memcpy(to, &start.m_data[start.m_current], toCopy);
         start.m_current += toCopy;
-        m_current += toCopy;
+        to += toCopy;
         size -= toCopy;
     }
     if (start.m_current <= start.m_zeroEnd)
     {
         uint32_t toCopy = std::min(size, start.m_zeroEnd - start.m_current);
-        memset(&m_data[m_current], 0, toCopy);
+        memset(to, 0, toCopy);
         start.m_current += toCopy;
-        m_current += toCopy;
+        to += toCopy;
         size -= toCopy;
     }
     uint32_t toCopy = std::min(size, start.m_dataEnd - start.m_current);
     uint8_t* from = &start.m_data[start.m_current - (start.m_zeroEnd - start.m_zeroStart)];
-    uint8_t* to = &m_data[m_current];
     memcpy(to, from, toCopy);
-    m_current += toCopy;
 }
 
 void
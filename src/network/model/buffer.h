@@ -25,6 +25,10 @@
 #include <stdint.h>
 #include <vector>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 #define BUFFER_FREE_LIST 1
 
 namespace ns3
@@ -644,6 +648,44 @@ class Buffer
     Buffer(uint32_t dataSize, bool initialize);
     ~Buffer();
 
+    /**
+     * \brief Statistics of the buffer data pool of one thread.
+     */
+    struct PoolStats
+    {
+        uint64_t hits;        //!< Allocations served by the pool.
+        uint64_t misses;      //!< Allocations forwarded to the global allocator.
+        uint64_t releases;    //!< Deallocations kept in the pool.
+        uint64_t frees;       //!< Deallocations forwarded to the global allocator.
+        uint64_t cached;      //!< Blocks currently held by the pool.
+        uint64_t cachedBytes; //!< Bytes currently held by the pool.
+    };
+
+    /**
+     * \brief Get the statistics of the buffer data pool of the calling thread.
+     *
+     * \returns the pool statistics
+     */
+    static PoolStats GetPoolStats();
+
+    /**
+     * \brief Set the limits of the buffer data pools.
+     *
+     * The buffer data storage is allocated in blocks whose size is a power
+     * of two, and each thread keeps one free list of released blocks for
+     * each block size.  Blocks larger than \p maxBlockSize are not pooled,
+     * and the blocks released when the pool of a thread already holds
+     * \p maxCachedBytes bytes are returned to the global allocator.
+     *
+     * The limits apply to the pools of all the threads, and are usually set
+     * before the simulation starts.
+     *
+     * \param maxBlockSize the size of the largest pooled block, in bytes
+     * \param maxCachedBytes the maximum number of bytes held by the pool
+     *        of each thread
+     */
+    static void SetPoolLimits(uint32_t maxBlockSize, uint64_t maxCachedBytes);
+
   private:
     /**
      * This data structure is variable-sized through its last member whose size
@@ -658,6 +700,11 @@ class Buffer
      * New user data can be safely written only outside of the "dirty
      * area" if the reference count is higher than 1 (that is, if
      * more than one Buffer instance references the same BufferData).
+     *
+     * With the multithreaded simulator, the Buffer instances which
+     * reference the same BufferData may be used by different threads,
+     * hence the reference count and the bounds of the dirty area are
+     * atomic.
      */
     struct Data
     {
@@ -665,7 +712,11 @@ class Buffer
          * The reference count of an instance of this data structure.
          * Each buffer which references an instance holds a count.
          */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_count;
+#else
         uint32_t m_count;
+#endif
         /**
          * the size of the m_data field below.
          */
@@ -674,12 +725,20 @@ class Buffer
          * offset from the start of the m_data field below to the
          * start of the area in which user bytes were written.
          */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_dirtyStart;
+#else
         uint32_t m_dirtyStart;
+#endif
         /**
          * offset from the start of the m_data field below to the
          * end of the area in which user bytes were written.
          */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_dirtyEnd;
+#else
         uint32_t m_dirtyEnd;
+#endif
         /**
          * The real data buffer holds _at least_ one byte.
          * Its real size is stored in the m_size field.
@@ -728,6 +787,28 @@ class Buffer
      */
     uint32_t GetInternalEnd() const;
 
+    /**
+     * \brief Extend the dirty area to the bytes before the buffer start.
+     *
+     * The dirty area is not extended if another buffer which shares the
+     * data has already written bytes before the buffer start.
+     *
+     * \param start the new start of the dirty area
+     * \returns true if the dirty area was extended
+     */
+    bool ExtendDirtyStart(uint32_t start);
+
+    /**
+     * \brief Extend the dirty area to the bytes after the buffer end.
+     *
+     * The dirty area is not extended if another buffer which shares the
+     * data has already written bytes after the buffer end.
+     *
+     * \param end the new end of the dirty area
+     * \returns true if the dirty area was extended
+     */
+    bool ExtendDirtyEnd(uint32_t end);
+
     /**
      * \brief Recycle the buffer memory
      * \param data the buffer data storage
@@ -767,9 +848,14 @@ class Buffer
     /**
      * location in a newly-allocated buffer where you should start
      * writing data. i.e., m_start should be initialized to this
-     * value.
+     * value.  This heuristic is kept per thread with the
+     * multithreaded simulator.
      */
+#ifdef NS3_MTP
+    static thread_local uint32_t g_recommendedStart;
+#else
     static uint32_t g_recommendedStart;
+#endif
 
     /**
      * offset to the start of the virtual zero area from the start
@@ -791,21 +877,6 @@ class Buffer
      * instance from the start of m_data->m_data
      */
     uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-    /// Container for buffer data
-    typedef std::vector<struct Buffer::Data*> FreeList;
-
-    /// Local static destructor structure
-    struct LocalStaticDestructor
-    {
-        ~LocalStaticDestructor();
-    };
-
-    static uint32_t g_maxSize;                            //!< Max observed data size
-    static FreeList* g_freeList;                          //!< Buffer data container
-    static LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
@@ -20,6 +20,8 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <limits>
 #include <vector>
@@ -39,40 +41,104 @@ NS_LOG_COMPONENT_DEFINE("ByteTagList");
  * \brief Internal representation of the byte tags stored in a packet.
  *
  * This structure is only used by ByteTagList and should not be accessed directly.
+ * With the multithreaded simulator, the lists which share the data may be
+ * used by different threads, hence the use counter and the number of bytes
+ * in use are atomic.
  */
 struct ByteTagListData
 {
-    uint32_t size;   //!< size of the data
-    uint32_t count;  //!< use counter (for smart deallocation)
-    uint32_t dirty;  //!< number of bytes actually in use
+    uint32_t size; //!< size of the data
+#ifdef NS3_MTP
+    std::atomic<uint32_t> count; //!< use counter (for smart deallocation)
+    std::atomic<uint32_t> dirty; //!< number of bytes actually in use
+#else
+    uint32_t count; //!< use counter (for smart deallocation)
+    uint32_t dirty; //!< number of bytes actually in use
+#endif
     uint8_t data[4]; //!< data
 };
 
+namespace
+{
+
+/**
+ * \ingroup packet
+ * Extend the bytes in use of the tag data, unless another list which
+ * shares the data has already added tags after the bytes of a list.
+ *
+ * \param data the tag data
+ * \param used the number of bytes used by the list
+ * \param dirty the new number of bytes in use
+ * \returns true if the bytes in use were extended
+ */
+bool
+ExtendDirty(struct ByteTagListData* data, uint32_t used, uint32_t dirty)
+{
+    if (data->count == 1)
+    {
+        data->dirty = dirty;
+        return true;
+    }
+#ifdef NS3_MTP
+    // The lists which share the data may add tags concurrently
+    return data->dirty.compare_exchange_strong(used, dirty);
+#else
+    if (data->dirty == used)
+    {
+        data->dirty = dirty;
+        return true;
+    }
+    return false;
+#endif
+}
+
+} // namespace
+
 #ifdef USE_FREE_LIST
+namespace
+{
+
+/// Size of the smallest blocks of tag data: the blocks are powers of two.
+const uint32_t MIN_BLOCK_SIZE = 64;
+/// Number of block sizes recycled by the free lists.
+const std::size_t N_BLOCK_SIZES = 6;
+
 /**
  * \ingroup packet
  *
- * \brief Container class for struct ByteTagListData
+ * \brief Free lists of struct ByteTagListData, one per block size.
  *
- * Internal use only.
+ * There is one instance per thread, such that packets can be tagged
+ * concurrently by the threads of a parallel simulation.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData*>
+struct ByteTagListDataFreeList
 {
-  public:
+    /// Destructor: deallocate the blocks of the free lists
     ~ByteTagListDataFreeList();
-} g_freeList; //!< Container for struct ByteTagListData
+    /// The free blocks, by block size
+    std::vector<struct ByteTagListData*> m_blocks[N_BLOCK_SIZES];
+};
 
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+/// Has the free list of this thread been destroyed?
+thread_local bool g_freeListDestroyed = false;
+/// Container for struct ByteTagListData
+thread_local ByteTagListDataFreeList g_freeList;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList()
 {
-    NS_LOG_FUNCTION(this);
-    for (ByteTagListDataFreeList::iterator i = begin(); i != end(); i++)
+    for (auto& blocks : m_blocks)
     {
-        uint8_t* buffer = (uint8_t*)(*i);
-        delete[] buffer;
+        for (auto data : blocks)
+        {
+            uint8_t* buffer = (uint8_t*)data;
+            delete[] buffer;
+        }
+        blocks.clear();
     }
+    g_freeListDestroyed = true;
 }
+
+} // unnamed namespace
 #endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item(TagBuffer buf_)
@@ -211,7 +277,7 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         m_data = Allocate(spaceNeeded);
         m_used = 0;
     }
-    else if (m_data->size < spaceNeeded || (m_data->count != 1 && m_data->dirty != m_used))
+    else if (m_data->size < spaceNeeded || !ExtendDirty(m_data, m_used, spaceNeeded))
     {
         struct ByteTagListData* newData = Allocate(spaceNeeded);
         std::memcpy(&newData->data, &m_data->data, m_used);
@@ -292,28 +358,7 @@ ByteTagList::AddAtEnd(int32_t appendOffset)
     {
         return;
     }
-    ByteTagList list;
-    ByteTagList::Iterator i = BeginAll();
-    while (i.HasNext())
-    {
-        ByteTagList::Iterator::Item item = i.Next();
-
-        if (item.start >= appendOffset)
-        {
-            continue;
-        }
-        if (item.end > appendOffset)
-        {
-            item.end = appendOffset;
-        }
-        TagBuffer buf = list.Add(item.tid, item.size, item.start, item.end);
-        buf.CopyFrom(item.buf);
-        if (item.end > m_maxEnd)
-        {
-            m_maxEnd = item.end;
-        }
-    }
-    *this = list;
+    Clip(0, appendOffset);
 }
 
 void
@@ -324,29 +369,61 @@ ByteTagList::AddAtStart(int32_t prependOffset)
     {
         return;
     }
-    m_minStart = INT32_MAX;
-    ByteTagList list;
-    ByteTagList::Iterator i = BeginAll();
-    while (i.HasNext())
-    {
-        ByteTagList::Iterator::Item item = i.Next();
+    Clip(prependOffset, OFFSET_MAX);
+}
 
-        if (item.end <= prependOffset)
-        {
-            continue;
-        }
-        if (item.start < prependOffset)
+void
+ByteTagList::Clip(int32_t offsetStart, int32_t offsetEnd)
+{
+    NS_LOG_FUNCTION(this << offsetStart << offsetEnd);
+    NS_ASSERT(m_data != nullptr);
+    if (m_data->count != 1)
+    {
+        // Shared: copy the tags which are kept in a new list
+        ByteTagList list;
+        ByteTagList::Iterator i = Begin(offsetStart, offsetEnd);
+        while (i.HasNext())
         {
-            item.start = prependOffset;
+            ByteTagList::Iterator::Item item = i.Next();
+            TagBuffer buf = list.Add(item.tid, item.size, item.start, item.end);
+            buf.CopyFrom(item.buf);
         }
-        TagBuffer buf = list.Add(item.tid, item.size, item.start, item.end);
-        buf.CopyFrom(item.buf);
-        if (item.start < m_minStart)
+        *this = list;
+        return;
+    }
+
+    // Not shared: clip the tags and compact the list in place
+    m_minStart = INT32_MAX;
+    m_maxEnd = INT32_MIN;
+    uint8_t* current = m_data->data;
+    uint8_t* end = &m_data->data[m_used];
+    uint8_t* kept = m_data->data;
+    while (current < end)
+    {
+        TagBuffer buf = TagBuffer(current + 4, end); // skip the tid
+        uint32_t size = buf.ReadU32();
+        int32_t start = buf.ReadU32() + m_adjustment;
+        int32_t stop = buf.ReadU32() + m_adjustment;
+        uint32_t itemSize = 4 + 4 + 4 + 4 + size;
+        if (start < offsetEnd && stop > offsetStart)
         {
-            m_minStart = item.start;
+            start = std::max(start, offsetStart) - m_adjustment;
+            stop = std::min(stop, offsetEnd) - m_adjustment;
+            if (kept != current)
+            {
+                std::memmove(kept, current, itemSize);
+            }
+            buf = TagBuffer(kept + 8, kept + 16);
+            buf.WriteU32(start);
+            buf.WriteU32(stop);
+            m_minStart = std::min(m_minStart, start);
+            m_maxEnd = std::max(m_maxEnd, stop);
+            kept += itemSize;
         }
+        current += itemSize;
     }
-    *this = list;
+    m_used = kept - m_data->data;
+    m_data->dirty = m_used;
 }
 
 #ifdef USE_FREE_LIST
@@ -355,24 +432,28 @@ struct ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    while (!g_freeList.empty())
+    // Round up to a power of two, such that a list which grows one tag
+    // at a time is reallocated a logarithmic number of times.
+    std::size_t index = 0;
+    uint32_t blockSize = MIN_BLOCK_SIZE;
+    while (blockSize < size)
     {
-        struct ByteTagListData* data = g_freeList.back();
-        g_freeList.pop_back();
-        NS_ASSERT(data != nullptr);
-        if (data->size >= size)
-        {
-            data->count = 1;
-            data->dirty = 0;
-            return data;
-        }
-        uint8_t* buffer = (uint8_t*)data;
-        delete[] buffer;
+        blockSize *= 2;
+        index++;
+    }
+    if (index < N_BLOCK_SIZES && !g_freeListDestroyed && !g_freeList.m_blocks[index].empty())
+    {
+        struct ByteTagListData* data = g_freeList.m_blocks[index].back();
+        g_freeList.m_blocks[index].pop_back();
+        NS_ASSERT(data != nullptr && data->size == blockSize);
+        data->count = 1;
+        data->dirty = 0;
+        return data;
     }
-    uint8_t* buffer = new uint8_t[std::max(size, g_maxSize) + sizeof(struct ByteTagListData) - 4];
+    uint8_t* buffer = new uint8_t[blockSize + sizeof(struct ByteTagListData) - 4];
     struct ByteTagListData* data = (struct ByteTagListData*)buffer;
     data->count = 1;
-    data->size = size;
+    data->size = blockSize;
     data->dirty = 0;
     return data;
 }
@@ -385,18 +466,22 @@ ByteTagList::Deallocate(struct ByteTagListData* data)
     {
         return;
     }
-    g_maxSize = std::max(g_maxSize, data->size);
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
-        if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
+        std::size_t index = 0;
+        while (index < N_BLOCK_SIZES && (MIN_BLOCK_SIZE << index) != data->size)
+        {
+            index++;
+        }
+        if (index == N_BLOCK_SIZES || g_freeListDestroyed ||
+            g_freeList.m_blocks[index].size() >= FREE_LIST_SIZE)
         {
             uint8_t* buffer = (uint8_t*)data;
             delete[] buffer;
         }
         else
         {
-            g_freeList.push_back(data);
+            g_freeList.m_blocks[index].push_back(data);
         }
     }
 }
@@ -423,8 +508,7 @@ ByteTagList::Deallocate(struct ByteTagListData* data)
     {
         return;
     }
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
         uint8_t* buffer = (uint8_t*)data;
         delete[] buffer;
@@ -49,7 +49,8 @@ struct ByteTagListData;
  *
  *   - The struct ByteTagListData structure which contains the tag byte buffer
  *     is shared and, thus, reference-counted. This data structure is unshared
- *     as-needed to emulate COW semantics.
+ *     as-needed to emulate COW semantics. Its size is a power of two, and
+ *     the unused structures are kept in per-thread free lists.
  *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are relative to the start of the packet
@@ -60,7 +61,8 @@ struct ByteTagListData;
  *     boundaries remain in ByteTagList. It is not a problem as iterator fixes
  *     the boundaries before returning item. However, when packet is extending,
  *     it calls ByteTagList::AddAtStart or ByteTagList::AddAtEnd to cut byte
- *     tags that will otherwise cover new bytes.
+ *     tags that will otherwise cover new bytes. The tags are cut in place
+ *     unless the list is shared.
  */
 class ByteTagList
 {
@@ -270,6 +272,16 @@ class ByteTagList
      */
     ByteTagList::Iterator BeginAll() const;
 
+    /**
+     * \brief Remove the tags outside of an interval and trim the others.
+     *
+     * The tags are modified in place when the list is not shared.
+     *
+     * \param offsetStart the start of the interval
+     * \param offsetEnd the end of the interval
+     */
+    void Clip(int32_t offsetStart, int32_t offsetEnd);
+
     /**
      * \brief Allocate the memory for the ByteTagListData
      * \param size the memory to allocate
@@ -22,40 +22,75 @@
 #include "header.h"
 #include "trailer.h"
 
+#include "ns3/abort.h"
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 
-#include <list>
-#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("PacketMetadata");
 
-bool PacketMetadata::m_enable = false;
-bool PacketMetadata::m_enableChecking = false;
-bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+namespace
+{
 
-PacketMetadata::DataFreeList::~DataFreeList()
+/// Number of items of the storages allocated by default, and recycled.
+const uint16_t DEFAULT_CAPACITY = 8;
+/// Maximum number of storages kept in the free list of each thread.
+const std::size_t MAX_FREE_DATA = 1000;
+
+/**
+ * \ingroup packet
+ * \brief Free list of the storages of the default capacity.
+ *
+ * There is one free list per thread, such that packets can be created
+ * and destroyed concurrently by the threads of a parallel simulation.
+ */
+struct DataFreeList
 {
-    NS_LOG_FUNCTION(this);
-    for (iterator i = begin(); i != end(); i++)
+    /// Destructor: deallocate the storages of the free list
+    ~DataFreeList();
+    /// The free storages
+    std::vector<uint8_t*> m_blocks;
+};
+
+/// Has the free list of this thread been destroyed?
+thread_local bool g_dataFreeListDestroyed = false;
+/// The free list of this thread
+thread_local DataFreeList g_dataFreeList;
+
+DataFreeList::~DataFreeList()
+{
+    for (auto block : m_blocks)
     {
-        PacketMetadata::Deallocate(*i);
+        delete[] block;
     }
-    PacketMetadata::m_enable = false;
+    m_blocks.clear();
+    g_dataFreeListDestroyed = true;
 }
 
+} // unnamed namespace
+
+bool PacketMetadata::m_enable = false;
+bool PacketMetadata::m_enableChecking = false;
+std::atomic<bool> PacketMetadata::m_metadataSkipped{false};
+#ifdef NS3_MTP
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+#else
+uint16_t PacketMetadata::m_chunkUid = 0;
+#endif
+
 void
 PacketMetadata::Enable()
 {
     NS_LOG_FUNCTION_NOARGS();
-    NS_ASSERT_MSG(!m_metadataSkipped,
+    NS_ASSERT_MSG(!m_metadataSkipped.load(std::memory_order_relaxed),
                   "Error: attempting to enable the packet metadata "
                   "subsystem too late in the simulation, which is not allowed.\n"
                   "A common cause for this problem is to enable ASCII tracing "
@@ -73,567 +108,241 @@ PacketMetadata::EnableChecking()
     m_enableChecking = true;
 }
 
-void
-PacketMetadata::ReserveCopy(uint32_t size)
-{
-    NS_LOG_FUNCTION(this << size);
-    struct PacketMetadata::Data* newData = PacketMetadata::Create(m_used + size);
-    memcpy(newData->m_data, m_data->m_data, m_used);
-    newData->m_dirtyEnd = m_used;
-    m_data->m_count--;
-    if (m_data->m_count == 0)
-    {
-        PacketMetadata::Recycle(m_data);
-    }
-    m_data = newData;
-    if (m_head != 0xffff)
-    {
-        uint8_t* start;
-        NS_ASSERT(m_tail != 0xffff);
-        // clear the next field of the tail
-        start = &m_data->m_data[m_tail];
-        Append16(0xffff, start);
-        // clear the prev field of the head
-        start = &m_data->m_data[m_head] + 2;
-        Append16(0xffff, start);
-    }
+struct PacketMetadata::Data*
+PacketMetadata::Allocate(uint16_t capacity)
+{
+    NS_LOG_FUNCTION(capacity);
+    // The arrays are sorted by decreasing alignment, right after the
+    // structure, whose size is a multiple of the alignment of its pointers.
+    std::size_t itemSize = sizeof(uint64_t) + 3 * sizeof(uint32_t) + 2 * sizeof(uint16_t) +
+                           sizeof(uint8_t);
+    uint8_t* block = new uint8_t[sizeof(struct Data) + capacity * itemSize];
+    auto data = reinterpret_cast<struct PacketMetadata::Data*>(block);
+    uint8_t* current = block + sizeof(struct Data);
+    data->m_packetUid = reinterpret_cast<uint64_t*>(current);
+    current += capacity * sizeof(uint64_t);
+    data->m_size = reinterpret_cast<uint32_t*>(current);
+    current += capacity * sizeof(uint32_t);
+    data->m_fragmentStart = reinterpret_cast<uint32_t*>(current);
+    current += capacity * sizeof(uint32_t);
+    data->m_fragmentEnd = reinterpret_cast<uint32_t*>(current);
+    current += capacity * sizeof(uint32_t);
+    data->m_typeUid = reinterpret_cast<uint16_t*>(current);
+    current += capacity * sizeof(uint16_t);
+    data->m_chunkUid = reinterpret_cast<uint16_t*>(current);
+    current += capacity * sizeof(uint16_t);
+    data->m_type = current;
+    data->m_capacity = capacity;
+    data->m_count = 1;
+    return data;
 }
 
 void
-PacketMetadata::Reserve(uint32_t size)
-{
-    NS_LOG_FUNCTION(this << size);
-    NS_ASSERT(m_data != nullptr);
-    if (m_data->m_size >= m_used + size &&
-        (m_head == 0xffff || m_data->m_count == 1 || m_data->m_dirtyEnd == m_used))
-    {
-        /* enough room, not dirty. */
-    }
-    else
-    {
-        /* (enough room and dirty) or (not enough room) */
-        ReserveCopy(size);
-    }
-}
-
-bool
-PacketMetadata::IsSharedPointerOk(uint16_t pointer) const
-{
-    NS_LOG_FUNCTION(this << pointer);
-    bool ok = pointer == 0xffff || pointer <= m_data->m_size;
-    return ok;
-}
-
-bool
-PacketMetadata::IsPointerOk(uint16_t pointer) const
-{
-    NS_LOG_FUNCTION(this << pointer);
-    bool ok = pointer == 0xffff || pointer <= m_used;
-    return ok;
-}
-
-bool
-PacketMetadata::IsStateOk() const
+PacketMetadata::Deallocate(struct PacketMetadata::Data* data)
 {
-    NS_LOG_FUNCTION(this);
-    bool ok = m_used <= m_data->m_size;
-    ok &= IsPointerOk(m_head);
-    ok &= IsPointerOk(m_tail);
-    uint16_t current = m_head;
-    while (ok && current != 0xffff)
-    {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        ok &= IsSharedPointerOk(item.next);
-        ok &= IsSharedPointerOk(item.prev);
-        if (current != m_head)
-        {
-            ok &= IsPointerOk(item.prev);
-        }
-        if (current != m_tail)
-        {
-            ok &= IsPointerOk(item.next);
-        }
-        if (current == m_tail)
-        {
-            break;
-        }
-        current = item.next;
-    }
-    return ok;
+    NS_LOG_FUNCTION(data);
+    auto block = reinterpret_cast<uint8_t*>(data);
+    delete[] block;
 }
 
-uint32_t
-PacketMetadata::GetUleb128Size(uint32_t value) const
+struct PacketMetadata::Data*
+PacketMetadata::Create(uint16_t capacity)
 {
-    NS_LOG_FUNCTION(this << value);
-    if (value < 0x80)
-    {
-        return 1;
-    }
-    if (value < 0x4000)
-    {
-        return 2;
-    }
-    if (value < 0x200000)
+    NS_LOG_LOGIC("create capacity=" << capacity);
+    struct PacketMetadata::Data* data;
+    if (capacity <= DEFAULT_CAPACITY && !g_dataFreeListDestroyed &&
+        !g_dataFreeList.m_blocks.empty())
     {
-        return 3;
+        data = reinterpret_cast<struct PacketMetadata::Data*>(g_dataFreeList.m_blocks.back());
+        g_dataFreeList.m_blocks.pop_back();
+        data->m_count = 1;
     }
-    if (value < 0x10000000)
+    else
     {
-        return 4;
+        data = PacketMetadata::Allocate(std::max(capacity, DEFAULT_CAPACITY));
     }
-    return 5;
+    NS_LOG_LOGIC("create alloc capacity=" << data->m_capacity);
+    return data;
 }
 
-uint32_t
-PacketMetadata::ReadUleb128(const uint8_t** pBuffer) const
+void
+PacketMetadata::Recycle(struct PacketMetadata::Data* data)
 {
-    NS_LOG_FUNCTION(this << &pBuffer);
-    const uint8_t* buffer = *pBuffer;
-    uint32_t result;
-    uint8_t byte;
-
-    byte = buffer[0];
-    result = (byte & (~0x80));
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 1;
-        return result;
-    }
-    byte = buffer[1];
-    result |= (byte & (~0x80)) << 7;
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 2;
-        return result;
-    }
-    byte = buffer[2];
-    result |= (byte & (~0x80)) << 14;
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 3;
-        return result;
-    }
-    byte = buffer[3];
-    result |= (byte & (~0x80)) << 21;
-    if (!(byte & 0x80))
+    NS_LOG_FUNCTION(data);
+    NS_ASSERT(data->m_count == 0);
+    if (data->m_capacity == DEFAULT_CAPACITY && !g_dataFreeListDestroyed &&
+        g_dataFreeList.m_blocks.size() < MAX_FREE_DATA)
     {
-        *pBuffer = buffer + 4;
-        return result;
+        g_dataFreeList.m_blocks.push_back(reinterpret_cast<uint8_t*>(data));
     }
-    byte = buffer[4];
-    result |= (byte & (~0x80)) << 28;
-    if (!(byte & 0x80))
+    else
     {
-        *pBuffer = buffer + 5;
-        return result;
+        PacketMetadata::Deallocate(data);
     }
-    /* This means that the LEB128 number was not valid.
-     * ie: the last (5th) byte did not have the high-order bit zeroed.
-     */
-    NS_ASSERT(false);
-    return 0;
 }
 
 void
-PacketMetadata::Append16(uint16_t value, uint8_t* buffer)
-{
-    NS_LOG_FUNCTION(this << value << &buffer);
-    buffer[0] = value & 0xff;
-    value >>= 8;
-    buffer[1] = value;
-}
-
-void
-PacketMetadata::Append32(uint32_t value, uint8_t* buffer)
-{
-    NS_LOG_FUNCTION(this << value << &buffer);
-    buffer[0] = value & 0xff;
-    buffer[1] = (value >> 8) & 0xff;
-    buffer[2] = (value >> 16) & 0xff;
-    buffer[3] = (value >> 24) & 0xff;
+PacketMetadata::CopyItems(const struct PacketMetadata::Data* from,
+                          uint16_t fromIndex,
+                          struct PacketMetadata::Data* to,
+                          uint16_t toIndex,
+                          uint16_t n)
+{
+    NS_ASSERT(fromIndex + n <= from->m_capacity && toIndex + n <= to->m_capacity);
+    std::memcpy(&to->m_packetUid[toIndex], &from->m_packetUid[fromIndex], n * sizeof(uint64_t));
+    std::memcpy(&to->m_size[toIndex], &from->m_size[fromIndex], n * sizeof(uint32_t));
+    std::memcpy(&to->m_fragmentStart[toIndex],
+                &from->m_fragmentStart[fromIndex],
+                n * sizeof(uint32_t));
+    std::memcpy(&to->m_fragmentEnd[toIndex],
+                &from->m_fragmentEnd[fromIndex],
+                n * sizeof(uint32_t));
+    std::memcpy(&to->m_typeUid[toIndex], &from->m_typeUid[fromIndex], n * sizeof(uint16_t));
+    std::memcpy(&to->m_chunkUid[toIndex], &from->m_chunkUid[fromIndex], n * sizeof(uint16_t));
+    std::memcpy(&to->m_type[toIndex], &from->m_type[fromIndex], n * sizeof(uint8_t));
 }
 
 void
-PacketMetadata::AppendValueExtra(uint32_t value, uint8_t* buffer)
+PacketMetadata::ReserveCopy(uint16_t head, uint16_t tail)
 {
-    NS_LOG_FUNCTION(this << value << &buffer);
-    if (value < 0x200000)
+    NS_LOG_FUNCTION(this << head << tail);
+    uint32_t n = m_tail - m_head;
+    uint32_t needed = n + head + tail;
+    NS_ABORT_MSG_IF(needed > std::numeric_limits<uint16_t>::max(),
+                    "Too many items in the packet metadata");
+    // Leave room to grow at both ends, trailers and concatenated packets
+    // being less frequent than headers.
+    uint32_t capacity = DEFAULT_CAPACITY;
+    while (capacity < 2 * needed && capacity < 0x8000)
     {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[1] = 0x80 | byte;
-        value >>= 7;
-        buffer[2] = value;
-        return;
+        capacity *= 2;
     }
-    if (value < 0x10000000)
+    capacity = std::max(capacity, needed);
+    uint32_t free = capacity - n;
+    uint32_t backFree = std::max<uint32_t>(tail, std::min(free / 4, free - head));
+    uint16_t front = free - backFree;
+
+    struct PacketMetadata::Data* newData = PacketMetadata::Create(capacity);
+    if (n > 0)
     {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[1] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[2] = 0x80 | byte;
-        value >>= 7;
-        buffer[3] = value;
-        return;
+        CopyItems(m_data, m_head, newData, front, n);
     }
+    if (m_data != nullptr)
     {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[1] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[2] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[3] = 0x80 | byte;
-        value >>= 7;
-        buffer[4] = value;
+        if (--m_data->m_count == 0)
+        {
+            PacketMetadata::Recycle(m_data);
+        }
     }
+    m_data = newData;
+    m_head = front;
+    m_tail = front + n;
+    m_data->m_dirtyStart = m_head;
+    m_data->m_dirtyEnd = m_tail;
 }
 
 void
-PacketMetadata::AppendValue(uint32_t value, uint8_t* buffer)
+PacketMetadata::ReserveHead(uint16_t n)
 {
-    NS_LOG_FUNCTION(this << value << &buffer);
-    if (value < 0x80)
-    {
-        buffer[0] = value;
-        return;
-    }
-    if (value < 0x4000)
+    // The free slots before the first item can be written in place if no
+    // other copy uses them.
+    if (m_data == nullptr || m_head < n || !ExtendDirtyStart(m_head - n))
     {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        buffer[1] = value;
-        return;
+        ReserveCopy(n, 0);
+        m_data->m_dirtyStart = m_head - n;
     }
-    AppendValueExtra(value, buffer);
 }
 
 void
-PacketMetadata::UpdateTail(uint16_t written)
+PacketMetadata::ReserveTail(uint16_t n)
 {
-    NS_LOG_FUNCTION(this << written);
-    if (m_head == 0xffff)
-    {
-        NS_ASSERT(m_tail == 0xffff);
-        m_head = m_used;
-        m_tail = m_used;
-    }
-    else
+    // The free slots after the last item can be written in place if no
+    // other copy uses them.
+    if (m_data == nullptr || m_tail + n > m_data->m_capacity || !ExtendDirtyEnd(m_tail + n))
     {
-        NS_ASSERT(m_tail != 0xffff);
-        // overwrite the next field of the previous tail of the list.
-        uint8_t* previousTail = &m_data->m_data[m_tail];
-        Append16(m_used, previousTail);
-        // update the tail of the list to the new node.
-        m_tail = m_used;
+        ReserveCopy(0, n);
+        m_data->m_dirtyEnd = m_tail + n;
     }
-    NS_ASSERT(m_tail != 0xffff);
-    NS_ASSERT(m_head != 0xffff);
-    NS_ASSERT(written >= 8);
-    m_used += written;
-    m_data->m_dirtyEnd = m_used;
 }
 
-void
-PacketMetadata::UpdateHead(uint16_t written)
+bool
+PacketMetadata::ExtendDirtyStart(uint16_t start)
 {
-    NS_LOG_FUNCTION(this << written);
-    if (m_head == 0xffff)
+    if (m_data->m_count == 1)
     {
-        NS_ASSERT(m_tail == 0xffff);
-        m_head = m_used;
-        m_tail = m_used;
+        m_data->m_dirtyStart = start;
+        return true;
     }
-    else
+#ifdef NS3_MTP
+    // The copies which share the items may extend the dirty area concurrently
+    uint16_t expected = m_head;
+    return m_data->m_dirtyStart.compare_exchange_strong(expected, start);
+#else
+    if (m_head == m_data->m_dirtyStart)
     {
-        NS_ASSERT(m_head != 0xffff);
-        // overwrite the prev field of the previous head of the list.
-        uint8_t* previousHead = &m_data->m_data[m_head + 2];
-        Append16(m_used, previousHead);
-        // update the head of list to the new node.
-        m_head = m_used;
+        m_data->m_dirtyStart = start;
+        return true;
     }
-    NS_ASSERT(m_tail != 0xffff);
-    NS_ASSERT(m_head != 0xffff);
-    NS_ASSERT(written >= 8);
-    m_used += written;
-    m_data->m_dirtyEnd = m_used;
+    return false;
+#endif
 }
 
-uint16_t
-PacketMetadata::AddSmall(const struct PacketMetadata::SmallItem* item)
+bool
+PacketMetadata::ExtendDirtyEnd(uint16_t end)
 {
-    NS_LOG_FUNCTION(this << item->next << item->prev << item->typeUid << item->size
-                         << item->chunkUid);
-    NS_ASSERT(m_data != nullptr);
-    NS_ASSERT(m_used != item->prev && m_used != item->next);
-    uint32_t typeUidSize = GetUleb128Size(item->typeUid);
-    uint32_t sizeSize = GetUleb128Size(item->size);
-    uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2;
-    if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+    if (m_data->m_count == 1)
     {
-        ReserveCopy(n);
+        m_data->m_dirtyEnd = end;
+        return true;
     }
-    uint8_t* buffer = &m_data->m_data[m_used];
-    Append16(item->next, buffer);
-    buffer += 2;
-    Append16(item->prev, buffer);
-    buffer += 2;
-    AppendValue(item->typeUid, buffer);
-    buffer += typeUidSize;
-    AppendValue(item->size, buffer);
-    buffer += sizeSize;
-    Append16(item->chunkUid, buffer);
-    return n;
-}
-
-uint16_t
-PacketMetadata::AddBig(uint32_t next,
-                       uint32_t prev,
-                       const PacketMetadata::SmallItem* item,
-                       const PacketMetadata::ExtraItem* extraItem)
-{
-    NS_LOG_FUNCTION(this << next << prev << item->next << item->prev << item->typeUid << item->size
-                         << item->chunkUid << extraItem->fragmentStart << extraItem->fragmentEnd
-                         << extraItem->packetUid);
-    NS_ASSERT(m_data != nullptr);
-    uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid + 1;
-    NS_ASSERT(m_used != prev && m_used != next);
-
-    uint32_t typeUidSize = GetUleb128Size(typeUid);
-    uint32_t sizeSize = GetUleb128Size(item->size);
-    uint32_t fragStartSize = GetUleb128Size(extraItem->fragmentStart);
-    uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
-    uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-    if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+#ifdef NS3_MTP
+    // The copies which share the items may extend the dirty area concurrently
+    uint16_t expected = m_tail;
+    return m_data->m_dirtyEnd.compare_exchange_strong(expected, end);
+#else
+    if (m_tail == m_data->m_dirtyEnd)
     {
-        ReserveCopy(n);
+        m_data->m_dirtyEnd = end;
+        return true;
     }
-
-    uint8_t* buffer = &m_data->m_data[m_used];
-
-    Append16(next, buffer);
-    buffer += 2;
-    Append16(prev, buffer);
-    buffer += 2;
-    AppendValue(typeUid, buffer);
-    buffer += typeUidSize;
-    AppendValue(item->size, buffer);
-    buffer += sizeSize;
-    Append16(item->chunkUid, buffer);
-    buffer += 2;
-    AppendValue(extraItem->fragmentStart, buffer);
-    buffer += fragStartSize;
-    AppendValue(extraItem->fragmentEnd, buffer);
-    buffer += fragEndSize;
-    Append32(extraItem->packetUid, buffer);
-
-    return n;
+    return false;
+#endif
 }
 
 void
-PacketMetadata::ReplaceTail(PacketMetadata::SmallItem* item,
-                            PacketMetadata::ExtraItem* extraItem,
-                            uint32_t available)
+PacketMetadata::Unshare()
 {
-    NS_LOG_FUNCTION(this << item->next << item->prev << item->typeUid << item->size
-                         << item->chunkUid << extraItem->fragmentStart << extraItem->fragmentEnd
-                         << extraItem->packetUid << available);
-
     NS_ASSERT(m_data != nullptr);
-    /* If the tail we want to replace is located at the end of the data array,
-     * and if there is extra room at the end of this array, then,
-     * we can try to use that extra space to avoid falling in the slow
-     * path below.
-     */
-    if (m_tail + available == m_used && m_used == m_data->m_dirtyEnd)
-    {
-        available = m_data->m_size - m_tail;
-    }
-
-    uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid + 1;
-    uint32_t typeUidSize = GetUleb128Size(typeUid);
-    uint32_t sizeSize = GetUleb128Size(item->size);
-    uint32_t fragStartSize = GetUleb128Size(extraItem->fragmentStart);
-    uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
-    uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-    if (available >= n && m_data->m_count == 1)
-    {
-        uint8_t* buffer = &m_data->m_data[m_tail];
-        Append16(item->next, buffer);
-        buffer += 2;
-        Append16(item->prev, buffer);
-        buffer += 2;
-        AppendValue(typeUid, buffer);
-        buffer += typeUidSize;
-        AppendValue(item->size, buffer);
-        buffer += sizeSize;
-        Append16(item->chunkUid, buffer);
-        buffer += 2;
-        AppendValue(extraItem->fragmentStart, buffer);
-        buffer += fragStartSize;
-        AppendValue(extraItem->fragmentEnd, buffer);
-        buffer += fragEndSize;
-        Append32(extraItem->packetUid, buffer);
-        m_used = std::max(m_used, (uint16_t)(buffer - &m_data->m_data[0]));
-        m_data->m_dirtyEnd = m_used;
-        return;
-    }
-
-    /* Below is the slow path which is hit if the new tail we want
-     * to append is bigger than the previous tail.
-     */
-
-    // create a copy of the packet without its tail.
-    PacketMetadata h(m_packetUid, 0);
-    uint16_t current = m_head;
-    while (current != 0xffff && current != m_tail)
-    {
-        struct PacketMetadata::SmallItem tmpItem;
-        PacketMetadata::ExtraItem tmpExtraItem;
-        ReadItems(current, &tmpItem, &tmpExtraItem);
-        uint16_t written = h.AddBig(0xffff, h.m_tail, &tmpItem, &tmpExtraItem);
-        h.UpdateTail(written);
-        current = tmpItem.next;
-    }
-    // append new tail.
-    uint16_t written = h.AddBig(0xffff, h.m_tail, item, extraItem);
-    h.UpdateTail(written);
-
-    *this = h;
-}
-
-uint32_t
-PacketMetadata::ReadItems(uint16_t current,
-                          struct PacketMetadata::SmallItem* item,
-                          struct PacketMetadata::ExtraItem* extraItem) const
-{
-    NS_LOG_FUNCTION(this << current << item->chunkUid << item->prev << item->next << item->size
-                         << item->typeUid << extraItem->fragmentEnd << extraItem->fragmentStart
-                         << extraItem->packetUid);
-    NS_ASSERT(current <= m_data->m_size);
-    const uint8_t* buffer = &m_data->m_data[current];
-    item->next = buffer[0];
-    item->next |= (buffer[1]) << 8;
-    item->prev = buffer[2];
-    item->prev |= (buffer[3]) << 8;
-    buffer += 4;
-    item->typeUid = ReadUleb128(&buffer);
-    item->size = ReadUleb128(&buffer);
-    item->chunkUid = buffer[0];
-    item->chunkUid |= (buffer[1]) << 8;
-    buffer += 2;
-
-    bool isExtra = (item->typeUid & 0x1) == 0x1;
-    if (isExtra)
-    {
-        extraItem->fragmentStart = ReadUleb128(&buffer);
-        extraItem->fragmentEnd = ReadUleb128(&buffer);
-        extraItem->packetUid = buffer[0];
-        extraItem->packetUid |= buffer[1] << 8;
-        extraItem->packetUid |= buffer[2] << 16;
-        extraItem->packetUid |= buffer[3] << 24;
-        buffer += 4;
-    }
-    else
+    if (m_data->m_count > 1)
     {
-        extraItem->fragmentStart = 0;
-        extraItem->fragmentEnd = item->size;
-        extraItem->packetUid = m_packetUid;
+        ReserveCopy(0, 0);
     }
-    NS_ASSERT(buffer <= &m_data->m_data[m_data->m_size]);
-    return buffer - &m_data->m_data[current];
 }
 
-struct PacketMetadata::Data*
-PacketMetadata::Create(uint32_t size)
+void
+PacketMetadata::AddItemAtEnd(const ItemData& item)
 {
-    NS_LOG_FUNCTION(size);
-    NS_LOG_LOGIC("create size=" << size << ", max=" << m_maxSize);
-    if (size > m_maxSize)
-    {
-        m_maxSize = size;
-    }
-    while (!m_freeList.empty())
-    {
-        struct PacketMetadata::Data* data = m_freeList.back();
-        m_freeList.pop_back();
-        if (data->m_size >= size)
-        {
-            NS_LOG_LOGIC("create found size=" << data->m_size);
-            data->m_count = 1;
-            return data;
-        }
-        NS_LOG_LOGIC("create dealloc size=" << data->m_size);
-        PacketMetadata::Deallocate(data);
-    }
-    NS_LOG_LOGIC("create alloc size=" << m_maxSize);
-    return PacketMetadata::Allocate(m_maxSize);
+    ReserveTail(1);
+    WriteItem(m_tail, item);
+    m_tail++;
 }
 
-void
-PacketMetadata::Recycle(struct PacketMetadata::Data* data)
+bool
+PacketMetadata::IsStateOk() const
 {
-    NS_LOG_FUNCTION(data);
-    if (!m_enable)
-    {
-        PacketMetadata::Deallocate(data);
-        return;
-    }
-    NS_LOG_LOGIC("recycle size=" << data->m_size << ", list=" << m_freeList.size());
-    NS_ASSERT(data->m_count == 0);
-    if (m_freeList.size() > 1000 || data->m_size < m_maxSize)
-    {
-        PacketMetadata::Deallocate(data);
-    }
-    else
+    NS_LOG_FUNCTION(this);
+    if (m_data == nullptr)
     {
-        m_freeList.push_back(data);
+        return m_head == 0 && m_tail == 0;
     }
-}
-
-struct PacketMetadata::Data*
-PacketMetadata::Allocate(uint32_t n)
-{
-    NS_LOG_FUNCTION(n);
-    uint32_t size = sizeof(struct Data);
-    if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
+    bool ok = m_head <= m_tail && m_tail <= m_data->m_capacity;
+    ok &= m_data->m_dirtyStart <= m_head && m_tail <= m_data->m_dirtyEnd;
+    for (uint16_t i = m_head; ok && i < m_tail; i++)
     {
-        n = PACKET_METADATA_DATA_M_DATA_SIZE;
+        ok &= m_data->m_fragmentStart[i] <= m_data->m_fragmentEnd[i];
+        ok &= m_data->m_fragmentEnd[i] <= m_data->m_size[i];
     }
-    size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-    uint8_t* buf = new uint8_t[size];
-    struct PacketMetadata::Data* data = (struct PacketMetadata::Data*)buf;
-    data->m_size = n;
-    data->m_count = 1;
-    data->m_dirtyEnd = 0;
-    return data;
-}
-
-void
-PacketMetadata::Deallocate(struct PacketMetadata::Data* data)
-{
-    NS_LOG_FUNCTION(data);
-    uint8_t* buf = (uint8_t*)data;
-    delete[] buf;
+    return ok;
 }
 
 PacketMetadata
@@ -650,46 +359,46 @@ void
 PacketMetadata::AddHeader(const Header& header, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &header << size);
-    uint32_t uid = header.GetInstanceTypeId().GetUid() << 1;
-    DoAddHeader(uid, size);
+    uint16_t uid = header.GetInstanceTypeId().GetUid();
+    DoAddHeader(uid, size, Item::HEADER);
     NS_ASSERT(IsStateOk());
 }
 
 void
-PacketMetadata::DoAddHeader(uint32_t uid, uint32_t size)
+PacketMetadata::DoAddHeader(uint16_t uid, uint32_t size, Item::ItemType type)
 {
-    NS_LOG_FUNCTION(this << uid << size);
+    NS_LOG_FUNCTION(this << uid << size << type);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
 
-    struct PacketMetadata::SmallItem item;
-    item.next = m_head;
-    item.prev = 0xffff;
-    item.typeUid = uid;
+    ItemData item;
+    item.packetUid = m_packetUid;
     item.size = size;
+    item.fragmentStart = 0;
+    item.fragmentEnd = size;
+    item.typeUid = uid;
     item.chunkUid = m_chunkUid;
+    item.type = type;
     m_chunkUid++;
-    uint16_t written = AddSmall(&item);
-    UpdateHead(written);
+    ReserveHead(1);
+    m_head--;
+    WriteItem(m_head, item);
 }
 
 void
 PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
 {
-    uint32_t uid = header.GetInstanceTypeId().GetUid() << 1;
+    uint16_t uid = header.GetInstanceTypeId().GetUid();
     NS_LOG_FUNCTION(this << &header << size);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t read = ReadItems(m_head, &item, &extraItem);
-    if ((item.typeUid & 0xfffffffe) != uid || item.size != size)
+    if (m_head == m_tail || m_data->m_typeUid[m_head] != uid || m_data->m_size[m_head] != size)
     {
         if (m_enableChecking)
         {
@@ -697,7 +406,7 @@ PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
         }
         return;
     }
-    else if (item.typeUid != uid && (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != size))
+    else if (m_data->m_fragmentStart[m_head] != 0 || m_data->m_fragmentEnd[m_head] != size)
     {
         if (m_enableChecking)
         {
@@ -705,58 +414,44 @@ PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
         }
         return;
     }
-    if (m_head + read == m_used)
-    {
-        m_used = m_head;
-    }
-    if (m_head == m_tail)
-    {
-        m_head = 0xffff;
-        m_tail = 0xffff;
-    }
-    else
-    {
-        m_head = item.next;
-    }
+    m_head++;
     NS_ASSERT(IsStateOk());
 }
 
 void
 PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
 {
-    uint32_t uid = trailer.GetInstanceTypeId().GetUid() << 1;
     NS_LOG_FUNCTION(this << &trailer << size);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
-    struct PacketMetadata::SmallItem item;
-    item.next = 0xffff;
-    item.prev = m_tail;
-    item.typeUid = uid;
+    ItemData item;
+    item.packetUid = m_packetUid;
     item.size = size;
+    item.fragmentStart = 0;
+    item.fragmentEnd = size;
+    item.typeUid = trailer.GetInstanceTypeId().GetUid();
     item.chunkUid = m_chunkUid;
+    item.type = Item::TRAILER;
     m_chunkUid++;
-    uint16_t written = AddSmall(&item);
-    UpdateTail(written);
+    AddItemAtEnd(item);
     NS_ASSERT(IsStateOk());
 }
 
 void
 PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
 {
-    uint32_t uid = trailer.GetInstanceTypeId().GetUid() << 1;
+    uint16_t uid = trailer.GetInstanceTypeId().GetUid();
     NS_LOG_FUNCTION(this << &trailer << size);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t read = ReadItems(m_tail, &item, &extraItem);
-    if ((item.typeUid & 0xfffffffe) != uid || item.size != size)
+    uint16_t last = m_tail - 1;
+    if (m_head == m_tail || m_data->m_typeUid[last] != uid || m_data->m_size[last] != size)
     {
         if (m_enableChecking)
         {
@@ -764,7 +459,7 @@ PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
         }
         return;
     }
-    else if (item.typeUid != uid && (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != size))
+    else if (m_data->m_fragmentStart[last] != 0 || m_data->m_fragmentEnd[last] != size)
     {
         if (m_enableChecking)
         {
@@ -772,19 +467,7 @@ PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
         }
         return;
     }
-    if (m_tail + read == m_used)
-    {
-        m_used = m_tail;
-    }
-    if (m_head == m_tail)
-    {
-        m_head = 0xffff;
-        m_tail = 0xffff;
-    }
-    else
-    {
-        m_tail = item.prev;
-    }
+    m_tail--;
     NS_ASSERT(IsStateOk());
 }
 
@@ -794,10 +477,10 @@ PacketMetadata::AddAtEnd(const PacketMetadata& o)
     NS_LOG_FUNCTION(this << &o);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
-    if (m_tail == 0xffff)
+    if (m_head == m_tail)
     {
         // We have no items so 'AddAtEnd' is
         // equivalent to self-assignment.
@@ -805,61 +488,45 @@ PacketMetadata::AddAtEnd(const PacketMetadata& o)
         NS_ASSERT(IsStateOk());
         return;
     }
-    if (o.m_head == 0xffff)
+    if (o.m_head == o.m_tail)
     {
-        NS_ASSERT(o.m_tail == 0xffff);
-        // we have nothing to append.
+        NS_ASSERT(o.m_data == nullptr || o.m_data->m_count != 0);
+        // o has no items so 'AddAtEnd' is a no-op.
         return;
     }
-    NS_ASSERT(m_head != 0xffff && m_tail != 0xffff);
-
-    // We read the current tail because we are going to append
-    // after this item.
-    struct PacketMetadata::SmallItem tailItem;
-    PacketMetadata::ExtraItem tailExtraItem;
-    uint32_t tailSize = ReadItems(m_tail, &tailItem, &tailExtraItem);
-
-    uint16_t current;
-    struct PacketMetadata::SmallItem item;
-    PacketMetadata::ExtraItem extraItem;
-    o.ReadItems(o.m_head, &item, &extraItem);
-    if (extraItem.packetUid == tailExtraItem.packetUid && item.typeUid == tailItem.typeUid &&
-        item.chunkUid == tailItem.chunkUid && item.size == tailItem.size &&
-        extraItem.fragmentStart == tailExtraItem.fragmentEnd)
-    {
-        /* If the previous tail came from the same header as
-         * the next item we want to append to our array, then,
-         * we merge them and attempt to reuse the previous tail's
-         * location.
-         */
-        tailExtraItem.fragmentEnd = extraItem.fragmentEnd;
-        ReplaceTail(&tailItem, &tailExtraItem, tailSize);
-        if (o.m_head == o.m_tail)
-        {
-            // there is only one item to append to self from other.
-            return;
-        }
-        current = item.next;
-    }
-    else
+    if (&o == this)
     {
-        current = o.m_head;
+        PacketMetadata copy = o;
+        AddAtEnd(copy);
+        return;
     }
 
-    /* Now that we have merged our current tail with the head of the
-     * next packet, we just append all items from the next packet
-     * to the current packet.
-     */
-    while (current != 0xffff)
+    uint16_t first = o.m_head;
+    uint16_t last = m_tail - 1;
+    if (m_data->m_packetUid[last] == o.m_data->m_packetUid[first] &&
+        m_data->m_typeUid[last] == o.m_data->m_typeUid[first] &&
+        m_data->m_chunkUid[last] == o.m_data->m_chunkUid[first] &&
+        m_data->m_size[last] == o.m_data->m_size[first] &&
+        m_data->m_fragmentEnd[last] == o.m_data->m_fragmentStart[first])
     {
-        o.ReadItems(current, &item, &extraItem);
-        uint16_t written = AddBig(0xffff, m_tail, &item, &extraItem);
-        UpdateTail(written);
-        if (current == o.m_tail)
+        // The last item and the first item of o are two adjacent
+        // fragments of the same header, trailer or payload: merge them.
+        uint32_t fragmentEnd = o.m_data->m_fragmentEnd[first];
+        if (m_data->m_count > 1)
         {
-            break;
+            ReserveCopy(0, o.m_tail - first - 1);
         }
-        current = item.next;
+        m_data->m_fragmentEnd[m_tail - 1] = fragmentEnd;
+        first++;
+    }
+
+    uint16_t n = o.m_tail - first;
+    if (n > 0)
+    {
+        ReserveTail(n);
+        // If o shares our storage, its items are before the free slots.
+        CopyItems(o.m_data, first, m_data, m_tail, n);
+        m_tail += n;
     }
     NS_ASSERT(IsStateOk());
 }
@@ -870,7 +537,7 @@ PacketMetadata::AddPaddingAtEnd(uint32_t end)
     NS_LOG_FUNCTION(this << end);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
 }
@@ -881,56 +548,26 @@ PacketMetadata::RemoveAtStart(uint32_t start)
     NS_LOG_FUNCTION(this << start);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
-    NS_ASSERT(m_data != nullptr);
     uint32_t leftToRemove = start;
-    uint16_t current = m_head;
-    while (current != 0xffff && leftToRemove > 0)
+    while (m_head < m_tail && leftToRemove > 0)
     {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
+        uint32_t itemRealSize = m_data->m_fragmentEnd[m_head] - m_data->m_fragmentStart[m_head];
         if (itemRealSize <= leftToRemove)
         {
-            // remove from list.
-            if (m_head == m_tail)
-            {
-                m_head = 0xffff;
-                m_tail = 0xffff;
-            }
-            else
-            {
-                m_head = item.next;
-            }
+            // remove the whole item.
+            m_head++;
             leftToRemove -= itemRealSize;
         }
         else
         {
-            // fragment the list item.
-            PacketMetadata fragment(m_packetUid, 0);
-            extraItem.fragmentStart += leftToRemove;
+            // fragment the item.
+            Unshare();
+            m_data->m_fragmentStart[m_head] += leftToRemove;
             leftToRemove = 0;
-            uint16_t written = fragment.AddBig(0xffff, fragment.m_tail, &item, &extraItem);
-            fragment.UpdateTail(written);
-            while (current != 0xffff && current != m_tail)
-            {
-                current = item.next;
-                ReadItems(current, &item, &extraItem);
-                written = fragment.AddBig(0xffff, fragment.m_tail, &item, &extraItem);
-                fragment.UpdateTail(written);
-            }
-            *this = fragment;
-        }
-        NS_ASSERT(item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                  extraItem.fragmentStart <= extraItem.fragmentEnd);
-        if (current == m_tail)
-        {
-            break;
         }
-        current = item.next;
     }
     NS_ASSERT(leftToRemove == 0);
     NS_ASSERT(IsStateOk());
@@ -942,58 +579,27 @@ PacketMetadata::RemoveAtEnd(uint32_t end)
     NS_LOG_FUNCTION(this << end);
     if (!m_enable)
     {
-        m_metadataSkipped = true;
+        m_metadataSkipped.store(true, std::memory_order_relaxed);
         return;
     }
-    NS_ASSERT(m_data != nullptr);
-
     uint32_t leftToRemove = end;
-    uint16_t current = m_tail;
-    while (current != 0xffff && leftToRemove > 0)
+    while (m_head < m_tail && leftToRemove > 0)
     {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
+        uint16_t last = m_tail - 1;
+        uint32_t itemRealSize = m_data->m_fragmentEnd[last] - m_data->m_fragmentStart[last];
         if (itemRealSize <= leftToRemove)
         {
-            // remove from list.
-            if (m_head == m_tail)
-            {
-                m_head = 0xffff;
-                m_tail = 0xffff;
-            }
-            else
-            {
-                m_tail = item.prev;
-            }
+            // remove the whole item.
+            m_tail--;
             leftToRemove -= itemRealSize;
         }
         else
         {
-            // fragment the list item.
-            PacketMetadata fragment(m_packetUid, 0);
-            NS_ASSERT(extraItem.fragmentEnd > leftToRemove);
-            extraItem.fragmentEnd -= leftToRemove;
+            // fragment the item.
+            Unshare();
+            m_data->m_fragmentEnd[m_tail - 1] -= leftToRemove;
             leftToRemove = 0;
-            uint16_t written = fragment.AddBig(fragment.m_head, 0xffff, &item, &extraItem);
-            fragment.UpdateHead(written);
-            while (current != 0xffff && current != m_head)
-            {
-                current = item.prev;
-                ReadItems(current, &item, &extraItem);
-                written = fragment.AddBig(fragment.m_head, 0xffff, &item, &extraItem);
-                fragment.UpdateHead(written);
-            }
-            *this = fragment;
         }
-        NS_ASSERT(item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                  extraItem.fragmentStart <= extraItem.fragmentEnd);
-        if (current == m_head)
-        {
-            break;
-        }
-        current = item.prev;
     }
     NS_ASSERT(leftToRemove == 0);
     NS_ASSERT(IsStateOk());
@@ -1004,20 +610,9 @@ PacketMetadata::GetTotalSize() const
 {
     NS_LOG_FUNCTION(this);
     uint32_t totalSize = 0;
-    uint16_t current = m_head;
-    uint16_t tail = m_tail;
-    while (current != 0xffff)
+    for (uint16_t i = m_head; i < m_tail; i++)
     {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        totalSize += extraItem.fragmentEnd - extraItem.fragmentStart;
-        if (current == tail)
-        {
-            break;
-        }
-        NS_ASSERT(current != item.next);
-        current = item.next;
+        totalSize += m_data->m_fragmentEnd[i] - m_data->m_fragmentStart[i];
     }
     return totalSize;
 }
@@ -1040,8 +635,7 @@ PacketMetadata::ItemIterator::ItemIterator(const PacketMetadata* metadata, Buffe
     : m_metadata(metadata),
       m_buffer(buffer),
       m_current(metadata->m_head),
-      m_offset(0),
-      m_hasReadTail(false)
+      m_offset(0)
 {
     NS_LOG_FUNCTION(this << metadata << &buffer);
 }
@@ -1050,15 +644,7 @@ bool
 PacketMetadata::ItemIterator::HasNext() const
 {
     NS_LOG_FUNCTION(this);
-    if (m_current == 0xffff)
-    {
-        return false;
-    }
-    if (m_hasReadTail)
-    {
-        return false;
-    }
-    return true;
+    return m_current < m_metadata->m_tail;
 }
 
 PacketMetadata::Item
@@ -1066,56 +652,28 @@ PacketMetadata::ItemIterator::Next()
 {
     NS_LOG_FUNCTION(this);
     struct PacketMetadata::Item item;
-    struct PacketMetadata::SmallItem smallItem;
-    struct PacketMetadata::ExtraItem extraItem;
-    m_metadata->ReadItems(m_current, &smallItem, &extraItem);
-    if (m_current == m_metadata->m_tail)
-    {
-        m_hasReadTail = true;
-    }
-    m_current = smallItem.next;
-    uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
-    item.tid.SetUid(uid);
-    item.currentTrimmedFromStart = extraItem.fragmentStart;
-    item.currentTrimmedFromEnd = extraItem.fragmentEnd - smallItem.size;
-    item.currentSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-    if (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != smallItem.size)
-    {
-        item.isFragment = true;
-    }
-    else
-    {
-        item.isFragment = false;
-    }
-    TypeId tid;
-    tid.SetUid(uid);
-    if (uid == 0)
-    {
-        item.type = PacketMetadata::Item::PAYLOAD;
-    }
-    else if (tid.IsChildOf(Header::GetTypeId()))
-    {
-        item.type = PacketMetadata::Item::HEADER;
-        if (!item.isFragment)
-        {
-            item.current = m_buffer.Begin();
-            item.current.Next(m_offset);
-        }
-    }
-    else if (tid.IsChildOf(Trailer::GetTypeId()))
-    {
-        item.type = PacketMetadata::Item::TRAILER;
-        if (!item.isFragment)
-        {
-            item.current = m_buffer.End();
-            item.current.Prev(m_buffer.GetSize() - (m_offset + smallItem.size));
-        }
-    }
-    else
-    {
-        NS_ASSERT(false);
-    }
-    m_offset += extraItem.fragmentEnd - extraItem.fragmentStart;
+    struct PacketMetadata::ItemData data;
+    m_metadata->ReadItem(m_current, &data);
+    m_current++;
+    item.tid.SetUid(data.typeUid);
+    item.currentTrimmedFromStart = data.fragmentStart;
+    item.currentTrimmedFromEnd = data.fragmentEnd - data.size;
+    item.currentSize = data.fragmentEnd - data.fragmentStart;
+    item.isFragment = data.fragmentStart != 0 || data.fragmentEnd != data.size;
+    // The type was recorded when the item was added, to avoid looking up
+    // the TypeId hierarchy for each item.
+    item.type = static_cast<PacketMetadata::Item::ItemType>(data.type);
+    if (item.type == PacketMetadata::Item::HEADER && !item.isFragment)
+    {
+        item.current = m_buffer.Begin();
+        item.current.Next(m_offset);
+    }
+    else if (item.type == PacketMetadata::Item::TRAILER && !item.isFragment)
+    {
+        item.current = m_buffer.End();
+        item.current.Prev(m_buffer.GetSize() - (m_offset + data.size));
+    }
+    m_offset += item.currentSize;
     return item;
 }
 
@@ -1136,13 +694,9 @@ PacketMetadata::GetSerializedSize() const
         return totalSize;
     }
 
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t current = m_head;
-    while (current != 0xffff)
+    for (uint16_t i = m_head; i < m_tail; i++)
     {
-        ReadItems(current, &item, &extraItem);
-        uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
+        uint16_t uid = m_data->m_typeUid[i];
         if (uid == 0)
         {
             totalSize += 4;
@@ -1154,12 +708,6 @@ PacketMetadata::GetSerializedSize() const
             totalSize += 4 + tid.GetName().size();
         }
         totalSize += 1 + 4 + 2 + 4 + 4 + 8;
-        if (current == m_tail)
-        {
-            break;
-        }
-        NS_ASSERT(current != item.next);
-        current = item.next;
     }
     return totalSize;
 }
@@ -1176,24 +724,21 @@ PacketMetadata::Serialize(uint8_t* buffer, uint32_t maxSize) const
         return 0;
     }
 
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t current = m_head;
-    while (current != 0xffff)
+    struct PacketMetadata::ItemData item;
+    for (uint16_t i = m_head; i < m_tail; i++)
     {
-        ReadItems(current, &item, &extraItem);
+        ReadItem(i, &item);
         NS_LOG_LOGIC("bytesWritten=" << static_cast<uint32_t>(buffer - start)
                                      << ", typeUid=" << item.typeUid << ", size=" << item.size
                                      << ", chunkUid=" << item.chunkUid
-                                     << ", fragmentStart=" << extraItem.fragmentStart
-                                     << ", fragmentEnd=" << extraItem.fragmentEnd
-                                     << ", packetUid=" << extraItem.packetUid);
+                                     << ", fragmentStart=" << item.fragmentStart
+                                     << ", fragmentEnd=" << item.fragmentEnd
+                                     << ", packetUid=" << item.packetUid);
 
-        uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
-        if (uid != 0)
+        if (item.typeUid != 0)
         {
             TypeId tid;
-            tid.SetUid(uid);
+            tid.SetUid(item.typeUid);
             std::string uidString = tid.GetName();
             uint32_t uidStringSize = uidString.size();
             buffer = AddToRawU32(uidStringSize, start, buffer, maxSize);
@@ -1220,7 +765,10 @@ PacketMetadata::Serialize(uint8_t* buffer, uint32_t maxSize) const
             }
         }
 
-        uint8_t isBig = item.typeUid & 0x1;
+        // Kept for compatibility with the former encoding of the items,
+        // which stored the fragments and foreign items in a larger format.
+        uint8_t isBig = (item.fragmentStart != 0 || item.fragmentEnd != item.size ||
+                         item.packetUid != m_packetUid);
         buffer = AddToRawU8(isBig, start, buffer, maxSize);
         if (buffer == nullptr)
         {
@@ -1239,31 +787,23 @@ PacketMetadata::Serialize(uint8_t* buffer, uint32_t maxSize) const
             return 0;
         }
 
-        buffer = AddToRawU32(extraItem.fragmentStart, start, buffer, maxSize);
+        buffer = AddToRawU32(item.fragmentStart, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
 
-        buffer = AddToRawU32(extraItem.fragmentEnd, start, buffer, maxSize);
+        buffer = AddToRawU32(item.fragmentEnd, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
 
-        buffer = AddToRawU64(extraItem.packetUid, start, buffer, maxSize);
+        buffer = AddToRawU64(item.packetUid, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
-
-        if (current == m_tail)
-        {
-            break;
-        }
-
-        NS_ASSERT(current != item.next);
-        current = item.next;
     }
 
     NS_ASSERT(static_cast<uint32_t>(buffer - start) == maxSize);
@@ -1280,18 +820,17 @@ PacketMetadata::Deserialize(const uint8_t* buffer, uint32_t size)
     buffer = ReadFromRawU64(m_packetUid, start, buffer, size);
     desSize -= 8;
 
-    struct PacketMetadata::SmallItem item = {0};
-    struct PacketMetadata::ExtraItem extraItem = {0};
+    struct PacketMetadata::ItemData item = {0};
     while (desSize > 0)
     {
         uint32_t uidStringSize = 0;
         buffer = ReadFromRawU32(uidStringSize, start, buffer, size);
         desSize -= 4;
-        uint32_t uid;
         if (uidStringSize == 0)
         {
             // uid zero for payload.
-            uid = 0;
+            item.typeUid = 0;
+            item.type = Item::PAYLOAD;
         }
         else
         {
@@ -1304,28 +843,35 @@ PacketMetadata::Deserialize(const uint8_t* buffer, uint32_t size)
                 desSize--;
             }
             TypeId tid = TypeId::LookupByName(uidString);
-            uid = tid.GetUid();
+            item.typeUid = tid.GetUid();
+            if (tid.IsChildOf(Header::GetTypeId()))
+            {
+                item.type = Item::HEADER;
+            }
+            else
+            {
+                NS_ASSERT(tid.IsChildOf(Trailer::GetTypeId()));
+                item.type = Item::TRAILER;
+            }
         }
         uint8_t isBig = 0;
         buffer = ReadFromRawU8(isBig, start, buffer, size);
         desSize--;
-        item.typeUid = (uid << 1) | isBig;
         buffer = ReadFromRawU32(item.size, start, buffer, size);
         desSize -= 4;
         buffer = ReadFromRawU16(item.chunkUid, start, buffer, size);
         desSize -= 2;
-        buffer = ReadFromRawU32(extraItem.fragmentStart, start, buffer, size);
+        buffer = ReadFromRawU32(item.fragmentStart, start, buffer, size);
         desSize -= 4;
-        buffer = ReadFromRawU32(extraItem.fragmentEnd, start, buffer, size);
+        buffer = ReadFromRawU32(item.fragmentEnd, start, buffer, size);
         desSize -= 4;
-        buffer = ReadFromRawU64(extraItem.packetUid, start, buffer, size);
+        buffer = ReadFromRawU64(item.packetUid, start, buffer, size);
         desSize -= 8;
         NS_LOG_LOGIC("size=" << size << ", typeUid=" << item.typeUid << ", size=" << item.size
                              << ", chunkUid=" << item.chunkUid << ", fragmentStart="
-                             << extraItem.fragmentStart << ", fragmentEnd=" << extraItem.fragmentEnd
-                             << ", packetUid=" << extraItem.packetUid);
-        uint32_t tmp = AddBig(0xffff, m_tail, &item, &extraItem);
-        UpdateTail(tmp);
+                             << item.fragmentStart << ", fragmentEnd=" << item.fragmentEnd
+                             << ", packetUid=" << item.packetUid);
+        AddItemAtEnd(item);
     }
     NS_ASSERT(desSize == 0);
     return (desSize != 0) ? 0 : 1;
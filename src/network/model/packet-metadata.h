@@ -25,6 +25,7 @@
 #include "ns3/callback.h"
 #include "ns3/type-id.h"
 
+#include <atomic>
 #include <limits>
 #include <stdint.h>
 #include <vector>
@@ -46,14 +47,11 @@ class Trailer;
  * an implementation of the Packet::Print methods which uses
  * the metadata to analyse the content of the packet's buffer.
  *
- * To achieve this, this class maintains a linked list of so-called
+ * To achieve this, this class maintains an ordered array of so-called
  * "items", each of which represents a header or a trailer, or
- * payload, or a fragment of any of these. Each item contains a "next"
- * and a "prev" field which point to the next and previous entries
- * in the linked list. The PacketMetadata class maintains a pair
- * of pointers to the head and the tail of the linked list.
+ * payload, or a fragment of any of these.
  *
- * Each entry in the list also maintains:
+ * Each item maintains:
  *   - its native size (the size it had when it was first added
  *     to the packet)
  *   - its type: identifies what kind of header, what kind of trailer,
@@ -62,20 +60,15 @@ class Trailer;
  *   - the start and end of the area represented by a fragment
  *     if it is one.
  *
- * This linked list is flattened in a byte buffer stored in
- * struct PacketMetadata::Data. Each entry of the linked list is
- * identified by an offset which identifies the first byte of the
- * entry from the start of the data buffer. The size of this data
- * buffer is 2^16-1 bytes maximum which somewhat limits the number
- * of entries which can be stored in this linked list but it is
- * quite unlikely to hit this limit in practice.
- *
- * Each item of the linked list is a variable-sized byte buffer
- * made of a number of fields. Some of these fields are stored
- * as fixed-size 32 bit integers, others as fixed-size 16 bit
- * integers, and some others as variable-size 32-bit integers.
- * The variable-size 32 bit integers are stored using the uleb128
- * encoding.
+ * The items are stored in struct PacketMetadata::Data, one array for
+ * each of these fields, such that iterating over the items reads
+ * contiguous memory. The storage is shared by the copies of a
+ * PacketMetadata and copied only when a shared item is modified or
+ * when an item is added next to the items of another copy; a storage
+ * holds 8 items by default and is reallocated with a larger capacity
+ * when it is full. The storages of the default capacity are recycled
+ * by a per-thread free list. No storage is allocated when the metadata
+ * is disabled.
  */
 class PacketMetadata
 {
@@ -156,9 +149,8 @@ class PacketMetadata
       private:
         const PacketMetadata* m_metadata; //!< pointer to the metadata
         Buffer m_buffer;                  //!< buffer the metadata refers to
-        uint16_t m_current;               //!< current position
-        uint32_t m_offset;                //!< offset
-        bool m_hasReadTail;               //!< true if the metadata tail has been read
+        uint16_t m_current;               //!< index of the next item
+        uint32_t m_offset;                //!< offset of the next item in the buffer
     };
 
     /**
@@ -415,202 +407,160 @@ class PacketMetadata
                                    uint32_t maxSize);
 
     /**
-     * the size of PacketMetadata::Data::m_data such that the total size
-     * of PacketMetadata::Data is 16 bytes
-     */
-#define PACKET_METADATA_DATA_M_DATA_SIZE 8
-
-    /**
-     * Data structure
+     * \brief Storage of the items, shared by copy-on-write.
+     *
+     * The fields of the items are stored in separate arrays (a structure
+     * of arrays), allocated in the same memory block as this structure.
+     * The items of a PacketMetadata are the indexes [m_head, m_tail) of
+     * the arrays, so that headers are added in the free slots before
+     * m_head and trailers and concatenated items in the free slots
+     * after m_tail.
+     *
+     * With the multithreaded simulator, the copies which share the items
+     * may be used by different threads, hence the reference count and the
+     * bounds of the dirty area are atomic.
      */
     struct Data
     {
-        /** number of references to this struct Data instance. */
+        /**
+         * The reference count of an instance of this data structure.
+         * Each PacketMetadata which references an instance holds a count.
+         */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_count;
+#else
         uint32_t m_count;
-        /** size (in bytes) of m_data buffer below */
-        uint16_t m_size;
-        /** max of the m_used field over all objects which reference this struct Data instance */
+#endif
+        /**
+         * the number of items which fit in the arrays.
+         */
+        uint16_t m_capacity;
+        /**
+         * index of the first item written in the arrays.
+         */
+#ifdef NS3_MTP
+        std::atomic<uint16_t> m_dirtyStart;
+#else
+        uint16_t m_dirtyStart;
+#endif
+        /**
+         * index after the last item written in the arrays.
+         */
+#ifdef NS3_MTP
+        std::atomic<uint16_t> m_dirtyEnd;
+#else
         uint16_t m_dirtyEnd;
-        /** variable-sized buffer of bytes */
-        uint8_t m_data[PACKET_METADATA_DATA_M_DATA_SIZE];
-    };
-
-    /* Note that since the next and prev fields are 16 bit integers
-       and since the value 0xffff is reserved to identify the
-       fact that the end or the start of the list is reached,
-       only a limited number of elements can be stored in
-       a m_data byte buffer.
-     */
-    /**
-     * \brief SmallItem structure
-     */
-    struct SmallItem
-    {
-        /** offset (in bytes) from start of m_data buffer
-            to next element in linked list. value is 0xffff
-            if next element does not exist.
-            stored as a fixed-size 16 bit integer.
-        */
-        uint16_t next;
-        /** offset (in bytes) from start of m_data buffer
-            to previous element in linked list. value is 0xffff
-            if previous element does not exist.
-            stored as a fixed-size 16 bit integer.
+#endif
+        /**
+         * uid of the packet to which each item was first added.
          */
-        uint16_t prev;
-        /** the high 31 bits of this field identify the
-            type of the header or trailer represented by
-            this item: the value zero represents payload.
-            If the low bit of this uid is one, an ExtraItem
-            structure follows this SmallItem structure.
-            stored as a variable-size 32 bit integer.
+        uint64_t* m_packetUid;
+        /**
+         * native size of each item: the size it had when it was first
+         * added to a packet.
          */
-        uint32_t typeUid;
-        /** the size (in bytes) of the header or trailer represented
-            by this element.
-            stored as a variable-size 32 bit integer.
+        uint32_t* m_size;
+        /**
+         * offset, from the start of each item, of the start of the
+         * part of the item still present.
          */
-        uint32_t size;
-        /** this field tries to uniquely identify each header or
-            trailer _instance_ while the typeUid field uniquely
-            identifies each header or trailer _type_. This field
-            is used to test whether two items are equal in the sense
-            that they represent the same header or trailer instance.
-            That equality test is based on the typeUid and chunkUid
-            fields so, the likelihood that two header instances
-            share the same chunkUid _and_ typeUid is very small
-            unless they are really representations of the same header
-            instance.
-            stored as a fixed-size 16 bit integer.
+        uint32_t* m_fragmentStart;
+        /**
+         * offset, from the start of each item, of the end of the
+         * part of the item still present.
          */
-        uint16_t chunkUid;
-    };
-
-    /**
-     * \brief ExtraItem structure
-     */
-    struct ExtraItem
-    {
-        /** offset (in bytes) from start of original header to
-            the start of the fragment still present.
-            stored as a variable-size 32 bit integer.
+        uint32_t* m_fragmentEnd;
+        /**
+         * TypeId uid of the header or trailer represented by each item:
+         * the value zero represents payload.
          */
-        uint32_t fragmentStart;
-        /** offset (in bytes) from start of original header to
-            the end of the fragment still present.
-            stored as a variable-size 32 bit integer.
+        uint16_t* m_typeUid;
+        /**
+         * uid of the header or trailer _instance_ of each item, used
+         * with the packet uid and the type uid to test whether two
+         * fragments are parts of the same header or trailer instance.
          */
-        uint32_t fragmentEnd;
-        /** the packetUid of the packet in which this header or trailer
-            was first added. It could be different from the m_packetUid
-            field if the user has aggregated multiple packets into one.
-            stored as a fixed-size 64 bit integer.
+        uint16_t* m_chunkUid;
+        /**
+         * PacketMetadata::Item::ItemType of each item.
          */
-        uint64_t packetUid;
+        uint8_t* m_type;
     };
 
     /**
-     * \brief Class to hold all the metadata
+     * \brief The fields of one item.
      */
-    class DataFreeList : public std::vector<struct Data*>
+    struct ItemData
     {
-      public:
-        ~DataFreeList();
+        uint64_t packetUid;     //!< uid of the packet to which the item was first added
+        uint32_t size;          //!< native size of the item
+        uint32_t fragmentStart; //!< start of the part of the item still present
+        uint32_t fragmentEnd;   //!< end of the part of the item still present
+        uint16_t typeUid;       //!< TypeId uid of the item, zero for payload
+        uint16_t chunkUid;      //!< uid of the header or trailer instance
+        uint8_t type;           //!< PacketMetadata::Item::ItemType of the item
     };
 
-    friend DataFreeList::~DataFreeList();
     /// Friend class
     friend class ItemIterator;
 
     /**
-     * \brief Add a SmallItem
-     * \param item the SmallItem to add
-     * \return added size
-     */
-    inline uint16_t AddSmall(const PacketMetadata::SmallItem* item);
-    /**
-     * \brief Add a "Big" Item (a SmallItem plus an ExtraItem)
-     * \param head the head
-     * \param tail the tail
-     * \param item the SmallItem to add
-     * \param extraItem the ExtraItem to add
-     * \return added size
-     */
-    uint16_t AddBig(uint32_t head,
-                    uint32_t tail,
-                    const PacketMetadata::SmallItem* item,
-                    const PacketMetadata::ExtraItem* extraItem);
-    /**
-     * \brief Replace the tail
-     * \param item the item data to write
-     * \param extraItem the extra item data to write
-     * \param available the number of bytes which can
-     *        be written without having to rewrite the buffer entirely.
-     */
-    void ReplaceTail(PacketMetadata::SmallItem* item,
-                     PacketMetadata::ExtraItem* extraItem,
-                     uint32_t available);
-    /**
-     * \brief Update the head
-     * \param written the used bytes
-     */
-    inline void UpdateHead(uint16_t written);
-    /**
-     * \brief Update the tail
-     * \param written the used bytes
-     */
-    inline void UpdateTail(uint16_t written);
-
-    /**
-     * \brief Get the ULEB128 (Unsigned Little Endian Base 128) size
-     * \param value the value
-     * \returns the value's ULEB128 size
+     * \brief Read an item.
+     * \param index the index of the item
+     * \param item the item fields
      */
-    inline uint32_t GetUleb128Size(uint32_t value) const;
+    inline void ReadItem(uint16_t index, ItemData* item) const;
     /**
-     * \brief Read a ULEB128 (Unsigned Little Endian Base 128) coded number
-     * \param pBuffer the buffer to read from
-     * \returns the value
+     * \brief Write an item.
+     * \param index the index of the item
+     * \param item the item fields
      */
-    uint32_t ReadUleb128(const uint8_t** pBuffer) const;
+    inline void WriteItem(uint16_t index, const ItemData& item);
     /**
-     * \brief Append a 16-bit value to the buffer
-     * \param value the value to add
-     * \param buffer the buffer to write to
+     * \brief Make room to add items before the first item.
+     * \param n the number of items to add
      */
-    inline void Append16(uint16_t value, uint8_t* buffer);
+    void ReserveHead(uint16_t n);
     /**
-     * \brief Append a 32-bit value to the buffer
-     * \param value the value to add
-     * \param buffer the buffer to write to
+     * \brief Make room to add items after the last item.
+     * \param n the number of items to add
      */
-    inline void Append32(uint32_t value, uint8_t* buffer);
+    void ReserveTail(uint16_t n);
     /**
-     * \brief Append a value to the buffer
-     * \param value the value to add
-     * \param buffer the buffer to write to
+     * \brief Extend the dirty area to the free slots before the first item.
+     *
+     * The dirty area is not extended if another copy which shares the items
+     * has already written items before the first item.
+     *
+     * \param start the new start of the dirty area
+     * \returns true if the dirty area was extended
      */
-    inline void AppendValue(uint32_t value, uint8_t* buffer);
+    bool ExtendDirtyStart(uint16_t start);
     /**
-     * \brief Append a value to the buffer - extra
+     * \brief Extend the dirty area to the free slots after the last item.
      *
-     * This function is called by AppendValue
+     * The dirty area is not extended if another copy which shares the items
+     * has already written items after the last item.
      *
-     * \param value the value to add
-     * \param buffer the buffer to write to
+     * \param end the new end of the dirty area
+     * \returns true if the dirty area was extended
      */
-    void AppendValueExtra(uint32_t value, uint8_t* buffer);
-
+    bool ExtendDirtyEnd(uint16_t end);
     /**
-     * \brief Reserve space
-     * \param n space to reserve
+     * \brief Make sure that the items are not shared, to modify them.
      */
-    inline void Reserve(uint32_t n);
+    void Unshare();
     /**
-     * \brief Reserve space and make a metadata copy
-     * \param n space to reserve
+     * \brief Copy the items in a new storage.
+     * \param head the number of free slots needed before the first item
+     * \param tail the number of free slots needed after the last item
      */
-    void ReserveCopy(uint32_t n);
+    void ReserveCopy(uint16_t head, uint16_t tail);
+    /**
+     * \brief Add an item after the last item.
+     * \param item the item to add
+     */
+    void AddItemAtEnd(const ItemData& item);
 
     /**
      * \brief Get the total size used by the metadata
@@ -618,86 +568,73 @@ class PacketMetadata
      */
     uint32_t GetTotalSize() const;
 
-    /**
-     * \brief Read items
-     * \param current the offset we should start reading the data from
-     * \param item pointer to where we should store the data to return to the caller
-     * \param extraItem pointer to where we should store the data to return to the caller
-     * \returns the number of bytes read.
-     */
-    uint32_t ReadItems(uint16_t current,
-                       struct PacketMetadata::SmallItem* item,
-                       struct PacketMetadata::ExtraItem* extraItem) const;
     /**
      * \brief Add an header
      * \param uid header's uid to add
      * \param size header serialized size
+     * \param type the type of the item: header or payload
      */
-    void DoAddHeader(uint32_t uid, uint32_t size);
+    void DoAddHeader(uint16_t uid, uint32_t size, Item::ItemType type);
     /**
      * \brief Check if the metadata state is ok
-     * \returns true if the internal state is ok
+     * \return true if the internal state is ok
      */
     bool IsStateOk() const;
-    /**
-     * \brief Check if the position is valid
-     * \param pointer the position to check
-     * \returns true if the position is valid
-     */
-    bool IsPointerOk(uint16_t pointer) const;
-    /**
-     * \brief Check if the position is valid
-     * \param pointer the position to check
-     * \returns true if the position is valid
-     */
-    bool IsSharedPointerOk(uint16_t pointer) const;
 
     /**
-     * \brief Recycle the buffer memory
-     * \param data the buffer data storage
+     * \brief Recycle the storage of the items
+     * \param data the storage
      */
     static void Recycle(struct PacketMetadata::Data* data);
     /**
-     * \brief Create a buffer data storage
-     * \param size the storage size to create
-     * \returns a pointer to the created buffer storage
+     * \brief Create a storage for the items
+     * \param capacity the number of items
+     * \return the storage
      */
-    static struct PacketMetadata::Data* Create(uint32_t size);
+    static struct PacketMetadata::Data* Create(uint16_t capacity);
     /**
-     * \brief Allocate a buffer data storage
-     * \param n the storage size to create
-     * \returns a pointer to the allocated buffer storage
+     * \brief Allocate a storage for the items
+     * \param capacity the number of items
+     * \return the storage
      */
-    static struct PacketMetadata::Data* Allocate(uint32_t n);
+    static struct PacketMetadata::Data* Allocate(uint16_t capacity);
     /**
-     * \brief Deallocate the buffer memory
-     * \param data the buffer data storage
+     * \brief Deallocate the storage of the items
+     * \param data the storage
      */
     static void Deallocate(struct PacketMetadata::Data* data);
+    /**
+     * \brief Copy consecutive items between two storages
+     * \param from the source storage
+     * \param fromIndex the index of the first item to copy in the source
+     * \param to the destination storage
+     * \param toIndex the index of the first item copied in the destination
+     * \param n the number of items to copy
+     */
+    static void CopyItems(const struct PacketMetadata::Data* from,
+                          uint16_t fromIndex,
+                          struct PacketMetadata::Data* to,
+                          uint16_t toIndex,
+                          uint16_t n);
 
-    static DataFreeList m_freeList; //!< the metadata data storage
-    static bool m_enable;           //!< Enable the packet metadata
-    static bool m_enableChecking;   //!< Enable the packet metadata checking
+    static bool m_enable;         //!< Enable the packet metadata
+    static bool m_enableChecking; //!< Enable the packet metadata checking
 
     /**
-     * Set to true when adding metadata to a packet is skipped because
-     * m_enable is false; used to detect enabling of metadata in the
-     * middle of a simulation, which isn't allowed.
+     * Set to true when any of the metadata operations is skipped because
+     * the metadata is disabled, to detect a call to Enable() too late.
      */
-    static bool m_metadataSkipped;
+    static std::atomic<bool> m_metadataSkipped;
 
-    static uint32_t m_maxSize;  //!< maximum metadata size
+#ifdef NS3_MTP
+    static thread_local uint16_t m_chunkUid; //!< Chunk Uid, per thread
+#else
     static uint16_t m_chunkUid; //!< Chunk Uid
+#endif
 
-    struct Data* m_data; //!< Metadata storage
-    /*
-       head -(next)-> tail
-         ^             |
-          \---(prev)---|
-     */
-    uint16_t m_head;      //!< list head
-    uint16_t m_tail;      //!< list tail
-    uint16_t m_used;      //!< used portion
+    struct Data* m_data;  //!< Storage of the items, null if no item was ever added
+    uint16_t m_head;      //!< index of the first item
+    uint16_t m_tail;      //!< index after the last item
     uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -707,16 +644,14 @@ namespace ns3
 {
 
 PacketMetadata::PacketMetadata(uint64_t uid, uint32_t size)
-    : m_data(PacketMetadata::Create(10)),
-      m_head(0xffff),
-      m_tail(0xffff),
-      m_used(0),
+    : m_data(nullptr),
+      m_head(0),
+      m_tail(0),
       m_packetUid(uid)
 {
-    memset(m_data->m_data, 0xff, 4);
     if (size > 0)
     {
-        DoAddHeader(0, size);
+        DoAddHeader(0, size, Item::PAYLOAD);
     }
 }
 
@@ -724,12 +659,13 @@ PacketMetadata::PacketMetadata(const PacketMetadata& o)
     : m_data(o.m_data),
       m_head(o.m_head),
       m_tail(o.m_tail),
-      m_used(o.m_used),
       m_packetUid(o.m_packetUid)
 {
-    NS_ASSERT(m_data != nullptr);
-    NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
-    m_data->m_count++;
+    if (m_data != nullptr)
+    {
+        NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
+        m_data->m_count++;
+    }
 }
 
 PacketMetadata&
@@ -738,33 +674,62 @@ PacketMetadata::operator=(const PacketMetadata& o)
     if (m_data != o.m_data)
     {
         // not self assignment
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (m_data != nullptr)
         {
-            PacketMetadata::Recycle(m_data);
+            if (--m_data->m_count == 0)
+            {
+                PacketMetadata::Recycle(m_data);
+            }
         }
         m_data = o.m_data;
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count++;
+        if (m_data != nullptr)
+        {
+            m_data->m_count++;
+        }
     }
     m_head = o.m_head;
     m_tail = o.m_tail;
-    m_used = o.m_used;
     m_packetUid = o.m_packetUid;
     return *this;
 }
 
 PacketMetadata::~PacketMetadata()
 {
-    NS_ASSERT(m_data != nullptr);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (m_data != nullptr)
     {
-        PacketMetadata::Recycle(m_data);
+        if (--m_data->m_count == 0)
+        {
+            PacketMetadata::Recycle(m_data);
+        }
     }
 }
 
+void
+PacketMetadata::ReadItem(uint16_t index, ItemData* item) const
+{
+    NS_ASSERT(m_data != nullptr && index < m_data->m_capacity);
+    item->packetUid = m_data->m_packetUid[index];
+    item->size = m_data->m_size[index];
+    item->fragmentStart = m_data->m_fragmentStart[index];
+    item->fragmentEnd = m_data->m_fragmentEnd[index];
+    item->typeUid = m_data->m_typeUid[index];
+    item->chunkUid = m_data->m_chunkUid[index];
+    item->type = m_data->m_type[index];
+}
+
+void
+PacketMetadata::WriteItem(uint16_t index, const ItemData& item)
+{
+    NS_ASSERT(m_data != nullptr && index < m_data->m_capacity);
+    m_data->m_packetUid[index] = item.packetUid;
+    m_data->m_size[index] = item.size;
+    m_data->m_fragmentStart[index] = item.fragmentStart;
+    m_data->m_fragmentEnd[index] = item.fragmentEnd;
+    m_data->m_typeUid[index] = item.typeUid;
+    m_data->m_chunkUid[index] = item.chunkUid;
+    m_data->m_type[index] = item.type;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_METADATA_H */
@@ -19,7 +19,7 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a list of Packet tags, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
@@ -30,276 +30,210 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("PacketTagList");
 
-PacketTagList::TagData*
-PacketTagList::CreateTagData(size_t dataSize)
+uint32_t
+PacketTagList::GetRecordSize(uint32_t dataSize)
 {
-    NS_ASSERT_MSG(dataSize < std::numeric_limits<decltype(TagData::size)>::max(),
-                  "Requested TagData size " << dataSize << " exceeds maximum "
-                                            << std::numeric_limits<decltype(TagData::size)>::max());
-
-    void* p = std::malloc(sizeof(TagData) + dataSize - 1);
-    // The matching frees are in RemoveAll and RemoveWriter
-
-    TagData* tag = new (p) TagData;
-    tag->size = dataSize;
-    return tag;
+    return (offsetof(TagData, data) + dataSize + 3) & (~3);
 }
 
-bool
-PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
+uint64_t
+PacketTagList::GetFilterBit(TypeId tid)
 {
-    TypeId tid = tag.GetInstanceTypeId();
-    NS_LOG_FUNCTION(this << tid);
-    NS_LOG_INFO("looking for " << tid);
+    return uint64_t(1) << (tid.GetUid() % 64);
+}
 
-    // trivial case when list is empty
-    if (m_next == nullptr)
+uint32_t
+PacketTagList::Find(TypeId tid) const
+{
+    if ((m_filter & GetFilterBit(tid)) == 0)
     {
-        return false;
+        return m_used;
     }
-
-    bool found = false;
-
-    struct TagData** prevNext = &m_next; // previous node's next pointer
-    struct TagData* cur = m_next;        // cursor to current node
-    struct TagData* it = nullptr;        // utility
-
-    // Search from the head of the list until we find tid or a merge
-    while (cur != nullptr)
+    const uint8_t* data = GetData();
+    uint32_t offset = 0;
+    while (offset < m_used)
     {
-        if (cur->count > 1)
-        {
-            // found merge
-            NS_LOG_INFO("found initial merge before tid");
-            break;
-        }
-        else if (cur->tid == tid)
+        auto record = reinterpret_cast<const TagData*>(data + offset);
+        if (record->tid == tid)
         {
-            NS_LOG_INFO("found tid before initial merge, calling writer");
-            found = (this->*Writer)(tag, true, cur, prevNext);
             break;
         }
-        else
-        {
-            // no merge or tid found yet, move on
-            prevNext = &cur->next;
-            cur = cur->next;
-        }
-    } // while !found && !cow
-
-    // did we find it or run out of tags?
-    if (cur == nullptr || found)
-    {
-        NS_LOG_INFO("returning after header with found: " << found);
-        return found;
+        offset += GetRecordSize(record->size);
     }
+    return offset;
+}
 
-    // From here on out, we have to copy the list
-    // until we find tid, then link past it
-
-    // Before we do all that work, let's make sure tid really exists
-    for (it = cur; it != nullptr; it = it->next)
+uint8_t*
+PacketTagList::Reserve(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    if (m_shared == nullptr && size <= INLINE_SIZE)
     {
-        if (it->tid == tid)
-        {
-            break;
-        }
+        return reinterpret_cast<uint8_t*>(m_inline);
     }
-    if (it == nullptr)
+    if (m_shared != nullptr && m_shared->count == 1 && size <= m_shared->capacity)
     {
-        // got to end of list without finding tid
-        NS_LOG_INFO("tid not found after first merge");
-        return found;
+        return m_shared->data;
     }
-
-    // At this point cur is a merge, but untested for tid
-    NS_ASSERT(cur != nullptr);
-    NS_ASSERT(cur->count > 1);
-
-    /*
-       Walk the remainder of the list, copying, until we find tid
-       As we put a copy of the cur node onto our list,
-       we move the merge point down the list.
-
-       Starting position                  End position
-         T1 is a merge                     T1.count decremented
-                                           T2 is a merge
-                                           T1' is a copy of T1
-
-            other                             other
-                 \                                 \
-        Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-             /   /                                         /|
-        pNext cur                         Prev  ->  T1' --/ |
-                                                       /    |
-                                                  pNext   cur
-
-       When we reach tid, we link past it, decrement count, and we're done.
-    */
-
-    // Should normally check for null cur pointer,
-    // but since we know tid exists, we'll skip this test
-    while (/* cur && */ cur->tid != tid)
+    if (size <= INLINE_SIZE)
     {
-        NS_ASSERT(cur != nullptr);
-        NS_ASSERT(cur->count > 1);
-        cur->count--; // unmerge cur
-        struct TagData* copy = CreateTagData(cur->size);
-        copy->tid = cur->tid;
-        copy->count = 1;
-        copy->size = cur->size;
-        memcpy(copy->data, cur->data, copy->size);
-        copy->next = cur->next; // merge into tail
-        copy->next->count++;    // mark new merge
-        *prevNext = copy;       // point prior list at copy
-        prevNext = &copy->next; // advance
-        cur = copy->next;
+        // Shared records which fit in the PacketTagList again
+        std::memcpy(m_inline, m_shared->data, m_used);
+        Release();
+        return reinterpret_cast<uint8_t*>(m_inline);
     }
-    // Sanity check:
-    NS_ASSERT(cur != nullptr);  // cur should be non-zero
-    NS_ASSERT(cur->tid == tid); // cur->tid should be tid
-    NS_ASSERT(cur->count > 1);  // cur should be a merge
-
-    // link around tid, removing it from our list
-    found = (this->*Writer)(tag, false, cur, prevNext);
-    return found;
+
+    NS_ASSERT_MSG(size < std::numeric_limits<uint32_t>::max() / 2,
+                  "Requested tag list size " << size << " exceeds maximum");
+    uint32_t capacity = std::max(size, 2 * m_used);
+    void* p = std::malloc(sizeof(SharedData) - sizeof(SharedData::data) + capacity);
+    // The matching free is in Release
+    auto shared = static_cast<SharedData*>(p);
+    shared->count = 1;
+    shared->capacity = capacity;
+    std::memcpy(shared->data, GetData(), m_used);
+    Release();
+    m_shared = shared;
+    return m_shared->data;
 }
 
-bool
-PacketTagList::Remove(Tag& tag)
+PacketTagList::TagData*
+PacketTagList::WriteRecord(uint32_t offset, TypeId tid, uint32_t dataSize)
 {
-    return COWTraverse(tag, &PacketTagList::RemoveWriter);
+    uint8_t* data = m_shared != nullptr ? m_shared->data : reinterpret_cast<uint8_t*>(m_inline);
+    auto record = reinterpret_cast<TagData*>(data + offset);
+    record->size = dataSize;
+    record->tid = tid;
+    return record;
 }
 
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter(Tag& tag,
-                            bool preMerge,
-                            struct PacketTagList::TagData* cur,
-                            struct PacketTagList::TagData** prevNext)
+void
+PacketTagList::Erase(uint32_t offset)
 {
-    NS_LOG_FUNCTION_NOARGS();
-
-    // found tid
-    bool found = true;
-    tag.Deserialize(TagBuffer(cur->data, cur->data + cur->size));
-    *prevNext = cur->next; // link around cur
-
-    if (preMerge)
+    NS_LOG_FUNCTION(this << offset);
+    uint8_t* data = Reserve(m_used);
+    auto record = reinterpret_cast<const TagData*>(data + offset);
+    uint32_t recordSize = GetRecordSize(record->size);
+    std::memmove(data + offset, data + offset + recordSize, m_used - offset - recordSize);
+    m_used -= recordSize;
+
+    // rebuild the filter, since another tag type may have the same bit
+    m_filter = 0;
+    for (const TagData* cur = Head(); cur != nullptr; cur = Next(cur))
     {
-        // found tid before first merge, so delete cur
-        cur->~TagData();
-        std::free(cur);
-    }
-    else
-    {
-        // cur is always a merge at this point
-        // unmerge cur, since we linked around it already
-        cur->count--;
-        if (cur->next != nullptr)
-        {
-            // there's a next, so make it a merge
-            cur->next->count++;
-        }
+        m_filter |= GetFilterBit(cur->tid);
     }
-    return found;
 }
 
 bool
-PacketTagList::Replace(Tag& tag)
+PacketTagList::Remove(Tag& tag)
 {
-    bool found = COWTraverse(tag, &PacketTagList::ReplaceWriter);
-    if (!found)
+    TypeId tid = tag.GetInstanceTypeId();
+    NS_LOG_FUNCTION(this << tid);
+    uint32_t offset = Find(tid);
+    if (offset == m_used)
     {
-        Add(tag);
+        return false;
     }
-    return found;
+    auto record = reinterpret_cast<const TagData*>(GetData() + offset);
+    auto begin = const_cast<uint8_t*>(record->data);
+    tag.Deserialize(TagBuffer(begin, begin + record->size));
+    Erase(offset);
+    return true;
 }
 
-// COWWriter implementing Replace
 bool
-PacketTagList::ReplaceWriter(Tag& tag,
-                             bool preMerge,
-                             struct PacketTagList::TagData* cur,
-                             struct PacketTagList::TagData** prevNext)
+PacketTagList::Replace(Tag& tag)
 {
-    NS_LOG_FUNCTION_NOARGS();
-
-    // found tid
-    bool found = true;
-    if (preMerge)
+    TypeId tid = tag.GetInstanceTypeId();
+    NS_LOG_FUNCTION(this << tid);
+    uint32_t offset = Find(tid);
+    if (offset == m_used)
     {
-        // found tid before first merge, so just rewrite
-        tag.Serialize(TagBuffer(cur->data, cur->data + cur->size));
+        Add(tag);
+        return false;
     }
-    else
+    auto record = reinterpret_cast<const TagData*>(GetData() + offset);
+    uint32_t dataSize = tag.GetSerializedSize();
+    if (record->size != dataSize)
     {
-        // cur is always a merge at this point
-        // need to copy, replace, and link past cur
-        cur->count--; // unmerge cur
-        struct TagData* copy = CreateTagData(tag.GetSerializedSize());
-        copy->tid = tag.GetInstanceTypeId();
-        copy->count = 1;
-        tag.Serialize(TagBuffer(copy->data, copy->data + copy->size));
-        copy->next = cur->next; // merge into tail
-        if (copy->next != nullptr)
-        {
-            copy->next->count++; // mark new merge
-        }
-        *prevNext = copy; // point prior list at copy
+        // the new value does not fit in the record: add it anew
+        Erase(offset);
+        Add(tag);
+        return true;
     }
-    return found;
+    Reserve(m_used);
+    TagData* copy = WriteRecord(offset, tid, dataSize);
+    tag.Serialize(TagBuffer(copy->data, copy->data + copy->size));
+    return true;
 }
 
 void
 PacketTagList::Add(const Tag& tag) const
 {
-    NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
+    TypeId tid = tag.GetInstanceTypeId();
+    NS_LOG_FUNCTION(this << tid);
     // ensure this id was not yet added
-    for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
-    {
-        NS_ASSERT_MSG(cur->tid != tag.GetInstanceTypeId(),
-                      "Error: cannot add the same kind of tag twice.");
-    }
-    struct TagData* head = CreateTagData(tag.GetSerializedSize());
-    head->count = 1;
-    head->next = nullptr;
-    head->tid = tag.GetInstanceTypeId();
-    head->next = m_next;
+    NS_ASSERT_MSG(Find(tid) == m_used, "Error: cannot add the same kind of tag twice.");
+
+    // Adding a tag does not change the other tags, hence this const method
+    auto self = const_cast<PacketTagList*>(this);
+    uint32_t dataSize = tag.GetSerializedSize();
+    uint32_t recordSize = GetRecordSize(dataSize);
+    uint8_t* data = self->Reserve(m_used + recordSize);
+    std::memmove(data + recordSize, data, m_used);
+    self->m_used += recordSize;
+    TagData* head = self->WriteRecord(0, tid, dataSize);
     tag.Serialize(TagBuffer(head->data, head->data + head->size));
-
-    const_cast<PacketTagList*>(this)->m_next = head;
+    self->m_filter |= GetFilterBit(tid);
 }
 
 bool
 PacketTagList::Peek(Tag& tag) const
 {
-    NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
     TypeId tid = tag.GetInstanceTypeId();
-    for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    NS_LOG_FUNCTION(this << tid);
+    uint32_t offset = Find(tid);
+    if (offset == m_used)
     {
-        if (cur->tid == tid)
-        {
-            /* found tag */
-            tag.Deserialize(TagBuffer(cur->data, cur->data + cur->size));
-            return true;
-        }
+        /* no tag found */
+        return false;
     }
-    /* no tag found */
-    return false;
+    /* found tag */
+    auto record = reinterpret_cast<const TagData*>(GetData() + offset);
+    auto begin = const_cast<uint8_t*>(record->data);
+    tag.Deserialize(TagBuffer(begin, begin + record->size));
+    return true;
 }
 
 const struct PacketTagList::TagData*
 PacketTagList::Head() const
 {
-    return m_next;
+    if (m_used == 0)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const TagData*>(GetData());
+}
+
+const struct PacketTagList::TagData*
+PacketTagList::Next(const struct PacketTagList::TagData* data) const
+{
+    auto next = reinterpret_cast<const uint8_t*>(data) + GetRecordSize(data->size);
+    if (next == GetData() + m_used)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const TagData*>(next);
 }
 
 uint32_t
@@ -311,7 +245,7 @@ PacketTagList::GetSerializedSize() const
 
     size = 4; // numberOfTags
 
-    for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    for (const TagData* cur = Head(); cur != nullptr; cur = Next(cur))
     {
         size += 4; // TagData -> size
 
@@ -348,7 +282,7 @@ PacketTagList::Serialize(uint32_t* buffer, uint32_t maxSize) const
         return 0;
     }
 
-    for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    for (const TagData* cur = Head(); cur != nullptr; cur = Next(cur))
     {
         if (size + 4 <= maxSize)
         {
@@ -409,7 +343,7 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
 
     NS_LOG_INFO("Deserializing number of tags " << numberOfTags);
 
-    struct TagData* prevTag = nullptr;
+    RemoveAll();
     for (uint32_t i = 0; i < numberOfTags; ++i)
     {
         NS_ASSERT(sizeCheck >= 4);
@@ -427,10 +361,12 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
 
         NS_LOG_INFO("Deserializing tag of type " << tid);
 
-        struct TagData* newTag = CreateTagData(tagSize);
-        newTag->count = 1;
-        newTag->next = nullptr;
-        newTag->tid = tid;
+        // The tags are serialized from the head: append them
+        uint32_t offset = m_used;
+        Reserve(m_used + GetRecordSize(tagSize));
+        m_used += GetRecordSize(tagSize);
+        TagData* newTag = WriteRecord(offset, tid, tagSize);
+        m_filter |= GetFilterBit(tid);
 
         NS_ASSERT(sizeCheck >= tagSize);
         memcpy(newTag->data, p, tagSize);
@@ -439,18 +375,6 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
         uint32_t tagWordSize = (tagSize + 3) & (~3);
         p += tagWordSize / 4;
         sizeCheck -= tagWordSize;
-
-        // Set link list pointers.
-        if (i == 0)
-        {
-            m_next = newTag;
-        }
-        else
-        {
-            prevTag->next = newTag;
-        }
-
-        prevTag = newTag;
     }
 
     NS_ASSERT(sizeCheck == 0);
@@ -21,14 +21,20 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a list of Packet tags, including copy-on-write semantics.
 */
 
 #include "ns3/type-id.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <ostream>
 #include <stdint.h>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 namespace ns3
 {
 
@@ -44,90 +50,28 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
- *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
- *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
- *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
+ *   - Tags are stored in serialized form, as consecutive TagData records
+ *     (aligned on 4 bytes), the most recent tag first.
  *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
+ *   - The records are stored in a small buffer within the PacketTagList
+ *     as long as they fit in #INLINE_SIZE bytes, which is enough for a few
+ *     small tags, so that most packets need no memory allocation for
+ *     their tags. Copying such a list copies the records.
  *
- * \par <b> Copy-on-write </b> is implemented as follows:
+ *   - Larger lists are stored in a heap-allocated, reference-counted
+ *     block, which is shared by the copies of the list until one of them
+ *     is modified (copy-on-write).
  *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
- *   - Copy constructor (PacketTagList(const PacketTagList & o))
- *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
- *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ *   - A 64-bit filter, with the bit of index <tt>uid % 64</tt> set for the
+ *     TypeId uid of each tag, makes #Peek, #Remove and #Replace return
+ *     without scanning the records when the tag type is absent, which is
+ *     the most frequent case of lookup.
  */
 class PacketTagList
 {
   public:
     /**
-     * Tree node for sharing serialized tags.
-     *
-     * See PacketTagList for a discussion of the data structure.
+     * Serialized tag.
      *
      * \internal
      * Unfortunately this has to be public, because
@@ -135,17 +79,14 @@ class PacketTagList
      * The Item nested class can't be forward declared, so friending isn't
      * possible.
      *
-     * We use placement new so we can allocate enough room for the Tag
-     * type which will be serialized into data.  See Object::Aggregates
-     * for a similar construction.
+     * A record is followed by the serialized tag, and padded to a multiple
+     * of 4 bytes.
      */
     struct TagData
     {
-        struct TagData* next; //!< Pointer to next in list
-        uint32_t count;       //!< Number of incoming links
-        TypeId tid;           //!< Type of the tag serialized into #data
-        uint32_t size;        //!< Size of the \c data buffer
-        uint8_t data[1];      //!< Serialization buffer
+        uint32_t size;   //!< Size of the \c data buffer
+        TypeId tid;      //!< Type of the tag serialized into #data
+        uint8_t data[2]; //!< Serialization buffer
     };
 
     /**
@@ -157,8 +98,8 @@ class PacketTagList
      *
      * \param [in] o The PacketTagList to copy.
      *
-     * This makes a light-weight copy by #RemoveAll, then
-     * pointing to the same \ref TagData as \pname{o}.
+     * This copies the records stored in the PacketTagList, or shares
+     * the heap-allocated records of \pname{o}.
      */
     inline PacketTagList(const PacketTagList& o);
     /**
@@ -167,19 +108,17 @@ class PacketTagList
      * \param [in] o The PacketTagList to copy.
      * \returns the copied object
      *
-     * This makes a light-weight copy by #RemoveAll, then
-     * pointing to the same \ref TagData as \pname{o}.
+     * This copies the records stored in the PacketTagList, or shares
+     * the heap-allocated records of \pname{o}.
      */
     inline PacketTagList& operator=(const PacketTagList& o);
     /**
      * Destructor
-     *
-     * #RemoveAll's the tags up to the first merge.
      */
     inline ~PacketTagList();
 
     /**
-     * Add a tag to the head of this branch.
+     * Add a tag to the head of this list.
      *
      * \param [in] tag The tag to add
      */
@@ -211,13 +150,18 @@ class PacketTagList
      */
     bool Peek(Tag& tag) const;
     /**
-     * Remove all tags from this list (up to the first merge).
+     * Remove all tags from this list.
      */
     inline void RemoveAll();
     /**
-     * \returns pointer to head of tag list
+     * \returns pointer to the first tag of the list, or null if the list is empty
      */
     const struct PacketTagList::TagData* Head() const;
+    /**
+     * \param [in] data A tag of this list.
+     * \returns pointer to the tag after \pname{data}, or null if it is the last one
+     */
+    const struct PacketTagList::TagData* Next(const struct PacketTagList::TagData* data) const;
     /**
      * Returns number of bytes required for packet serialization.
      *
@@ -245,66 +189,85 @@ class PacketTagList
 
   private:
     /**
-     * Allocate and construct a TagData struct, sizing the data area
-     * large enough to serialize dataSize bytes from a Tag.
-     *
-     * \param [in] dataSize The serialized size of the Tag.
-     * \returns The newly constructed TagData object.
+     * Heap-allocated records, shared by copy-on-write.
      */
-    static TagData* CreateTagData(size_t dataSize);
+    struct SharedData
+    {
+#ifdef NS3_MTP
+        std::atomic<uint32_t> count; //!< Number of PacketTagList using these records
+#else
+        uint32_t count; //!< Number of PacketTagList using these records
+#endif
+        uint32_t capacity; //!< Size of the \c data buffer
+        uint8_t data[8];   //!< The records
+    };
 
+    /** Size of the buffer of the records stored in the PacketTagList. */
+    static const uint32_t INLINE_SIZE = 64;
+
+    /**
+     * \returns The records.
+     */
+    inline const uint8_t* GetData() const;
     /**
-     * Typedef of method function pointer for copy-on-write operations
+     * Get the size of the record of a tag.
      *
-     * \param [in] tag The tag type to operate on.
-     * \param [in] preMerge True if \pname{tag} was found before the first merge,
-     *             false otherwise.
-     * \param [in] cur Pointer to the tag.
-     * \param [in] prevNext Pointer to the struct TagData.next pointer
-     *          pointing to \pname{cur}.
-     * \returns True if operation successful, false otherwise
+     * \param [in] dataSize The serialized size of the tag.
+     * \returns The size of the record, including its padding.
      */
-    typedef bool (PacketTagList::*COWWriter)(Tag& tag,
-                                             bool preMerge,
-                                             struct TagData* cur,
-                                             struct TagData** prevNext);
+    static uint32_t GetRecordSize(uint32_t dataSize);
     /**
-     * Traverse the list implementing copy-on-write, using \pname{Writer}.
+     * Get the bit of the filter of a tag type.
      *
-     * \param [in] tag The tag type to operate on.
-     * \param [in] Writer The copy-on-write function to use.
-     * \returns True if \pname{tag} found, false otherwise.
+     * \param [in] tid The tag type.
+     * \returns The bit of the filter.
      */
-    bool COWTraverse(Tag& tag, PacketTagList::COWWriter Writer);
+    static uint64_t GetFilterBit(TypeId tid);
     /**
-     * Copy-on-write implementing Remove.
+     * Find the record of a tag type.
      *
-     * \param [in] tag The target tag type to remove.
-     * \param [in] preMerge True if \pname{tag} was found before the first merge,
-     *             false otherwise.
-     * \param [in] cur Pointer to the tag.
-     * \param [in] prevNext Pointer to the struct TagData.next pointer
-     *          pointing to \pname{cur}.
-     * \returns True, since tag will definitely be removed.
+     * \param [in] tid The tag type.
+     * \returns The offset of the record, or #m_used if absent.
      */
-    bool RemoveWriter(Tag& tag, bool preMerge, struct TagData* cur, struct TagData** prevNext);
+    uint32_t Find(TypeId tid) const;
     /**
-     * Copy-on-write implementing Replace
+     * Make sure that the records are not shared and that their
+     * storage can hold some bytes.
      *
-     * \param [in] tag The target tag type to replace
-     * \param [in] preMerge True if \pname{tag} was found before the first merge,
-     *          false otherwise.
-     * \param [in] cur Pointer to the tag
-     * \param [in] prevNext Pointer to the struct TagData.next pointer
-     *          pointing to \pname{cur}.
-     * \returns True, since tag value will definitely be replaced.
+     * \param [in] size The number of bytes needed.
+     * \returns The records.
      */
-    bool ReplaceWriter(Tag& tag, bool preMerge, struct TagData* cur, struct TagData** prevNext);
-
+    uint8_t* Reserve(uint32_t size);
+    /**
+     * Remove a record.
+     *
+     * \param [in] offset The offset of the record.
+     */
+    void Erase(uint32_t offset);
+    /**
+     * Write a record.
+     *
+     * \param [in] offset The offset of the record.
+     * \param [in] tid The type of the tag.
+     * \param [in] dataSize The serialized size of the tag.
+     * \returns The record.
+     */
+    TagData* WriteRecord(uint32_t offset, TypeId tid, uint32_t dataSize);
+    /**
+     * Release the heap-allocated records, if any.
+     */
+    inline void Release();
     /**
-     * Pointer to first \ref TagData on the list
+     * Copy the records of another list.
+     *
+     * \param [in] o The other list.
      */
-    struct TagData* m_next;
+    inline void CopyFrom(const PacketTagList& o);
+
+    SharedData* m_shared;               //!< The heap-allocated records, or null if inline
+    uint64_t m_filter;                  //!< Bit filter of the tag types of the list
+    uint32_t m_used;                    //!< Number of bytes of the records
+    uint32_t m_inline[INLINE_SIZE / 4]; //!< The records, if they are not heap-allocated
 };
 
 } // namespace ns3
@@ -317,65 +280,77 @@ namespace ns3
 {
 
 PacketTagList::PacketTagList()
-    : m_next()
+    : m_shared(nullptr),
+      m_filter(0),
+      m_used(0)
 {
 }
 
 PacketTagList::PacketTagList(const PacketTagList& o)
-    : m_next(o.m_next)
+    : m_shared(nullptr)
 {
-    if (m_next != nullptr)
-    {
-        m_next->count++;
-    }
+    CopyFrom(o);
 }
 
 PacketTagList&
 PacketTagList::operator=(const PacketTagList& o)
 {
     // self assignment
-    if (m_next == o.m_next)
+    if (this == &o)
     {
         return *this;
     }
-    RemoveAll();
-    m_next = o.m_next;
-    if (m_next != nullptr)
-    {
-        m_next->count++;
-    }
+    Release();
+    CopyFrom(o);
     return *this;
 }
 
 PacketTagList::~PacketTagList()
 {
-    RemoveAll();
+    Release();
 }
 
 void
 PacketTagList::RemoveAll()
 {
-    struct TagData* prev = nullptr;
-    for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    Release();
+    m_filter = 0;
+    m_used = 0;
+}
+
+const uint8_t*
+PacketTagList::GetData() const
+{
+    return m_shared != nullptr ? m_shared->data : reinterpret_cast<const uint8_t*>(m_inline);
+}
+
+void
+PacketTagList::Release()
+{
+    if (m_shared != nullptr)
     {
-        cur->count--;
-        if (cur->count > 0)
-        {
-            break;
-        }
-        if (prev != nullptr)
+        if (--m_shared->count == 0)
         {
-            prev->~TagData();
-            std::free(prev);
+            std::free(m_shared);
         }
-        prev = cur;
+        m_shared = nullptr;
+    }
+}
+
+void
+PacketTagList::CopyFrom(const PacketTagList& o)
+{
+    m_filter = o.m_filter;
+    m_used = o.m_used;
+    m_shared = o.m_shared;
+    if (m_shared != nullptr)
+    {
+        m_shared->count++;
     }
-    if (prev != nullptr)
+    else
     {
-        prev->~TagData();
-        std::free(prev);
+        std::memcpy(m_inline, o.m_inline, m_used);
     }
-    m_next = nullptr;
 }
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <string>
 
@@ -30,7 +31,11 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Packet");
 
+#ifdef NS3_MTP
+std::atomic<uint32_t> Packet::m_globalUid{0};
+#else
 uint32_t Packet::m_globalUid = 0;
+#endif
 
 TypeId
 ByteTagIterator::Item::GetTypeId() const
@@ -89,8 +94,9 @@ ByteTagIterator::ByteTagIterator(ByteTagList::Iterator i)
 {
 }
 
-PacketTagIterator::PacketTagIterator(const struct PacketTagList::TagData* head)
-    : m_current(head)
+PacketTagIterator::PacketTagIterator(const PacketTagList* list)
+    : m_list(list),
+      m_current(list->Head())
 {
 }
 
@@ -105,7 +111,7 @@ PacketTagIterator::Next()
 {
     NS_ASSERT(HasNext());
     const struct PacketTagList::TagData* prev = m_current;
-    m_current = m_current->next;
+    m_current = m_list->Next(m_current);
     return PacketTagIterator::Item(prev);
 }
 
@@ -138,6 +144,7 @@ Packet::Copy() const
 
 Packet::Packet()
     : m_buffer(),
+      m_chainSize(0),
       m_byteTagList(),
       m_packetTagList(),
       /* The upper 32 bits of the packet id in
@@ -146,14 +153,15 @@ Packet::Packet()
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, 0),
+      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid++, 0),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
 }
 
 Packet::Packet(const Packet& o)
     : m_buffer(o.m_buffer),
+      m_chain(o.m_chain),
+      m_chainSize(o.m_chainSize),
       m_byteTagList(o.m_byteTagList),
       m_packetTagList(o.m_packetTagList),
       m_metadata(o.m_metadata)
@@ -169,6 +177,8 @@ Packet::operator=(const Packet& o)
         return *this;
     }
     m_buffer = o.m_buffer;
+    m_chain = o.m_chain;
+    m_chainSize = o.m_chainSize;
     m_byteTagList = o.m_byteTagList;
     m_packetTagList = o.m_packetTagList;
     m_metadata = o.m_metadata;
@@ -178,6 +188,7 @@ Packet::operator=(const Packet& o)
 
 Packet::Packet(uint32_t size)
     : m_buffer(size),
+      m_chainSize(0),
       m_byteTagList(),
       m_packetTagList(),
       /* The upper 32 bits of the packet id in
@@ -186,14 +197,14 @@ Packet::Packet(uint32_t size)
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid++, size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
 }
 
 Packet::Packet(const uint8_t* buffer, uint32_t size, bool magic)
     : m_buffer(0, false),
+      m_chainSize(0),
       m_byteTagList(),
       m_packetTagList(),
       m_metadata(0, 0),
@@ -205,6 +216,7 @@ Packet::Packet(const uint8_t* buffer, uint32_t size, bool magic)
 
 Packet::Packet(const uint8_t* buffer, uint32_t size)
     : m_buffer(),
+      m_chainSize(0),
       m_byteTagList(),
       m_packetTagList(),
       /* The upper 32 bits of the packet id in
@@ -213,10 +225,9 @@ Packet::Packet(const uint8_t* buffer, uint32_t size)
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid++, size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
     m_buffer.AddAtStart(size);
     Buffer::Iterator i = m_buffer.Begin();
     i.Write(buffer, size);
@@ -227,6 +238,7 @@ Packet::Packet(const Buffer& buffer,
                const PacketTagList& packetTagList,
                const PacketMetadata& metadata)
     : m_buffer(buffer),
+      m_chainSize(0),
       m_byteTagList(byteTagList),
       m_packetTagList(packetTagList),
       m_metadata(metadata),
@@ -238,20 +250,74 @@ Ptr<Packet>
 Packet::CreateFragment(uint32_t start, uint32_t length) const
 {
     NS_LOG_FUNCTION(this << start << length);
-    Buffer buffer = m_buffer.CreateFragment(start, length);
+    NS_ASSERT(GetSize() >= start + length);
+    uint32_t end = GetSize() - (start + length);
     ByteTagList byteTagList = m_byteTagList;
     byteTagList.Adjust(-start);
-    NS_ASSERT(m_buffer.GetSize() >= start + length);
-    uint32_t end = m_buffer.GetSize() - (start + length);
     PacketMetadata metadata = m_metadata.CreateFragment(start, end);
+    // the fragment references the part of each buffer it covers
+    uint32_t size = m_buffer.GetSize();
+    uint32_t count = std::min(length, size - std::min(start, size));
+    Buffer buffer = m_buffer.CreateFragment(std::min(start, size), count);
+    start -= std::min(start, size);
+    length -= count;
     // again, call the constructor directly rather than
     // through Create because it is private.
     Ptr<Packet> ret =
         Ptr<Packet>(new Packet(buffer, byteTagList, m_packetTagList, metadata), false);
+    for (auto i = m_chain.begin(); i != m_chain.end() && length > 0; i++)
+    {
+        size = i->GetSize();
+        if (start >= size)
+        {
+            start -= size;
+            continue;
+        }
+        count = std::min(length, size - start);
+        if (ret->m_buffer.GetSize() == 0)
+        {
+            ret->m_buffer = i->CreateFragment(start, count);
+        }
+        else
+        {
+            ret->Chain(i->CreateFragment(start, count));
+        }
+        start = 0;
+        length -= count;
+    }
     ret->SetNixVector(GetNixVector());
     return ret;
 }
 
+void
+Packet::Chain(const Buffer& buffer)
+{
+    // the buffer may be an element of m_chain, which push_back reallocates
+    uint32_t size = buffer.GetSize();
+    if (size == 0)
+    {
+        return;
+    }
+    m_chain.push_back(buffer);
+    m_chainSize += size;
+}
+
+void
+Packet::Flatten() const
+{
+    if (m_chain.empty())
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << m_chain.size() << m_chainSize);
+    for (const auto& buffer : m_chain)
+    {
+        m_buffer.AddAtEnd(buffer);
+    }
+    m_chain.clear();
+    m_chainSize = 0;
+}
+
 void
 Packet::SetNixVector(Ptr<NixVector> nixVector) const
 {
@@ -279,6 +345,7 @@ Packet::AddHeader(const Header& header)
 uint32_t
 Packet::RemoveHeader(Header& header, uint32_t size)
 {
+    Flatten();
     Buffer::Iterator end;
     end = m_buffer.Begin();
     end.Next(size);
@@ -293,6 +360,7 @@ Packet::RemoveHeader(Header& header, uint32_t size)
 uint32_t
 Packet::RemoveHeader(Header& header)
 {
+    Flatten();
     uint32_t deserialized = header.Deserialize(m_buffer.Begin());
     NS_LOG_FUNCTION(this << header.GetInstanceTypeId().GetName() << deserialized);
     m_buffer.RemoveAtStart(deserialized);
@@ -304,6 +372,7 @@ Packet::RemoveHeader(Header& header)
 uint32_t
 Packet::PeekHeader(Header& header) const
 {
+    Flatten();
     uint32_t deserialized = header.Deserialize(m_buffer.Begin());
     NS_LOG_FUNCTION(this << header.GetInstanceTypeId().GetName() << deserialized);
     return deserialized;
@@ -312,6 +381,7 @@ Packet::PeekHeader(Header& header) const
 uint32_t
 Packet::PeekHeader(Header& header, uint32_t size) const
 {
+    Flatten();
     Buffer::Iterator end;
     end = m_buffer.Begin();
     end.Next(size);
@@ -326,6 +396,7 @@ Packet::AddTrailer(const Trailer& trailer)
     uint32_t size = trailer.GetSerializedSize();
     NS_LOG_FUNCTION(this << trailer.GetInstanceTypeId().GetName() << size);
     m_byteTagList.AddAtEnd(GetSize());
+    Flatten();
     m_buffer.AddAtEnd(size);
     Buffer::Iterator end = m_buffer.End();
     trailer.Serialize(end);
@@ -335,6 +406,7 @@ Packet::AddTrailer(const Trailer& trailer)
 uint32_t
 Packet::RemoveTrailer(Trailer& trailer)
 {
+    Flatten();
     uint32_t deserialized = trailer.Deserialize(m_buffer.End());
     NS_LOG_FUNCTION(this << trailer.GetInstanceTypeId().GetName() << deserialized);
     m_buffer.RemoveAtEnd(deserialized);
@@ -345,6 +417,7 @@ Packet::RemoveTrailer(Trailer& trailer)
 uint32_t
 Packet::PeekTrailer(Trailer& trailer)
 {
+    Flatten();
     uint32_t deserialized = trailer.Deserialize(m_buffer.End());
     NS_LOG_FUNCTION(this << trailer.GetInstanceTypeId().GetName() << deserialized);
     return deserialized;
@@ -359,7 +432,21 @@ Packet::AddAtEnd(Ptr<const Packet> packet)
     copy.AddAtStart(0);
     copy.Adjust(GetSize());
     m_byteTagList.Add(copy);
-    m_buffer.AddAtEnd(packet->m_buffer);
+    // reference the buffers of the packet rather than copying them;
+    // the packet may be this packet, hence the chain is read by index
+    std::size_t n = packet->m_chain.size();
+    if (GetSize() == 0)
+    {
+        m_buffer = packet->m_buffer;
+    }
+    else
+    {
+        Chain(packet->m_buffer);
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        Chain(packet->m_chain[i]);
+    }
     m_metadata.AddAtEnd(packet->m_metadata);
 }
 
@@ -368,7 +455,15 @@ Packet::AddPaddingAtEnd(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
     m_byteTagList.AddAtEnd(GetSize());
-    m_buffer.AddAtEnd(size);
+    // a zero area, which also makes sure that the padding is zero-filled
+    if (m_chain.empty())
+    {
+        m_buffer.AddAtEnd(Buffer(size));
+    }
+    else
+    {
+        Chain(Buffer(size));
+    }
     m_metadata.AddPaddingAtEnd(size);
 }
 
@@ -376,17 +471,44 @@ void
 Packet::RemoveAtEnd(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    m_buffer.RemoveAtEnd(size);
     m_metadata.RemoveAtEnd(size);
+    while (size > 0 && !m_chain.empty())
+    {
+        Buffer& last = m_chain.back();
+        uint32_t removed = std::min(size, last.GetSize());
+        last.RemoveAtEnd(removed);
+        m_chainSize -= removed;
+        size -= removed;
+        if (last.GetSize() == 0)
+        {
+            m_chain.pop_back();
+        }
+    }
+    m_buffer.RemoveAtEnd(size);
 }
 
 void
 Packet::RemoveAtStart(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    m_buffer.RemoveAtStart(size);
     m_byteTagList.Adjust(-size);
     m_metadata.RemoveAtStart(size);
+    if (size >= m_buffer.GetSize() && !m_chain.empty())
+    {
+        // drop the leading buffers and make the next one the first buffer
+        auto i = m_chain.begin();
+        size -= m_buffer.GetSize();
+        while (i + 1 != m_chain.end() && size >= i->GetSize())
+        {
+            size -= i->GetSize();
+            m_chainSize -= i->GetSize();
+            i++;
+        }
+        m_buffer = *i;
+        m_chainSize -= i->GetSize();
+        m_chain.erase(m_chain.begin(), i + 1);
+    }
+    m_buffer.RemoveAtStart(size);
 }
 
 void
@@ -399,13 +521,24 @@ Packet::RemoveAllByteTags()
 uint32_t
 Packet::CopyData(uint8_t* buffer, uint32_t size) const
 {
-    return m_buffer.CopyData(buffer, size);
+    uint32_t copied = m_buffer.CopyData(buffer, size);
+    for (auto i = m_chain.begin(); i != m_chain.end() && copied < size; i++)
+    {
+        copied += i->CopyData(buffer + copied, size - copied);
+    }
+    return copied;
 }
 
 void
 Packet::CopyData(std::ostream* os, uint32_t size) const
 {
-    return m_buffer.CopyData(os, size);
+    m_buffer.CopyData(os, size);
+    size -= std::min(size, m_buffer.GetSize());
+    for (auto i = m_chain.begin(); i != m_chain.end() && size > 0; i++)
+    {
+        i->CopyData(os, size);
+        size -= std::min(size, i->GetSize());
+    }
 }
 
 uint64_t
@@ -455,6 +588,7 @@ Packet::ToString() const
 void
 Packet::Print(std::ostream& os) const
 {
+    Flatten();
     PacketMetadata::ItemIterator i = m_metadata.BeginItem(m_buffer);
     while (i.HasNext())
     {
@@ -589,6 +723,7 @@ Packet::Print(std::ostream& os) const
 PacketMetadata::ItemIterator
 Packet::BeginItem() const
 {
+    Flatten();
     return m_metadata.BeginItem(m_buffer);
 }
 
@@ -609,6 +744,7 @@ Packet::EnableChecking()
 uint32_t
 Packet::GetSerializedSize() const
 {
+    Flatten();
     uint32_t size = 0;
 
     if (m_nixVector)
@@ -662,6 +798,7 @@ Packet::GetSerializedSize() const
 uint32_t
 Packet::Serialize(uint8_t* buffer, uint32_t maxSize) const
 {
+    Flatten();
     uint32_t* p = reinterpret_cast<uint32_t*>(buffer);
     uint32_t size = 0;
 
@@ -1038,7 +1175,7 @@ Packet::PrintPacketTags(std::ostream& os) const
 PacketTagIterator
 Packet::GetPacketTagIterator() const
 {
-    return PacketTagIterator(m_packetTagList.Head());
+    return PacketTagIterator(&m_packetTagList);
 }
 
 std::ostream&
@@ -34,6 +34,11 @@
 #include "ns3/ptr.h"
 
 #include <stdint.h>
+#include <vector>
+
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 namespace ns3
 {
@@ -180,9 +185,10 @@ class PacketTagIterator
     friend class Packet;
     /**
      * Constructor
-     * \param head head of the items
+     * \param list the list of the items
      */
-    PacketTagIterator(const struct PacketTagList::TagData* head);
+    PacketTagIterator(const PacketTagList* list);
+    const PacketTagList* m_list; //!< the list of the tags in a packet
     const struct PacketTagList::TagData*
         m_current; //!< actual position over the set of tags in a packet
 };
@@ -399,6 +405,10 @@ class Packet : public SimpleRefCount<Packet>
      *
      * This does not alter the uid of either packet.
      *
+     * The byte buffers of the input packet are referenced, not copied:
+     * they are copied in the byte buffer of this packet only when a
+     * contiguous view of the bytes is needed, e.g., to remove a header.
+     *
      * \param packet packet to concatenate
      */
     void AddAtEnd(Ptr<const Packet> packet);
@@ -788,15 +798,34 @@ class Packet : public SimpleRefCount<Packet>
      */
     uint32_t Deserialize(const uint8_t* buffer, uint32_t size);
 
-    Buffer m_buffer;               //!< the packet buffer (it's actual contents)
-    ByteTagList m_byteTagList;     //!< the ByteTag list
-    PacketTagList m_packetTagList; //!< the packet's Tag list
-    PacketMetadata m_metadata;     //!< the packet's metadata
+    /**
+     * \brief Copy the buffers of m_chain at the end of m_buffer.
+     *
+     * The content of the packet is unchanged, hence this method is const.
+     */
+    void Flatten() const;
+
+    /**
+     * \brief Append a buffer to m_chain, unless it is empty.
+     * \param buffer the buffer to append
+     */
+    void Chain(const Buffer& buffer);
+
+    mutable Buffer m_buffer;             //!< the packet buffer (it's actual contents)
+    mutable std::vector<Buffer> m_chain; //!< the buffers which follow m_buffer
+    mutable uint32_t m_chainSize;        //!< total size of the buffers of m_chain
+    ByteTagList m_byteTagList;           //!< the ByteTag list
+    PacketTagList m_packetTagList;       //!< the packet's Tag list
+    PacketMetadata m_metadata;           //!< the packet's metadata
 
     /* Please see comments above about nix-vector */
     mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+#ifdef NS3_MTP
+    static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
+#else
     static uint32_t m_globalUid; //!< Global counter of packets Uid
+#endif
 };
 
 /**
@@ -824,7 +853,6 @@ std::ostream& operator<<(std::ostream& os, const Packet& packet);
  * Dirty operations:
  *   - ns3::Packet::AddHeader
  *   - ns3::Packet::AddTrailer
- *   - both versions of ns3::Packet::AddAtEnd
  *   - ns3::Packet::RemovePacketTag
  *   - ns3::Packet::ReplacePacketTag
  *
@@ -841,6 +869,16 @@ std::ostream& operator<<(std::ostream& os, const Packet& packet);
  *   - ns3::Packet::RemoveAtStart
  *   - ns3::Packet::RemoveAtEnd
  *   - ns3::Packet::CopyData
+ *   - ns3::Packet::AddAtEnd
+ *   - ns3::Packet::AddPaddingAtEnd
+ *
+ * ns3::Packet::AddAtEnd keeps a reference to the byte buffer of the
+ * concatenated packet: the buffers of a packet built by concatenation
+ * are copied into a single buffer only by the first operation which
+ * needs a contiguous view of the packet bytes, i.e., the removal or
+ * the deserialization of a header or trailer, ns3::Packet::Print and
+ * ns3::Packet::Serialize. ns3::Packet::CreateFragment and
+ * ns3::Packet::CopyData operate on each buffer in turn.
  *
  * Dirty operations will always be slower than non-dirty operations,
  * sometimes by several orders of magnitude. However, even the
@@ -861,7 +899,7 @@ namespace ns3
 uint32_t
 Packet::GetSize() const
 {
-    return m_buffer.GetSize();
+    return m_buffer.GetSize() + m_chainSize;
 }
 
 } // namespace ns3
@@ -393,6 +393,111 @@ BufferTest::DoRun()
     val2 <<= 8;
     val2 |= i.ReadU8();
     NS_TEST_ASSERT_MSG_EQ(val1, val2, "Bad ReadNtohU16()");
+
+    // Zero areas are merged without copy, even when the data is shared
+    buffer = Buffer(100);
+    buffer.AddAtStart(2);
+    buffer.Begin().WriteU16(0x1234);
+    Buffer shared = buffer;
+    Buffer::PoolStats before = Buffer::GetPoolStats();
+    buffer.AddAtEnd(Buffer(1000));
+    Buffer::PoolStats after = Buffer::GetPoolStats();
+    NS_TEST_ASSERT_MSG_EQ(after.hits + after.misses,
+                          before.hits + before.misses + 1,
+                          "Shared buffer data copied");
+    NS_TEST_ASSERT_MSG_EQ(buffer.GetSize(), 1102, "Bad buffer size");
+    NS_TEST_ASSERT_MSG_EQ(buffer.Begin().ReadU16(), 0x1234, "Bad buffer data");
+    NS_TEST_ASSERT_MSG_EQ(shared.GetSize(), 102, "Shared buffer modified");
+    // Data written at the end of a shared buffer is not seen by the others
+    buffer.AddAtEnd(1);
+    i = buffer.End();
+    i.Prev();
+    i.WriteU8(0x55);
+    shared.AddAtEnd(1);
+    i = shared.End();
+    i.Prev();
+    i.WriteU8(0x66);
+    ENSURE_WRITTEN_BYTES(shared.CreateFragment(100, 3), 3, 0x00, 0x00, 0x66);
+    ENSURE_WRITTEN_BYTES(buffer.CreateFragment(1100, 3), 3, 0x00, 0x00, 0x55);
+
+    // A fragment appended in place to a buffer which shares its data
+    buffer = Buffer();
+    buffer.AddAtStart(4);
+    buffer.Begin().WriteHtonU32(0x01020304);
+    Buffer copy = buffer;
+    copy.AddAtEnd(buffer.CreateFragment(2, 2));
+    ENSURE_WRITTEN_BYTES(copy, 6, 0x01, 0x02, 0x03, 0x04, 0x03, 0x04);
+    ENSURE_WRITTEN_BYTES(buffer, 4, 0x01, 0x02, 0x03, 0x04);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer data pool unit tests.
+ */
+class BufferPoolTest : public TestCase
+{
+  public:
+    void DoRun() override;
+    BufferPoolTest();
+};
+
+BufferPoolTest::BufferPoolTest()
+    : TestCase("Buffer data pool")
+{
+}
+
+void
+BufferPoolTest::DoRun()
+{
+    // Buffers with a virtual zero area, headers and real data
+    auto useBuffers = []() {
+        Buffer a(1500);
+        a.AddAtStart(40);
+        Buffer b;
+        b.AddAtEnd(1500);
+        b.AddAtStart(40);
+    };
+    // Warm up the pool, and the heuristics of the zero area position
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        useBuffers();
+    }
+
+    Buffer::PoolStats before = Buffer::GetPoolStats();
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        useBuffers();
+    }
+    Buffer::PoolStats after = Buffer::GetPoolStats();
+    NS_TEST_ASSERT_MSG_EQ(after.misses, before.misses, "Buffer data allocated out of the pool");
+    NS_TEST_ASSERT_MSG_GT(after.hits - before.hits, 200, "Too few pool hits");
+    NS_TEST_ASSERT_MSG_EQ(after.hits - before.hits,
+                          after.releases - before.releases,
+                          "Wrong number of releases");
+    NS_TEST_ASSERT_MSG_EQ(after.cached, before.cached, "Buffer data leaked out of the pool");
+
+    // Blocks larger than the limit are not pooled
+    Buffer::SetPoolLimits(1024, 64 * 1024 * 1024);
+    before = Buffer::GetPoolStats();
+    {
+        Buffer a;
+        a.AddAtEnd(1500);
+    }
+    after = Buffer::GetPoolStats();
+    NS_TEST_ASSERT_MSG_EQ(after.misses - before.misses, 1, "Wrong number of pool misses");
+    NS_TEST_ASSERT_MSG_EQ(after.frees - before.frees, 1, "Wrong number of frees");
+
+    // Nothing is pooled when the pool cannot hold any byte
+    Buffer::SetPoolLimits(65536, 0);
+    before = Buffer::GetPoolStats();
+    {
+        Buffer b(100);
+    }
+    after = Buffer::GetPoolStats();
+    NS_TEST_ASSERT_MSG_EQ(after.releases, before.releases, "Buffer data released to the pool");
+    Buffer::SetPoolLimits(65536, 64 * 1024 * 1024);
 }
 
 /**
@@ -411,6 +516,7 @@ BufferTestSuite::BufferTestSuite()
     : TestSuite("buffer", UNIT)
 {
     AddTestCase(new BufferTest, TestCase::QUICK);
+    AddTestCase(new BufferPoolTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -25,7 +25,9 @@
 #include <iomanip>
 #include <iostream>
 #include <limits> // std:numeric_limits
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -1176,6 +1178,39 @@ PacketTagListTest::DoRun()
 #undef RemoveCheck
 } // Removal
 
+{ // Copies of small lists, and of lists which do not fit in a PacketTagList
+    std::cout << GetName() << "check copies of small and large lists" << std::endl;
+    PacketTagList ptl;
+    ptl.Add(t1);
+    ptl.Add(t2);
+    PacketTagList small = ptl;
+    ptl.Add(t3);
+    ptl.Add(t4);
+    ptl.Add(t5);
+    ptl.Add(t6);
+    PacketTagList large = ptl;
+    ptl.Add(t7);
+    CheckRefList(ptl, "grown list");
+    CheckRef(small, t1, "small copy");
+    CheckRef(small, t2, "small copy");
+    CheckRef(small, t3, "small copy", true);
+    CheckRef(large, t6, "large copy");
+    CheckRef(large, t7, "large copy", true);
+
+    // Remove tags from a shared list, then add one back
+    large = ptl;
+    large.Remove(t7);
+    large.Remove(t6);
+    large.Remove(t5);
+    large.Remove(t4);
+    CheckRefList(ptl, "shrunk copy, orig");
+    CheckRef(large, t3, "shrunk copy");
+    CheckRef(large, t4, "shrunk copy", true);
+    large.Add(t4);
+    CheckRef(large, t4, "shrunk copy, add");
+    CheckRefList(ptl, "shrunk copy, add, orig");
+}
+
 { // Replace
 
     std::cout << GetName() << "check replacing each tag" << std::endl;
@@ -1260,6 +1295,104 @@ PacketTagListTest::DoRun()
 } // Timing
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet concatenation without copy of the byte buffers.
+ */
+class PacketChainTest : public TestCase
+{
+  public:
+    PacketChainTest();
+    void DoRun() override;
+
+  private:
+    /**
+     * Get the bytes of a packet.
+     * \param p The packet
+     * \returns The bytes of the packet.
+     */
+    static std::string GetBytes(Ptr<const Packet> p);
+};
+
+PacketChainTest::PacketChainTest()
+    : TestCase("Packet concatenation without copy")
+{
+}
+
+std::string
+PacketChainTest::GetBytes(Ptr<const Packet> p)
+{
+    std::string bytes(p->GetSize(), '\0');
+    p->CopyData(reinterpret_cast<uint8_t*>(&bytes[0]), p->GetSize());
+    return bytes;
+}
+
+void
+PacketChainTest::DoRun()
+{
+    const std::string parts[] = {"hello ", "wonderful ", "world"};
+    std::string expected;
+    std::vector<Ptr<Packet>> packets;
+    for (const auto& part : parts)
+    {
+        packets.push_back(
+            Create<Packet>(reinterpret_cast<const uint8_t*>(part.c_str()), part.size()));
+        expected += part;
+    }
+
+    // Neither the concatenation nor the fragmentation allocate buffer data
+    Buffer::PoolStats before = Buffer::GetPoolStats();
+    Ptr<Packet> p = packets[0]->Copy();
+    p->AddAtEnd(packets[1]);
+    p->AddAtEnd(packets[2]);
+    Ptr<Packet> fragment = p->CreateFragment(3, 15);
+    std::string bytes = GetBytes(p);
+    std::ostringstream oss;
+    fragment->CopyData(&oss, fragment->GetSize());
+    Buffer::PoolStats after = Buffer::GetPoolStats();
+    NS_TEST_EXPECT_MSG_EQ(after.hits + after.misses,
+                          before.hits + before.misses,
+                          "Buffer data allocated");
+    NS_TEST_EXPECT_MSG_EQ(p->GetSize(), expected.size(), "Wrong size");
+    NS_TEST_EXPECT_MSG_EQ(bytes, expected, "Wrong content");
+    NS_TEST_EXPECT_MSG_EQ(oss.str(), expected.substr(3, 15), "Wrong fragment content");
+    NS_TEST_EXPECT_MSG_EQ(GetBytes(packets[0]), parts[0], "Concatenated packet modified");
+
+    // Removing bytes across buffers
+    Ptr<Packet> q = p->Copy();
+    q->RemoveAtStart(8);
+    q->RemoveAtEnd(7);
+    NS_TEST_EXPECT_MSG_EQ(GetBytes(q), expected.substr(8, 6), "Wrong content");
+    q->AddPaddingAtEnd(2);
+    q->AddAtEnd(packets[2]);
+    NS_TEST_EXPECT_MSG_EQ(GetBytes(q),
+                          expected.substr(8, 6) + std::string(2, '\0') + parts[2],
+                          "Wrong content");
+
+    // The buffers are copied in a single buffer by the header operations
+    ATestHeader<3> header;
+    p->AddHeader(header);
+    p->AddAtEnd(packets[0]);
+    Ptr<Packet> copy = p->Copy();
+    p->RemoveHeader(header);
+    NS_TEST_EXPECT_MSG_EQ(header.m_error, false, "Wrong header");
+    NS_TEST_EXPECT_MSG_EQ(GetBytes(p), expected + parts[0], "Wrong content");
+    NS_TEST_EXPECT_MSG_EQ(copy->GetSize(), p->GetSize() + 3, "Copy modified");
+    NS_TEST_EXPECT_MSG_EQ(GetBytes(copy->CreateFragment(3, p->GetSize())),
+                          expected + parts[0],
+                          "Wrong copy content");
+
+    // Concatenation of a packet to itself
+    Ptr<Packet> r = packets[1]->Copy();
+    r->AddAtEnd(packets[2]);
+    r->AddAtEnd(r);
+    NS_TEST_EXPECT_MSG_EQ(GetBytes(r),
+                          parts[1] + parts[2] + parts[1] + parts[2],
+                          "Wrong content");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1277,6 +1410,7 @@ PacketTestSuite::PacketTestSuite()
 {
     AddTestCase(new PacketTest, TestCase::QUICK);
     AddTestCase(new PacketTagListTest, TestCase::QUICK);
+    AddTestCase(new PacketChainTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -15,16 +15,28 @@
  * Author:  Craig Dowell (craigdo@ee.washington.edu)
  */
 
+#include "ns3/async-file-buffer.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/enum.h"
 #include "ns3/log.h"
+#include "ns3/output-stream-wrapper.h"
 #include "ns3/pcap-file.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("pcap-file-test-suite");
@@ -1375,6 +1387,138 @@ DiffTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ(usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the pcap and ASCII files written by the
+ * background thread of AsyncFileBuffer, compressed or not, have the same
+ * contents as the files written directly.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+  public:
+    AsyncWriteTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Write the known packets many times in a pcap file, and lines in an
+     * ASCII file.
+     * \param pcapFilename the name of the pcap file
+     * \param asciiFilename the name of the ASCII file
+     */
+    void WriteFiles(const std::string& pcapFilename, const std::string& asciiFilename);
+
+    /**
+     * \param filename the name of a file
+     * \return the contents of the file
+     */
+    static std::string ReadFile(const std::string& filename);
+
+    static const uint32_t N_REPETITIONS = 200; //!< Number of times the packets are written
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase()
+    : TestCase("Check that the files written by the background thread are complete")
+{
+}
+
+void
+AsyncWriteTestCase::WriteFiles(const std::string& pcapFilename, const std::string& asciiFilename)
+{
+    PcapFile f;
+    f.Open(pcapFilename, std::ios::out);
+    NS_TEST_ASSERT_MSG_EQ(f.Fail(), false, "Open (" << pcapFilename << ") returns error");
+    f.Init(1, N_PACKET_BYTES);
+    Ptr<OutputStreamWrapper> ascii = Create<OutputStreamWrapper>(asciiFilename, std::ios::out);
+
+    for (uint32_t j = 0; j < N_REPETITIONS; ++j)
+    {
+        for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+        {
+            const PacketEntry& p = knownPackets[i];
+            f.Write(p.tsSec + j, p.tsUsec, (const uint8_t*)p.data, p.origLen);
+            NS_TEST_ASSERT_MSG_EQ(f.Fail(), false, "Write must not fail");
+            *ascii->GetStream() << "t " << p.tsSec + j << "." << p.tsUsec << " len "
+                                << p.origLen << std::endl;
+        }
+    }
+    f.Close();
+}
+
+std::string
+AsyncWriteTestCase::ReadFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void
+AsyncWriteTestCase::DoRun()
+{
+    std::string pcapFilename = CreateTempDirFilename("direct.pcap");
+    std::string asciiFilename = CreateTempDirFilename("direct.tr");
+    WriteFiles(pcapFilename, asciiFilename);
+
+    // small buffers, such that the writer thread applies backpressure
+    Config::SetGlobal("AsyncTraceWriter", BooleanValue(true));
+    Config::SetGlobal("TraceBufferSize", UintegerValue(512));
+    std::string asyncPcapFilename = CreateTempDirFilename("async.pcap");
+    std::string asyncAsciiFilename = CreateTempDirFilename("async.tr");
+    WriteFiles(asyncPcapFilename, asyncAsciiFilename);
+
+    uint32_t sec(0);
+    uint32_t usec(0);
+    uint32_t packets(0);
+    NS_TEST_EXPECT_MSG_EQ(PcapFile::Diff(pcapFilename, asyncPcapFilename, sec, usec, packets),
+                          false,
+                          "The pcap file written by the background thread is different");
+    NS_TEST_EXPECT_MSG_EQ(packets, N_KNOWN_PACKETS * N_REPETITIONS, "Missing packets");
+    NS_TEST_EXPECT_MSG_EQ((ReadFile(pcapFilename) == ReadFile(asyncPcapFilename)),
+                          true,
+                          "The pcap files are not identical");
+    NS_TEST_EXPECT_MSG_EQ((ReadFile(asciiFilename) == ReadFile(asyncAsciiFilename)),
+                          true,
+                          "The ASCII files are not identical");
+
+#ifdef HAVE_ZLIB
+    Config::SetGlobal("TraceCompression", EnumValue(AsyncFileBuffer::GZIP));
+    std::string gzPcapFilename = CreateTempDirFilename("compressed.pcap");
+    std::string gzAsciiFilename = CreateTempDirFilename("compressed.tr");
+    WriteFiles(gzPcapFilename, gzAsciiFilename);
+
+    for (const auto& files : {std::make_pair(pcapFilename, gzPcapFilename),
+                              std::make_pair(asciiFilename, gzAsciiFilename)})
+    {
+        gzFile gz = gzopen((files.second + ".gz").c_str(), "rb");
+        NS_TEST_ASSERT_MSG_NE(gz, nullptr, "Unable to open " << files.second << ".gz");
+        std::string contents;
+        char data[4096];
+        int n;
+        while ((n = gzread(gz, data, sizeof(data))) > 0)
+        {
+            contents.append(data, n);
+        }
+        gzclose(gz);
+        NS_TEST_EXPECT_MSG_EQ((contents == ReadFile(files.first)),
+                              true,
+                              "The compressed file " << files.second << " is different");
+        std::remove((files.second + ".gz").c_str());
+    }
+    Config::SetGlobal("TraceCompression", EnumValue(AsyncFileBuffer::NONE));
+#endif
+
+    Config::SetGlobal("AsyncTraceWriter", BooleanValue(false));
+    Config::SetGlobal("TraceBufferSize", UintegerValue(65536));
+    for (const auto& filename :
+         {pcapFilename, asciiFilename, asyncPcapFilename, asyncAsciiFilename})
+    {
+        std::remove(filename.c_str());
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1398,6 +1542,7 @@ PcapFileTestSuite::PcapFileTestSuite()
     AddTestCase(new RecordHeaderTestCase, TestCase::QUICK);
     AddTestCase(new ReadFileTestCase, TestCase::QUICK);
     AddTestCase(new DiffTestCase, TestCase::QUICK);
+    AddTestCase(new AsyncWriteTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
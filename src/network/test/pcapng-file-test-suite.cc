@@ -0,0 +1,346 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/pcapng-file-wrapper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/trace-helper.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/// A block of a pcapng file
+struct PcapngBlock
+{
+    uint32_t type;             //!< Block type
+    std::vector<uint8_t> body; //!< Contents between the block length fields
+};
+
+/**
+ * Read the blocks of a pcapng file.
+ *
+ * \param filename the name of the file
+ * \param blocks the blocks read
+ * \return true if the file is a sequence of well-formed blocks
+ */
+static bool
+ReadPcapngBlocks(const std::string& filename, std::vector<PcapngBlock>& blocks)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+    std::size_t offset = 0;
+    while (offset < data.size())
+    {
+        uint32_t header[2];
+        if (data.size() - offset < 12)
+        {
+            return false;
+        }
+        std::memcpy(header, &data[offset], sizeof(header));
+        uint32_t trailer;
+        if (header[1] % 4 != 0 || header[1] < 12 || data.size() - offset < header[1])
+        {
+            return false;
+        }
+        std::memcpy(&trailer, &data[offset + header[1] - 4], sizeof(trailer));
+        if (trailer != header[1])
+        {
+            return false;
+        }
+        blocks.push_back({header[0],
+                          std::vector<uint8_t>(data.begin() + offset + 8,
+                                               data.begin() + offset + header[1] - 4)});
+        offset += header[1];
+    }
+    return true;
+}
+
+/**
+ * \param block a block
+ * \param offset the offset of a field in the body of the block
+ * \return the 32-bit field
+ */
+static uint32_t
+Get32(const PcapngBlock& block, std::size_t offset)
+{
+    uint32_t value;
+    std::memcpy(&value, &block.body[offset], sizeof(value));
+    return value;
+}
+
+/**
+ * \param block an Interface Description Block
+ * \return the value of its if_name option
+ */
+static std::string
+GetInterfaceName(const PcapngBlock& block)
+{
+    std::size_t offset = 8;
+    while (offset + 4 <= block.body.size())
+    {
+        uint16_t option[2];
+        std::memcpy(option, &block.body[offset], sizeof(option));
+        if (option[0] == 2)
+        {
+            return std::string(block.body.begin() + offset + 4,
+                               block.body.begin() + offset + 4 + option[1]);
+        }
+        if (option[0] == 0)
+        {
+            break;
+        }
+        offset += 4 + ((option[1] + 3) & ~3U);
+    }
+    return "";
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the packets of several interfaces, with
+ * different snapshot lengths and filters, are written in the pcapng format.
+ */
+class PcapngWriteTestCase : public TestCase
+{
+  public:
+    PcapngWriteTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Filter of the second interface
+     * \param p a packet
+     * \return true if the packet is smaller than 100 bytes
+     */
+    static bool IsSmall(Ptr<const Packet> p);
+};
+
+PcapngWriteTestCase::PcapngWriteTestCase()
+    : TestCase("Check that the packets of several interfaces are written in a pcapng file")
+{
+}
+
+bool
+PcapngWriteTestCase::IsSmall(Ptr<const Packet> p)
+{
+    return p->GetSize() < 100;
+}
+
+void
+PcapngWriteTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("write.pcapng");
+    Ptr<PcapngFileWrapper> file = CreateObject<PcapngFileWrapper>();
+    file->Open(filename);
+    NS_TEST_ASSERT_MSG_EQ(file->Fail(), false, "Open (" << filename << ") returns error");
+
+    uint32_t first = file->AddInterface(PcapHelper::DLT_EN10MB, "first", 16);
+    uint32_t second = file->AddInterface(PcapHelper::DLT_PPP, "second interface");
+    NS_TEST_EXPECT_MSG_EQ(first, 0, "Wrong index of the first interface");
+    NS_TEST_EXPECT_MSG_EQ(second, 1, "Wrong index of the second interface");
+    NS_TEST_EXPECT_MSG_EQ(file->GetInterfaceName(second), "second interface", "Wrong name");
+    file->SetInterfaceFilter(second, MakeCallback(&PcapngWriteTestCase::IsSmall));
+
+    uint8_t data[200];
+    for (uint32_t i = 0; i < sizeof(data); ++i)
+    {
+        data[i] = i;
+    }
+    file->Write(first, Seconds(1.5), Create<Packet>(data, 40));
+    file->Write(second, Seconds(2) + NanoSeconds(7), Create<Packet>(data, 21));
+    file->Write(second, Seconds(3), Create<Packet>(data, 200));
+    file->Write(first, Seconds(5000), data, 10);
+    NS_TEST_EXPECT_MSG_EQ(file->Fail(), false, "Write must not fail");
+    file->Close();
+
+    std::vector<PcapngBlock> blocks;
+    NS_TEST_ASSERT_MSG_EQ(ReadPcapngBlocks(filename, blocks), true, "Malformed pcapng file");
+    NS_TEST_ASSERT_MSG_EQ(blocks.size(), 6, "Unexpected number of blocks");
+
+    NS_TEST_EXPECT_MSG_EQ(blocks[0].type, PcapngFile::SECTION_HEADER_BLOCK, "Expected a SHB");
+    NS_TEST_EXPECT_MSG_EQ(Get32(blocks[0], 0), PcapngFile::BYTE_ORDER_MAGIC, "Wrong magic");
+    NS_TEST_EXPECT_MSG_EQ(Get32(blocks[0], 4), 1, "Wrong version");
+
+    for (uint32_t i : {1, 2})
+    {
+        NS_TEST_EXPECT_MSG_EQ(blocks[i].type,
+                              PcapngFile::INTERFACE_DESCRIPTION_BLOCK,
+                              "Expected an IDB");
+    }
+    NS_TEST_EXPECT_MSG_EQ(Get32(blocks[1], 0), PcapHelper::DLT_EN10MB, "Wrong link type");
+    NS_TEST_EXPECT_MSG_EQ(Get32(blocks[1], 4), 16, "Wrong snaplen");
+    NS_TEST_EXPECT_MSG_EQ(GetInterfaceName(blocks[1]), "first", "Wrong interface name");
+    NS_TEST_EXPECT_MSG_EQ(Get32(blocks[2], 0), PcapHelper::DLT_PPP, "Wrong link type");
+    NS_TEST_EXPECT_MSG_EQ(Get32(blocks[2], 4), 65535, "Snaplen not set by CaptureSize");
+    NS_TEST_EXPECT_MSG_EQ(GetInterfaceName(blocks[2]),
+                          "second interface",
+                          "Wrong interface name");
+
+    struct
+    {
+        uint32_t interface;
+        uint64_t ts;
+        uint32_t inclLen;
+        uint32_t origLen;
+    } expected[] = {
+        {0, 1500000000ULL, 16, 40},
+        {1, 2000000007ULL, 21, 21},
+        {0, 5000000000000ULL, 10, 10},
+    };
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const PcapngBlock& block = blocks[3 + i];
+        NS_TEST_EXPECT_MSG_EQ(block.type, PcapngFile::ENHANCED_PACKET_BLOCK, "Expected an EPB");
+        NS_TEST_EXPECT_MSG_EQ(Get32(block, 0), expected[i].interface, "Wrong interface");
+        uint64_t ts = (uint64_t(Get32(block, 4)) << 32) | Get32(block, 8);
+        NS_TEST_EXPECT_MSG_EQ(ts, expected[i].ts, "Wrong timestamp of packet " << i);
+        NS_TEST_EXPECT_MSG_EQ(Get32(block, 12), expected[i].inclLen, "Wrong captured length");
+        NS_TEST_EXPECT_MSG_EQ(Get32(block, 16), expected[i].origLen, "Wrong original length");
+        NS_TEST_EXPECT_MSG_EQ(block.body.size(),
+                              20 + ((expected[i].inclLen + 3) & ~3U),
+                              "Wrong block length");
+        NS_TEST_EXPECT_MSG_EQ(std::memcmp(&block.body[20], data, expected[i].inclLen),
+                              0,
+                              "Wrong data of packet " << i);
+    }
+    std::remove(filename.c_str());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Device helper keeping the pcap files it creates, which the test
+ * writes to.
+ */
+class PcapngTestDeviceHelper : public PcapHelperForDevice
+{
+  public:
+    void EnablePcapInternal(std::string prefix,
+                            Ptr<NetDevice> nd,
+                            bool promiscuous,
+                            bool explicitFilename) override
+    {
+        PcapHelper pcapHelper;
+        std::string filename = pcapHelper.GetFilenameFromDevice(prefix, nd);
+        files[nd] = pcapHelper.CreateFile(filename, std::ios::out, PcapHelper::DLT_EN10MB, 64);
+    }
+
+    std::map<Ptr<NetDevice>, Ptr<PcapFileWrapper>> files; //!< File of each device
+};
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the device helpers write the packets of
+ * all the devices in a single pcapng file.
+ */
+class PcapngHelperTestCase : public TestCase
+{
+  public:
+    PcapngHelperTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PcapngHelperTestCase::PcapngHelperTestCase()
+    : TestCase("Check that the device helpers write a single pcapng file")
+{
+}
+
+void
+PcapngHelperTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    NetDeviceContainer devices;
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        nodes.Get(i)->AddDevice(device);
+        devices.Add(device);
+    }
+
+    std::string filename = CreateTempDirFilename("helper.pcapng");
+    PcapHelper pcapHelper;
+    Ptr<PcapngFileWrapper> file = pcapHelper.CreatePcapngFile(filename);
+    PcapngTestDeviceHelper helper;
+    helper.EnablePcap(file, nodes);
+    NS_TEST_ASSERT_MSG_EQ(file->GetNInterfaces(), 2, "Expected an interface per device");
+
+    for (uint32_t i = 0; i < devices.GetN(); ++i)
+    {
+        std::ostringstream oss;
+        oss << "helper-" << nodes.Get(i)->GetId() << "-0";
+        NS_TEST_EXPECT_MSG_EQ(file->GetInterfaceName(i), oss.str(), "Wrong interface name");
+        helper.files[devices.Get(i)]->Write(MilliSeconds(i + 1), Create<Packet>(100 + i));
+    }
+    helper.files.clear();
+    file->Close();
+
+    std::vector<PcapngBlock> blocks;
+    NS_TEST_ASSERT_MSG_EQ(ReadPcapngBlocks(filename, blocks), true, "Malformed pcapng file");
+    NS_TEST_ASSERT_MSG_EQ(blocks.size(), 5, "Unexpected number of blocks");
+    for (uint32_t i = 0; i < devices.GetN(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(Get32(blocks[1 + i], 4), 64, "Wrong snaplen");
+        const PcapngBlock& block = blocks[3 + i];
+        NS_TEST_EXPECT_MSG_EQ(block.type, PcapngFile::ENHANCED_PACKET_BLOCK, "Expected an EPB");
+        NS_TEST_EXPECT_MSG_EQ(Get32(block, 0), i, "Wrong interface");
+        NS_TEST_EXPECT_MSG_EQ(Get32(block, 8), (i + 1) * 1000000, "Wrong timestamp");
+        NS_TEST_EXPECT_MSG_EQ(Get32(block, 12), 64, "Packet not truncated");
+        NS_TEST_EXPECT_MSG_EQ(Get32(block, 16), 100 + i, "Wrong original length");
+    }
+
+    Simulator::Destroy();
+    std::remove(filename.c_str());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief pcapng file TestSuite
+ */
+class PcapngFileTestSuite : public TestSuite
+{
+  public:
+    PcapngFileTestSuite();
+};
+
+PcapngFileTestSuite::PcapngFileTestSuite()
+    : TestSuite("pcapng-file", UNIT)
+{
+    AddTestCase(new PcapngWriteTestCase, TestCase::QUICK);
+    AddTestCase(new PcapngHelperTestCase, TestCase::QUICK);
+}
+
+static PcapngFileTestSuite pcapngFileTestSuite; //!< Static variable for test initialization
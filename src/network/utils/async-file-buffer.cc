@@ -0,0 +1,548 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-file-buffer.h"
+
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncFileBuffer");
+
+/**
+ * \relates AsyncFileBuffer
+ * \anchor GlobalValueAsyncTraceWriter
+ * \brief A global switch to write the trace files from a background thread.
+ */
+static GlobalValue g_asyncTraceWriter =
+    GlobalValue("AsyncTraceWriter",
+                "A global switch to write the pcap and ASCII trace files from a background thread",
+                BooleanValue(false),
+                MakeBooleanChecker());
+
+/**
+ * \relates AsyncFileBuffer
+ * \anchor GlobalValueTraceCompression
+ * \brief The compression of the trace files written from a background thread.
+ */
+static GlobalValue g_traceCompression =
+    GlobalValue("TraceCompression",
+                "The compression of the trace files written from a background thread "
+                "(Gzip adds the .gz extension)",
+                EnumValue(AsyncFileBuffer::NONE),
+                MakeEnumChecker(AsyncFileBuffer::NONE, "None", AsyncFileBuffer::GZIP, "Gzip"));
+
+/**
+ * \relates AsyncFileBuffer
+ * \anchor GlobalValueTraceBufferSize
+ * \brief The size of the buffers of the trace files written from a background thread.
+ */
+static GlobalValue g_traceBufferSize =
+    GlobalValue("TraceBufferSize",
+                "The size in bytes of the buffers of the trace files written from a "
+                "background thread",
+                UintegerValue(65536),
+                MakeUintegerChecker<uint32_t>(512));
+
+/**
+ * \ingroup network
+ *
+ * \brief Background thread writing the buffers of the AsyncFileBuffer
+ * objects, in the order in which they are handed over.
+ */
+class AsyncFileWriter
+{
+  public:
+    /// Maximum number of buffers waiting to be written
+    static const std::size_t MAX_PENDING_BUFFERS = 64;
+
+    /**
+     * \return the writer, started at the first call
+     */
+    static AsyncFileWriter& Get();
+
+    ~AsyncFileWriter();
+
+    /**
+     * Register an open file, to be flushed at Simulator::Destroy.
+     * \param file the file
+     */
+    void Register(AsyncFileBuffer* file);
+
+    /**
+     * Unregister a file, after all its data is written.
+     * \param file the file
+     */
+    void Unregister(AsyncFileBuffer* file);
+
+    /**
+     * Queue a buffer to be written, waiting while too many buffers are
+     * pending.
+     * \param file the file
+     * \param data the buffer
+     */
+    void Push(AsyncFileBuffer* file, std::vector<char>&& data);
+
+    /**
+     * Wait until all the buffers of a file are written.
+     * \param file the file
+     */
+    void Wait(AsyncFileBuffer* file);
+
+    /**
+     * \return an empty buffer, reusing the written ones
+     */
+    std::vector<char> GetBuffer();
+
+    /**
+     * Flush all the registered files.
+     */
+    void FlushAll();
+
+  private:
+    AsyncFileWriter();
+
+    /// Loop of the writer thread
+    void Run();
+
+    /// Buffer waiting to be written
+    struct Job
+    {
+        AsyncFileBuffer* file;  //!< File
+        std::vector<char> data; //!< Data
+    };
+
+    std::mutex m_mutex;                    //!< Mutex of the queue and of the files
+    std::condition_variable m_jobAdded;    //!< Signaled when a buffer is queued or on stop
+    std::condition_variable m_jobDone;     //!< Signaled when a buffer is dequeued or written
+    std::deque<Job> m_jobs;                //!< Buffers waiting to be written
+    AsyncFileBuffer* m_busy;               //!< File being written, or nullptr
+    std::vector<std::vector<char>> m_pool; //!< Written buffers, to be reused
+    std::set<AsyncFileBuffer*> m_files;    //!< Open files
+    bool m_isDestroyScheduled;             //!< True if FlushAll is scheduled at Destroy
+    bool m_stop;                           //!< True to stop the thread
+    std::thread m_thread;                  //!< Writer thread
+};
+
+AsyncFileWriter&
+AsyncFileWriter::Get()
+{
+    static AsyncFileWriter writer;
+    return writer;
+}
+
+AsyncFileWriter::AsyncFileWriter()
+    : m_busy(nullptr),
+      m_isDestroyScheduled(false),
+      m_stop(false)
+{
+    m_thread = std::thread(&AsyncFileWriter::Run, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_jobAdded.notify_all();
+    m_thread.join();
+
+    // complete the files which are still open at exit
+    for (auto file : m_files)
+    {
+        file->FinishFile();
+    }
+}
+
+void
+AsyncFileWriter::Register(AsyncFileBuffer* file)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.insert(file);
+    if (!m_isDestroyScheduled)
+    {
+        Simulator::ScheduleDestroy(&AsyncFileBuffer::FlushAll);
+        m_isDestroyScheduled = true;
+    }
+}
+
+void
+AsyncFileWriter::Unregister(AsyncFileBuffer* file)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.erase(file);
+}
+
+void
+AsyncFileWriter::Push(AsyncFileBuffer* file, std::vector<char>&& data)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_jobs.size() >= MAX_PENDING_BUFFERS)
+    {
+        NS_LOG_LOGIC("Waiting for the writer thread");
+        m_jobDone.wait(lock, [this]() { return m_jobs.size() < MAX_PENDING_BUFFERS; });
+    }
+    m_jobs.push_back({file, std::move(data)});
+    lock.unlock();
+    m_jobAdded.notify_one();
+}
+
+void
+AsyncFileWriter::Wait(AsyncFileBuffer* file)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobDone.wait(lock, [this, file]() {
+        return m_busy != file && std::none_of(m_jobs.begin(), m_jobs.end(), [file](const Job& job) {
+                   return job.file == file;
+               });
+    });
+}
+
+std::vector<char>
+AsyncFileWriter::GetBuffer()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pool.empty())
+    {
+        return std::vector<char>();
+    }
+    std::vector<char> buffer = std::move(m_pool.back());
+    m_pool.pop_back();
+    return buffer;
+}
+
+void
+AsyncFileWriter::FlushAll()
+{
+    std::set<AsyncFileBuffer*> files;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        files = m_files;
+        m_isDestroyScheduled = false;
+    }
+    for (auto file : files)
+    {
+        file->Flush();
+    }
+}
+
+void
+AsyncFileWriter::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_jobAdded.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+        if (m_jobs.empty())
+        {
+            return;
+        }
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_busy = job.file;
+        lock.unlock();
+        m_jobDone.notify_all();
+
+        job.file->WriteData(job.data);
+        job.data.clear();
+
+        lock.lock();
+        m_busy = nullptr;
+        if (m_pool.size() < MAX_PENDING_BUFFERS)
+        {
+            m_pool.push_back(std::move(job.data));
+        }
+        m_jobDone.notify_all();
+    }
+}
+
+AsyncFileBuffer::AsyncFileBuffer(const std::string& filename,
+                                 std::ios::openmode mode,
+                                 Compression compression)
+    : m_filename(filename),
+      m_file(nullptr),
+      m_gzFile(nullptr),
+      m_handedOver(0),
+      m_isUnfinished(false),
+      m_failed(false)
+{
+    // logging this as a std::streambuf* would read the buffer
+    NS_LOG_FUNCTION(static_cast<void*>(this) << filename << mode << compression);
+
+    const char* fileMode = (mode & std::ios::app) ? "ab" : "wb";
+    if (compression == GZIP)
+    {
+#ifdef HAVE_ZLIB
+        m_filename += ".gz";
+        m_gzFile = gzopen(m_filename.c_str(), fileMode);
+#else
+        NS_FATAL_ERROR("Unable to compress " << filename << ": ns-3 was built without zlib");
+#endif
+    }
+    else
+    {
+        m_file = std::fopen(m_filename.c_str(), fileMode);
+    }
+    if (!IsOpen())
+    {
+        NS_LOG_WARN("Unable to open " << m_filename);
+        return;
+    }
+
+    UintegerValue bufferSize;
+    g_traceBufferSize.GetValue(bufferSize);
+    m_buffer = AsyncFileWriter::Get().GetBuffer();
+    m_buffer.resize(bufferSize.Get());
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    AsyncFileWriter::Get().Register(this);
+}
+
+AsyncFileBuffer::~AsyncFileBuffer()
+{
+    NS_LOG_FUNCTION(static_cast<void*>(this));
+    Close();
+}
+
+bool
+AsyncFileBuffer::IsOpen() const
+{
+    return m_file || m_gzFile;
+}
+
+bool
+AsyncFileBuffer::IsEnabled()
+{
+    BooleanValue value;
+    g_asyncTraceWriter.GetValue(value);
+    return value.Get();
+}
+
+AsyncFileBuffer::Compression
+AsyncFileBuffer::GetDefaultCompression()
+{
+    EnumValue value;
+    g_traceCompression.GetValue(value);
+    return static_cast<Compression>(value.Get());
+}
+
+void
+AsyncFileBuffer::FlushAll()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    AsyncFileWriter::Get().FlushAll();
+}
+
+uint64_t
+AsyncFileBuffer::GetPosition() const
+{
+    return m_handedOver + (pptr() - pbase());
+}
+
+void
+AsyncFileBuffer::HandOver()
+{
+    std::size_t size = pptr() - pbase();
+    if (size == 0)
+    {
+        return;
+    }
+    NS_LOG_LOGIC("Handing over " << size << " bytes of " << m_filename);
+    std::size_t capacity = m_buffer.size();
+    m_buffer.resize(size);
+    m_handedOver += size;
+    AsyncFileWriter::Get().Push(this, std::move(m_buffer));
+    m_buffer = AsyncFileWriter::Get().GetBuffer();
+    m_buffer.resize(capacity);
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+AsyncFileBuffer::int_type
+AsyncFileBuffer::overflow(int_type c)
+{
+    if (!IsOpen() || m_failed)
+    {
+        return traits_type::eof();
+    }
+    HandOver();
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        return traits_type::not_eof(c);
+    }
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+}
+
+int
+AsyncFileBuffer::sync()
+{
+    return m_failed ? -1 : 0;
+}
+
+AsyncFileBuffer::pos_type
+AsyncFileBuffer::seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which)
+{
+    off_type position = GetPosition();
+    off_type target = (dir == std::ios::beg) ? off : (dir == std::ios::cur) ? position + off : -1;
+    if (!(which & std::ios::out) || target != position)
+    {
+        return pos_type(off_type(-1));
+    }
+    return pos_type(position);
+}
+
+AsyncFileBuffer::pos_type
+AsyncFileBuffer::seekpos(pos_type pos, std::ios::openmode which)
+{
+    return seekoff(off_type(pos), std::ios::beg, which);
+}
+
+void
+AsyncFileBuffer::WriteData(const std::vector<char>& data)
+{
+    bool written;
+#ifdef HAVE_ZLIB
+    if (m_gzFile)
+    {
+        written = gzwrite(m_gzFile, data.data(), data.size()) == static_cast<int>(data.size());
+    }
+    else
+#endif
+    {
+        written = std::fwrite(data.data(), 1, data.size(), m_file) == data.size();
+    }
+    if (!written)
+    {
+        m_failed = true;
+    }
+    m_isUnfinished = true;
+}
+
+void
+AsyncFileBuffer::FinishFile()
+{
+    if (!m_isUnfinished)
+    {
+        return;
+    }
+    m_isUnfinished = false;
+#ifdef HAVE_ZLIB
+    if (m_gzFile)
+    {
+        gzflush(m_gzFile, Z_FINISH);
+    }
+#endif
+    if (m_file && std::fflush(m_file) != 0)
+    {
+        m_failed = true;
+    }
+}
+
+void
+AsyncFileBuffer::Flush()
+{
+    NS_LOG_FUNCTION(static_cast<void*>(this));
+    if (!IsOpen())
+    {
+        return;
+    }
+    HandOver();
+    AsyncFileWriter::Get().Wait(this);
+    FinishFile();
+    if (m_failed)
+    {
+        NS_LOG_WARN("Unable to write " << m_filename);
+    }
+}
+
+void
+AsyncFileBuffer::Close()
+{
+    NS_LOG_FUNCTION(static_cast<void*>(this));
+    if (!IsOpen())
+    {
+        return;
+    }
+    HandOver();
+    AsyncFileWriter::Get().Wait(this);
+    AsyncFileWriter::Get().Unregister(this);
+#ifdef HAVE_ZLIB
+    if (m_gzFile && gzclose(m_gzFile) != Z_OK)
+    {
+        m_failed = true;
+    }
+#endif
+    if (m_file && std::fclose(m_file) != 0)
+    {
+        m_failed = true;
+    }
+    m_file = nullptr;
+    m_gzFile = nullptr;
+    setp(nullptr, nullptr);
+    if (m_failed)
+    {
+        NS_LOG_WARN("Unable to write " << m_filename);
+    }
+}
+
+AsyncFileStream::AsyncFileStream(const std::string& filename,
+                                 std::ios::openmode mode,
+                                 AsyncFileBuffer::Compression compression)
+    : std::ostream(&m_buffer),
+      m_buffer(filename, mode, compression)
+{
+    if (!m_buffer.IsOpen())
+    {
+        setstate(std::ios::failbit);
+    }
+}
+
+AsyncFileStream::~AsyncFileStream()
+{
+    m_buffer.Close();
+}
+
+bool
+AsyncFileStream::IsOpen() const
+{
+    return m_buffer.IsOpen();
+}
+
+void
+AsyncFileStream::Close()
+{
+    m_buffer.Close();
+}
+
+} // namespace ns3
@@ -0,0 +1,224 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_FILE_BUFFER_H
+#define ASYNC_FILE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <ios>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/// zlib file handle
+struct gzFile_s;
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief Output stream buffer whose contents are written to a file by a
+ * background thread.
+ *
+ * The data written to the stream is accumulated in a buffer in memory.
+ * When the buffer is full, it is handed to a writer thread, shared by all
+ * the AsyncFileBuffer objects, which writes it to the file (compressed
+ * with gzip if requested) while the simulation continues in a new buffer.
+ * When too many buffers are waiting to be written, the simulation thread
+ * waits for the writer thread.
+ *
+ * Flushing the stream (e.g., with std::endl) does not hand the buffer
+ * over: the data is written when the buffer is full, when Flush or Close
+ * is called, and at Simulator::Destroy, where all the files are flushed.
+ *
+ * PcapFile and OutputStreamWrapper use this buffer for the files they
+ * open for writing when the "AsyncTraceWriter" global value is true.
+ * The "TraceCompression" global value selects the compression of these
+ * files, and "TraceBufferSize" the size of the buffers.
+ *
+ * \note The writer thread only accesses the files: the AsyncFileBuffer
+ * objects must be used from the simulation thread.
+ */
+class AsyncFileBuffer : public std::streambuf
+{
+  public:
+    /// Compression of the file
+    enum Compression
+    {
+        NONE, //!< Not compressed
+        GZIP  //!< Gzip compression, the ".gz" extension is added to the file name
+    };
+
+    /**
+     * Open a file for writing.
+     *
+     * \param filename the name of the file, without the extension of the compression
+     * \param mode the mode of the file: std::ios::app to append to the file,
+     *        otherwise the file is truncated
+     * \param compression the compression of the file
+     */
+    AsyncFileBuffer(const std::string& filename, std::ios::openmode mode, Compression compression);
+    ~AsyncFileBuffer() override;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    AsyncFileBuffer(const AsyncFileBuffer&) = delete;
+    AsyncFileBuffer& operator=(const AsyncFileBuffer&) = delete;
+
+    /**
+     * \return true if the file was opened
+     */
+    bool IsOpen() const;
+
+    /**
+     * Write the data of the stream to the file, and wait until it is written.
+     * A compressed file is complete after this call: further data is written
+     * in a new gzip member.
+     */
+    void Flush();
+
+    /**
+     * Write the data of the stream to the file, and close it.
+     */
+    void Close();
+
+    /**
+     * Flush all the open files. Called at Simulator::Destroy.
+     */
+    static void FlushAll();
+
+    /**
+     * \return true if the trace files should be written by the writer thread,
+     *         as configured by the "AsyncTraceWriter" global value
+     */
+    static bool IsEnabled();
+
+    /**
+     * \return the compression of the trace files, as configured by the
+     *         "TraceCompression" global value
+     */
+    static Compression GetDefaultCompression();
+
+  protected:
+    /**
+     * Hand the full buffer over to the writer thread, and store a character
+     * in a new buffer.
+     * \param c the character
+     * \return c, or EOF if the file could not be written
+     */
+    int_type overflow(int_type c) override;
+
+    /**
+     * Do not hand the buffer over.
+     * \return -1 if the file could not be written, 0 otherwise
+     */
+    int sync() override;
+
+    /**
+     * Only the current position can be sought.
+     * \param off the offset
+     * \param dir the origin of the offset
+     * \param which the sequence, which must include std::ios::out
+     * \return the current position, or -1 if it is not the target
+     */
+    pos_type seekoff(off_type off,
+                     std::ios::seekdir dir,
+                     std::ios::openmode which = std::ios::in | std::ios::out) override;
+
+    /**
+     * Only the current position can be sought.
+     * \param pos the position
+     * \param which the sequence, which must include std::ios::out
+     * \return the current position, or -1 if it is not the target
+     */
+    pos_type seekpos(pos_type pos,
+                     std::ios::openmode which = std::ios::in | std::ios::out) override;
+
+  private:
+    friend class AsyncFileWriter;
+
+    /**
+     * Hand the data of the stream over to the writer thread, and start
+     * a new buffer.
+     */
+    void HandOver();
+
+    /**
+     * Write data to the file. Called by the writer thread.
+     * \param data the data
+     */
+    void WriteData(const std::vector<char>& data);
+
+    /**
+     * Write the data buffered by the C library or by zlib to the file.
+     * Called when no data of the file is pending in the writer thread.
+     */
+    void FinishFile();
+
+    /**
+     * \return the number of bytes written to the stream
+     */
+    uint64_t GetPosition() const;
+
+    std::string m_filename;     //!< Name of the file
+    std::FILE* m_file;          //!< File, if not compressed
+    gzFile_s* m_gzFile;         //!< Compressed file
+    std::vector<char> m_buffer; //!< Buffer being filled
+    uint64_t m_handedOver;      //!< Number of bytes handed over to the writer thread
+    bool m_isUnfinished;        //!< True if data was written since the last FinishFile
+    std::atomic<bool> m_failed; //!< True if the file could not be written
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Output stream writing a file through an AsyncFileBuffer.
+ */
+class AsyncFileStream : public std::ostream
+{
+  public:
+    /**
+     * Open a file for writing.
+     *
+     * \param filename the name of the file, without the extension of the compression
+     * \param mode the mode of the file
+     * \param compression the compression of the file
+     */
+    AsyncFileStream(const std::string& filename,
+                    std::ios::openmode mode,
+                    AsyncFileBuffer::Compression compression);
+    ~AsyncFileStream() override;
+
+    /**
+     * \return true if the file was opened
+     */
+    bool IsOpen() const;
+
+    /**
+     * Write the data of the stream to the file, and close it.
+     */
+    void Close();
+
+  private:
+    AsyncFileBuffer m_buffer; //!< Stream buffer
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_BUFFER_H */
@@ -17,6 +17,8 @@
 
 #include "output-stream-wrapper.h"
 
+#include "async-file-buffer.h"
+
 #include "ns3/abort.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/log.h"
@@ -32,11 +34,23 @@ OutputStreamWrapper::OutputStreamWrapper(std::string filename, std::ios::openmod
     : m_destroyable(true)
 {
     NS_LOG_FUNCTION(this << filename << filemode);
-    std::ofstream* os = new std::ofstream();
-    os->open(filename, filemode);
-    m_ostream = os;
+    bool isOpen;
+    if (!(filemode & std::ios::in) && AsyncFileBuffer::IsEnabled())
+    {
+        AsyncFileStream* os =
+            new AsyncFileStream(filename, filemode, AsyncFileBuffer::GetDefaultCompression());
+        isOpen = os->IsOpen();
+        m_ostream = os;
+    }
+    else
+    {
+        std::ofstream* os = new std::ofstream();
+        os->open(filename, filemode);
+        isOpen = os->is_open();
+        m_ostream = os;
+    }
     FatalImpl::RegisterStream(m_ostream);
-    NS_ABORT_MSG_UNLESS(os->is_open(),
+    NS_ABORT_MSG_UNLESS(isOpen,
                         "AsciiTraceHelper::CreateFileStream():  "
                             << "Unable to Open " << filename << " for mode " << filemode);
 }
@@ -73,6 +73,10 @@ class OutputStreamWrapper : public SimpleRefCount<OutputStreamWrapper>
   public:
     /**
      * Constructor
+     *
+     * When the "AsyncTraceWriter" global value is true, a file opened for
+     * writing only is written by the background thread of AsyncFileBuffer.
+     *
      * \param filename file name
      * \param filemode std::ios::openmode flags
      */
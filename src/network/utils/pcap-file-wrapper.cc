@@ -53,6 +53,7 @@ PcapFileWrapper::GetTypeId()
 }
 
 PcapFileWrapper::PcapFileWrapper()
+    : m_pcapngInterface(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -67,6 +68,10 @@ bool
 PcapFileWrapper::Fail() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_pcapng)
+    {
+        return m_pcapng->Fail();
+    }
     return m_file.Fail();
 }
 
@@ -88,9 +93,18 @@ void
 PcapFileWrapper::Close()
 {
     NS_LOG_FUNCTION(this);
+    m_pcapng = nullptr;
     m_file.Close();
 }
 
+void
+PcapFileWrapper::SetPcapngInterface(Ptr<PcapngFileWrapper> file, uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << file << interface);
+    m_pcapng = file;
+    m_pcapngInterface = interface;
+}
+
 void
 PcapFileWrapper::Open(const std::string& filename, std::ios::openmode mode)
 {
@@ -121,6 +135,11 @@ void
 PcapFileWrapper::Write(Time t, Ptr<const Packet> p)
 {
     NS_LOG_FUNCTION(this << t << p);
+    if (m_pcapng)
+    {
+        m_pcapng->Write(m_pcapngInterface, t, p);
+        return;
+    }
     if (m_file.IsNanoSecMode())
     {
         uint64_t current = t.GetNanoSeconds();
@@ -141,6 +160,11 @@ void
 PcapFileWrapper::Write(Time t, const Header& header, Ptr<const Packet> p)
 {
     NS_LOG_FUNCTION(this << t << &header << p);
+    if (m_pcapng)
+    {
+        m_pcapng->Write(m_pcapngInterface, t, header, p);
+        return;
+    }
     if (m_file.IsNanoSecMode())
     {
         uint64_t current = t.GetNanoSeconds();
@@ -161,6 +185,11 @@ void
 PcapFileWrapper::Write(Time t, const uint8_t* buffer, uint32_t length)
 {
     NS_LOG_FUNCTION(this << t << &buffer << length);
+    if (m_pcapng)
+    {
+        m_pcapng->Write(m_pcapngInterface, t, buffer, length);
+        return;
+    }
     if (m_file.IsNanoSecMode())
     {
         uint64_t current = t.GetNanoSeconds();
@@ -19,6 +19,7 @@
 #define PCAP_FILE_WRAPPER_H
 
 #include "pcap-file.h"
+#include "pcapng-file-wrapper.h"
 
 #include "ns3/nstime.h"
 #include "ns3/object.h"
@@ -79,10 +80,21 @@ class PcapFileWrapper : public Object
     void Open(const std::string& filename, std::ios::openmode mode);
 
     /**
-     * Close the underlying pcap file.
+     * Close the underlying pcap file, or detach the wrapper from the
+     * interface of the pcapng file.
      */
     void Close();
 
+    /**
+     * Write the packets to an interface of a pcapng file instead of a pcap
+     * file, which must not be opened.  The data link type and the snapshot
+     * length are those of the interface.
+     *
+     * \param file the pcapng file
+     * \param interface the index of the interface in the pcapng file
+     */
+    void SetPcapngInterface(Ptr<PcapngFileWrapper> file, uint32_t interface);
+
     /**
      * Initialize the pcap file associated with this wrapper.  This file must have
      * been previously opened with write permissions.
@@ -222,9 +234,11 @@ class PcapFileWrapper : public Object
     uint32_t GetDataLinkType();
 
   private:
-    PcapFile m_file;    //!< Pcap file
-    uint32_t m_snapLen; //!< max length of saved packets
-    bool m_nanosecMode; //!< Timestamps in nanosecond mode
+    PcapFile m_file;                 //!< Pcap file
+    uint32_t m_snapLen;              //!< max length of saved packets
+    bool m_nanosecMode;              //!< Timestamps in nanosecond mode
+    Ptr<PcapngFileWrapper> m_pcapng; //!< Pcapng file written instead of the pcap file, if any
+    uint32_t m_pcapngInterface;      //!< Interface of the pcapng file
 };
 
 } // namespace ns3
@@ -19,6 +19,8 @@
 
 #include "pcap-file.h"
 
+#include "async-file-buffer.h"
+
 #include "ns3/assert.h"
 #include "ns3/buffer.h"
 #include "ns3/build-profile.h"
@@ -92,6 +94,14 @@ void
 PcapFile::Close()
 {
     NS_LOG_FUNCTION(this);
+    if (m_asyncBuffer)
+    {
+        m_asyncBuffer->Close();
+        // restore the file buffer of the stream
+        static_cast<std::ios&>(m_file).rdbuf(m_file.rdbuf());
+        m_asyncBuffer.reset();
+        return;
+    }
     m_file.close();
 }
 
@@ -339,6 +349,21 @@ PcapFile::Open(const std::string& filename, std::ios::openmode mode)
     mode |= std::ios::binary;
 
     m_filename = filename;
+    if (!(mode & std::ios::in) && AsyncFileBuffer::IsEnabled())
+    {
+        m_asyncBuffer = std::make_unique<AsyncFileBuffer>(filename,
+                                                          mode,
+                                                          AsyncFileBuffer::GetDefaultCompression());
+        if (!m_asyncBuffer->IsOpen())
+        {
+            m_asyncBuffer.reset();
+            m_file.setstate(std::ios::failbit);
+            return;
+        }
+        // the stream writes to the buffer of the writer thread
+        static_cast<std::ios&>(m_file).rdbuf(m_asyncBuffer.get());
+        return;
+    }
     m_file.open(filename, mode);
     if (mode & std::ios::in)
     {
@@ -23,6 +23,7 @@
 #include "ns3/ptr.h"
 
 #include <fstream>
+#include <memory>
 #include <stdint.h>
 #include <string>
 
@@ -31,6 +32,7 @@ namespace ns3
 
 class Packet;
 class Header;
+class AsyncFileBuffer;
 
 /**
  * \brief A class representing a pcap file
@@ -75,6 +77,9 @@ class PcapFile
      * selected as a binary file (fstream::binary is automatically ored with the mode
      * field).
      *
+     * When the "AsyncTraceWriter" global value is true, a file opened for
+     * writing only is written by the background thread of AsyncFileBuffer.
+     *
      * \param filename String containing the name of the file.
      *
      * \param mode the access mode for the file.
@@ -378,6 +383,8 @@ class PcapFile
     PcapFileHeader m_fileHeader; //!< file header
     bool m_swapMode;             //!< swap mode
     bool m_nanosecMode;          //!< nanosecond timestamp mode
+    /// Buffer of m_file when it is written by the writer thread of AsyncFileBuffer
+    std::unique_ptr<AsyncFileBuffer> m_asyncBuffer;
 };
 
 } // namespace ns3
@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcapng-file-wrapper.h"
+
+#include "pcap-file.h"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PcapngFileWrapper");
+
+NS_OBJECT_ENSURE_REGISTERED(PcapngFileWrapper);
+
+TypeId
+PcapngFileWrapper::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PcapngFileWrapper")
+            .SetParent<Object>()
+            .SetGroupName("Network")
+            .AddConstructor<PcapngFileWrapper>()
+            .AddAttribute("CaptureSize",
+                          "Maximum length of captured packets of the interfaces whose length "
+                          "is not provided (cf. pcap snaplen)",
+                          UintegerValue(PcapFile::SNAPLEN_DEFAULT),
+                          MakeUintegerAccessor(&PcapngFileWrapper::m_snapLen),
+                          MakeUintegerChecker<uint32_t>(0, PcapFile::SNAPLEN_DEFAULT));
+    return tid;
+}
+
+PcapngFileWrapper::PcapngFileWrapper()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+PcapngFileWrapper::~PcapngFileWrapper()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+bool
+PcapngFileWrapper::Fail() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_file.Fail();
+}
+
+void
+PcapngFileWrapper::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    m_file.Open(filename);
+    m_filename = filename;
+    m_names.clear();
+    m_filters.clear();
+}
+
+void
+PcapngFileWrapper::Close()
+{
+    NS_LOG_FUNCTION(this);
+    m_file.Close();
+}
+
+std::string
+PcapngFileWrapper::GetFilename() const
+{
+    return m_filename;
+}
+
+uint32_t
+PcapngFileWrapper::AddInterface(uint32_t dataLinkType, const std::string& name, uint32_t snapLen)
+{
+    NS_LOG_FUNCTION(this << dataLinkType << name << snapLen);
+    if (snapLen == std::numeric_limits<uint32_t>::max())
+    {
+        snapLen = m_snapLen;
+    }
+    uint32_t interface = m_file.AddInterface(dataLinkType, snapLen, name);
+    m_names.push_back(name);
+    m_filters.emplace_back();
+    return interface;
+}
+
+uint32_t
+PcapngFileWrapper::GetNInterfaces() const
+{
+    return m_names.size();
+}
+
+std::string
+PcapngFileWrapper::GetInterfaceName(uint32_t interface) const
+{
+    NS_ASSERT(interface < m_names.size());
+    return m_names[interface];
+}
+
+void
+PcapngFileWrapper::SetInterfaceFilter(uint32_t interface, FilterCallback filter)
+{
+    NS_LOG_FUNCTION(this << interface);
+    NS_ASSERT(interface < m_filters.size());
+    m_filters[interface] = filter;
+}
+
+bool
+PcapngFileWrapper::Accept(uint32_t interface, Ptr<const Packet> p) const
+{
+    NS_ASSERT_MSG(interface < m_filters.size(), "Unknown interface " << interface);
+    return m_filters[interface].IsNull() || m_filters[interface](p);
+}
+
+void
+PcapngFileWrapper::Write(uint32_t interface, Time t, Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(this << interface << t << p);
+    if (Accept(interface, p))
+    {
+        m_file.Write(interface, t.GetNanoSeconds(), p);
+    }
+}
+
+void
+PcapngFileWrapper::Write(uint32_t interface, Time t, const Header& header, Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(this << interface << t << &header << p);
+    if (Accept(interface, p))
+    {
+        m_file.Write(interface, t.GetNanoSeconds(), header, p);
+    }
+}
+
+void
+PcapngFileWrapper::Write(uint32_t interface, Time t, const uint8_t* buffer, uint32_t length)
+{
+    NS_LOG_FUNCTION(this << interface << t << &buffer << length);
+    m_file.Write(interface, t.GetNanoSeconds(), buffer, length);
+}
+
+} // namespace ns3
@@ -0,0 +1,167 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_WRAPPER_H
+#define PCAPNG_FILE_WRAPPER_H
+
+#include "pcapng-file.h"
+
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * A class that wraps a PcapngFile as an ns3::Object, to capture the packets
+ * of many interfaces in a single pcapng file.
+ *
+ * Each interface has its own data link type, snapshot length and optional
+ * filter, which selects the packets written for the interface.
+ *
+ * The device helpers can write the packets of all the devices they trace in
+ * a PcapngFileWrapper, see PcapHelperForDevice::EnablePcapAll.
+ */
+class PcapngFileWrapper : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    PcapngFileWrapper();
+    ~PcapngFileWrapper() override;
+
+    /**
+     * Callback selecting the packets written for an interface: the packet is
+     * written if it returns true.
+     */
+    typedef Callback<bool, Ptr<const Packet>> FilterCallback;
+
+    /**
+     * \return true if the 'fail' bit is set in the underlying stream, or if
+     *         no file is open, false otherwise.
+     */
+    bool Fail() const;
+
+    /**
+     * Create a new pcapng file.
+     *
+     * \param filename the name of the file
+     */
+    void Open(const std::string& filename);
+
+    /**
+     * Close the underlying pcapng file.
+     */
+    void Close();
+
+    /**
+     * \return the name of the file
+     */
+    std::string GetFilename() const;
+
+    /**
+     * Add an interface to the file.
+     *
+     * \param dataLinkType the data link type of the packets of the interface,
+     *        as defined in the pcap library
+     * \param name the name of the interface, omitted from the file if empty
+     * \param snapLen the maximum length of the packet data written for the
+     *        interface; the "CaptureSize" attribute is used if it is not provided
+     * \return the index of the interface
+     */
+    uint32_t AddInterface(uint32_t dataLinkType,
+                          const std::string& name,
+                          uint32_t snapLen = std::numeric_limits<uint32_t>::max());
+
+    /**
+     * \return the number of interfaces of the file
+     */
+    uint32_t GetNInterfaces() const;
+
+    /**
+     * \param interface the index of an interface
+     * \return the name of the interface
+     */
+    std::string GetInterfaceName(uint32_t interface) const;
+
+    /**
+     * Set the filter of an interface. The filter is not called for the
+     * packets written as a data buffer.
+     *
+     * \param interface the index of the interface
+     * \param filter the filter, or a null callback to write all the packets
+     */
+    void SetInterfaceFilter(uint32_t interface, FilterCallback filter);
+
+    /**
+     * \brief Write the next packet of an interface to the file
+     *
+     * \param interface the index of the interface
+     * \param t Packet timestamp as ns3::Time.
+     * \param p Packet to write to the pcapng file.
+     */
+    void Write(uint32_t interface, Time t, Ptr<const Packet> p);
+
+    /**
+     * \brief Write the provided header along with the packet to the file.
+     *
+     * The filter of the interface is called with the packet without the header.
+     *
+     * \param interface the index of the interface
+     * \param t Packet timestamp as ns3::Time.
+     * \param header The Header to prepend to the packet.
+     * \param p Packet to write to the pcapng file.
+     */
+    void Write(uint32_t interface, Time t, const Header& header, Ptr<const Packet> p);
+
+    /**
+     * \brief Write the provided data buffer to the file.
+     *
+     * \param interface the index of the interface
+     * \param t Packet timestamp as ns3::Time.
+     * \param buffer The buffer to write.
+     * \param length The size of the buffer.
+     */
+    void Write(uint32_t interface, Time t, const uint8_t* buffer, uint32_t length);
+
+  private:
+    /**
+     * \param interface the index of an interface
+     * \param p a packet of the interface
+     * \return true if the packet must be written
+     */
+    bool Accept(uint32_t interface, Ptr<const Packet> p) const;
+
+    PcapngFile m_file;                     //!< Pcapng file
+    std::string m_filename;                //!< Name of the file
+    uint32_t m_snapLen;                    //!< Default max length of saved packets
+    std::vector<std::string> m_names;      //!< Name of each interface
+    std::vector<FilterCallback> m_filters; //!< Filter of each interface
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_WRAPPER_H */
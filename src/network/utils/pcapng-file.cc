@@ -0,0 +1,257 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcapng-file.h"
+
+#include "async-file-buffer.h"
+
+#include "ns3/assert.h"
+#include "ns3/buffer.h"
+#include "ns3/build-profile.h"
+#include "ns3/header.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PcapngFile");
+
+/// Codes of the options written in the blocks
+enum PcapngOption : uint16_t
+{
+    OPT_ENDOFOPT = 0, //!< End of the options
+    IF_NAME = 2,      //!< Name of the interface
+    SHB_USERAPPL = 4, //!< Application which wrote the section
+    IF_TSRESOL = 9,   //!< Resolution of the timestamps of the interface
+};
+
+/// Version of the pcapng format
+const uint16_t PCAPNG_VERSION_MAJOR = 1;
+/// Minor version of the pcapng format
+const uint16_t PCAPNG_VERSION_MINOR = 0;
+/// Name of the application written in the Section Header Block
+const char PCAPNG_USER_APPLICATION[] = "ns-3";
+/// Timestamps in 10^-9 seconds
+const uint8_t PCAPNG_TS_RESOLUTION = 9;
+
+/**
+ * \param length a length in bytes
+ * \return the length padded to 32 bits
+ */
+static uint32_t
+Pad32(uint32_t length)
+{
+    return (length + 3) & ~3U;
+}
+
+PcapngFile::PcapngFile()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+PcapngFile::~PcapngFile()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+bool
+PcapngFile::Fail() const
+{
+    return !m_file || m_file->fail();
+}
+
+void
+PcapngFile::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    Close();
+    m_filename = filename;
+    m_snapLens.clear();
+    if (AsyncFileBuffer::IsEnabled())
+    {
+        auto file = std::make_unique<AsyncFileStream>(filename,
+                                                      std::ios::out | std::ios::binary,
+                                                      AsyncFileBuffer::GetDefaultCompression());
+        if (!file->IsOpen())
+        {
+            file->setstate(std::ios::failbit);
+        }
+        m_file = std::move(file);
+    }
+    else
+    {
+        m_file = std::make_unique<std::ofstream>(filename, std::ios::out | std::ios::binary);
+    }
+    if (Fail())
+    {
+        NS_LOG_WARN("Unable to open " << filename);
+        return;
+    }
+
+    // Section Header Block, with a section length of -1 (not specified)
+    uint32_t optionsLen = 4 + Pad32(sizeof(PCAPNG_USER_APPLICATION) - 1) + 4;
+    uint32_t blockLen = 24 + optionsLen + 4;
+    Write32(SECTION_HEADER_BLOCK);
+    Write32(blockLen);
+    Write32(BYTE_ORDER_MAGIC);
+    uint16_t version[2] = {PCAPNG_VERSION_MAJOR, PCAPNG_VERSION_MINOR};
+    m_file->write(reinterpret_cast<const char*>(version), sizeof(version));
+    int64_t sectionLen = -1;
+    m_file->write(reinterpret_cast<const char*>(&sectionLen), sizeof(sectionLen));
+    WriteOption(SHB_USERAPPL, PCAPNG_USER_APPLICATION, sizeof(PCAPNG_USER_APPLICATION) - 1);
+    WriteOption(OPT_ENDOFOPT, nullptr, 0);
+    Write32(blockLen);
+}
+
+void
+PcapngFile::Close()
+{
+    NS_LOG_FUNCTION(this);
+    // the destructor of the stream writes the data and closes the file
+    m_file.reset();
+}
+
+uint32_t
+PcapngFile::AddInterface(uint16_t dataLinkType, uint32_t snapLen, const std::string& name)
+{
+    NS_LOG_FUNCTION(this << dataLinkType << snapLen << name);
+    NS_ASSERT_MSG(m_file, "Pcapng file not open");
+    NS_ASSERT_MSG(name.size() < 0xffff, "Interface name too long");
+
+    uint32_t optionsLen = 4 + Pad32(sizeof(PCAPNG_TS_RESOLUTION)) + 4;
+    if (!name.empty())
+    {
+        optionsLen += 4 + Pad32(name.size());
+    }
+    uint32_t blockLen = 16 + optionsLen + 4;
+    Write32(INTERFACE_DESCRIPTION_BLOCK);
+    Write32(blockLen);
+    uint16_t linkType[2] = {dataLinkType, 0};
+    m_file->write(reinterpret_cast<const char*>(linkType), sizeof(linkType));
+    Write32(snapLen);
+    if (!name.empty())
+    {
+        WriteOption(IF_NAME, name.data(), name.size());
+    }
+    WriteOption(IF_TSRESOL, &PCAPNG_TS_RESOLUTION, sizeof(PCAPNG_TS_RESOLUTION));
+    WriteOption(OPT_ENDOFOPT, nullptr, 0);
+    Write32(blockLen);
+
+    m_snapLens.push_back(snapLen);
+    return m_snapLens.size() - 1;
+}
+
+uint32_t
+PcapngFile::GetNInterfaces() const
+{
+    return m_snapLens.size();
+}
+
+uint32_t
+PcapngFile::GetSnapLen(uint32_t interface) const
+{
+    NS_ASSERT(interface < m_snapLens.size());
+    return m_snapLens[interface];
+}
+
+void
+PcapngFile::Write32(uint32_t value)
+{
+    m_file->write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void
+PcapngFile::WriteOption(uint16_t code, const void* value, uint16_t length)
+{
+    uint16_t header[2] = {code, length};
+    m_file->write(reinterpret_cast<const char*>(header), sizeof(header));
+    if (length > 0)
+    {
+        static const char padding[3] = {0, 0, 0};
+        m_file->write(static_cast<const char*>(value), length);
+        m_file->write(padding, Pad32(length) - length);
+    }
+}
+
+uint32_t
+PcapngFile::WritePacketHeader(uint32_t interface, uint64_t ts, uint32_t totalLen)
+{
+    NS_LOG_FUNCTION(this << interface << ts << totalLen);
+    NS_ASSERT_MSG(m_file, "Pcapng file not open");
+    NS_ASSERT_MSG(interface < m_snapLens.size(), "Unknown interface " << interface);
+
+    uint32_t snapLen = m_snapLens[interface];
+    uint32_t inclLen = (snapLen != 0 && totalLen > snapLen) ? snapLen : totalLen;
+    uint32_t blockLen = 28 + Pad32(inclLen) + 4;
+    uint32_t header[7] = {ENHANCED_PACKET_BLOCK,
+                          blockLen,
+                          interface,
+                          static_cast<uint32_t>(ts >> 32),
+                          static_cast<uint32_t>(ts),
+                          inclLen,
+                          totalLen};
+    m_file->write(reinterpret_cast<const char*>(header), sizeof(header));
+    return inclLen;
+}
+
+void
+PcapngFile::WritePacketTrailer(uint32_t inclLen)
+{
+    static const char padding[3] = {0, 0, 0};
+    m_file->write(padding, Pad32(inclLen) - inclLen);
+    Write32(28 + Pad32(inclLen) + 4);
+    NS_BUILD_DEBUG(m_file->flush());
+}
+
+void
+PcapngFile::Write(uint32_t interface, uint64_t ts, const uint8_t* const data, uint32_t totalLen)
+{
+    NS_LOG_FUNCTION(this << interface << ts << &data << totalLen);
+    uint32_t inclLen = WritePacketHeader(interface, ts, totalLen);
+    m_file->write(reinterpret_cast<const char*>(data), inclLen);
+    WritePacketTrailer(inclLen);
+}
+
+void
+PcapngFile::Write(uint32_t interface, uint64_t ts, Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(this << interface << ts << p);
+    uint32_t inclLen = WritePacketHeader(interface, ts, p->GetSize());
+    p->CopyData(m_file.get(), inclLen);
+    WritePacketTrailer(inclLen);
+}
+
+void
+PcapngFile::Write(uint32_t interface, uint64_t ts, const Header& header, Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(this << interface << ts << &header << p);
+    uint32_t headerSize = header.GetSerializedSize();
+    uint32_t inclLen = WritePacketHeader(interface, ts, headerSize + p->GetSize());
+
+    Buffer headerBuffer;
+    headerBuffer.AddAtStart(headerSize);
+    header.Serialize(headerBuffer.Begin());
+    uint32_t toCopy = std::min(headerSize, inclLen);
+    headerBuffer.CopyData(m_file.get(), toCopy);
+    p->CopyData(m_file.get(), inclLen - toCopy);
+    WritePacketTrailer(inclLen);
+}
+
+} // namespace ns3
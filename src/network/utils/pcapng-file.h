@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include "ns3/ptr.h"
+
+#include <memory>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class Packet;
+class Header;
+
+/**
+ * \brief A class representing a pcapng file being written
+ *
+ * Unlike a pcap file, a pcapng file can hold the packets of several
+ * interfaces, possibly with different data link types and snapshot lengths:
+ * each interface is described by an Interface Description Block, and each
+ * packet is written in an Enhanced Packet Block which refers to the index of
+ * its interface.  The packets of many devices can thus be captured in a
+ * single file, written sequentially.
+ *
+ * The file has a single section, in the byte order of the host.  The
+ * timestamps of the packets are in nanoseconds (if_tsresol option).
+ *
+ * See https://datatracker.ietf.org/doc/draft-ietf-opsawg-pcapng/
+ *
+ * When the "AsyncTraceWriter" global value is true, the file is written by
+ * the writer thread of AsyncFileBuffer.
+ */
+class PcapngFile
+{
+  public:
+    PcapngFile();
+    ~PcapngFile();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    PcapngFile(const PcapngFile&) = delete;
+    PcapngFile& operator=(const PcapngFile&) = delete;
+
+    /**
+     * \return true if the 'fail' bit is set in the underlying stream, or if
+     *         no file is open, false otherwise.
+     */
+    bool Fail() const;
+
+    /**
+     * Create a new pcapng file, and write its Section Header Block.
+     *
+     * \param filename the name of the file
+     */
+    void Open(const std::string& filename);
+
+    /**
+     * Close the file.
+     */
+    void Close();
+
+    /**
+     * Write an Interface Description Block.
+     *
+     * \param dataLinkType the data link type of the packets of the interface,
+     *        as defined in the pcap library
+     * \param snapLen the maximum length of the packet data written for the
+     *        interface, longer packets are truncated (0 for no limit)
+     * \param name the name of the interface (if_name option), omitted if empty
+     * \return the index of the interface
+     */
+    uint32_t AddInterface(uint16_t dataLinkType, uint32_t snapLen, const std::string& name);
+
+    /**
+     * \return the number of interfaces of the file
+     */
+    uint32_t GetNInterfaces() const;
+
+    /**
+     * \param interface the index of an interface
+     * \return the snapshot length of the interface
+     */
+    uint32_t GetSnapLen(uint32_t interface) const;
+
+    /**
+     * \brief Write the next packet to the file
+     *
+     * \param interface the index of the interface of the packet
+     * \param ts the timestamp of the packet, in nanoseconds
+     * \param data the data of the packet
+     * \param totalLen the length of the packet
+     */
+    void Write(uint32_t interface, uint64_t ts, const uint8_t* const data, uint32_t totalLen);
+
+    /**
+     * \brief Write the next packet to the file
+     *
+     * \param interface the index of the interface of the packet
+     * \param ts the timestamp of the packet, in nanoseconds
+     * \param p the packet
+     */
+    void Write(uint32_t interface, uint64_t ts, Ptr<const Packet> p);
+
+    /**
+     * \brief Write the next packet to the file
+     *
+     * \param interface the index of the interface of the packet
+     * \param ts the timestamp of the packet, in nanoseconds
+     * \param header a header to write before the packet
+     * \param p the packet
+     */
+    void Write(uint32_t interface, uint64_t ts, const Header& header, Ptr<const Packet> p);
+
+    /// Block type of the Section Header Block
+    static constexpr uint32_t SECTION_HEADER_BLOCK = 0x0a0d0d0a;
+    /// Block type of the Interface Description Block
+    static constexpr uint32_t INTERFACE_DESCRIPTION_BLOCK = 0x00000001;
+    /// Block type of the Enhanced Packet Block
+    static constexpr uint32_t ENHANCED_PACKET_BLOCK = 0x00000006;
+    /// Byte-order magic of the Section Header Block
+    static constexpr uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;
+
+  private:
+    /**
+     * Write the header of an Enhanced Packet Block, which is followed by the
+     * packet data and by WritePacketTrailer.
+     *
+     * \param interface the index of the interface of the packet
+     * \param ts the timestamp of the packet, in nanoseconds
+     * \param totalLen the length of the packet
+     * \return the length of the packet data to write
+     */
+    uint32_t WritePacketHeader(uint32_t interface, uint64_t ts, uint32_t totalLen);
+
+    /**
+     * Write the padding of the packet data and the end of an Enhanced Packet
+     * Block.
+     *
+     * \param inclLen the length of the packet data written
+     */
+    void WritePacketTrailer(uint32_t inclLen);
+
+    /**
+     * Write an option, padded to 32 bits.
+     *
+     * \param code the code of the option
+     * \param value the value of the option
+     * \param length the length of the value
+     */
+    void WriteOption(uint16_t code, const void* value, uint16_t length);
+
+    /**
+     * Write a 32-bit value in the byte order of the host.
+     * \param value the value
+     */
+    void Write32(uint32_t value);
+
+    std::string m_filename;               //!< Name of the file
+    std::unique_ptr<std::ostream> m_file; //!< File stream
+    std::vector<uint32_t> m_snapLens;     //!< Snapshot length of each interface
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
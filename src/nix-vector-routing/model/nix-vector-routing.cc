@@ -30,7 +30,9 @@
 #include "ns3/loopback-net-device.h"
 #include "ns3/names.h"
 
+#include <algorithm>
 #include <iomanip>
+#include <limits>
 #include <queue>
 
 namespace ns3
@@ -48,6 +50,18 @@ bool NixVectorRouting<T>::g_isCacheDirty = false;
 template <typename T>
 uint32_t NixVectorRouting<T>::g_epoch = 1;
 
+template <typename T>
+std::vector<typename NixVectorRouting<T>::TopologyChange> NixVectorRouting<T>::g_topologyChanges;
+
+template <typename T>
+bool NixVectorRouting<T>::g_isFullFlushNeeded = false;
+
+template <typename T>
+std::unordered_map<uint32_t, std::vector<Ptr<Node>>> NixVectorRouting<T>::g_bfsTrees;
+
+template <typename T>
+typename NixVectorRouting<T>::CacheStats NixVectorRouting<T>::g_cacheStats;
+
 template <typename T>
 typename NixVectorRouting<T>::IpAddressToNodeMap NixVectorRouting<T>::g_ipAddressToNodeMap;
 
@@ -169,6 +183,26 @@ NixVectorRouting<T>::FlushGlobalNixRoutingCache() const
     // IP address to node mapping is potentially invalid so clear it.
     // Will be repopulated in lazy evaluation when mapping is needed.
     g_ipAddressToNodeMap.clear();
+
+    // The BFS trees and the pending topology changes are superseded
+    g_bfsTrees.clear();
+    g_topologyChanges.clear();
+    g_isFullFlushNeeded = false;
+    g_cacheStats.fullFlushes++;
+}
+
+template <typename T>
+typename NixVectorRouting<T>::CacheStats
+NixVectorRouting<T>::GetCacheStats()
+{
+    return g_cacheStats;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::ResetCacheStats()
+{
+    g_cacheStats = CacheStats();
 }
 
 template <typename T>
@@ -189,7 +223,10 @@ NixVectorRouting<T>::FlushIpRouteCache() const
 
 template <typename T>
 Ptr<NixVector>
-NixVectorRouting<T>::GetNixVector(Ptr<Node> source, IpAddress dest, Ptr<NetDevice> oif) const
+NixVectorRouting<T>::GetNixVector(Ptr<Node> source,
+                                  IpAddress dest,
+                                  Ptr<NetDevice> oif,
+                                  std::vector<uint32_t>* path) const
 {
     NS_LOG_FUNCTION(this << source << dest << oif);
 
@@ -218,12 +255,42 @@ NixVectorRouting<T>::GetNixVector(Ptr<Node> source, IpAddress dest, Ptr<NetDevic
     {
         // otherwise proceed as normal
         // and build the nix vector
-        std::vector<Ptr<Node>> parentVector;
+        std::vector<Ptr<Node>> oifParentVector;
+        const std::vector<Ptr<Node>>* parentVector = &oifParentVector;
+        bool found = false;
 
-        if (BFS(NodeList::GetNNodes(), source, destNode, parentVector, oif))
+        if (oif)
         {
-            if (BuildNixVector(parentVector, source->GetId(), destNode->GetId(), nixVector))
+            found = BFS(NodeList::GetNNodes(), source, destNode, oifParentVector, oif);
+        }
+        else
+        {
+            // the BFS tree of the source is the same for all the destinations
+            std::vector<Ptr<Node>>& tree = g_bfsTrees[source->GetId()];
+            if (tree.size() != NodeList::GetNNodes() || tree.at(source->GetId()) != source)
             {
+                BFS(NodeList::GetNNodes(), source, nullptr, tree, nullptr);
+            }
+            parentVector = &tree;
+            found = true;
+        }
+
+        if (found)
+        {
+            if (BuildNixVector(*parentVector, source->GetId(), destNode->GetId(), nixVector))
+            {
+                g_cacheStats.nixVectorsBuilt++;
+                if (path)
+                {
+                    path->clear();
+                    for (uint32_t id = destNode->GetId(); id != source->GetId();
+                         id = parentVector->at(id)->GetId())
+                    {
+                        path->push_back(id);
+                    }
+                    path->push_back(source->GetId());
+                    std::reverse(path->begin(), path->end());
+                }
                 return nixVector;
             }
             else
@@ -253,7 +320,7 @@ NixVectorRouting<T>::GetNixVectorInCache(const IpAddress& address, bool& foundIn
     {
         NS_LOG_LOGIC("Found Nix-vector in cache.");
         foundInCache = true;
-        return iter->second;
+        return iter->second.nixVector;
     }
 
     // not in cache
@@ -263,17 +330,17 @@ NixVectorRouting<T>::GetNixVectorInCache(const IpAddress& address, bool& foundIn
 
 template <typename T>
 Ptr<typename NixVectorRouting<T>::IpRoute>
-NixVectorRouting<T>::GetIpRouteInCache(IpAddress address)
+NixVectorRouting<T>::GetIpRouteInCache(IpAddress address, uint32_t nixIndex)
 {
-    NS_LOG_FUNCTION(this << address);
+    NS_LOG_FUNCTION(this << address << nixIndex);
 
     CheckCacheStateAndFlush();
 
     typename IpRouteMap_t::iterator iter = m_ipRouteCache.find(address);
-    if (iter != m_ipRouteCache.end())
+    if (iter != m_ipRouteCache.end() && iter->second.nixIndex == nixIndex)
     {
         NS_LOG_LOGIC("Found IpRoute in cache.");
-        return iter->second;
+        return iter->second.route;
     }
 
     // not in cache
@@ -760,11 +827,13 @@ NixVectorRouting<T>::RouteOutput(Ptr<Packet> p,
         NS_LOG_LOGIC("Nix-vector not in cache, build: ");
         // Build the nix-vector, given this node and the
         // dest IP address
-        nixVectorInCache = GetNixVector(m_node, destAddress, oif);
+        NixCacheEntry entry;
+        nixVectorInCache = GetNixVector(m_node, destAddress, oif, &entry.path);
         if (nixVectorInCache)
         {
             // cache it
-            m_nixCache.insert(typename NixMap_t::value_type(destAddress, nixVectorInCache));
+            entry.nixVector = nixVectorInCache;
+            m_nixCache.insert(typename NixMap_t::value_type(destAddress, entry));
         }
     }
 
@@ -791,7 +860,7 @@ NixVectorRouting<T>::RouteOutput(Ptr<Packet> p,
 
         // Search here in a cache for this node index
         // and look for a IpRoute
-        rtentry = GetIpRouteInCache(destAddress);
+        rtentry = GetIpRouteInCache(destAddress, nodeIndex);
 
         if (!rtentry || !(rtentry->GetOutputDevice() == oif))
         {
@@ -800,10 +869,7 @@ NixVectorRouting<T>::RouteOutput(Ptr<Packet> p,
 
             // first, make sure we erase existing (incorrect)
             // rtentry from the map
-            if (rtentry)
-            {
-                m_ipRouteCache.erase(destAddress);
-            }
+            m_ipRouteCache.erase(destAddress);
 
             NS_LOG_LOGIC("IpRoute not in cache, build: ");
             IpAddress gatewayIp;
@@ -842,7 +908,8 @@ NixVectorRouting<T>::RouteOutput(Ptr<Packet> p,
             sockerr = Socket::ERROR_NOTERROR;
 
             // add rtentry to cache
-            m_ipRouteCache.insert(typename IpRouteMap_t::value_type(destAddress, rtentry));
+            m_ipRouteCache.insert(
+                typename IpRouteMap_t::value_type(destAddress, {rtentry, nodeIndex}));
         }
 
         NS_LOG_LOGIC("Nix-vector contents: " << *nixVectorInCache << " : Remaining bits: "
@@ -956,8 +1023,8 @@ NixVectorRouting<T>::RouteInput(Ptr<const Packet> p,
     uint32_t numberOfBits = nixVector->BitCount(m_totalNeighbors);
     uint32_t nodeIndex = nixVector->ExtractNeighborIndex(numberOfBits);
 
-    rtentry = GetIpRouteInCache(destAddress);
-    // not in cache
+    rtentry = GetIpRouteInCache(destAddress, nodeIndex);
+    // not in cache, or cached for another next hop
     if (!rtentry)
     {
         NS_LOG_LOGIC("IpRoute not in cache, build: ");
@@ -975,7 +1042,7 @@ NixVectorRouting<T>::RouteInput(Ptr<const Packet> p,
         rtentry->SetOutputDevice(m_ip->GetNetDevice(interfaceIndex));
 
         // add rtentry to cache
-        m_ipRouteCache.insert(typename IpRouteMap_t::value_type(destAddress, rtentry));
+        m_ipRouteCache[destAddress] = {rtentry, nodeIndex};
     }
 
     NS_LOG_LOGIC("At Node " << m_node->GetId() << ", Extracting " << numberOfBits
@@ -1027,9 +1094,9 @@ NixVectorRouting<T>::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Un
             std::ostringstream dest;
             dest << it->first;
             *os << std::setw(30) << dest.str();
-            if (it->second)
+            if (it->second.nixVector)
             {
-                *os << *(it->second) << std::endl;
+                *os << *(it->second.nixVector) << std::endl;
             }
             else
             {
@@ -1052,20 +1119,21 @@ NixVectorRouting<T>::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Un
             std::ostringstream dest;
             std::ostringstream gw;
             std::ostringstream src;
-            dest << it->second->GetDestination();
+            Ptr<IpRoute> route = it->second.route;
+            dest << route->GetDestination();
             *os << std::setw(30) << dest.str();
-            gw << it->second->GetGateway();
+            gw << route->GetGateway();
             *os << std::setw(30) << gw.str();
-            src << it->second->GetSource();
+            src << route->GetSource();
             *os << std::setw(30) << src.str();
             *os << "  ";
-            if (Names::FindName(it->second->GetOutputDevice()) != "")
+            if (Names::FindName(route->GetOutputDevice()) != "")
             {
-                *os << Names::FindName(it->second->GetOutputDevice());
+                *os << Names::FindName(route->GetOutputDevice());
             }
             else
             {
-                *os << it->second->GetOutputDevice()->GetIfIndex();
+                *os << route->GetOutputDevice()->GetIfIndex();
             }
             *os << std::endl;
         }
@@ -1080,28 +1148,28 @@ template <typename T>
 void
 NixVectorRouting<T>::NotifyInterfaceUp(uint32_t i)
 {
-    g_isCacheDirty = true;
+    NotifyTopologyChange(i, true);
 }
 
 template <typename T>
 void
 NixVectorRouting<T>::NotifyInterfaceDown(uint32_t i)
 {
-    g_isCacheDirty = true;
+    NotifyTopologyChange(i, false);
 }
 
 template <typename T>
 void
 NixVectorRouting<T>::NotifyAddAddress(uint32_t interface, IpInterfaceAddress address)
 {
-    g_isCacheDirty = true;
+    NotifyTopologyChange(interface, true);
 }
 
 template <typename T>
 void
 NixVectorRouting<T>::NotifyRemoveAddress(uint32_t interface, IpInterfaceAddress address)
 {
-    g_isCacheDirty = true;
+    NotifyTopologyChange(interface, false);
 }
 
 template <typename T>
@@ -1113,6 +1181,7 @@ NixVectorRouting<T>::NotifyAddRoute(IpAddress dst,
                                     IpAddress prefixToUse)
 {
     g_isCacheDirty = true;
+    g_isFullFlushNeeded = true;
 }
 
 template <typename T>
@@ -1124,6 +1193,22 @@ NixVectorRouting<T>::NotifyRemoveRoute(IpAddress dst,
                                        IpAddress prefixToUse)
 {
     g_isCacheDirty = true;
+    g_isFullFlushNeeded = true;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::NotifyTopologyChange(uint32_t interface, bool up)
+{
+    NS_LOG_FUNCTION(this << interface << up);
+
+    g_isCacheDirty = true;
+    if (!m_ip || interface >= m_ip->GetNInterfaces())
+    {
+        g_isFullFlushNeeded = true;
+        return;
+    }
+    g_topologyChanges.push_back({m_ip->GetNetDevice(interface), up});
 }
 
 template <typename T>
@@ -1136,7 +1221,15 @@ NixVectorRouting<T>::BFS(uint32_t numberOfNodes,
 {
     NS_LOG_FUNCTION(this << numberOfNodes << source << dest << parentVector << oif);
 
-    NS_LOG_LOGIC("Going from Node " << source->GetId() << " to Node " << dest->GetId());
+    if (dest)
+    {
+        NS_LOG_LOGIC("Going from Node " << source->GetId() << " to Node " << dest->GetId());
+    }
+    else
+    {
+        NS_LOG_LOGIC("Going from Node " << source->GetId() << " to all the nodes");
+    }
+    g_cacheStats.bfsRuns++;
     std::queue<Ptr<Node>> greyNodeList; // discovered nodes with unexplored children
 
     // reset the parent vector
@@ -1291,6 +1384,171 @@ NixVectorRouting<T>::BFS(uint32_t numberOfNodes,
     return false;
 }
 
+template <typename T>
+void
+NixVectorRouting<T>::GetDistances(Ptr<Node> root, std::vector<uint32_t>& distances) const
+{
+    NS_LOG_FUNCTION(this << root);
+
+    std::vector<Ptr<Node>> parentVector;
+    BFS(NodeList::GetNNodes(), root, nullptr, parentVector, nullptr);
+
+    const uint32_t unreachable = std::numeric_limits<uint32_t>::max();
+    distances.assign(parentVector.size(), unreachable);
+    distances.at(root->GetId()) = 0;
+    std::vector<uint32_t> branch;
+    for (uint32_t id = 0; id < parentVector.size(); id++)
+    {
+        // walk up the tree until a node with a known distance
+        uint32_t curr = id;
+        branch.clear();
+        while (distances[curr] == unreachable && parentVector[curr])
+        {
+            branch.push_back(curr);
+            curr = parentVector[curr]->GetId();
+        }
+        if (distances[curr] == unreachable)
+        {
+            continue;
+        }
+        for (auto it = branch.rbegin(); it != branch.rend(); it++)
+        {
+            distances[*it] = distances[curr] + 1;
+            curr = *it;
+        }
+    }
+}
+
+template <typename T>
+bool
+NixVectorRouting<T>::AddAffectedNodes(Ptr<NetDevice> device, std::set<uint32_t>& nodes) const
+{
+    NS_LOG_FUNCTION(this << device);
+
+    if (!device->GetNode() || device->IsBridge() || NetDeviceIsBridged(device))
+    {
+        return false;
+    }
+    nodes.insert(device->GetNode()->GetId());
+
+    Ptr<Channel> channel = device->GetChannel();
+    if (!channel)
+    {
+        return true;
+    }
+    for (std::size_t i = 0; i < channel->GetNDevices(); i++)
+    {
+        Ptr<NetDevice> remoteDevice = channel->GetDevice(i);
+        if (!remoteDevice->GetNode() || NetDeviceIsBridged(remoteDevice))
+        {
+            return false;
+        }
+        nodes.insert(remoteDevice->GetNode()->GetId());
+    }
+    return true;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::InvalidateCaches() const
+{
+    NS_LOG_FUNCTION(this);
+
+    // The nodes whose neighbors may have changed, and those of them
+    // which may have new neighbors
+    std::set<uint32_t> affected;
+    std::set<uint32_t> gained;
+    bool isFullFlushNeeded = g_isFullFlushNeeded;
+    for (const auto& change : g_topologyChanges)
+    {
+        if (isFullFlushNeeded)
+        {
+            break;
+        }
+        isFullFlushNeeded = !AddAffectedNodes(change.device, affected) ||
+                            (change.up && !AddAffectedNodes(change.device, gained));
+    }
+    if (isFullFlushNeeded)
+    {
+        NS_LOG_LOGIC("Topology change not tracked, flushing all the caches");
+        FlushGlobalNixRoutingCache();
+        return;
+    }
+    g_topologyChanges.clear();
+    g_cacheStats.targetedInvalidations++;
+
+    // The addresses and the BFS trees may have changed
+    g_ipAddressToNodeMap.clear();
+    g_bfsTrees.clear();
+
+    // The hops from the nodes with new neighbors, computed on demand. A path
+    // of length L from s to d may be shortened through a node g only if
+    // distance (g, s) + distance (g, d) <= L.
+    std::vector<std::vector<uint32_t>> distances;
+    bool isDistancesComputed = false;
+
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<NixVectorRouting<T>> rp = (*i)->GetObject<NixVectorRouting>();
+        if (!rp)
+        {
+            continue;
+        }
+        if (affected.count((*i)->GetId()))
+        {
+            // the nix indexes of the neighbors may have changed
+            rp->FlushIpRouteCache();
+            rp->m_totalNeighbors = 0;
+        }
+
+        for (auto it = rp->m_nixCache.begin(); it != rp->m_nixCache.end();)
+        {
+            const std::vector<uint32_t>& path = it->second.path;
+            bool isValid = !path.empty() && GetNodeByIp(it->first) &&
+                           GetNodeByIp(it->first)->GetId() == path.back() &&
+                           std::none_of(path.begin(), path.end(), [&affected](uint32_t id) {
+                               return affected.count(id);
+                           });
+            if (isValid && !gained.empty())
+            {
+                if (!isDistancesComputed)
+                {
+                    for (uint32_t id : gained)
+                    {
+                        distances.emplace_back();
+                        GetDistances(NodeList::GetNode(id), distances.back());
+                    }
+                    isDistancesComputed = true;
+                }
+                uint64_t length = path.size() - 1;
+                for (const auto& distance : distances)
+                {
+                    if (uint64_t(distance.at(path.front())) + distance.at(path.back()) <= length)
+                    {
+                        isValid = false;
+                        break;
+                    }
+                }
+            }
+
+            if (isValid)
+            {
+                it->second.nixVector->SetEpoch(g_epoch);
+                g_cacheStats.nixVectorsKept++;
+                it++;
+            }
+            else
+            {
+                NS_LOG_LOGIC("Removing the Nix-vector of node " << (*i)->GetId() << " to "
+                                                                << it->first);
+                rp->m_ipRouteCache.erase(it->first);
+                it = rp->m_nixCache.erase(it);
+                g_cacheStats.nixVectorsInvalidated++;
+            }
+        }
+    }
+}
+
 template <typename T>
 void
 NixVectorRouting<T>::PrintRoutingPath(Ptr<Node> source,
@@ -1432,9 +1690,9 @@ NixVectorRouting<T>::CheckCacheStateAndFlush() const
 {
     if (g_isCacheDirty)
     {
-        FlushGlobalNixRoutingCache();
         g_epoch++;
         g_isCacheDirty = false;
+        InvalidateCaches();
     }
 }
 
@@ -1443,6 +1701,12 @@ template void NixVectorRouting<Ipv4RoutingProtocol>::SetNode(Ptr<Node> node);
 template void NixVectorRouting<Ipv6RoutingProtocol>::SetNode(Ptr<Node> node);
 template void NixVectorRouting<Ipv4RoutingProtocol>::FlushGlobalNixRoutingCache() const;
 template void NixVectorRouting<Ipv6RoutingProtocol>::FlushGlobalNixRoutingCache() const;
+template NixVectorRouting<Ipv4RoutingProtocol>::CacheStats
+NixVectorRouting<Ipv4RoutingProtocol>::GetCacheStats();
+template NixVectorRouting<Ipv6RoutingProtocol>::CacheStats
+NixVectorRouting<Ipv6RoutingProtocol>::GetCacheStats();
+template void NixVectorRouting<Ipv4RoutingProtocol>::ResetCacheStats();
+template void NixVectorRouting<Ipv6RoutingProtocol>::ResetCacheStats();
 template void NixVectorRouting<Ipv4RoutingProtocol>::PrintRoutingPath(
     Ptr<Node> source,
     IpAddress dest,
@@ -42,7 +42,9 @@
 #include "ns3/nstime.h"
 
 #include <map>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 // NOLINTBEGIN(modernize-use-override)
 
@@ -142,6 +144,31 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
                           Ptr<OutputStreamWrapper> stream,
                           Time::Unit unit) const;
 
+    /**
+     * Counters of the work done to build and maintain the nix-vector caches
+     * of all the nodes, since the start of the simulation or the last call
+     * to ResetCacheStats.
+     */
+    struct CacheStats
+    {
+        uint64_t nixVectorsBuilt{0};       //!< Nix-vectors built
+        uint64_t bfsRuns{0};               //!< Breadth first searches
+        uint64_t fullFlushes{0};           //!< Flushes of all the caches
+        uint64_t targetedInvalidations{0}; //!< Topology changes handled without a full flush
+        uint64_t nixVectorsInvalidated{0}; //!< Cached nix-vectors removed by a topology change
+        uint64_t nixVectorsKept{0};        //!< Cached nix-vectors kept after a topology change
+    };
+
+    /**
+     * \return the counters of the work done on the nix-vector caches
+     */
+    static CacheStats GetCacheStats();
+
+    /**
+     * Reset the counters of the work done on the nix-vector caches.
+     */
+    static void ResetCacheStats();
+
   private:
     /**
      * Flushes the cache which stores nix-vector based on
@@ -165,14 +192,21 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
     /**
      * Takes in the source node and dest IP and calls GetNodeByIp,
      * BFS, accounting for any output interface specified, and finally
-     * BuildNixVector to return the built nix-vector
+     * BuildNixVector to return the built nix-vector.
      *
-     * \param source Source node
-     * \param dest Destination node address
-     * \param oif Preferred output interface
+     * Without output interface, the BFS tree of the source node is shared
+     * by all the destinations until the next topology change.
+     *
+     * \param [in] source Source node
+     * \param [in] dest Destination node address
+     * \param [in] oif Preferred output interface
+     * \param [out] path If not null, the ids of the nodes of the path, from source to dest
      * \returns The NixVector to be used in routing.
      */
-    Ptr<NixVector> GetNixVector(Ptr<Node> source, IpAddress dest, Ptr<NetDevice> oif) const;
+    Ptr<NixVector> GetNixVector(Ptr<Node> source,
+                                IpAddress dest,
+                                Ptr<NetDevice> oif,
+                                std::vector<uint32_t>* path = nullptr) const;
 
     /**
      * Checks the cache based on dest IP for the nix-vector
@@ -185,9 +219,10 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
     /**
      * Checks the cache based on dest IP for the IpRoute
      * \param address Address to check
-     * \returns The cached route.
+     * \param nixIndex Nix index of the next hop
+     * \returns The cached route, or null if it is not cached for this next hop.
      */
-    Ptr<IpRoute> GetIpRouteInCache(IpAddress address);
+    Ptr<IpRoute> GetIpRouteInCache(IpAddress address, uint32_t nixIndex);
 
     /**
      * Given a net-device returns all the adjacent net-devices,
@@ -271,6 +306,38 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
              std::vector<Ptr<Node>>& parentVector,
              Ptr<NetDevice> oif) const;
 
+    /**
+     * Compute the number of hops from a node to all the nodes.
+     * \param [in] root the node from which the hops are counted
+     * \param [out] distances the number of hops to each node, indexed by node id,
+     *              or UINT32_MAX if the node is unreachable
+     */
+    void GetDistances(Ptr<Node> root, std::vector<uint32_t>& distances) const;
+
+    /**
+     * Record a topology change on an interface of this node, to be processed
+     * at the next cache check.
+     * \param interface the index of the interface
+     * \param up true if the interface may have new neighbors (interface up,
+     *           address added), false if it may have lost some
+     */
+    void NotifyTopologyChange(uint32_t interface, bool up);
+
+    /**
+     * Add the nodes whose neighbors may be changed by a change on a device,
+     * i.e., the nodes of all the devices on its channel.
+     * \param [in] device the NetDevice which changed
+     * \param [in,out] nodes the ids of the nodes
+     * \returns false if the change can not be tracked (bridged device), true o.w.
+     */
+    bool AddAffectedNodes(Ptr<NetDevice> device, std::set<uint32_t>& nodes) const;
+
+    /**
+     * Process the recorded topology changes: remove the cached nix-vectors
+     * whose path may have changed, and revalidate the others.
+     */
+    void InvalidateCaches() const;
+
     /**
      * \sa Ipv4RoutingProtocol::DoInitialize
      * \sa Ipv6RoutingProtocol::DoInitialize
@@ -283,10 +350,24 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
      */
     void DoDispose();
 
+    /// Cached nix-vector, with the path it encodes
+    struct NixCacheEntry
+    {
+        Ptr<NixVector> nixVector;   //!< Nix-vector
+        std::vector<uint32_t> path; //!< Ids of the nodes of the path, from source to dest
+    };
+
+    /// Cached IpRoute, with the nix index of its next hop
+    struct IpRouteCacheEntry
+    {
+        Ptr<IpRoute> route; //!< Route
+        uint32_t nixIndex;  //!< Nix index of the next hop
+    };
+
     /// Map of IpAddress to NixVector
-    typedef std::map<IpAddress, Ptr<NixVector>> NixMap_t;
+    typedef std::map<IpAddress, NixCacheEntry> NixMap_t;
     /// Map of IpAddress to IpRoute
-    typedef std::map<IpAddress, Ptr<IpRoute>> IpRouteMap_t;
+    typedef std::map<IpAddress, IpRouteCacheEntry> IpRouteMap_t;
 
     /// Callback for IPv4 unicast packets to be forwarded
     typedef Callback<void, Ptr<IpRoute>, Ptr<const Packet>, const IpHeader&>
@@ -487,10 +568,29 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
     static bool g_isCacheDirty;
 
     /**
-     * Nix Epoch, incremented each time a flush is performed.
+     * Nix Epoch, incremented each time the caches are flushed or invalidated.
      */
     static uint32_t g_epoch;
 
+    /// Topology change on a device
+    struct TopologyChange
+    {
+        Ptr<NetDevice> device; //!< Device which changed
+        bool up;               //!< True if the device may have new neighbors
+    };
+
+    /// Topology changes not yet processed
+    static std::vector<TopologyChange> g_topologyChanges;
+
+    /// Flag to mark that a change can not be tracked and all the caches must be flushed
+    static bool g_isFullFlushNeeded;
+
+    /// BFS trees (parent vectors) of the source nodes, by node id
+    static std::unordered_map<uint32_t, std::vector<Ptr<Node>>> g_bfsTrees;
+
+    /// Counters of the work done on the caches
+    static CacheStats g_cacheStats;
+
     /** Cache stores nix-vectors based on destination ip */
     mutable NixMap_t m_nixCache;
 
@@ -25,6 +25,7 @@
 #include "ns3/ipv6-address-helper.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/nix-vector-helper.h"
+#include "ns3/nix-vector-routing.h"
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
@@ -393,6 +394,199 @@ NixVectorRoutingTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * The topology is of the form:
+ * \verbatim
+    n0 -- n1 -- n2 -- n3
+     |                 |
+    n4 -- n5 -------- n6
+           |
+          n7
+   \endverbatim
+ *
+ * n0 sends a packet to n3 after each of the following topology changes:
+ * - The interface of n7 goes down, then up again: the link is far from the
+ *   path n0-n1-n2-n3, and the cached nix-vector of n0 is kept.
+ * - The interface of n1 on the n1-n2 channel goes down: the cached
+ *   nix-vector is removed, and the path n0-n4-n5-n6-n3 is taken.
+ * - The interface goes up again: the cached nix-vector is removed, since
+ *   the path through n1 is shorter, and the path n0-n1-n2-n3 is taken.
+ *
+ * \brief IPv4 Nix-Vector Routing targeted cache invalidation test
+ */
+class NixVectorRoutingInvalidationTest : public TestCase
+{
+  public:
+    NixVectorRoutingInvalidationTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Send a packet from n0 to n3.
+     * \param socket The sending socket.
+     * \param to The destination address.
+     */
+    void Send(Ptr<Socket> socket, Ipv4Address to);
+
+    /**
+     * Check the cache counters.
+     * \param built The expected number of nix-vectors built.
+     * \param kept The expected number of cached nix-vectors kept.
+     * \param invalidated The expected number of cached nix-vectors removed.
+     */
+    void CheckStats(uint64_t built, uint64_t kept, uint64_t invalidated);
+
+    /**
+     * Receive data.
+     * \param socket The receiving socket.
+     */
+    void ReceivePkt(Ptr<Socket> socket);
+
+    uint32_t m_received; //!< Number of received packets
+};
+
+NixVectorRoutingInvalidationTest::NixVectorRoutingInvalidationTest()
+    : TestCase("targeted cache invalidation on link changes"),
+      m_received(0)
+{
+}
+
+void
+NixVectorRoutingInvalidationTest::Send(Ptr<Socket> socket, Ipv4Address to)
+{
+    socket->SendTo(Create<Packet>(123), 0, InetSocketAddress(to, 1234));
+}
+
+void
+NixVectorRoutingInvalidationTest::CheckStats(uint64_t built, uint64_t kept, uint64_t invalidated)
+{
+    Ipv4NixVectorRouting::CacheStats stats = Ipv4NixVectorRouting::GetCacheStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.nixVectorsBuilt,
+                          built,
+                          "Wrong number of nix-vectors built at " << Now().As(Time::S));
+    NS_TEST_EXPECT_MSG_EQ(stats.nixVectorsKept,
+                          kept,
+                          "Wrong number of nix-vectors kept at " << Now().As(Time::S));
+    NS_TEST_EXPECT_MSG_EQ(stats.nixVectorsInvalidated,
+                          invalidated,
+                          "Wrong number of nix-vectors removed at " << Now().As(Time::S));
+    NS_TEST_EXPECT_MSG_EQ(stats.fullFlushes, 0, "No full flush expected");
+}
+
+void
+NixVectorRoutingInvalidationTest::ReceivePkt(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        m_received++;
+    }
+}
+
+void
+NixVectorRoutingInvalidationTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(8);
+
+    Ipv4NixVectorHelper nixRouting;
+    InternetStackHelper stack;
+    stack.SetRoutingHelper(nixRouting);
+    stack.SetIpv6StackInstall(false);
+    stack.Install(nodes);
+
+    SimpleNetDeviceHelper devHelper;
+    devHelper.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper address;
+    address.SetBase("10.2.0.0", "255.255.255.0");
+    std::vector<std::pair<uint32_t, uint32_t>> links{
+        {0, 1}, {1, 2}, {2, 3}, {0, 4}, {4, 5}, {5, 6}, {6, 3}, {5, 7}};
+    std::vector<NetDeviceContainer> devices;
+    std::vector<Ipv4InterfaceContainer> interfaces;
+    for (const auto& link : links)
+    {
+        devices.push_back(devHelper.Install(NodeContainer(nodes.Get(link.first),
+                                                          nodes.Get(link.second))));
+        interfaces.push_back(address.Assign(devices.back()));
+        address.NewNetwork();
+    }
+    Ipv4Address dest = interfaces[2].GetAddress(1);
+
+    Ptr<Socket> rxSocket = Socket::CreateSocket(nodes.Get(3), UdpSocketFactory::GetTypeId());
+    rxSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 1234));
+    rxSocket->SetRecvCallback(MakeCallback(&NixVectorRoutingInvalidationTest::ReceivePkt, this));
+    Ptr<Socket> txSocket = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+
+    Ptr<Ipv4> ipv4n7 = nodes.Get(7)->GetObject<Ipv4>();
+    int32_t ifn7 = ipv4n7->GetInterfaceForDevice(devices[7].Get(1));
+    Ptr<Ipv4> ipv4n1 = nodes.Get(1)->GetObject<Ipv4>();
+    int32_t ifn1 = ipv4n1->GetInterfaceForDevice(devices[1].Get(0));
+
+    std::ostringstream farPath;
+    std::ostringstream detourPath;
+    std::ostringstream shortPath;
+
+    Ipv4NixVectorRouting::ResetCacheStats();
+    Simulator::Schedule(Seconds(1), &NixVectorRoutingInvalidationTest::Send, this, txSocket, dest);
+    Simulator::Schedule(Seconds(2), &NixVectorRoutingInvalidationTest::CheckStats, this, 1, 0, 0);
+
+    // far link down and up: the nix-vector is kept
+    Simulator::Schedule(Seconds(3), &Ipv4::SetDown, ipv4n7, ifn7);
+    Simulator::Schedule(Seconds(4), &NixVectorRoutingInvalidationTest::Send, this, txSocket, dest);
+    Simulator::Schedule(Seconds(5), &Ipv4::SetUp, ipv4n7, ifn7);
+    Simulator::Schedule(Seconds(6), &NixVectorRoutingInvalidationTest::Send, this, txSocket, dest);
+    Simulator::Schedule(Seconds(6.5), &NixVectorRoutingInvalidationTest::CheckStats, this, 1, 2, 0);
+    nixRouting.PrintRoutingPathAt(Seconds(6.5),
+                                  nodes.Get(0),
+                                  dest,
+                                  Create<OutputStreamWrapper>(&farPath));
+
+    // link on the path down: the nix-vector is rebuilt
+    Simulator::Schedule(Seconds(7), &Ipv4::SetDown, ipv4n1, ifn1);
+    Simulator::Schedule(Seconds(8), &NixVectorRoutingInvalidationTest::Send, this, txSocket, dest);
+    Simulator::Schedule(Seconds(8.5), &NixVectorRoutingInvalidationTest::CheckStats, this, 2, 2, 1);
+    nixRouting.PrintRoutingPathAt(Seconds(8.5),
+                                  nodes.Get(0),
+                                  dest,
+                                  Create<OutputStreamWrapper>(&detourPath));
+
+    // the link up again gives a shorter path: the nix-vector is rebuilt
+    Simulator::Schedule(Seconds(9), &Ipv4::SetUp, ipv4n1, ifn1);
+    Simulator::Schedule(Seconds(10), &NixVectorRoutingInvalidationTest::Send, this, txSocket, dest);
+    Simulator::Schedule(Seconds(10.5),
+                        &NixVectorRoutingInvalidationTest::CheckStats,
+                        this,
+                        3,
+                        2,
+                        2);
+    nixRouting.PrintRoutingPathAt(Seconds(10.5),
+                                  nodes.Get(0),
+                                  dest,
+                                  Create<OutputStreamWrapper>(&shortPath));
+
+    Simulator::Stop(Seconds(20));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(m_received, 5, "All the packets should have been received");
+
+    const std::string n1n2 = "(Node 1)  ---->   10.2.1.2                 (Node 2)";
+    const std::string n5n6 = "(Node 5)  ---->   10.2.5.2                 (Node 6)";
+    NS_TEST_EXPECT_MSG_NE(farPath.str().find(n1n2),
+                          std::string::npos,
+                          "Path through n1 not kept: " << farPath.str());
+    NS_TEST_EXPECT_MSG_NE(detourPath.str().find(n5n6),
+                          std::string::npos,
+                          "Path through n5 not taken: " << detourPath.str());
+    NS_TEST_EXPECT_MSG_NE(shortPath.str().find(n1n2),
+                          std::string::npos,
+                          "Path through n1 not taken again: " << shortPath.str());
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup nix-vector-routing-test
  * \ingroup tests
@@ -406,6 +600,7 @@ class NixVectorRoutingTestSuite : public TestSuite
         : TestSuite("nix-vector-routing", UNIT)
     {
         AddTestCase(new NixVectorRoutingTest(), TestCase::QUICK);
+        AddTestCase(new NixVectorRoutingInvalidationTest(), TestCase::QUICK);
     }
 };
 
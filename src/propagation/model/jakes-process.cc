@@ -84,6 +84,19 @@ JakesProcess::SetPropagationLossModel(Ptr<const PropagationLossModel> propagatio
     ConstructOscillators();
 }
 
+void
+JakesProcess::SetUniformRandomVariable(Ptr<UniformRandomVariable> uniform)
+{
+    NS_ASSERT_MSG(m_oscillators.empty(), "The oscillators are already constructed");
+    m_uniformVariable = uniform;
+}
+
+std::size_t
+JakesProcess::GetMemoryUsage() const
+{
+    return sizeof(*this) + m_oscillators.capacity() * sizeof(Oscillator);
+}
+
 void
 JakesProcess::SetNOscillators(unsigned int nOscillators)
 {
@@ -100,10 +113,13 @@ void
 JakesProcess::ConstructOscillators()
 {
     NS_ASSERT(m_jakes);
+    Ptr<UniformRandomVariable> uniform =
+        m_uniformVariable ? m_uniformVariable : m_jakes->GetUniformRandomVariable();
     // Initial phase is common for all oscillators:
-    double phi = m_jakes->GetUniformRandomVariable()->GetValue();
+    double phi = uniform->GetValue();
     // Theta is common for all oscillators:
-    double theta = m_jakes->GetUniformRandomVariable()->GetValue();
+    double theta = uniform->GetValue();
+    m_oscillators.reserve(m_nOscillators);
     for (unsigned int i = 0; i < m_nOscillators; i++)
     {
         unsigned int n = i + 1;
@@ -114,12 +130,14 @@ JakesProcess::ConstructOscillators()
         /// 1b. Initiate rotation speed:
         double omega = m_omegaDopplerMax * std::cos(alpha);
         /// 2. Initiate complex amplitude:
-        double psi = m_jakes->GetUniformRandomVariable()->GetValue();
+        double psi = uniform->GetValue();
         std::complex<double> amplitude =
             std::complex<double>(std::cos(psi), std::sin(psi)) * 2.0 / std::sqrt(m_nOscillators);
         /// 3. Construct oscillator:
         m_oscillators.emplace_back(amplitude, phi, omega);
     }
+    // the random variable is not needed anymore
+    m_uniformVariable = nullptr;
 }
 
 JakesProcess::JakesProcess()
@@ -82,6 +82,20 @@ class JakesProcess : public Object
      */
     void SetPropagationLossModel(Ptr<const PropagationLossModel> model);
 
+    /**
+     * Set the random variable from which the oscillators are drawn, instead
+     * of the random variable of the propagation model. It must be called
+     * before SetPropagationLossModel.
+     * \param uniform the random variable, uniform over [-pi, pi)
+     */
+    void SetUniformRandomVariable(Ptr<UniformRandomVariable> uniform);
+
+    /**
+     * Get the memory used by this object
+     * \return the memory used by this object, in bytes
+     */
+    std::size_t GetMemoryUsage() const;
+
   protected:
     void DoDispose() override;
 
@@ -133,7 +147,7 @@ class JakesProcess : public Object
     std::vector<Oscillator> m_oscillators;        //!< Vector of oscillators
     double m_omegaDopplerMax;                     //!< max rotation speed Doppler frequency
     unsigned int m_nOscillators;                  //!< number of oscillators
-    Ptr<UniformRandomVariable> m_uniformVariable; //!< random stream
+    Ptr<UniformRandomVariable> m_uniformVariable; //!< random stream of the oscillators, if any
     Ptr<const JakesPropagationLossModel> m_jakes; //!< pointer to the propagation loss model
 };
 } // namespace ns3
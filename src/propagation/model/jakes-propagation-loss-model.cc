@@ -20,7 +20,13 @@
 #include "jakes-propagation-loss-model.h"
 
 #include "ns3/double.h"
+#include "ns3/integer.h"
 #include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
 
 namespace ns3
 {
@@ -30,6 +36,9 @@ NS_LOG_COMPONENT_DEFINE("Jakes");
 NS_OBJECT_ENSURE_REGISTERED(JakesPropagationLossModel);
 
 JakesPropagationLossModel::JakesPropagationLossModel()
+    : m_cacheMaxMemory(0),
+      m_pathStream(0),
+      m_hasPathStream(false)
 {
     m_uniformVariable = CreateObject<UniformRandomVariable>();
     m_uniformVariable->SetAttribute("Min", DoubleValue(-1.0 * M_PI));
@@ -43,18 +52,82 @@ JakesPropagationLossModel::~JakesPropagationLossModel()
 TypeId
 JakesPropagationLossModel::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::JakesPropagationLossModel")
-                            .SetParent<PropagationLossModel>()
-                            .SetGroupName("Propagation")
-                            .AddConstructor<JakesPropagationLossModel>();
+    static TypeId tid =
+        TypeId("ns3::JakesPropagationLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Propagation")
+            .AddConstructor<JakesPropagationLossModel>()
+            .AddAttribute("CacheMaxMemory",
+                          "The maximum memory, in bytes, used by the cache of JakesProcess; "
+                          "the least recently used paths are removed beyond it. "
+                          "The default value does not limit the cache.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&JakesPropagationLossModel::SetCacheMaxMemory,
+                                               &JakesPropagationLossModel::GetCacheMaxMemory),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("CacheTimeToLive",
+                          "The time after which an unused path is removed from the cache of "
+                          "JakesProcess. The default value does not limit the cache.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&JakesPropagationLossModel::SetCacheTimeToLive,
+                                           &JakesPropagationLossModel::GetCacheTimeToLive),
+                          MakeTimeChecker());
     return tid;
 }
 
+void
+JakesPropagationLossModel::SetCacheMaxMemory(uint64_t maxMemory)
+{
+    m_cacheMaxMemory = maxMemory;
+    m_propagationCache.SetMaxMemory(maxMemory);
+    UpdatePathStream();
+}
+
+uint64_t
+JakesPropagationLossModel::GetCacheMaxMemory() const
+{
+    return m_cacheMaxMemory;
+}
+
+void
+JakesPropagationLossModel::SetCacheTimeToLive(Time timeToLive)
+{
+    m_cacheTimeToLive = timeToLive;
+    m_propagationCache.SetTimeToLive(timeToLive);
+    UpdatePathStream();
+}
+
+void
+JakesPropagationLossModel::UpdatePathStream()
+{
+    // drawn once, when the model is configured, rather than when the first
+    // path is created, so that the streams of the other objects do not
+    // depend on the traffic
+    if (m_propagationCache.IsBounded() && !m_hasPathStream)
+    {
+        m_pathStream = RngSeedManager::GetNextStreamIndex();
+        m_hasPathStream = true;
+    }
+}
+
+Time
+JakesPropagationLossModel::GetCacheTimeToLive() const
+{
+    return m_cacheTimeToLive;
+}
+
+PropagationCacheStats
+JakesPropagationLossModel::GetCacheStats() const
+{
+    return m_propagationCache.GetStats();
+}
+
 void
 JakesPropagationLossModel::DoDispose()
 {
     m_uniformVariable = nullptr;
     m_propagationCache.Cleanup();
+    m_mobilityIds.clear();
 }
 
 double
@@ -69,7 +142,12 @@ JakesPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     if (!pathData)
     {
         pathData = CreateObject<JakesProcess>();
+        if (m_propagationCache.IsBounded())
+        {
+            pathData->SetUniformRandomVariable(GetPathRandomVariable(a, b));
+        }
         pathData->SetPropagationLossModel(this);
+        m_propagationCache.SetEntrySize(pathData->GetMemoryUsage());
         m_propagationCache.AddPathData(
             pathData,
             a,
@@ -85,6 +163,37 @@ JakesPropagationLossModel::GetUniformRandomVariable() const
     return m_uniformVariable;
 }
 
+Ptr<UniformRandomVariable>
+JakesPropagationLossModel::GetPathRandomVariable(Ptr<const MobilityModel> a,
+                                                 Ptr<const MobilityModel> b) const
+{
+    uint64_t idA = m_mobilityIds.emplace(a, m_mobilityIds.size()).first->second;
+    uint64_t idB = m_mobilityIds.emplace(b, m_mobilityIds.size()).first->second;
+    NS_ASSERT(m_hasPathStream);
+    // mix the stream of the model, as the index of its RngStream, and the
+    // (symmetric) path into a user stream number. The automatic streams are
+    // counted from 0 and the user stream s is the stream 2^63 + s: the paths
+    // are drawn from the upper half of the user streams, out of the range of
+    // the streams assigned by the users, counted from 0.
+    int64_t stream = m_uniformVariable->GetStream();
+    uint64_t h = stream < 0 ? m_pathStream : (1ULL << 63) + static_cast<uint64_t>(stream);
+    for (uint64_t v : {std::min(idA, idB), std::max(idA, idB)})
+    {
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= h >> 31;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+    }
+    // the stream is set at construction, which does not draw an automatic one
+    return CreateObjectWithAttributes<UniformRandomVariable>(
+        "Min",
+        DoubleValue(-1.0 * M_PI),
+        "Max",
+        DoubleValue(M_PI),
+        "Stream",
+        IntegerValue(static_cast<int64_t>((1ULL << 62) | (h & ((1ULL << 62) - 1)))));
+}
+
 int64_t
 JakesPropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -23,6 +23,8 @@
 #include "ns3/propagation-cache.h"
 #include "ns3/propagation-loss-model.h"
 
+#include <map>
+
 namespace ns3
 {
 /**
@@ -30,6 +32,16 @@ namespace ns3
  *
  * \brief a  Jakes narrowband propagation model.
  * Symmetrical cache for JakesProcess
+ *
+ * The cache of JakesProcess can be bounded with the CacheMaxMemory and
+ * CacheTimeToLive attributes. In that case, the oscillators of each path
+ * are drawn from a random stream specific to the path, derived from the
+ * stream of the model and from the order in which the nodes of the path
+ * were first seen, such that a path removed from the cache is created
+ * again with the same oscillators, and the results do not depend on the
+ * limits of the cache. The stream of the model is the one set by
+ * AssignStreams or, by default, an automatic stream drawn when the cache
+ * is bounded.
  */
 
 class JakesPropagationLossModel : public PropagationLossModel
@@ -47,6 +59,12 @@ class JakesPropagationLossModel : public PropagationLossModel
     JakesPropagationLossModel(const JakesPropagationLossModel&) = delete;
     JakesPropagationLossModel& operator=(const JakesPropagationLossModel&) = delete;
 
+    /**
+     * Get the counters of the cache of JakesProcess
+     * \return the counters of the cache
+     */
+    PropagationCacheStats GetCacheStats() const;
+
   protected:
     void DoDispose() override;
 
@@ -65,8 +83,54 @@ class JakesPropagationLossModel : public PropagationLossModel
      */
     Ptr<UniformRandomVariable> GetUniformRandomVariable() const;
 
+    /**
+     * Get the random stream from which the oscillators of a path are drawn,
+     * when the cache is bounded
+     * \param a 1st node mobility model
+     * \param b 2nd node mobility model
+     * \return the random stream of the path
+     */
+    Ptr<UniformRandomVariable> GetPathRandomVariable(Ptr<const MobilityModel> a,
+                                                     Ptr<const MobilityModel> b) const;
+
+    /**
+     * Set the maximum memory of the cache
+     * \param maxMemory the maximum memory in bytes, or 0 for no limit
+     */
+    void SetCacheMaxMemory(uint64_t maxMemory);
+
+    /**
+     * Get the maximum memory of the cache
+     * \return the maximum memory in bytes, or 0 for no limit
+     */
+    uint64_t GetCacheMaxMemory() const;
+
+    /**
+     * Set the time to live of the unused paths of the cache
+     * \param timeToLive the time to live, or zero for no limit
+     */
+    void SetCacheTimeToLive(Time timeToLive);
+
+    /**
+     * Get the time to live of the unused paths of the cache
+     * \return the time to live, or zero for no limit
+     */
+    Time GetCacheTimeToLive() const;
+
+    /**
+     * Draw the automatic stream of the paths if the cache has been bounded
+     */
+    void UpdatePathStream();
+
     Ptr<UniformRandomVariable> m_uniformVariable;              //!< random stream
     mutable PropagationCache<JakesProcess> m_propagationCache; //!< Propagation cache
+    uint64_t m_cacheMaxMemory;                                 //!< Maximum memory of the cache
+    Time m_cacheTimeToLive;                                    //!< Time to live of unused paths
+    /// Automatic stream index from which the paths are drawn, unless AssignStreams is called
+    uint64_t m_pathStream;
+    bool m_hasPathStream; //!< Whether m_pathStream has been drawn
+    /// Order in which the nodes were first seen, to draw the paths when the cache is bounded
+    mutable std::map<Ptr<const MobilityModel>, uint32_t> m_mobilityIds;
 };
 
 } // namespace ns3
@@ -20,22 +20,55 @@
 #define PROPAGATION_CACHE_H_
 
 #include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
 
-#include <map>
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <unordered_map>
 
 namespace ns3
 {
+
+/**
+ * \ingroup propagation
+ * \brief Counters of a PropagationCache
+ */
+struct PropagationCacheStats
+{
+    uint64_t hits{0};      //!< Number of lookups which found their path
+    uint64_t misses{0};    //!< Number of lookups which did not find their path
+    uint64_t evictions{0}; //!< Number of paths removed to honor the limits
+    std::size_t size{0};   //!< Number of paths in the cache
+    std::size_t memory{0}; //!< Estimated memory used by the paths, in bytes
+};
+
 /**
  * \ingroup propagation
  * \brief Constructs a cache of objects, where each object is responsible for a single propagation
  * path loss calculations. Propagation path a-->b and b-->a is the same thing. Propagation path is
  * identified by a couple of MobilityModels and a spectrum model UID
+ *
+ * The cache is unbounded by default. SetMaxEntries and SetMaxMemory bound
+ * it: when a path is added to a full cache, the least recently used paths
+ * are removed. SetTimeToLive removes the paths which were not used for
+ * the given simulation time. A removed path is only dropped from the
+ * cache, without being disposed, since its object may still be used by
+ * the caller; the owner of the cache must be able to create its object
+ * again, identically, the next time the path is used.
  */
 template <class T>
 class PropagationCache
 {
   public:
-    PropagationCache(){};
+    PropagationCache()
+        : m_maxEntries(0),
+          m_maxMemory(0),
+          m_entrySize(sizeof(T))
+    {
+    }
+
     ~PropagationCache(){};
 
     /**
@@ -51,9 +84,22 @@ class PropagationCache
         typename PathCache::iterator it = m_pathCache.find(key);
         if (it == m_pathCache.end())
         {
+            m_stats.misses++;
             return nullptr;
         }
-        return it->second;
+        if (!m_timeToLive.IsZero() && it->second.lastUse + m_timeToLive < Simulator::Now())
+        {
+            // expired
+            m_lruList.erase(it->second.lruIt);
+            m_pathCache.erase(it);
+            m_stats.evictions++;
+            m_stats.misses++;
+            return nullptr;
+        }
+        m_stats.hits++;
+        it->second.lastUse = Simulator::Now();
+        m_lruList.splice(m_lruList.begin(), m_lruList, it->second.lruIt);
+        return it->second.data;
     };
 
     /**
@@ -70,7 +116,15 @@ class PropagationCache
     {
         PropagationPathIdentifier key = PropagationPathIdentifier(a, b, modelUid);
         NS_ASSERT(m_pathCache.find(key) == m_pathCache.end());
-        m_pathCache.insert(std::make_pair(key, data));
+        if (IsBounded())
+        {
+            Evict(1);
+        }
+        m_lruList.push_front(key);
+        PathData& pathData = m_pathCache[key];
+        pathData.data = data;
+        pathData.lastUse = Simulator::Now();
+        pathData.lruIt = m_lruList.begin();
     };
 
     /**
@@ -78,11 +132,72 @@ class PropagationCache
      */
     void Cleanup()
     {
-        for (auto i : m_pathCache)
+        for (auto& i : m_pathCache)
         {
-            i.second->Dispose();
+            i.second.data->Dispose();
         }
         m_pathCache.clear();
+        m_lruList.clear();
+    }
+
+    /**
+     * Set the maximum number of paths in the cache
+     * \param maxEntries the maximum number of paths, or 0 for no limit
+     */
+    void SetMaxEntries(std::size_t maxEntries)
+    {
+        m_maxEntries = maxEntries;
+        Evict(0);
+    }
+
+    /**
+     * Set the maximum memory used by the paths of the cache
+     * \param maxMemory the maximum memory in bytes, or 0 for no limit
+     */
+    void SetMaxMemory(std::size_t maxMemory)
+    {
+        m_maxMemory = maxMemory;
+        Evict(0);
+    }
+
+    /**
+     * Set the memory used by the object of a path, to account the memory
+     * of the cache. It defaults to the size of T.
+     * \param entrySize the memory used by the object of a path, in bytes
+     */
+    void SetEntrySize(std::size_t entrySize)
+    {
+        m_entrySize = entrySize;
+        Evict(0);
+    }
+
+    /**
+     * Set the time after which an unused path is removed
+     * \param timeToLive the time to live of the paths, or zero for no limit
+     */
+    void SetTimeToLive(Time timeToLive)
+    {
+        m_timeToLive = timeToLive;
+        Evict(0);
+    }
+
+    /**
+     * \return whether paths can be removed from the cache before Cleanup
+     */
+    bool IsBounded() const
+    {
+        return m_maxEntries != 0 || m_maxMemory != 0 || !m_timeToLive.IsZero();
+    }
+
+    /**
+     * \return the counters of the cache
+     */
+    PropagationCacheStats GetStats() const
+    {
+        PropagationCacheStats stats = m_stats;
+        stats.size = m_pathCache.size();
+        stats.memory = m_pathCache.size() * GetPathMemory();
+        return stats;
     }
 
   private:
@@ -98,53 +213,99 @@ class PropagationCache
         PropagationPathIdentifier(Ptr<const MobilityModel> a,
                                   Ptr<const MobilityModel> b,
                                   uint32_t modelUid)
-            : m_srcMobility(a),
-              m_dstMobility(b),
+            : m_srcMobility(std::min(a, b)),
+              m_dstMobility(std::max(a, b)),
               m_spectrumModelUid(modelUid){};
         Ptr<const MobilityModel> m_srcMobility; //!< 1st node mobility model
         Ptr<const MobilityModel> m_dstMobility; //!< 2nd node mobility model
         uint32_t m_spectrumModelUid;            //!< model UID
 
         /**
-         * Less-than operator.
-         *
-         * The goal of this operator is just to provide a stable comparison
-         * to be used in containers requiring a order (of any kind).
+         * Equality operator.
          *
-         * If the models are different, the comparison is based on their Uid.
-         * Otherwise, the comparison is based on the pointers of the Mobility models.
+         * Links are supposed to be symmetrical, hence the mobility models are
+         * stored in a canonical order by the constructor.
          *
          * \param other Right value of the operator.
-         * \returns True if the Left value is less than the Right value.
+         * \returns True if the two identifiers designate the same path.
          */
-        bool operator<(const PropagationPathIdentifier& other) const
+        bool operator==(const PropagationPathIdentifier& other) const
         {
-            if (m_spectrumModelUid != other.m_spectrumModelUid)
-            {
-                return m_spectrumModelUid < other.m_spectrumModelUid;
-            }
-            /// Links are supposed to be symmetrical!
-            if (std::min(m_dstMobility, m_srcMobility) !=
-                std::min(other.m_dstMobility, other.m_srcMobility))
-            {
-                return std::min(m_dstMobility, m_srcMobility) <
-                       std::min(other.m_dstMobility, other.m_srcMobility);
-            }
-            if (std::max(m_dstMobility, m_srcMobility) !=
-                std::max(other.m_dstMobility, other.m_srcMobility))
-            {
-                return std::max(m_dstMobility, m_srcMobility) <
-                       std::max(other.m_dstMobility, other.m_srcMobility);
-            }
-            return false;
+            return m_spectrumModelUid == other.m_spectrumModelUid &&
+                   m_srcMobility == other.m_srcMobility && m_dstMobility == other.m_dstMobility;
         }
     };
 
-    /// Typedef: PropagationPathIdentifier, Ptr<T>
-    typedef std::map<PropagationPathIdentifier, Ptr<T>> PathCache;
+    /// Hash of a PropagationPathIdentifier
+    struct PropagationPathIdentifierHash
+    {
+        /**
+         * \param key the path identifier
+         * \return the hash of the path identifier
+         */
+        std::size_t operator()(const PropagationPathIdentifier& key) const
+        {
+            std::size_t h = std::hash<const MobilityModel*>()(PeekPointer(key.m_srcMobility));
+            h = h * 31 + std::hash<const MobilityModel*>()(PeekPointer(key.m_dstMobility));
+            return h * 31 + key.m_spectrumModelUid;
+        }
+    };
 
-  private:
-    PathCache m_pathCache; //!< Path cache
+    /// Entry of the cache
+    struct PathData
+    {
+        Ptr<T> data;                                                   //!< Object of the path
+        Time lastUse;                                                  //!< Time of the last lookup
+        typename std::list<PropagationPathIdentifier>::iterator lruIt; //!< Position in m_lruList
+    };
+
+    /// Typedef: PropagationPathIdentifier, PathData
+    typedef std::unordered_map<PropagationPathIdentifier, PathData, PropagationPathIdentifierHash>
+        PathCache;
+
+    /**
+     * \return the estimated memory used by a path, including the cache overhead
+     */
+    std::size_t GetPathMemory() const
+    {
+        // the hash table node, the bucket and the LRU list node
+        return m_entrySize + sizeof(typename PathCache::value_type) + 2 * sizeof(void*) +
+               sizeof(PropagationPathIdentifier) + 2 * sizeof(void*);
+    }
+
+    /**
+     * Remove the expired paths, then the least recently used paths until
+     * the limits allow to add paths.
+     * \param room the number of paths to be added
+     */
+    void Evict(std::size_t room)
+    {
+        Time now = Simulator::Now();
+        while (!m_lruList.empty())
+        {
+            typename PathCache::iterator it = m_pathCache.find(m_lruList.back());
+            NS_ASSERT(it != m_pathCache.end());
+            std::size_t size = m_pathCache.size() + room;
+            bool isExpired = !m_timeToLive.IsZero() && it->second.lastUse + m_timeToLive < now;
+            bool isFull = (m_maxEntries != 0 && size > m_maxEntries) ||
+                          (m_maxMemory != 0 && size * GetPathMemory() > m_maxMemory);
+            if (!isExpired && !isFull)
+            {
+                break;
+            }
+            m_pathCache.erase(it);
+            m_lruList.pop_back();
+            m_stats.evictions++;
+        }
+    }
+
+    PathCache m_pathCache;                          //!< Path cache
+    std::list<PropagationPathIdentifier> m_lruList; //!< Paths, most recently used first
+    std::size_t m_maxEntries;                       //!< Maximum number of paths (0 for none)
+    std::size_t m_maxMemory;                        //!< Maximum memory of the paths (0 for none)
+    std::size_t m_entrySize;                        //!< Memory used by the object of a path
+    Time m_timeToLive;                              //!< Time to live of unused paths
+    PropagationCacheStats m_stats;                  //!< Counters
 };
 } // namespace ns3
 
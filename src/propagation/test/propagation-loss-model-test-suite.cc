@@ -19,10 +19,15 @@
 #include "ns3/config.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/double.h"
+#include "ns3/jakes-propagation-loss-model.h"
 #include "ns3/log.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/rng-seed-manager.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -489,6 +494,117 @@ RangePropagationLossModelTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup propagation-tests
+ *
+ * \brief JakesPropagationLossModel Test: a path removed from a bounded cache
+ * is created again with the same fading, without drawing automatic streams,
+ * and the paths of different models have different fading.
+ */
+class JakesPropagationLossModelCacheTestCase : public TestCase
+{
+  public:
+    JakesPropagationLossModelCacheTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Compare the received power of all the paths with both models
+     */
+    void ComparePaths();
+
+    std::vector<Ptr<MobilityModel>> m_mobilities; //!< Mobility models of the nodes
+    Ptr<JakesPropagationLossModel> m_small;      //!< Model with a cache of at most one path
+    Ptr<JakesPropagationLossModel> m_large;      //!< Model with a cache which is never emptied
+    Ptr<JakesPropagationLossModel> m_autoA;      //!< Model with an automatic stream
+    Ptr<JakesPropagationLossModel> m_autoB;      //!< Other model with an automatic stream
+    uint32_t m_samePaths;                        //!< Paths with the same fading in both
+};
+
+JakesPropagationLossModelCacheTestCase::JakesPropagationLossModelCacheTestCase()
+    : TestCase("Test the bounded cache of JakesPropagationLossModel"),
+      m_samePaths(0)
+{
+}
+
+void
+JakesPropagationLossModelCacheTestCase::ComparePaths()
+{
+    for (std::size_t i = 0; i < m_mobilities.size(); i++)
+    {
+        for (std::size_t j = 0; j < m_mobilities.size(); j++)
+        {
+            if (i != j)
+            {
+                NS_TEST_EXPECT_MSG_EQ(m_small->CalcRxPower(0, m_mobilities[i], m_mobilities[j]),
+                                      m_large->CalcRxPower(0, m_mobilities[i], m_mobilities[j]),
+                                      "Different fading for the path " << i << " - " << j);
+                if (m_autoA->CalcRxPower(0, m_mobilities[i], m_mobilities[j]) ==
+                    m_autoB->CalcRxPower(0, m_mobilities[i], m_mobilities[j]))
+                {
+                    m_samePaths++;
+                }
+            }
+        }
+    }
+}
+
+void
+JakesPropagationLossModelCacheTestCase::DoRun()
+{
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        m_mobilities.push_back(CreateObject<ConstantPositionMobilityModel>());
+    }
+    m_small = CreateObject<JakesPropagationLossModel>();
+    m_small->SetAttribute("CacheMaxMemory", UintegerValue(1));
+    m_small->AssignStreams(1);
+    m_large = CreateObject<JakesPropagationLossModel>();
+    m_large->SetAttribute("CacheTimeToLive", TimeValue(Seconds(1000)));
+    m_large->AssignStreams(1);
+    m_autoA = CreateObject<JakesPropagationLossModel>();
+    m_autoA->SetAttribute("CacheMaxMemory", UintegerValue(1));
+    m_autoB = CreateObject<JakesPropagationLossModel>();
+    m_autoB->SetAttribute("CacheMaxMemory", UintegerValue(1));
+    uint64_t nextStream = RngSeedManager::GetNextStreamIndex();
+
+    for (uint32_t t = 0; t < 10; t++)
+    {
+        Simulator::Schedule(MilliSeconds(t),
+                            &JakesPropagationLossModelCacheTestCase::ComparePaths,
+                            this);
+    }
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(RngSeedManager::GetNextStreamIndex(),
+                          nextStream + 1,
+                          "Automatic streams drawn by the paths");
+    NS_TEST_EXPECT_MSG_EQ(m_samePaths, 0, "Same fading in different models");
+
+    PropagationCacheStats small = m_small->GetCacheStats();
+    PropagationCacheStats large = m_large->GetCacheStats();
+    NS_TEST_EXPECT_MSG_EQ(small.size, 1, "Too many paths in the small cache");
+    NS_TEST_EXPECT_MSG_EQ(small.hits, 0, "Paths found in the small cache");
+    NS_TEST_EXPECT_MSG_EQ(small.evictions, small.misses - 1, "Paths not evicted");
+    NS_TEST_EXPECT_MSG_EQ(large.size, 10, "Wrong number of paths in the large cache");
+    NS_TEST_EXPECT_MSG_EQ(large.misses, 10, "Wrong number of misses in the large cache");
+    NS_TEST_EXPECT_MSG_EQ(large.hits, 190, "Wrong number of hits in the large cache");
+    NS_TEST_EXPECT_MSG_EQ(large.evictions, 0, "Paths evicted from the large cache");
+    NS_TEST_EXPECT_MSG_GT(large.memory, 10 * sizeof(JakesProcess), "Memory not accounted");
+
+    Simulator::Destroy();
+    m_small->Dispose();
+    m_large->Dispose();
+    m_autoA->Dispose();
+    m_autoB->Dispose();
+    m_small = nullptr;
+    m_large = nullptr;
+    m_autoA = nullptr;
+    m_autoB = nullptr;
+    m_mobilities.clear();
+}
+
 /**
  * \ingroup propagation-tests
  *
@@ -500,6 +616,7 @@ RangePropagationLossModelTestCase::DoRun()
  *   - LogDistancePropagationLossModel
  *   - MatrixPropagationLossModel
  *   - RangePropagationLossModel
+ *   - JakesPropagationLossModel
  */
 class PropagationLossModelsTestSuite : public TestSuite
 {
@@ -515,6 +632,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite()
     AddTestCase(new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
     AddTestCase(new MatrixPropagationLossModelTestCase, TestCase::QUICK);
     AddTestCase(new RangePropagationLossModelTestCase, TestCase::QUICK);
+    AddTestCase(new JakesPropagationLossModelCacheTestCase, TestCase::QUICK);
 }
 
 /// Static variable for test initialization
@@ -0,0 +1,254 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fading-trace.h"
+
+#include <ns3/fatal-error.h>
+#include <ns3/log.h>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FadingTrace");
+
+/// Magic of the binary fading traces
+static const char FADING_TRACE_MAGIC[8] = {'N', 'S', '3', 'F', 'A', 'D', 'E', '\0'};
+/// Version of the binary format
+static const uint32_t FADING_TRACE_VERSION = 1;
+/// Byte order mark of the binary format
+static const uint32_t FADING_TRACE_BYTE_ORDER = 0x01020304;
+
+/// Header of the binary fading traces
+struct FadingTraceHeader
+{
+    char magic[8];       //!< FADING_TRACE_MAGIC
+    uint32_t version;    //!< FADING_TRACE_VERSION
+    uint32_t rbNum;      //!< Number of RBs
+    uint32_t samplesNum; //!< Number of samples per RB
+    uint32_t byteOrder;  //!< FADING_TRACE_BYTE_ORDER, in the byte order of the writer
+};
+
+static_assert(sizeof(FadingTraceHeader) == 24, "unexpected padding of the fading trace header");
+
+/// Key of the loaded traces: file name, number of RBs and number of samples
+using FadingTraceKey = std::tuple<std::string, uint32_t, uint32_t>;
+
+/**
+ * \return the traces loaded in this process, which remove themselves when
+ * they are destroyed
+ */
+static std::map<FadingTraceKey, FadingTrace*>&
+GetLoadedTraces()
+{
+    static std::map<FadingTraceKey, FadingTrace*> traces;
+    return traces;
+}
+
+FadingTrace::FadingTrace(const std::string& fileName)
+    : m_fileName(fileName),
+      m_rbNum(0),
+      m_samplesNum(0),
+      m_samples(nullptr),
+      m_map(nullptr),
+      m_mapSize(0)
+{
+    NS_LOG_FUNCTION(this << fileName);
+}
+
+FadingTrace::~FadingTrace()
+{
+    NS_LOG_FUNCTION(this);
+    GetLoadedTraces().erase({m_fileName, m_rbNum, m_samplesNum});
+#ifndef __WIN32__
+    if (m_map)
+    {
+        munmap(m_map, m_mapSize);
+    }
+#endif
+}
+
+Ptr<const FadingTrace>
+FadingTrace::Load(const std::string& fileName, uint32_t rbNum, uint32_t samplesNum)
+{
+    NS_LOG_FUNCTION(fileName << rbNum << samplesNum);
+    auto& traces = GetLoadedTraces();
+    auto it = traces.find({fileName, rbNum, samplesNum});
+    if (it != traces.end())
+    {
+        NS_LOG_LOGIC("Fading trace " << fileName << " already loaded");
+        return Ptr<const FadingTrace>(it->second);
+    }
+
+    Ptr<FadingTrace> trace(new FadingTrace(fileName), false);
+    if (IsBinary(fileName))
+    {
+        trace->LoadBinary(rbNum, samplesNum);
+    }
+    else
+    {
+        trace->LoadAscii(rbNum, samplesNum);
+    }
+    traces[{fileName, rbNum, samplesNum}] = PeekPointer(trace);
+    return trace;
+}
+
+bool
+FadingTrace::IsBinary(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ifstream::binary);
+    if (!file.good())
+    {
+        NS_FATAL_ERROR("Fading trace file " << fileName << " not found");
+    }
+    char magic[sizeof(FADING_TRACE_MAGIC)];
+    file.read(magic, sizeof(magic));
+    return file.good() && std::memcmp(magic, FADING_TRACE_MAGIC, sizeof(magic)) == 0;
+}
+
+void
+FadingTrace::LoadAscii(uint32_t rbNum, uint32_t samplesNum)
+{
+    NS_LOG_FUNCTION(this << rbNum << samplesNum);
+    std::ifstream file(m_fileName, std::ifstream::in);
+    m_values.resize(static_cast<std::size_t>(rbNum) * samplesNum);
+    for (auto& value : m_values)
+    {
+        if (!(file >> value))
+        {
+            NS_FATAL_ERROR("Fading trace file " << m_fileName << " has less than " << rbNum
+                                                << " RBs of " << samplesNum << " samples");
+        }
+    }
+    m_rbNum = rbNum;
+    m_samplesNum = samplesNum;
+    m_samples = m_values.data();
+}
+
+void
+FadingTrace::LoadBinary(uint32_t rbNum, uint32_t samplesNum)
+{
+    NS_LOG_FUNCTION(this << rbNum << samplesNum);
+    std::ifstream file(m_fileName, std::ifstream::binary);
+    FadingTraceHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good())
+    {
+        NS_FATAL_ERROR("Fading trace file " << m_fileName << " is truncated");
+    }
+    if (header.byteOrder != FADING_TRACE_BYTE_ORDER)
+    {
+        NS_FATAL_ERROR("Fading trace file " << m_fileName
+                                            << " was written with another byte order, convert the "
+                                               "ASCII trace again on this host");
+    }
+    if (header.version != FADING_TRACE_VERSION)
+    {
+        NS_FATAL_ERROR("Fading trace file " << m_fileName << " has the unsupported version "
+                                            << header.version);
+    }
+    if (header.rbNum != rbNum || header.samplesNum != samplesNum)
+    {
+        NS_FATAL_ERROR("Fading trace file " << m_fileName << " has " << header.rbNum
+                                            << " RBs of " << header.samplesNum
+                                            << " samples instead of " << rbNum << " RBs of "
+                                            << samplesNum << " samples");
+    }
+    std::size_t count = static_cast<std::size_t>(rbNum) * samplesNum;
+    std::size_t size = sizeof(header) + count * sizeof(double);
+    file.seekg(0, std::ifstream::end);
+    if (static_cast<std::size_t>(file.tellg()) < size)
+    {
+        NS_FATAL_ERROR("Fading trace file " << m_fileName << " is truncated");
+    }
+    m_rbNum = rbNum;
+    m_samplesNum = samplesNum;
+
+#ifndef __WIN32__
+    int fd = open(m_fileName.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map != MAP_FAILED)
+        {
+            NS_LOG_LOGIC("Fading trace " << m_fileName << " mapped");
+            m_map = map;
+            m_mapSize = size;
+            m_samples = reinterpret_cast<const double*>(static_cast<const char*>(map) +
+                                                        sizeof(FadingTraceHeader));
+            return;
+        }
+    }
+    NS_LOG_WARN("Unable to map the fading trace " << m_fileName << ", read it");
+#endif
+
+    m_values.resize(count);
+    file.seekg(sizeof(header));
+    file.read(reinterpret_cast<char*>(m_values.data()), count * sizeof(double));
+    m_samples = m_values.data();
+}
+
+void
+FadingTrace::WriteBinary(const std::string& fileName) const
+{
+    NS_LOG_FUNCTION(this << fileName);
+    FadingTraceHeader header;
+    std::memcpy(header.magic, FADING_TRACE_MAGIC, sizeof(header.magic));
+    header.version = FADING_TRACE_VERSION;
+    header.rbNum = m_rbNum;
+    header.samplesNum = m_samplesNum;
+    header.byteOrder = FADING_TRACE_BYTE_ORDER;
+
+    std::ofstream file(fileName, std::ofstream::binary | std::ofstream::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_samples),
+               static_cast<std::size_t>(m_rbNum) * m_samplesNum * sizeof(double));
+    if (!file.good())
+    {
+        NS_FATAL_ERROR("Unable to write the fading trace file " << fileName);
+    }
+}
+
+uint32_t
+FadingTrace::GetRbNum() const
+{
+    return m_rbNum;
+}
+
+uint32_t
+FadingTrace::GetSamplesNum() const
+{
+    return m_samplesNum;
+}
+
+bool
+FadingTrace::IsMapped() const
+{
+    return m_map != nullptr;
+}
+
+} // namespace ns3
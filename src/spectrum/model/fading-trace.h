@@ -0,0 +1,155 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FADING_TRACE_H
+#define FADING_TRACE_H
+
+#include <ns3/assert.h>
+#include <ns3/ptr.h>
+#include <ns3/simple-ref-count.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief Read-only fading trace, made of the fading samples (in dB) of a
+ * number of RBs.
+ *
+ * A trace is loaded either from the ASCII format generated by
+ * fading_trace_generator.m (one row of samples per RB) or from the binary
+ * format written by WriteBinary.  A binary trace is memory-mapped when the
+ * platform supports it, so that its pages are shared by all the processes
+ * using the same file, and only the pages which are accessed are read.
+ *
+ * The traces are shared: loading a file which is already loaded in this
+ * process returns the same FadingTrace, as long as it is referenced.
+ *
+ * The binary format is a 24-byte header followed by the samples of each RB
+ * as doubles in the byte order of the host which wrote the file:
+ *
+ * \verbatim
+     offset  size  field
+          0     8  magic "NS3FADE\0"
+          8     4  format version (1)
+         12     4  number of RBs
+         16     4  number of samples per RB
+         20     4  byte order mark 0x01020304
+         24     8  sample 0 of RB 0, then the following samples of each RB
+   \endverbatim
+ */
+class FadingTrace : public SimpleRefCount<FadingTrace>
+{
+  public:
+    ~FadingTrace();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    FadingTrace(const FadingTrace&) = delete;
+    FadingTrace& operator=(const FadingTrace&) = delete;
+
+    /**
+     * Load a fading trace, or get it if it is already loaded. A binary trace
+     * must have the expected dimensions.
+     *
+     * \param fileName the name of the ASCII or binary trace file
+     * \param rbNum the number of RBs of the trace
+     * \param samplesNum the number of samples per RB
+     * \return the fading trace
+     */
+    static Ptr<const FadingTrace> Load(const std::string& fileName,
+                                       uint32_t rbNum,
+                                       uint32_t samplesNum);
+
+    /**
+     * Write the fading trace in the binary format.
+     *
+     * \param fileName the name of the binary trace file
+     */
+    void WriteBinary(const std::string& fileName) const;
+
+    /**
+     * \return the number of RBs of the trace
+     */
+    uint32_t GetRbNum() const;
+
+    /**
+     * \return the number of samples per RB
+     */
+    uint32_t GetSamplesNum() const;
+
+    /**
+     * \return true if the trace is a memory-mapped binary file
+     */
+    bool IsMapped() const;
+
+    /**
+     * \param rb the RB
+     * \param sample the index of the sample
+     * \return the fading of the RB at the sample, in dB
+     */
+    double GetValue(uint32_t rb, uint32_t sample) const
+    {
+        NS_ASSERT_MSG(rb < m_rbNum && sample < m_samplesNum,
+                      "sample " << sample << " of RB " << rb << " out of the fading trace");
+        return m_samples[static_cast<std::size_t>(rb) * m_samplesNum + sample];
+    }
+
+  private:
+    /**
+     * Create an empty trace.
+     *
+     * \param fileName the name of the trace file
+     */
+    FadingTrace(const std::string& fileName);
+
+    /**
+     * Read an ASCII trace.
+     *
+     * \param rbNum the number of RBs of the trace
+     * \param samplesNum the number of samples per RB
+     */
+    void LoadAscii(uint32_t rbNum, uint32_t samplesNum);
+
+    /**
+     * Map, or read if mapping is not supported, a binary trace.
+     *
+     * \param rbNum the expected number of RBs
+     * \param samplesNum the expected number of samples per RB
+     */
+    void LoadBinary(uint32_t rbNum, uint32_t samplesNum);
+
+    /**
+     * \param fileName the name of a trace file
+     * \return true if the file starts with the magic of the binary format
+     */
+    static bool IsBinary(const std::string& fileName);
+
+    std::string m_fileName;       //!< Name of the trace file
+    uint32_t m_rbNum;             //!< Number of RBs
+    uint32_t m_samplesNum;        //!< Number of samples per RB
+    const double* m_samples;      //!< Samples, RB after RB
+    std::vector<double> m_values; //!< Storage of the samples when the file is not mapped
+    void* m_map;                  //!< Mapping of the file, or nullptr
+    std::size_t m_mapSize;        //!< Size of the mapping
+};
+
+} // namespace ns3
+
+#endif /* FADING_TRACE_H */
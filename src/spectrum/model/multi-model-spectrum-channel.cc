@@ -37,6 +37,7 @@
 #include <ns3/spectrum-propagation-loss-model.h>
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <utility>
 
@@ -80,7 +81,9 @@ RxSpectrumModelInfo::RxSpectrumModelInfo(Ptr<const SpectrumModel> rxSpectrumMode
 }
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel()
-    : m_numDevices{0}
+    : m_numDevices{0},
+      m_rxIndexValid{false},
+      m_rxCellSize{0}
 {
     NS_LOG_FUNCTION(this);
 }
@@ -89,6 +92,18 @@ void
 MultiModelSpectrumChannel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    for (const auto& mobility : m_trackedMobilities)
+    {
+        mobility->TraceDisconnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&MultiModelSpectrumChannel::RxCourseChange, this));
+    }
+    m_trackedMobilities.clear();
+    m_rxEntries.clear();
+    m_rxCells.clear();
+    m_rxMobile.clear();
+    m_rxEntriesByMobility.clear();
+    m_rxIndexValid = false;
     m_txSpectrumModelInfoMap.clear();
     m_rxSpectrumModelInfoMap.clear();
     SpectrumChannel::DoDispose();
@@ -97,12 +112,22 @@ MultiModelSpectrumChannel::DoDispose()
 TypeId
 MultiModelSpectrumChannel::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::MultiModelSpectrumChannel")
-                            .SetParent<SpectrumChannel>()
-                            .SetGroupName("Spectrum")
-                            .AddConstructor<MultiModelSpectrumChannel>()
-
-        ;
+    static TypeId tid =
+        TypeId("ns3::MultiModelSpectrumChannel")
+            .SetParent<SpectrumChannel>()
+            .SetGroupName("Spectrum")
+            .AddConstructor<MultiModelSpectrumChannel>()
+            .AddAttribute("MaxRange",
+                          "If positive, the maximum distance in meters between the "
+                          "transmitter and the receivers to which a transmission is "
+                          "delivered. The other receivers are skipped before any loss "
+                          "is computed, such that the Gain and PathLoss traces are not "
+                          "fired for them. The receivers are found through a grid over "
+                          "their positions. The default value delivers every "
+                          "transmission to all the receivers.",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&MultiModelSpectrumChannel::m_maxRange),
+                          MakeDoubleChecker<double>(0));
     return tid;
 }
 
@@ -126,6 +151,7 @@ MultiModelSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
         {
             rxInfoIterator->second.m_rxPhys.erase(phyIt);
             --m_numDevices;
+            m_rxIndexValid = false;
             break; // there should be at most one entry
         }
     }
@@ -154,6 +180,7 @@ MultiModelSpectrumChannel::AddRx(Ptr<SpectrumPhy> phy)
     // rxInfoIterator points either to the newly inserted element or to the element that
     // prevented insertion. In both cases, add the phy to the element pointed to by rxInfoIterator
     rxInfoIterator->second.m_rxPhys.push_back(phy);
+    m_rxIndexValid = false;
 
     if (inserted)
     {
@@ -256,6 +283,12 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
     NS_LOG_LOGIC("converter map first element: "
                  << txInfoIteratorerator->second.m_spectrumConverterMap.begin()->first);
 
+    if (m_maxRange > 0 && txMobility)
+    {
+        StartTxInRange(txParams, txMobility, txInfoIteratorerator);
+        return;
+    }
+
     for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin();
          rxInfoIterator != m_rxSpectrumModelInfoMap.end();
          ++rxInfoIterator)
@@ -263,24 +296,12 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
         SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid();
         NS_LOG_LOGIC("rxSpectrumModelUids " << rxSpectrumModelUid);
 
-        Ptr<SpectrumValue> convertedTxPowerSpectrum;
-        if (txSpectrumModelUid == rxSpectrumModelUid)
+        Ptr<SpectrumValue> convertedTxPowerSpectrum =
+            ConvertTxPowerSpectrum(txParams, txInfoIteratorerator, rxSpectrumModelUid);
+        if (!convertedTxPowerSpectrum)
         {
-            NS_LOG_LOGIC("no spectrum conversion needed");
-            convertedTxPowerSpectrum = txParams->psd;
-        }
-        else
-        {
-            NS_LOG_LOGIC("converting txPowerSpectrum SpectrumModelUids "
-                         << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
-            SpectrumConverterMap_t::const_iterator rxConverterIterator =
-                txInfoIteratorerator->second.m_spectrumConverterMap.find(rxSpectrumModelUid);
-            if (rxConverterIterator == txInfoIteratorerator->second.m_spectrumConverterMap.end())
-            {
-                // No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
-                continue;
-            }
-            convertedTxPowerSpectrum = rxConverterIterator->second.Convert(txParams->psd);
+            // No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
+            continue;
         }
 
         for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin();
@@ -291,107 +312,301 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                           "SpectrumModel change was not notified to MultiModelSpectrumChannel "
                           "(i.e., AddRx should be called again after model is changed)");
 
-            if ((*rxPhyIterator) != txParams->txPhy)
+            StartTxToReceiver(txParams, txMobility, convertedTxPowerSpectrum, *rxPhyIterator);
+        }
+    }
+}
+
+Ptr<SpectrumValue>
+MultiModelSpectrumChannel::ConvertTxPowerSpectrum(
+    Ptr<SpectrumSignalParameters> txParams,
+    TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+    SpectrumModelUid_t rxSpectrumModelUid) const
+{
+    SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid();
+    if (txSpectrumModelUid == rxSpectrumModelUid)
+    {
+        NS_LOG_LOGIC("no spectrum conversion needed");
+        return txParams->psd;
+    }
+    NS_LOG_LOGIC("converting txPowerSpectrum SpectrumModelUids " << txSpectrumModelUid << " --> "
+                                                                 << rxSpectrumModelUid);
+    SpectrumConverterMap_t::const_iterator rxConverterIterator =
+        txInfoIterator->second.m_spectrumConverterMap.find(rxSpectrumModelUid);
+    if (rxConverterIterator == txInfoIterator->second.m_spectrumConverterMap.end())
+    {
+        return nullptr;
+    }
+    return rxConverterIterator->second.Convert(txParams->psd);
+}
+
+void
+MultiModelSpectrumChannel::StartTxToReceiver(Ptr<SpectrumSignalParameters> txParams,
+                                             Ptr<MobilityModel> txMobility,
+                                             Ptr<const SpectrumValue> convertedTxPowerSpectrum,
+                                             Ptr<SpectrumPhy> receiver)
+{
+    if (receiver == txParams->txPhy)
+    {
+        return;
+    }
+
+    Ptr<NetDevice> rxNetDevice = receiver->GetDevice();
+    Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+
+    if (rxNetDevice && txNetDevice)
+    {
+        // we assume that devices are attached to a node
+        if (rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId())
+        {
+            NS_LOG_DEBUG("Skipping the pathloss calculation among different antennas of the "
+                         "same node, not supported yet by any pathloss model in ns-3.");
+            return;
+        }
+    }
+
+    NS_LOG_LOGIC("copying signal parameters " << txParams);
+    Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+    rxParams->psd = Copy<SpectrumValue>(convertedTxPowerSpectrum);
+    Time delay = MicroSeconds(0);
+
+    Ptr<MobilityModel> receiverMobility = receiver->GetMobility();
+
+    if (txMobility && receiverMobility)
+    {
+        double txAntennaGain = 0;
+        double rxAntennaGain = 0;
+        double propagationGainDb = 0;
+        double pathLossDb = 0;
+        if (rxParams->txAntenna)
+        {
+            Angles txAngles(receiverMobility->GetPosition(), txMobility->GetPosition());
+            txAntennaGain = rxParams->txAntenna->GetGainDb(txAngles);
+            NS_LOG_LOGIC("txAntennaGain = " << txAntennaGain << " dB");
+            pathLossDb -= txAntennaGain;
+        }
+        Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel>(receiver->GetAntenna());
+        if (rxAntenna)
+        {
+            Angles rxAngles(txMobility->GetPosition(), receiverMobility->GetPosition());
+            rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
+            NS_LOG_LOGIC("rxAntennaGain = " << rxAntennaGain << " dB");
+            pathLossDb -= rxAntennaGain;
+        }
+        if (m_propagationLoss)
+        {
+            propagationGainDb = m_propagationLoss->CalcRxPower(0, txMobility, receiverMobility);
+            NS_LOG_LOGIC("propagationGainDb = " << propagationGainDb << " dB");
+            pathLossDb -= propagationGainDb;
+        }
+        NS_LOG_LOGIC("total pathLoss = " << pathLossDb << " dB");
+        // Gain trace
+        m_gainTrace(txMobility,
+                    receiverMobility,
+                    txAntennaGain,
+                    rxAntennaGain,
+                    propagationGainDb,
+                    pathLossDb);
+        // Pathloss trace
+        m_pathLossTrace(txParams->txPhy, receiver, pathLossDb);
+        if (pathLossDb > m_maxLossDb)
+        {
+            // beyond range
+            return;
+        }
+        double pathGainLinear = std::pow(10.0, (-pathLossDb) / 10.0);
+        *(rxParams->psd) *= pathGainLinear;
+
+        if (m_propagationDelay)
+        {
+            delay = m_propagationDelay->GetDelay(txMobility, receiverMobility);
+        }
+    }
+
+    if (rxNetDevice)
+    {
+        // the receiver has a NetDevice, so we expect that it is attached to a Node
+        uint32_t dstNode = rxNetDevice->GetNode()->GetId();
+        Simulator::ScheduleWithContext(dstNode,
+                                       delay,
+                                       &MultiModelSpectrumChannel::StartRx,
+                                       this,
+                                       rxParams,
+                                       receiver);
+    }
+    else
+    {
+        // the receiver is not attached to a NetDevice, so we cannot assume that it is
+        // attached to a node
+        Simulator::Schedule(delay, &MultiModelSpectrumChannel::StartRx, this, rxParams, receiver);
+    }
+}
+
+MultiModelSpectrumChannel::RxCell
+MultiModelSpectrumChannel::GetRxCell(const Vector& position) const
+{
+    return RxCell(static_cast<int64_t>(std::floor(position.x / m_rxCellSize)),
+                  static_cast<int64_t>(std::floor(position.y / m_rxCellSize)));
+}
+
+void
+MultiModelSpectrumChannel::UpdateRxIndex()
+{
+    if (m_rxIndexValid && m_rxCellSize == m_maxRange)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+    m_rxCellSize = m_maxRange;
+    m_rxEntries.clear();
+    m_rxCells.clear();
+    m_rxMobile.clear();
+    m_rxEntriesByMobility.clear();
+    for (const auto& rxInfo : m_rxSpectrumModelInfoMap)
+    {
+        for (const auto& phy : rxInfo.second.m_rxPhys)
+        {
+            RxIndexEntry entry;
+            entry.phy = phy;
+            entry.mobility = phy->GetMobility();
+            entry.rxSpectrumModelUid = rxInfo.first;
+            m_rxEntries.push_back(entry);
+        }
+    }
+    for (std::size_t i = 0; i < m_rxEntries.size(); i++)
+    {
+        Ptr<MobilityModel> mobility = m_rxEntries[i].mobility;
+        if (mobility)
+        {
+            m_rxEntriesByMobility[PeekPointer(mobility)].push_back(i);
+            if (m_trackedMobilities.insert(mobility).second)
             {
-                Ptr<NetDevice> rxNetDevice = (*rxPhyIterator)->GetDevice();
-                Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+                mobility->TraceConnectWithoutContext(
+                    "CourseChange",
+                    MakeCallback(&MultiModelSpectrumChannel::RxCourseChange, this));
+            }
+        }
+        PlaceRxEntry(i);
+    }
+    m_rxIndexValid = true;
+}
 
-                if (rxNetDevice && txNetDevice)
-                {
-                    // we assume that devices are attached to a node
-                    if (rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId())
-                    {
-                        NS_LOG_DEBUG(
-                            "Skipping the pathloss calculation among different antennas of the "
-                            "same node, not supported yet by any pathloss model in ns-3.");
-                        continue;
-                    }
-                }
+void
+MultiModelSpectrumChannel::PlaceRxEntry(std::size_t index)
+{
+    RxIndexEntry& entry = m_rxEntries[index];
+    Vector velocity = entry.mobility ? entry.mobility->GetVelocity() : Vector();
+    entry.isMobile =
+        !entry.mobility || velocity.x != 0 || velocity.y != 0 || velocity.z != 0;
+    if (entry.isMobile)
+    {
+        m_rxMobile.push_back(index);
+        return;
+    }
+    entry.position = entry.mobility->GetPosition();
+    entry.cell = GetRxCell(entry.position);
+    m_rxCells[entry.cell].push_back(index);
+}
 
-                NS_LOG_LOGIC("copying signal parameters " << txParams);
-                Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
-                rxParams->psd = Copy<SpectrumValue>(convertedTxPowerSpectrum);
-                Time delay = MicroSeconds(0);
+void
+MultiModelSpectrumChannel::UnplaceRxEntry(std::size_t index)
+{
+    RxIndexEntry& entry = m_rxEntries[index];
+    std::vector<std::size_t>& list = entry.isMobile ? m_rxMobile : m_rxCells[entry.cell];
+    auto it = std::find(list.begin(), list.end(), index);
+    NS_ASSERT(it != list.end());
+    *it = list.back();
+    list.pop_back();
+    if (!entry.isMobile && list.empty())
+    {
+        m_rxCells.erase(entry.cell);
+    }
+}
 
-                Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility();
+void
+MultiModelSpectrumChannel::RxCourseChange(Ptr<const MobilityModel> mobility)
+{
+    if (!m_rxIndexValid)
+    {
+        // the grid will be rebuilt at the next transmission
+        return;
+    }
+    auto it = m_rxEntriesByMobility.find(PeekPointer(mobility));
+    if (it == m_rxEntriesByMobility.end())
+    {
+        return;
+    }
+    for (std::size_t index : it->second)
+    {
+        UnplaceRxEntry(index);
+        PlaceRxEntry(index);
+    }
+}
 
-                if (txMobility && receiverMobility)
-                {
-                    double txAntennaGain = 0;
-                    double rxAntennaGain = 0;
-                    double propagationGainDb = 0;
-                    double pathLossDb = 0;
-                    if (rxParams->txAntenna)
-                    {
-                        Angles txAngles(receiverMobility->GetPosition(), txMobility->GetPosition());
-                        txAntennaGain = rxParams->txAntenna->GetGainDb(txAngles);
-                        NS_LOG_LOGIC("txAntennaGain = " << txAntennaGain << " dB");
-                        pathLossDb -= txAntennaGain;
-                    }
-                    Ptr<AntennaModel> rxAntenna =
-                        DynamicCast<AntennaModel>((*rxPhyIterator)->GetAntenna());
-                    if (rxAntenna)
-                    {
-                        Angles rxAngles(txMobility->GetPosition(), receiverMobility->GetPosition());
-                        rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
-                        NS_LOG_LOGIC("rxAntennaGain = " << rxAntennaGain << " dB");
-                        pathLossDb -= rxAntennaGain;
-                    }
-                    if (m_propagationLoss)
-                    {
-                        propagationGainDb =
-                            m_propagationLoss->CalcRxPower(0, txMobility, receiverMobility);
-                        NS_LOG_LOGIC("propagationGainDb = " << propagationGainDb << " dB");
-                        pathLossDb -= propagationGainDb;
-                    }
-                    NS_LOG_LOGIC("total pathLoss = " << pathLossDb << " dB");
-                    // Gain trace
-                    m_gainTrace(txMobility,
-                                receiverMobility,
-                                txAntennaGain,
-                                rxAntennaGain,
-                                propagationGainDb,
-                                pathLossDb);
-                    // Pathloss trace
-                    m_pathLossTrace(txParams->txPhy, *rxPhyIterator, pathLossDb);
-                    if (pathLossDb > m_maxLossDb)
-                    {
-                        // beyond range
-                        continue;
-                    }
-                    double pathGainLinear = std::pow(10.0, (-pathLossDb) / 10.0);
-                    *(rxParams->psd) *= pathGainLinear;
-
-                    if (m_propagationDelay)
-                    {
-                        delay = m_propagationDelay->GetDelay(txMobility, receiverMobility);
-                    }
-                }
+void
+MultiModelSpectrumChannel::StartTxInRange(Ptr<SpectrumSignalParameters> txParams,
+                                          Ptr<MobilityModel> txMobility,
+                                          TxSpectrumModelInfoMap_t::const_iterator txInfoIterator)
+{
+    NS_LOG_FUNCTION(this << txParams);
+    UpdateRxIndex();
 
-                if (rxNetDevice)
-                {
-                    // the receiver has a NetDevice, so we expect that it is attached to a Node
-                    uint32_t dstNode = rxNetDevice->GetNode()->GetId();
-                    Simulator::ScheduleWithContext(dstNode,
-                                                   delay,
-                                                   &MultiModelSpectrumChannel::StartRx,
-                                                   this,
-                                                   rxParams,
-                                                   *rxPhyIterator);
-                }
-                else
+    Vector txPosition = txMobility->GetPosition();
+    std::vector<std::size_t> receivers;
+    RxCell txCell = GetRxCell(txPosition);
+    for (int64_t dx = -1; dx <= 1; dx++)
+    {
+        for (int64_t dy = -1; dy <= 1; dy++)
+        {
+            auto cellIt = m_rxCells.find(RxCell(txCell.first + dx, txCell.second + dy));
+            if (cellIt == m_rxCells.end())
+            {
+                continue;
+            }
+            for (std::size_t index : cellIt->second)
+            {
+                if (CalculateDistance(m_rxEntries[index].position, txPosition) <= m_maxRange)
                 {
-                    // the receiver is not attached to a NetDevice, so we cannot assume that it is
-                    // attached to a node
-                    Simulator::Schedule(delay,
-                                        &MultiModelSpectrumChannel::StartRx,
-                                        this,
-                                        rxParams,
-                                        *rxPhyIterator);
+                    receivers.push_back(index);
                 }
             }
         }
     }
+    for (std::size_t index : m_rxMobile)
+    {
+        Ptr<MobilityModel> mobility = m_rxEntries[index].mobility;
+        if (!mobility || CalculateDistance(mobility->GetPosition(), txPosition) <= m_maxRange)
+        {
+            receivers.push_back(index);
+        }
+    }
+    NS_LOG_LOGIC(receivers.size() << " of " << m_rxEntries.size() << " receivers in range");
+
+    // schedule the receptions in the same order as without the grid
+    std::sort(receivers.begin(), receivers.end());
+    bool isConverted = false;
+    SpectrumModelUid_t rxSpectrumModelUid = 0;
+    Ptr<SpectrumValue> convertedTxPowerSpectrum;
+    for (std::size_t index : receivers)
+    {
+        const RxIndexEntry& entry = m_rxEntries[index];
+        NS_ASSERT_MSG(entry.phy->GetRxSpectrumModel()->GetUid() == entry.rxSpectrumModelUid,
+                      "SpectrumModel change was not notified to MultiModelSpectrumChannel "
+                      "(i.e., AddRx should be called again after model is changed)");
+        if (!isConverted || entry.rxSpectrumModelUid != rxSpectrumModelUid)
+        {
+            isConverted = true;
+            rxSpectrumModelUid = entry.rxSpectrumModelUid;
+            convertedTxPowerSpectrum =
+                ConvertTxPowerSpectrum(txParams, txInfoIterator, rxSpectrumModelUid);
+        }
+        if (!convertedTxPowerSpectrum)
+        {
+            // No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
+            continue;
+        }
+        StartTxToReceiver(txParams, txMobility, convertedTxPowerSpectrum, entry.phy);
+    }
 }
 
 void
@@ -26,8 +26,12 @@
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/spectrum-value.h>
 
+#include <ns3/vector.h>
+
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -98,6 +102,15 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * If the MaxRange attribute is set, a transmission is only delivered to
+ * the receivers located within this distance of the transmitter, which
+ * are found through a grid of cells of MaxRange side over the positions
+ * of the receivers, before any loss is computed. The receivers with a
+ * null velocity are placed in the grid, and moved when their
+ * MobilityModel fires its CourseChange trace; the distance of the moving
+ * receivers and the receivers without MobilityModel are checked at each
+ * transmission.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -136,6 +149,95 @@ class MultiModelSpectrumChannel : public SpectrumChannel
     TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel(
         Ptr<const SpectrumModel> txSpectrumModel);
 
+    /**
+     * Convert the PSD of a transmission to the spectrum model of a receiver.
+     *
+     * \param txParams The signal parameters of the transmission.
+     * \param txInfoIterator The entry of the TX SpectrumModel in m_txSpectrumModelInfoMap.
+     * \param rxSpectrumModelUid The UID of the RX SpectrumModel.
+     *
+     * \return the converted PSD, or nullptr if the spectrum models are orthogonal
+     */
+    Ptr<SpectrumValue> ConvertTxPowerSpectrum(
+        Ptr<SpectrumSignalParameters> txParams,
+        TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+        SpectrumModelUid_t rxSpectrumModelUid) const;
+
+    /**
+     * Compute the loss of a transmission to a receiver and schedule its reception.
+     *
+     * \param txParams The signal parameters of the transmission.
+     * \param txMobility The mobility of the transmitter, if any.
+     * \param convertedTxPowerSpectrum The PSD converted to the spectrum model of the receiver.
+     * \param receiver The receiver.
+     */
+    void StartTxToReceiver(Ptr<SpectrumSignalParameters> txParams,
+                           Ptr<MobilityModel> txMobility,
+                           Ptr<const SpectrumValue> convertedTxPowerSpectrum,
+                           Ptr<SpectrumPhy> receiver);
+
+    /// Cell of the grid of receivers
+    typedef std::pair<int64_t, int64_t> RxCell;
+
+    /// Receiver in the grid of receivers
+    struct RxIndexEntry
+    {
+        Ptr<SpectrumPhy> phy;                  //!< Receiver
+        Ptr<MobilityModel> mobility;           //!< Mobility of the receiver, if any
+        SpectrumModelUid_t rxSpectrumModelUid; //!< RX SpectrumModel of the receiver
+        bool isMobile;                         //!< Whether the receiver is outside of the grid
+        Vector position;                       //!< Position of a receiver in the grid
+        RxCell cell;                           //!< Cell of a receiver in the grid
+    };
+
+    /**
+     * Get the cell of the grid of receivers containing a position.
+     *
+     * \param position The position.
+     *
+     * \return the cell
+     */
+    RxCell GetRxCell(const Vector& position) const;
+
+    /**
+     * Rebuild the grid of receivers if receivers were added or removed, or
+     * if MaxRange was changed.
+     */
+    void UpdateRxIndex();
+
+    /**
+     * Place a receiver in the grid, or in the list of moving receivers,
+     * according to its current position and velocity.
+     *
+     * \param index The index of the receiver in m_rxEntries.
+     */
+    void PlaceRxEntry(std::size_t index);
+
+    /**
+     * Remove a receiver from the grid, or from the list of moving receivers.
+     *
+     * \param index The index of the receiver in m_rxEntries.
+     */
+    void UnplaceRxEntry(std::size_t index);
+
+    /**
+     * Move the receivers of a MobilityModel in the grid.
+     *
+     * \param mobility The MobilityModel which changed its course.
+     */
+    void RxCourseChange(Ptr<const MobilityModel> mobility);
+
+    /**
+     * Deliver a transmission to the receivers within MaxRange of the transmitter.
+     *
+     * \param txParams The signal parameters of the transmission.
+     * \param txMobility The mobility of the transmitter.
+     * \param txInfoIterator The entry of the TX SpectrumModel in m_txSpectrumModelInfoMap.
+     */
+    void StartTxInRange(Ptr<SpectrumSignalParameters> txParams,
+                        Ptr<MobilityModel> txMobility,
+                        TxSpectrumModelInfoMap_t::const_iterator txInfoIterator);
+
     /**
      * Used internally to reschedule transmission after the propagation delay.
      *
@@ -162,6 +264,22 @@ class MultiModelSpectrumChannel : public SpectrumChannel
      * Number of devices connected to the channel.
      */
     std::size_t m_numDevices;
+
+    double m_maxRange; //!< Distance beyond which the receivers are skipped (0 for none)
+
+    /**
+     * Receivers of the grid, in the order of m_rxSpectrumModelInfoMap, which
+     * is the order in which the receptions are scheduled.
+     */
+    std::vector<RxIndexEntry> m_rxEntries;
+    bool m_rxIndexValid; //!< Whether m_rxEntries reflects m_rxSpectrumModelInfoMap
+    double m_rxCellSize; //!< Side of the cells of the grid, in meters
+    std::map<RxCell, std::vector<std::size_t>> m_rxCells; //!< Receivers with a null velocity
+    std::vector<std::size_t> m_rxMobile; //!< Moving receivers and receivers without mobility
+    /// Receivers of each MobilityModel
+    std::map<const MobilityModel*, std::vector<std::size_t>> m_rxEntriesByMobility;
+    /// MobilityModels to which the CourseChange trace is connected
+    std::set<Ptr<MobilityModel>> m_trackedMobilities;
 };
 
 } // namespace ns3
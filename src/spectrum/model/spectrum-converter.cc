@@ -83,6 +83,9 @@ SpectrumConverter::Convert(Ptr<const SpectrumValue> fvvf) const
     Ptr<SpectrumValue> tvvf = Create<SpectrumValue>(m_toSpectrumModel);
 
     Values::iterator tvit = tvvf->ValuesBegin();
+    const double* fromValues = &(*fvvf->ConstValuesBegin());
+    const size_t* colInd = m_conversionColInd.data();
+    const double* coefficients = m_conversionMatrix.data();
     size_t i = 0; // Index of conversion coefficient
 
     for (std::vector<size_t>::const_iterator convIt = m_conversionRowPtr.begin();
@@ -92,7 +95,7 @@ SpectrumConverter::Convert(Ptr<const SpectrumValue> fvvf) const
         double sum = 0;
         while (i < *convIt)
         {
-            sum += (*fvvf)[m_conversionColInd.at(i)] * m_conversionMatrix.at(i);
+            sum += fromValues[colInd[i]] * coefficients[i];
             i++;
         }
         *tvit = sum;
@@ -126,7 +126,12 @@ SpectrumInterference::ConditionallyEvaluateChunk()
     NS_LOG_LOGIC("if condition: " << condition);
     if (condition)
     {
-        SpectrumValue sinr = (*m_rxSignal) / ((*m_allSignals) - (*m_rxSignal) + (*m_noise));
+        // in-place operations, to avoid the temporaries of the binary operators
+        SpectrumValue interf = *m_allSignals;
+        interf -= *m_rxSignal;
+        interf += *m_noise;
+        SpectrumValue sinr = *m_rxSignal;
+        sinr /= interf;
         Time duration = Now() - m_lastChangeTime;
         NS_LOG_LOGIC("calling m_errorModel->EvaluateChunk (sinr, duration)");
         m_errorModel->EvaluateChunk(sinr, duration);
@@ -22,6 +22,8 @@
 #include <ns3/math.h>
 #include <ns3/spectrum-value.h>
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -100,46 +102,41 @@ SpectrumValue::ConstBandsEnd() const
 void
 SpectrumValue::Add(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 += *it2;
-        ++it1;
-        ++it2;
+        values[i] += xValues[i];
     }
 }
 
 void
 SpectrumValue::Add(double s)
 {
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 += s;
-        ++it1;
+        values[i] += s;
     }
 }
 
 void
 SpectrumValue::Subtract(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 -= *it2;
-        ++it1;
-        ++it2;
+        values[i] -= xValues[i];
     }
 }
 
@@ -152,46 +149,41 @@ SpectrumValue::Subtract(double s)
 void
 SpectrumValue::Multiply(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 *= *it2;
-        ++it1;
-        ++it2;
+        values[i] *= xValues[i];
     }
 }
 
 void
 SpectrumValue::Multiply(double s)
 {
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 *= s;
-        ++it1;
+        values[i] *= s;
     }
 }
 
 void
 SpectrumValue::Divide(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 /= *it2;
-        ++it1;
-        ++it2;
+        values[i] /= xValues[i];
     }
 }
 
@@ -199,24 +191,22 @@ void
 SpectrumValue::Divide(double s)
 {
     NS_LOG_FUNCTION(this << s);
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 /= s;
-        ++it1;
+        values[i] /= s;
     }
 }
 
 void
 SpectrumValue::ChangeSign()
 {
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 = -(*it1);
-        ++it1;
+        values[i] = -values[i];
     }
 }
 
@@ -321,11 +311,11 @@ double
 Norm(const SpectrumValue& x)
 {
     double s = 0;
-    Values::const_iterator it1 = x.ConstValuesBegin();
-    while (it1 != x.ConstValuesEnd())
+    const double* values = x.m_values.data();
+    std::size_t n = x.m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        s += (*it1) * (*it1);
-        ++it1;
+        s += values[i] * values[i];
     }
     return std::sqrt(s);
 }
@@ -334,11 +324,11 @@ double
 Sum(const SpectrumValue& x)
 {
     double s = 0;
-    Values::const_iterator it1 = x.ConstValuesBegin();
-    while (it1 != x.ConstValuesEnd())
+    const double* values = x.m_values.data();
+    std::size_t n = x.m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        s += (*it1);
-        ++it1;
+        s += values[i];
     }
     return s;
 }
@@ -359,17 +349,15 @@ Prod(const SpectrumValue& x)
 double
 Integral(const SpectrumValue& arg)
 {
+    NS_ASSERT(arg.m_values.size() == arg.m_spectrumModel->GetNumBands());
     double i = 0;
-    Values::const_iterator vit = arg.ConstValuesBegin();
+    const double* values = arg.m_values.data();
     Bands::const_iterator bit = arg.ConstBandsBegin();
-    while (vit != arg.ConstValuesEnd())
+    std::size_t n = arg.m_values.size();
+    for (std::size_t j = 0; j < n; ++j, ++bit)
     {
-        NS_ASSERT(bit != arg.ConstBandsEnd());
-        i += (*vit) * (bit->fh - bit->fl);
-        ++vit;
-        ++bit;
+        i += values[j] * (bit->fh - bit->fl);
     }
-    NS_ASSERT(bit == arg.ConstBandsEnd());
     return i;
 }
 
@@ -612,12 +600,39 @@ SpectrumValue::operator/=(double rhs)
 SpectrumValue&
 SpectrumValue::operator=(double rhs)
 {
-    Values::iterator it1 = m_values.begin();
+    std::fill(m_values.begin(), m_values.end(), rhs);
+    return *this;
+}
 
-    while (it1 != m_values.end())
+SpectrumValue&
+SpectrumValue::AddProduct(const SpectrumValue& x, const SpectrumValue& y)
+{
+    NS_ASSERT(m_spectrumModel == x.m_spectrumModel && m_spectrumModel == y.m_spectrumModel);
+    NS_ASSERT(m_values.size() == x.m_values.size() && m_values.size() == y.m_values.size());
+
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    const double* yValues = y.m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 = rhs;
-        ++it1;
+        values[i] += xValues[i] * yValues[i];
+    }
+    return *this;
+}
+
+SpectrumValue&
+SpectrumValue::AddScaled(const SpectrumValue& x, double s)
+{
+    NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
+    NS_ASSERT(m_values.size() == x.m_values.size());
+
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        values[i] += xValues[i] * s;
     }
     return *this;
 }
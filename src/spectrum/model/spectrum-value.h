@@ -409,6 +409,28 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     SpectrumValue& operator=(double rhs);
 
+    /**
+     * Add the element-by-element product of two SpectrumValues to *this,
+     * without creating the product as a temporary, i.e., *this += x * y
+     *
+     * @param x the first factor
+     * @param y the second factor
+     *
+     * @return a reference to *this
+     */
+    SpectrumValue& AddProduct(const SpectrumValue& x, const SpectrumValue& y);
+
+    /**
+     * Add a SpectrumValue multiplied by a flat value to *this, without
+     * creating the product as a temporary, i.e., *this += x * s
+     *
+     * @param x the SpectrumValue
+     * @param s the flat value
+     *
+     * @return a reference to *this
+     */
+    SpectrumValue& AddScaled(const SpectrumValue& x, double s);
+
     /**
      *
      * @param x the operand
@@ -29,10 +29,13 @@
 #include "ns3/phased-array-model.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
 #include <ns3/simulator.h>
 
 #include <algorithm>
+#include <atomic>
 #include <random>
+#include <thread>
 
 namespace ns3
 {
@@ -244,6 +247,40 @@ static const double sqrtC_office_NLOS[6][6] = {
     {0, -0.069282, 0.295397, 0.430696, 0.468462, 0.709214},
 };
 
+/**
+ * The terms of the channel coefficients of a link which depend on the mobility
+ * and antenna models.  The indexes of the rays of cluster n are n *
+ * raysPerCluster to (n + 1) * raysPerCluster - 1.
+ */
+struct ThreeGppChannelModel::ChannelCoefficients
+{
+    Ptr<ChannelMatrix> channelMatrix; //!< the channel matrix, whose coefficients are computed
+    uint8_t reducedClusterNumber;     //!< number of clusters, without the sub-clusters
+    uint8_t raysPerCluster;           //!< number of rays per cluster
+    uint8_t cluster1st;               //!< index of the first strongest cluster
+    uint8_t cluster2nd;               //!< index of the second strongest cluster
+    DoubleVector clusterPower;        //!< cluster powers
+    std::vector<Vector> uLoc;         //!< location of the elements of the u antenna
+    std::vector<Vector> sLoc;         //!< location of the elements of the s antenna
+
+    std::vector<std::complex<double>> raysPreComp; //!< ray terms independent from u and s
+
+    DoubleVector sinCosA; //!< sin of the ZoA angles times cos of the AoA angles
+    DoubleVector sinSinA; //!< sin of the ZoA angles times sin of the AoA angles
+    DoubleVector cosZoA;  //!< cos of the ZoA angles
+    DoubleVector sinCosD; //!< sin of the ZoD angles times cos of the AoD angles
+    DoubleVector sinSinD; //!< sin of the ZoD angles times sin of the AoD angles
+    DoubleVector cosZoD;  //!< cos of the ZoD angles
+
+    std::vector<std::complex<double>> losRx; //!< LOS ray terms of the u elements
+    std::vector<std::complex<double>> losTx; //!< LOS ray phases of the s elements
+
+    bool isLos = false;        //!< whether the LOS ray is added
+    double losNlosScale = 0;   //!< scale of the NLOS coefficients in LOS condition
+    double losRayScale = 0;    //!< scale of the LOS ray
+    double losAttenuation = 1; //!< blockage attenuation of the LOS ray
+};
+
 ThreeGppChannelModel::ThreeGppChannelModel()
 {
     NS_LOG_FUNCTION(this);
@@ -335,6 +372,13 @@ ThreeGppChannelModel::GetTypeId()
                           DoubleValue(0.0),
                           MakeDoubleAccessor(&ThreeGppChannelModel::m_vScatt),
                           MakeDoubleChecker<double>(0.0))
+            .AddAttribute("Threads",
+                          "The number of threads which compute the channel coefficients "
+                          "(0 uses one thread per core). The channel matrices do not depend "
+                          "on the number of threads.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&ThreeGppChannelModel::m_threads),
+                          MakeUintegerChecker<uint32_t>())
 
         ;
     return tid;
@@ -1093,31 +1137,25 @@ ThreeGppChannelModel::ChannelMatrixNeedsUpdate(Ptr<const ThreeGppChannelParams>
     }
 }
 
-Ptr<const MatrixBasedChannelModel::ChannelMatrix>
-ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
-                                 Ptr<const MobilityModel> bMob,
-                                 Ptr<const PhasedArrayModel> aAntenna,
-                                 Ptr<const PhasedArrayModel> bAntenna)
+Ptr<ThreeGppChannelModel::ThreeGppChannelParams>
+ThreeGppChannelModel::UpdateChannelParams(Ptr<const MobilityModel> aMob,
+                                          Ptr<const MobilityModel> bMob,
+                                          Ptr<const ParamsTable>& table3gpp)
 {
     NS_LOG_FUNCTION(this);
 
     // Compute the channel params key. The key is reciprocal, i.e., key (a, b) = key (b, a)
     uint64_t channelParamsKey =
         GetKey(aMob->GetObject<Node>()->GetId(), bMob->GetObject<Node>()->GetId());
-    // Compute the channel matrix key. The key is reciprocal, i.e., key (a, b) = key (b, a)
-    uint64_t channelMatrixKey = GetKey(aAntenna->GetId(), bAntenna->GetId());
 
     // retrieve the channel condition
     Ptr<const ChannelCondition> condition =
         m_channelConditionModel->GetChannelCondition(aMob, bMob);
 
-    // Check if the channel is present in the map and return it, otherwise
-    // generate a new channel
+    // Check if the channel params are present in the map, otherwise
+    // generate new ones
     bool updateParams = false;
-    bool updateMatrix = false;
     bool notFoundParams = false;
-    bool notFoundMatrix = false;
-    Ptr<ChannelMatrix> channelMatrix;
     Ptr<ThreeGppChannelParams> channelParams;
 
     if (m_channelParamsMap.find(channelParamsKey) != m_channelParamsMap.end())
@@ -1142,7 +1180,7 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     double hBs = std::max(aMob->GetPosition().z, bMob->GetPosition().z);
 
     // get the 3GPP parameters
-    Ptr<const ParamsTable> table3gpp = GetThreeGppTable(condition, hBs, hUt, distance2D);
+    table3gpp = GetThreeGppTable(condition, hBs, hUt, distance2D);
 
     if (notFoundParams || updateParams)
     {
@@ -1159,6 +1197,29 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
         m_channelParamsMap[channelParamsKey] = channelParams;
     }
 
+    return channelParams;
+}
+
+Ptr<const MatrixBasedChannelModel::ChannelMatrix>
+ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
+                                 Ptr<const MobilityModel> bMob,
+                                 Ptr<const PhasedArrayModel> aAntenna,
+                                 Ptr<const PhasedArrayModel> bAntenna)
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<const ParamsTable> table3gpp;
+    Ptr<ThreeGppChannelParams> channelParams = UpdateChannelParams(aMob, bMob, table3gpp);
+
+    // Compute the channel matrix key. The key is reciprocal, i.e., key (a, b) = key (b, a)
+    uint64_t channelMatrixKey = GetKey(aAntenna->GetId(), bAntenna->GetId());
+
+    // Check if the channel is present in the map and return it, otherwise
+    // generate a new channel
+    bool updateMatrix = false;
+    bool notFoundMatrix = false;
+    Ptr<ChannelMatrix> channelMatrix;
+
     if (m_channelMatrixMap.find(channelMatrixKey) != m_channelMatrixMap.end())
     {
         // channel matrix present in the map
@@ -1190,6 +1251,55 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     return channelMatrix;
 }
 
+std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix>>
+ThreeGppChannelModel::GetChannels(const std::vector<ChannelLink>& links)
+{
+    NS_LOG_FUNCTION(this << links.size());
+
+    // Generate the channel parameters in the order of the links, such that
+    // the random numbers are drawn as by successive calls of GetChannel, and
+    // prepare the new channel matrices.  A new channel matrix is stored in the
+    // map right away, such that a later link between the same antennas reuses it.
+    std::vector<Ptr<const ChannelMatrix>> channels;
+    std::vector<std::unique_ptr<ChannelCoefficients>> coefficients;
+    for (const auto& link : links)
+    {
+        Ptr<const ParamsTable> table3gpp;
+        Ptr<ThreeGppChannelParams> channelParams =
+            UpdateChannelParams(link.aMob, link.bMob, table3gpp);
+        uint64_t channelMatrixKey = GetKey(link.aAntenna->GetId(), link.bAntenna->GetId());
+
+        auto matrixIt = m_channelMatrixMap.find(channelMatrixKey);
+        if (matrixIt != m_channelMatrixMap.end() &&
+            !ChannelMatrixNeedsUpdate(channelParams, matrixIt->second))
+        {
+            NS_LOG_DEBUG("channel matrix present in the map");
+            channels.emplace_back(matrixIt->second);
+            continue;
+        }
+        coefficients.push_back(PrepareChannelCoefficients(channelParams,
+                                                          table3gpp,
+                                                          link.aMob,
+                                                          link.bMob,
+                                                          link.aAntenna,
+                                                          link.bAntenna));
+        Ptr<ChannelMatrix> channelMatrix = coefficients.back()->channelMatrix;
+        channelMatrix->m_antennaPair = std::make_pair(link.aAntenna->GetId(),
+                                                      link.bAntenna->GetId());
+        m_channelMatrixMap[channelMatrixKey] = channelMatrix;
+        channels.emplace_back(channelMatrix);
+    }
+
+    // Compute the coefficients of the new channel matrices
+    std::vector<ChannelCoefficients*> toCompute;
+    for (const auto& c : coefficients)
+    {
+        toCompute.push_back(c.get());
+    }
+    ComputeChannelCoefficients(toCompute);
+    return channels;
+}
+
 Ptr<const MatrixBasedChannelModel::ChannelParams>
 ThreeGppChannelModel::GetParams(Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob) const
 {
@@ -1838,10 +1948,46 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
 {
     NS_LOG_FUNCTION(this);
 
+    std::unique_ptr<ChannelCoefficients> coefficients =
+        PrepareChannelCoefficients(channelParams, table3gpp, sMob, uMob, sAntenna, uAntenna);
+    ComputeChannelCoefficients({coefficients.get()});
+    Ptr<ChannelMatrix> channelMatrix = coefficients->channelMatrix;
+    const Complex3DVector& hUsn = channelMatrix->m_channel;
+
+    NS_LOG_DEBUG("Husn (sAntenna, uAntenna):" << sAntenna->GetId() << ", " << uAntenna->GetId());
+    for (size_t cIndex = 0; cIndex < hUsn.GetNumPages(); cIndex++)
+    {
+        for (size_t rowIdx = 0; rowIdx < hUsn.GetNumRows(); rowIdx++)
+        {
+            for (size_t colIdx = 0; colIdx < hUsn.GetNumCols(); colIdx++)
+            {
+                NS_LOG_DEBUG(" " << hUsn(rowIdx, colIdx, cIndex) << ",");
+            }
+        }
+    }
+
+    NS_LOG_INFO("size of coefficient matrix (rows, columns, clusters) = ("
+                << hUsn.GetNumRows() << ", " << hUsn.GetNumCols() << ", " << hUsn.GetNumPages()
+                << ")");
+    return channelMatrix;
+}
+
+std::unique_ptr<ThreeGppChannelModel::ChannelCoefficients>
+ThreeGppChannelModel::PrepareChannelCoefficients(Ptr<const ThreeGppChannelParams> channelParams,
+                                                 Ptr<const ParamsTable> table3gpp,
+                                                 const Ptr<const MobilityModel> sMob,
+                                                 const Ptr<const MobilityModel> uMob,
+                                                 Ptr<const PhasedArrayModel> sAntenna,
+                                                 Ptr<const PhasedArrayModel> uAntenna) const
+{
+    NS_LOG_FUNCTION(this);
+
     NS_ASSERT_MSG(m_frequency > 0.0, "Set the operating frequency first!");
 
+    auto coefficients = std::make_unique<ChannelCoefficients>();
     // create a channel matrix instance
     Ptr<ChannelMatrix> channelMatrix = Create<ChannelMatrix>();
+    coefficients->channelMatrix = channelMatrix;
     channelMatrix->m_generatedTime = Simulator::Now();
     // save in which order is generated this matrix
     channelMatrix->m_nodeIds =
@@ -1849,29 +1995,18 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     // check if channelParams structure is generated in direction s-to-u or u-to-s
     bool isSameDirection = (channelParams->m_nodeIds == channelMatrix->m_nodeIds);
 
-    MatrixBasedChannelModel::Double2DVector rayAodRadian;
-    MatrixBasedChannelModel::Double2DVector rayAoaRadian;
-    MatrixBasedChannelModel::Double2DVector rayZodRadian;
-    MatrixBasedChannelModel::Double2DVector rayZoaRadian;
-
     // if channel params is generated in the same direction in which we
     // generate the channel matrix, angles and zenith od departure and arrival are ok,
     // just set them to corresponding variable that will be used for the generation
     // of channel matrix, otherwise we need to flip angles and zeniths of departure and arrival
-    if (isSameDirection)
-    {
-        rayAodRadian = channelParams->m_rayAodRadian;
-        rayAoaRadian = channelParams->m_rayAoaRadian;
-        rayZodRadian = channelParams->m_rayZodRadian;
-        rayZoaRadian = channelParams->m_rayZoaRadian;
-    }
-    else
-    {
-        rayAodRadian = channelParams->m_rayAoaRadian;
-        rayAoaRadian = channelParams->m_rayAodRadian;
-        rayZodRadian = channelParams->m_rayZoaRadian;
-        rayZoaRadian = channelParams->m_rayZodRadian;
-    }
+    const Double2DVector& rayAodRadian =
+        isSameDirection ? channelParams->m_rayAodRadian : channelParams->m_rayAoaRadian;
+    const Double2DVector& rayAoaRadian =
+        isSameDirection ? channelParams->m_rayAoaRadian : channelParams->m_rayAodRadian;
+    const Double2DVector& rayZodRadian =
+        isSameDirection ? channelParams->m_rayZodRadian : channelParams->m_rayZoaRadian;
+    const Double2DVector& rayZoaRadian =
+        isSameDirection ? channelParams->m_rayZoaRadian : channelParams->m_rayZodRadian;
 
     // Step 11: Generate channel coefficients for each cluster n and each receiver
     //  and transmitter element pair u,s.
@@ -1886,7 +2021,8 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     uint16_t numOverallCluster = (channelParams->m_cluster1st != channelParams->m_cluster2nd)
                                      ? channelParams->m_reducedClusterNumber + 4
                                      : channelParams->m_reducedClusterNumber + 2;
-    Complex3DVector hUsn(uSize, sSize, numOverallCluster); // channel coefficient hUsn (u, s, n);
+    // channel coefficient hUsn (u, s, n)
+    channelMatrix->m_channel = Complex3DVector(uSize, sSize, numOverallCluster);
     NS_ASSERT(channelParams->m_reducedClusterNumber <= channelParams->m_clusterPhase.size());
     NS_ASSERT(channelParams->m_reducedClusterNumber <= channelParams->m_clusterPower.size());
     NS_ASSERT(channelParams->m_reducedClusterNumber <=
@@ -1903,51 +2039,39 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     NS_ASSERT(table3gpp->m_raysPerCluster <= rayAoaRadian[0].size());
     NS_ASSERT(table3gpp->m_raysPerCluster <= rayAodRadian[0].size());
 
-    double x = sMob->GetPosition().x - uMob->GetPosition().x;
-    double y = sMob->GetPosition().y - uMob->GetPosition().y;
-    double distance2D = sqrt(x * x + y * y);
-    // NOTE we assume hUT = min (height(a), height(b)) and
-    // hBS = max (height (a), height (b))
-    double hUt = std::min(sMob->GetPosition().z, uMob->GetPosition().z);
-    double hBs = std::max(sMob->GetPosition().z, uMob->GetPosition().z);
-    // compute the 3D distance using eq. 7.4-1
-    double distance3D = std::sqrt(distance2D * distance2D + (hBs - hUt) * (hBs - hUt));
-
-    Angles sAngle(uMob->GetPosition(), sMob->GetPosition());
-    Angles uAngle(sMob->GetPosition(), uMob->GetPosition());
-
-    Complex2DVector raysPreComp(channelParams->m_reducedClusterNumber,
-                                table3gpp->m_raysPerCluster); // stores part of the ray expression,
-    // cached as independent from the u- and s-indexes
-    Double2DVector sinCosA; // cached multiplications of sin and cos of the ZoA and AoA angles
-    Double2DVector sinSinA; // cached multiplications of sines of the ZoA and AoA angles
-    Double2DVector cosZoA;  // cached cos of the ZoA angle
-    Double2DVector sinCosD; // cached multiplications of sin and cos of the ZoD and AoD angles
-    Double2DVector sinSinD; // cached multiplications of the cosines of the ZoA and AoA angles
-    Double2DVector cosZoD;  // cached cos of the ZoD angle
-
-    // resize to appropriate dimensions
-    sinCosA.resize(channelParams->m_reducedClusterNumber);
-    sinSinA.resize(channelParams->m_reducedClusterNumber);
-    cosZoA.resize(channelParams->m_reducedClusterNumber);
-    sinCosD.resize(channelParams->m_reducedClusterNumber);
-    sinSinD.resize(channelParams->m_reducedClusterNumber);
-    cosZoD.resize(channelParams->m_reducedClusterNumber);
-    for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
+    coefficients->reducedClusterNumber = channelParams->m_reducedClusterNumber;
+    coefficients->raysPerCluster = table3gpp->m_raysPerCluster;
+    coefficients->cluster1st = channelParams->m_cluster1st;
+    coefficients->cluster2nd = channelParams->m_cluster2nd;
+    coefficients->clusterPower = channelParams->m_clusterPower;
+
+    // the element locations, which do not depend on the cluster
+    coefficients->uLoc.reserve(uSize);
+    for (size_t uIndex = 0; uIndex < uSize; uIndex++)
     {
-        sinCosA[nIndex].resize(table3gpp->m_raysPerCluster);
-        sinSinA[nIndex].resize(table3gpp->m_raysPerCluster);
-        cosZoA[nIndex].resize(table3gpp->m_raysPerCluster);
-        sinCosD[nIndex].resize(table3gpp->m_raysPerCluster);
-        sinSinD[nIndex].resize(table3gpp->m_raysPerCluster);
-        cosZoD[nIndex].resize(table3gpp->m_raysPerCluster);
+        coefficients->uLoc.push_back(uAntenna->GetElementLocation(uIndex));
     }
+    coefficients->sLoc.reserve(sSize);
+    for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+    {
+        coefficients->sLoc.push_back(sAntenna->GetElementLocation(sIndex));
+    }
+
     // pre-compute the terms which are independent from uIndex and sIndex
+    size_t numRays = channelParams->m_reducedClusterNumber * table3gpp->m_raysPerCluster;
+    coefficients->raysPreComp.resize(numRays);
+    coefficients->sinCosA.resize(numRays);
+    coefficients->sinSinA.resize(numRays);
+    coefficients->cosZoA.resize(numRays);
+    coefficients->sinCosD.resize(numRays);
+    coefficients->sinSinD.resize(numRays);
+    coefficients->cosZoD.resize(numRays);
     for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
     {
         for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
         {
-            DoubleVector initialPhase = channelParams->m_clusterPhase[nIndex][mIndex];
+            size_t ray = nIndex * table3gpp->m_raysPerCluster + mIndex;
+            const DoubleVector& initialPhase = channelParams->m_clusterPhase[nIndex][mIndex];
             NS_ASSERT(4 <= initialPhase.size());
             double k = channelParams->m_crossPolarizationPowerRatios[nIndex][mIndex];
 
@@ -1959,7 +2083,7 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
             auto [txFieldPatternPhi, txFieldPatternTheta] = sAntenna->GetElementFieldPattern(
                 Angles(channelParams->m_rayAodRadian[nIndex][mIndex],
                        channelParams->m_rayZodRadian[nIndex][mIndex]));
-            raysPreComp(nIndex, mIndex) =
+            coefficients->raysPreComp[ray] =
                 std::complex<double>(cos(initialPhase[0]), sin(initialPhase[0])) *
                     rxFieldPatternTheta * txFieldPatternTheta +
                 std::complex<double>(cos(initialPhase[1]), sin(initialPhase[1])) *
@@ -1974,132 +2098,40 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
             double sinRayZoa = sin(rayZoaRadian[nIndex][mIndex]);
             double sinRayAoa = cos(rayAoaRadian[nIndex][mIndex]);
             double cosRayAoa = cos(rayAoaRadian[nIndex][mIndex]);
-            sinCosA[nIndex][mIndex] = sinRayZoa * cosRayAoa;
-            sinSinA[nIndex][mIndex] = sinRayZoa * sinRayAoa;
-            cosZoA[nIndex][mIndex] = cos(rayZoaRadian[nIndex][mIndex]);
+            coefficients->sinCosA[ray] = sinRayZoa * cosRayAoa;
+            coefficients->sinSinA[ray] = sinRayZoa * sinRayAoa;
+            coefficients->cosZoA[ray] = cos(rayZoaRadian[nIndex][mIndex]);
 
             // cache the component of the "txPhaseDiff" terms which depend on the random angle of
             // departure only
             double sinRayZod = sin(rayZodRadian[nIndex][mIndex]);
             double sinRayAod = cos(rayAodRadian[nIndex][mIndex]);
             double cosRayAod = cos(rayAodRadian[nIndex][mIndex]);
-            sinCosD[nIndex][mIndex] = sinRayZod * cosRayAod;
-            sinSinD[nIndex][mIndex] = sinRayZod * sinRayAod;
-            cosZoD[nIndex][mIndex] = cos(rayZodRadian[nIndex][mIndex]);
+            coefficients->sinCosD[ray] = sinRayZod * cosRayAod;
+            coefficients->sinSinD[ray] = sinRayZod * sinRayAod;
+            coefficients->cosZoD[ray] = cos(rayZodRadian[nIndex][mIndex]);
         }
     }
 
-    // The following for loops computes the channel coefficients
-    // Keeps track of how many sub-clusters have been added up to now
-    uint8_t numSubClustersAdded = 0;
-    for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
+    if (channelParams->m_losCondition == ChannelCondition::LOS) //(7.5-29) && (7.5-30)
     {
-        for (size_t uIndex = 0; uIndex < uSize; uIndex++)
-        {
-            Vector uLoc = uAntenna->GetElementLocation(uIndex);
+        coefficients->isLos = true;
 
-            for (size_t sIndex = 0; sIndex < sSize; sIndex++)
-            {
-                Vector sLoc = sAntenna->GetElementLocation(sIndex);
-                // Compute the N-2 weakest cluster, assuming 0 slant angle and a
-                // polarization slant angle configured in the array (7.5-22)
-                if (nIndex != channelParams->m_cluster1st && nIndex != channelParams->m_cluster2nd)
-                {
-                    std::complex<double> rays(0, 0);
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
-                    {
-                        // lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                        double rxPhaseDiff =
-                            2 * M_PI *
-                            (sinCosA[nIndex][mIndex] * uLoc.x + sinSinA[nIndex][mIndex] * uLoc.y +
-                             cosZoA[nIndex][mIndex] * uLoc.z);
-
-                        double txPhaseDiff =
-                            2 * M_PI *
-                            (sinCosD[nIndex][mIndex] * sLoc.x + sinSinD[nIndex][mIndex] * sLoc.y +
-                             cosZoD[nIndex][mIndex] * sLoc.z);
-
-                        // NOTE Doppler is computed in the CalcBeamformingGain function and is
-                        // simplified to only account for the center angle of each cluster.
-                        rays += raysPreComp(nIndex, mIndex) *
-                                std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                                std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
-                    }
-                    rays *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    hUsn(uIndex, sIndex, nIndex) = rays;
-                }
-                else //(7.5-28)
-                {
-                    std::complex<double> raysSub1(0, 0);
-                    std::complex<double> raysSub2(0, 0);
-                    std::complex<double> raysSub3(0, 0);
+        Vector sPos = sMob->GetPosition();
+        Vector uPos = uMob->GetPosition();
+        double x = sPos.x - uPos.x;
+        double y = sPos.y - uPos.y;
+        double distance2D = sqrt(x * x + y * y);
+        // NOTE we assume hUT = min (height(a), height(b)) and
+        // hBS = max (height (a), height (b))
+        double hUt = std::min(sPos.z, uPos.z);
+        double hBs = std::max(sPos.z, uPos.z);
+        // compute the 3D distance using eq. 7.4-1
+        double distance3D = std::sqrt(distance2D * distance2D + (hBs - hUt) * (hBs - hUt));
 
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
-                    {
-                        // ZML:Just remind me that the angle offsets for the 3 subclusters were not
-                        // generated correctly.
-                        double rxPhaseDiff =
-                            2 * M_PI *
-                            (sinCosA[nIndex][mIndex] * uLoc.x + sinSinA[nIndex][mIndex] * uLoc.y +
-                             cosZoA[nIndex][mIndex] * uLoc.z);
-
-                        double txPhaseDiff =
-                            2 * M_PI *
-                            (sinCosD[nIndex][mIndex] * sLoc.x + sinSinD[nIndex][mIndex] * sLoc.y +
-                             cosZoD[nIndex][mIndex] * sLoc.z);
-
-                        std::complex<double> raySub =
-                            raysPreComp(nIndex, mIndex) *
-                            std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                            std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
-
-                        switch (mIndex)
-                        {
-                        case 9:
-                        case 10:
-                        case 11:
-                        case 12:
-                        case 17:
-                        case 18:
-                            raysSub2 += raySub;
-                            break;
-                        case 13:
-                        case 14:
-                        case 15:
-                        case 16:
-                            raysSub3 += raySub;
-                            break;
-                        default: // case 1,2,3,4,5,6,7,8,19,20
-                            raysSub1 += raySub;
-                            break;
-                        }
-                    }
-                    raysSub1 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    raysSub2 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    raysSub3 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    hUsn(uIndex, sIndex, nIndex) = raysSub1;
-                    hUsn(uIndex,
-                         sIndex,
-                         channelParams->m_reducedClusterNumber + numSubClustersAdded) = raysSub2;
-                    hUsn(uIndex,
-                         sIndex,
-                         channelParams->m_reducedClusterNumber + numSubClustersAdded + 1) =
-                        raysSub3;
-                }
-            }
-        }
-        if (nIndex == channelParams->m_cluster1st || nIndex == channelParams->m_cluster2nd)
-        {
-            numSubClustersAdded += 2;
-        }
-    }
+        Angles sAngle(uPos, sPos);
+        Angles uAngle(sPos, uPos);
 
-    if (channelParams->m_losCondition == ChannelCondition::LOS) //(7.5-29) && (7.5-30)
-    {
         double lambda = 3.0e8 / m_frequency; // the wavelength of the carrier frequency
         std::complex<double> phaseDiffDueToDistance(cos(-2 * M_PI * distance3D / lambda),
                                                     sin(-2 * M_PI * distance3D / lambda));
@@ -2113,66 +2145,238 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
         const double sinSAngleAz = sin(sAngle.GetAzimuth());
         const double cosSAngleAz = cos(sAngle.GetAzimuth());
 
-        for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+        auto [rxFieldPatternPhi, rxFieldPatternTheta] = uAntenna->GetElementFieldPattern(
+            Angles(uAngle.GetAzimuth(), uAngle.GetInclination()));
+        auto [txFieldPatternPhi, txFieldPatternTheta] = sAntenna->GetElementFieldPattern(
+            Angles(sAngle.GetAzimuth(), sAngle.GetInclination()));
+        std::complex<double> losRay =
+            (rxFieldPatternTheta * txFieldPatternTheta - rxFieldPatternPhi * txFieldPatternPhi) *
+            phaseDiffDueToDistance;
+
+        // the LOS ray of the elements u and s is losRx[u] * losTx[s]
+        coefficients->losRx.reserve(uSize);
+        for (const auto& uLoc : coefficients->uLoc)
         {
-            Vector uLoc = uAntenna->GetElementLocation(uIndex);
             double rxPhaseDiff = 2 * M_PI *
                                  (sinUAngleIncl * cosUAngleAz * uLoc.x +
                                   sinUAngleIncl * sinUAngleAz * uLoc.y + cosUAngleIncl * uLoc.z);
+            coefficients->losRx.push_back(losRay *
+                                          std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)));
+        }
+        coefficients->losTx.reserve(sSize);
+        for (const auto& sLoc : coefficients->sLoc)
+        {
+            double txPhaseDiff =
+                2 * M_PI *
+                (sinSAngleIncl * cosSAngleAz * sLoc.x + sinSAngleIncl * sinSAngleAz * sLoc.y +
+                 cosSAngleIncl * sLoc.z);
+            coefficients->losTx.emplace_back(cos(txPhaseDiff), sin(txPhaseDiff));
+        }
 
-            for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+        double kLinear = pow(10, channelParams->m_K_factor / 10.0);
+        coefficients->losNlosScale = sqrt(1.0 / (kLinear + 1));
+        coefficients->losRayScale = sqrt(kLinear / (1 + kLinear));
+        // the LOS path should be attenuated if blockage is enabled.
+        coefficients->losAttenuation = pow(10, channelParams->m_attenuation_dB[0] / 10.0);
+    }
+
+    return coefficients;
+}
+
+void
+ThreeGppChannelModel::ComputeChannelCoefficients(
+    const std::vector<ChannelCoefficients*>& links) const
+{
+    NS_LOG_FUNCTION(this << links.size());
+
+    // The following computes the coefficients of a cluster, for all the pairs
+    // of elements u and s: the rx terms are computed once per element u, the
+    // tx phases once per element s, and the innermost loop over the elements
+    // s accumulates the real and imaginary parts separately, such that it is
+    // vectorized.  The operations of the complex products are the same as
+    // those of std::complex.
+    auto computeCluster = [](ChannelCoefficients& c, uint8_t nIndex) {
+        Complex3DVector& hUsn = c.channelMatrix->m_channel;
+        const size_t uSize = c.uLoc.size();
+        const size_t sSize = c.sLoc.size();
+        const size_t numRays = c.raysPerCluster;
+        const size_t first = nIndex * numRays;
+
+        // the "rays" terms times the rx phases, rxTerm[u * numRays + m]
+        std::vector<std::complex<double>> rxTerm(uSize * numRays);
+        for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+        {
+            const Vector& uLoc = c.uLoc[uIndex];
+            for (size_t mIndex = 0; mIndex < numRays; mIndex++)
+            {
+                // lambda_0 is accounted in the antenna spacing uLoc and sLoc.
+                double rxPhaseDiff =
+                    2 * M_PI *
+                    (c.sinCosA[first + mIndex] * uLoc.x + c.sinSinA[first + mIndex] * uLoc.y +
+                     c.cosZoA[first + mIndex] * uLoc.z);
+                rxTerm[uIndex * numRays + mIndex] =
+                    c.raysPreComp[first + mIndex] *
+                    std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff));
+            }
+        }
+
+        // the tx phases, txRe[m * sSize + s] and txIm[m * sSize + s]
+        std::vector<double> txRe(numRays * sSize);
+        std::vector<double> txIm(numRays * sSize);
+        for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+        {
+            const Vector& sLoc = c.sLoc[sIndex];
+            for (size_t mIndex = 0; mIndex < numRays; mIndex++)
             {
-                Vector sLoc = sAntenna->GetElementLocation(sIndex);
-                std::complex<double> ray(0, 0);
                 double txPhaseDiff =
                     2 * M_PI *
-                    (sinSAngleIncl * cosSAngleAz * sLoc.x + sinSAngleIncl * sinSAngleAz * sLoc.y +
-                     cosSAngleIncl * sLoc.z);
-
-                auto [rxFieldPatternPhi, rxFieldPatternTheta] = uAntenna->GetElementFieldPattern(
-                    Angles(uAngle.GetAzimuth(), uAngle.GetInclination()));
-                auto [txFieldPatternPhi, txFieldPatternTheta] = sAntenna->GetElementFieldPattern(
-                    Angles(sAngle.GetAzimuth(), sAngle.GetInclination()));
-
-                ray = (rxFieldPatternTheta * txFieldPatternTheta -
-                       rxFieldPatternPhi * txFieldPatternPhi) *
-                      phaseDiffDueToDistance *
-                      std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                      std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
-
-                double kLinear = pow(10, channelParams->m_K_factor / 10.0);
-                // the LOS path should be attenuated if blockage is enabled.
-                hUsn(uIndex, sIndex, 0) =
-                    sqrt(1.0 / (kLinear + 1)) * hUsn(uIndex, sIndex, 0) +
-                    sqrt(kLinear / (1 + kLinear)) * ray /
-                        pow(10,
-                            channelParams->m_attenuation_dB[0] / 10.0); //(7.5-30) for tau = tau1
-                for (size_t nIndex = 1; nIndex < hUsn.GetNumPages(); nIndex++)
+                    (c.sinCosD[first + mIndex] * sLoc.x + c.sinSinD[first + mIndex] * sLoc.y +
+                     c.cosZoD[first + mIndex] * sLoc.z);
+                txRe[mIndex * sSize + sIndex] = cos(txPhaseDiff);
+                txIm[mIndex * sSize + sIndex] = sin(txPhaseDiff);
+            }
+        }
+
+        // Compute the N-2 weakest cluster, assuming 0 slant angle and a
+        // polarization slant angle configured in the array (7.5-22), and the
+        // strongest clusters as 3 sub-clusters (7.5-28)
+        bool isStrongest = (nIndex == c.cluster1st || nIndex == c.cluster2nd);
+        std::vector<uint8_t> subCluster(numRays, 0);
+        if (isStrongest)
+        {
+            for (size_t mIndex = 0; mIndex < numRays; mIndex++)
+            {
+                switch (mIndex)
                 {
-                    hUsn(uIndex, sIndex, nIndex) *=
-                        sqrt(1.0 / (kLinear + 1)); //(7.5-30) for tau = tau2...tauN
+                case 9:
+                case 10:
+                case 11:
+                case 12:
+                case 17:
+                case 18:
+                    subCluster[mIndex] = 1;
+                    break;
+                case 13:
+                case 14:
+                case 15:
+                case 16:
+                    subCluster[mIndex] = 2;
+                    break;
+                default: // case 1,2,3,4,5,6,7,8,19,20
+                    break;
                 }
             }
         }
+        // the sub-clusters of the strongest clusters are added after the clusters
+        size_t subClusterPage = c.reducedClusterNumber;
+        for (uint8_t index = 0; index < nIndex; index++)
+        {
+            if (index == c.cluster1st || index == c.cluster2nd)
+            {
+                subClusterPage += 2;
+            }
+        }
+
+        // NOTE Doppler is computed in the CalcBeamformingGain function and is
+        // simplified to only account for the center angle of each cluster.
+        const size_t numSubClusters = isStrongest ? 3 : 1;
+        const double scale = sqrt(c.clusterPower[nIndex] / c.raysPerCluster);
+        std::vector<double> raysRe(numSubClusters * sSize);
+        std::vector<double> raysIm(numSubClusters * sSize);
+        for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+        {
+            std::fill(raysRe.begin(), raysRe.end(), 0.0);
+            std::fill(raysIm.begin(), raysIm.end(), 0.0);
+            for (size_t mIndex = 0; mIndex < numRays; mIndex++)
+            {
+                const double aRe = rxTerm[uIndex * numRays + mIndex].real();
+                const double aIm = rxTerm[uIndex * numRays + mIndex].imag();
+                const double* bRe = txRe.data() + mIndex * sSize;
+                const double* bIm = txIm.data() + mIndex * sSize;
+                double* re = raysRe.data() + subCluster[mIndex] * sSize;
+                double* im = raysIm.data() + subCluster[mIndex] * sSize;
+                for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+                {
+                    re[sIndex] += aRe * bRe[sIndex] - aIm * bIm[sIndex];
+                    im[sIndex] += aRe * bIm[sIndex] + aIm * bRe[sIndex];
+                }
+            }
+            for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+            {
+                hUsn(uIndex, sIndex, nIndex) =
+                    std::complex<double>(raysRe[sIndex], raysIm[sIndex]) * scale;
+                if (isStrongest)
+                {
+                    hUsn(uIndex, sIndex, subClusterPage) =
+                        std::complex<double>(raysRe[sSize + sIndex], raysIm[sSize + sIndex]) *
+                        scale;
+                    hUsn(uIndex, sIndex, subClusterPage + 1) =
+                        std::complex<double>(raysRe[2 * sSize + sIndex],
+                                             raysIm[2 * sSize + sIndex]) *
+                        scale;
+                }
+            }
+        }
+    };
+
+    // The clusters of all the links are shared among the threads, which
+    // write distinct pages of the channel matrices
+    std::vector<std::pair<ChannelCoefficients*, uint8_t>> clusters;
+    for (auto link : links)
+    {
+        for (uint8_t nIndex = 0; nIndex < link->reducedClusterNumber; nIndex++)
+        {
+            clusters.emplace_back(link, nIndex);
+        }
+    }
+    std::size_t nThreads = m_threads;
+    if (nThreads == 0)
+    {
+        nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    nThreads = std::max<std::size_t>(std::min(nThreads, clusters.size()), 1);
+    std::atomic<std::size_t> next(0);
+    auto compute = [&clusters, &next, &computeCluster]() {
+        for (std::size_t i = next++; i < clusters.size(); i = next++)
+        {
+            computeCluster(*clusters[i].first, clusters[i].second);
+        }
+    };
+    std::vector<std::thread> running;
+    for (std::size_t i = 1; i < nThreads; i++)
+    {
+        running.emplace_back(compute);
+    }
+    compute();
+    for (auto& thread : running)
+    {
+        thread.join();
     }
 
-    NS_LOG_DEBUG("Husn (sAntenna, uAntenna):" << sAntenna->GetId() << ", " << uAntenna->GetId());
-    for (size_t cIndex = 0; cIndex < hUsn.GetNumPages(); cIndex++)
+    // add the LOS ray, once all the clusters are computed (7.5-29) && (7.5-30)
+    for (auto link : links)
     {
-        for (size_t rowIdx = 0; rowIdx < hUsn.GetNumRows(); rowIdx++)
+        if (!link->isLos)
         {
-            for (size_t colIdx = 0; colIdx < hUsn.GetNumCols(); colIdx++)
+            continue;
+        }
+        Complex3DVector& hUsn = link->channelMatrix->m_channel;
+        for (size_t uIndex = 0; uIndex < link->uLoc.size(); uIndex++)
+        {
+            for (size_t sIndex = 0; sIndex < link->sLoc.size(); sIndex++)
             {
-                NS_LOG_DEBUG(" " << hUsn(rowIdx, colIdx, cIndex) << ",");
+                std::complex<double> ray = link->losRx[uIndex] * link->losTx[sIndex];
+                hUsn(uIndex, sIndex, 0) =
+                    link->losNlosScale * hUsn(uIndex, sIndex, 0) +
+                    link->losRayScale * ray / link->losAttenuation; //(7.5-30) for tau = tau1
+                for (size_t nIndex = 1; nIndex < hUsn.GetNumPages(); nIndex++)
+                {
+                    hUsn(uIndex, sIndex, nIndex) *=
+                        link->losNlosScale; //(7.5-30) for tau = tau2...tauN
+                }
             }
         }
     }
-
-    NS_LOG_INFO("size of coefficient matrix (rows, columns, clusters) = ("
-                << hUsn.GetNumRows() << ", " << hUsn.GetNumCols() << ", " << hUsn.GetNumPages()
-                << ")");
-    channelMatrix->m_channel = hUsn;
-    return channelMatrix;
 }
 
 std::pair<double, double>
@@ -27,7 +27,9 @@
 #include <ns3/matrix-based-channel-model.h>
 
 #include <complex.h>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -127,6 +129,31 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      */
     Ptr<const ChannelParams> GetParams(Ptr<const MobilityModel> aMob,
                                        Ptr<const MobilityModel> bMob) const override;
+
+    /**
+     * The devices of a link, as passed to GetChannel
+     */
+    struct ChannelLink
+    {
+        Ptr<const MobilityModel> aMob;        //!< mobility model of the a device
+        Ptr<const MobilityModel> bMob;        //!< mobility model of the b device
+        Ptr<const PhasedArrayModel> aAntenna; //!< antenna of the a device
+        Ptr<const PhasedArrayModel> bAntenna; //!< antenna of the b device
+    };
+
+    /**
+     * Get the channel matrices of several links, as successive calls of
+     * GetChannel would.  The channel parameters of the links are generated
+     * first, in the order of the links, then the channel coefficients of the
+     * new channel matrices, which do not need any random number, are computed
+     * in parallel by the number of threads given by the attribute Threads.
+     * Hence, the channel matrices do not depend on the number of threads.
+     *
+     * \param links the links
+     * \return the channel matrix of each link
+     */
+    std::vector<Ptr<const ChannelMatrix>> GetChannels(const std::vector<ChannelLink>& links);
+
     /**
      * \brief Assign a fixed random variable stream number to the random variables
      * used by this model.
@@ -334,6 +361,18 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
     bool ChannelMatrixNeedsUpdate(Ptr<const ThreeGppChannelParams> channelParams,
                                   Ptr<const ChannelMatrix> channelMatrix);
 
+    /**
+     * Get the channel parameters of the pair of nodes of aMob and bMob, and
+     * generate new ones if they are not found or if they have to be updated
+     * \param aMob mobility model of the a device
+     * \param bMob mobility model of the b device
+     * \param [out] table3gpp the 3gpp parameters table of the link
+     * \return the channel parameters
+     */
+    Ptr<ThreeGppChannelParams> UpdateChannelParams(Ptr<const MobilityModel> aMob,
+                                                   Ptr<const MobilityModel> bMob,
+                                                   Ptr<const ParamsTable>& table3gpp);
+
     std::unordered_map<uint64_t, Ptr<ChannelMatrix>>
         m_channelMatrixMap; //!< map containing the channel realizations per pair of
                             //!< PhasedAntennaArray instances, the key of this map is reciprocal
@@ -370,6 +409,44 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
         2;                            //!< index of the THETA value in the m_nonSelfBlocking array
     static const uint8_t Y_INDEX = 3; //!< index of the Y value in the m_nonSelfBlocking array
     static const uint8_t R_INDEX = 4; //!< index of the R value in the m_nonSelfBlocking array
+
+    uint32_t m_threads; //!< the number of threads which compute the channel coefficients
+
+  private:
+    /**
+     * The terms of the channel coefficients of a link which depend on the
+     * mobility and antenna models, and the channel matrix being computed
+     */
+    struct ChannelCoefficients;
+
+    /**
+     * Compute the terms of the channel coefficients between two nodes s and u
+     * which depend on the mobility and antenna models, i.e., the part of
+     * GetNewChannel which has to run in the simulation thread
+     * \param channelParams the channel parameters previously generated for the pair of
+     * nodes s and u
+     * \param table3gpp the 3gpp parameters table
+     * \param sMob the mobility model of node s
+     * \param uMob the mobility model of node u
+     * \param sAntenna the antenna array of node s
+     * \param uAntenna the antenna array of node u
+     * \return the terms of the channel coefficients, with a channel matrix of the right size
+     */
+    std::unique_ptr<ChannelCoefficients> PrepareChannelCoefficients(
+        Ptr<const ThreeGppChannelParams> channelParams,
+        Ptr<const ParamsTable> table3gpp,
+        const Ptr<const MobilityModel> sMob,
+        const Ptr<const MobilityModel> uMob,
+        Ptr<const PhasedArrayModel> sAntenna,
+        Ptr<const PhasedArrayModel> uAntenna) const;
+
+    /**
+     * Compute the channel coefficients of several links (step 11) from their
+     * prepared terms.  The clusters of the links are shared among the threads,
+     * which only read the terms and write the coefficients of their clusters.
+     * \param links the terms of the channel coefficients of the links
+     */
+    void ComputeChannelCoefficients(const std::vector<ChannelCoefficients*>& links) const;
 };
 } // namespace ns3
 
@@ -227,6 +227,13 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain(
 
     NS_ASSERT(numCluster <= doppler.GetSize());
 
+    // the long term component times the doppler term, which does not depend on the sub-band
+    PhasedArrayModel::ComplexVector longTermDoppler(numCluster);
+    for (uint16_t cIndex = 0; cIndex < numCluster; cIndex++)
+    {
+        longTermDoppler[cIndex] = longTerm[cIndex] * doppler[cIndex];
+    }
+
     // apply the doppler term and the propagation delay to the long term component
     // to obtain the beamforming gain
     auto vit = tempPsd->ValuesBegin();      // psd iterator
@@ -240,7 +247,7 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain(
             for (uint16_t cIndex = 0; cIndex < numCluster; cIndex++)
             {
                 double delay = -2 * M_PI * fsb * (channelParams->m_delay[cIndex]);
-                subsbandGain = subsbandGain + longTerm[cIndex] * doppler[cIndex] *
+                subsbandGain = subsbandGain + longTermDoppler[cIndex] *
                                                   std::complex<double>(cos(delay), sin(delay));
             }
             *vit = (*vit) * (norm(subsbandGain));
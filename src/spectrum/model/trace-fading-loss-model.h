@@ -21,6 +21,8 @@
 #ifndef TRACE_FADING_LOSS_MODEL_H
 #define TRACE_FADING_LOSS_MODEL_H
 
+#include "fading-trace.h"
+
 #include "ns3/random-variable-stream.h"
 #include <ns3/nstime.h>
 #include <ns3/object.h>
@@ -37,6 +39,9 @@ class MobilityModel;
  * \ingroup spectrum
  *
  * \brief fading loss model based on precalculated fading traces
+ *
+ * The trace is loaded through FadingTrace::Load, so that the models using
+ * the same file share it, and binary traces are memory-mapped.
  */
 class TraceFadingLossModel : public SpectrumPropagationLossModel
 {
@@ -106,18 +111,9 @@ class TraceFadingLossModel : public SpectrumPropagationLossModel
     mutable std::map<ChannelRealizationId_t, Ptr<UniformRandomVariable>>
         m_startVariableMap; ///< start variable map
 
-    /**
-     * Vector with fading samples in time domain (for a fixed RB)
-     */
-    typedef std::vector<double> FadingTraceSample;
-    /**
-     * Vector collecting the time fading traces in the frequency domain (per RB)
-     */
-    typedef std::vector<FadingTraceSample> FadingTrace;
-
     std::string m_traceFile; ///< the trace file name
 
-    FadingTrace m_fadingTrace; ///< fading trace
+    Ptr<const FadingTrace> m_fadingTrace; ///< fading trace
 
     Time m_traceLength;               ///< the trace time
     uint32_t m_samplesNum;            ///< number of samples
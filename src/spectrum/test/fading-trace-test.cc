@@ -0,0 +1,168 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/fading-trace.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/string.h>
+#include <ns3/test.h>
+#include <ns3/trace-fading-loss-model.h>
+#include <ns3/uinteger.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief FadingTrace test: a binary trace converted from an ASCII trace has
+ * the same samples, the loaded traces are shared, and TraceFadingLossModel
+ * gives the same fading with both formats.
+ */
+class FadingTraceTestCase : public TestCase
+{
+  public:
+    FadingTraceTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Compute a received PSD with a TraceFadingLossModel.
+     * \param fileName The name of the trace file.
+     * \return The received PSD.
+     */
+    Ptr<SpectrumValue> CalcRxPsd(const std::string& fileName);
+
+    static const uint32_t RB_NUM = 4;       //!< Number of RBs of the trace
+    static const uint32_t SAMPLES_NUM = 50; //!< Number of samples per RB
+};
+
+FadingTraceTestCase::FadingTraceTestCase()
+    : TestCase("Binary and ASCII fading traces")
+{
+}
+
+Ptr<SpectrumValue>
+FadingTraceTestCase::CalcRxPsd(const std::string& fileName)
+{
+    Ptr<TraceFadingLossModel> model = CreateObject<TraceFadingLossModel>();
+    model->SetAttribute("TraceFilename", StringValue(fileName));
+    model->SetAttribute("TraceLength", TimeValue(MilliSeconds(SAMPLES_NUM)));
+    model->SetAttribute("SamplesNum", UintegerValue(SAMPLES_NUM));
+    model->SetAttribute("WindowSize", TimeValue(MilliSeconds(10)));
+    model->SetAttribute("RbNum", UintegerValue(RB_NUM));
+    model->AssignStreams(1);
+    model->Initialize();
+
+    Bands bands;
+    for (uint32_t i = 0; i < RB_NUM; i++)
+    {
+        BandInfo band;
+        band.fc = 2.12e9 + i * 180e3;
+        band.fl = band.fc - 90e3;
+        band.fh = band.fc + 90e3;
+        bands.push_back(band);
+    }
+    Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters>();
+    params->psd = Create<SpectrumValue>(Create<SpectrumModel>(bands));
+    *params->psd = 1e-15;
+    Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+    Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+    return model->CalcRxPowerSpectralDensity(params, a, b);
+}
+
+void
+FadingTraceTestCase::DoRun()
+{
+    std::string asciiFile = CreateTempDirFilename("fading-trace.fad");
+    std::string binaryFile = CreateTempDirFilename("fading-trace.bin");
+    {
+        std::ofstream ascii(asciiFile);
+        for (uint32_t rb = 0; rb < RB_NUM; rb++)
+        {
+            for (uint32_t sample = 0; sample < SAMPLES_NUM; sample++)
+            {
+                ascii << (rb * 0.25 - sample * 0.125 - 0.0625) << " ";
+            }
+            ascii << std::endl;
+        }
+    }
+
+    Ptr<const FadingTrace> ascii = FadingTrace::Load(asciiFile, RB_NUM, SAMPLES_NUM);
+    NS_TEST_ASSERT_MSG_EQ(ascii->GetRbNum(), RB_NUM, "Wrong number of RBs");
+    NS_TEST_ASSERT_MSG_EQ(ascii->GetSamplesNum(), SAMPLES_NUM, "Wrong number of samples");
+    NS_TEST_EXPECT_MSG_EQ(ascii->IsMapped(), false, "ASCII trace mapped");
+    NS_TEST_EXPECT_MSG_EQ(FadingTrace::Load(asciiFile, RB_NUM, SAMPLES_NUM),
+                          ascii,
+                          "Loaded trace not shared");
+    ascii->WriteBinary(binaryFile);
+
+    Ptr<const FadingTrace> binary = FadingTrace::Load(binaryFile, RB_NUM, SAMPLES_NUM);
+#ifndef __WIN32__
+    NS_TEST_EXPECT_MSG_EQ(binary->IsMapped(), true, "Binary trace not mapped");
+#endif
+    NS_TEST_EXPECT_MSG_EQ(FadingTrace::Load(binaryFile, RB_NUM, SAMPLES_NUM),
+                          binary,
+                          "Loaded trace not shared");
+    for (uint32_t rb = 0; rb < RB_NUM; rb++)
+    {
+        for (uint32_t sample = 0; sample < SAMPLES_NUM; sample++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(binary->GetValue(rb, sample),
+                                  rb * 0.25 - sample * 0.125 - 0.0625,
+                                  "Wrong sample " << sample << " of RB " << rb);
+            NS_TEST_ASSERT_MSG_EQ(binary->GetValue(rb, sample),
+                                  ascii->GetValue(rb, sample),
+                                  "Different sample " << sample << " of RB " << rb);
+        }
+    }
+
+    Ptr<SpectrumValue> asciiPsd = CalcRxPsd(asciiFile);
+    Ptr<SpectrumValue> binaryPsd = CalcRxPsd(binaryFile);
+    for (uint32_t rb = 0; rb < RB_NUM; rb++)
+    {
+        NS_TEST_EXPECT_MSG_EQ((*binaryPsd)[rb], (*asciiPsd)[rb], "Different fading of RB " << rb);
+        NS_TEST_EXPECT_MSG_NE((*binaryPsd)[rb], 1e-15, "No fading applied to RB " << rb);
+    }
+
+    ascii = nullptr;
+    binary = nullptr;
+    std::remove(asciiFile.c_str());
+    std::remove(binaryFile.c_str());
+}
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief FadingTrace TestSuite
+ */
+class FadingTraceTestSuite : public TestSuite
+{
+  public:
+    FadingTraceTestSuite();
+};
+
+FadingTraceTestSuite::FadingTraceTestSuite()
+    : TestSuite("fading-trace", UNIT)
+{
+    AddTestCase(new FadingTraceTestCase(), TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static FadingTraceTestSuite g_fadingTraceTestSuite;
@@ -0,0 +1,248 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/double.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/net-device.h>
+#include <ns3/simulator.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/test.h>
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief SpectrumPhy which records the receptions.
+ */
+class RangeTestPhy : public SpectrumPhy
+{
+  public:
+    /**
+     * Constructor
+     * \param id Identifier of the PHY.
+     * \param model Rx spectrum model.
+     * \param receptions List to which the identifier is appended at each reception.
+     */
+    RangeTestPhy(uint32_t id, Ptr<const SpectrumModel> model, std::vector<uint32_t>* receptions)
+        : m_id(id),
+          m_model(model),
+          m_receptions(receptions)
+    {
+    }
+
+    void SetDevice(Ptr<NetDevice> d) override
+    {
+    }
+
+    Ptr<NetDevice> GetDevice() const override
+    {
+        return nullptr;
+    }
+
+    void SetMobility(Ptr<MobilityModel> m) override
+    {
+        m_mobility = m;
+    }
+
+    Ptr<MobilityModel> GetMobility() const override
+    {
+        return m_mobility;
+    }
+
+    void SetChannel(Ptr<SpectrumChannel> c) override
+    {
+    }
+
+    Ptr<const SpectrumModel> GetRxSpectrumModel() const override
+    {
+        return m_model;
+    }
+
+    Ptr<Object> GetAntenna() const override
+    {
+        return nullptr;
+    }
+
+    void StartRx(Ptr<SpectrumSignalParameters> params) override
+    {
+        m_receptions->push_back(m_id);
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_mobility = nullptr;
+        m_model = nullptr;
+    }
+
+  private:
+    uint32_t m_id;                       //!< Identifier
+    Ptr<MobilityModel> m_mobility;       //!< Mobility
+    Ptr<const SpectrumModel> m_model;    //!< Rx spectrum model
+    std::vector<uint32_t>* m_receptions; //!< Receptions
+};
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief MultiModelSpectrumChannel test: with MaxRange, a transmission is
+ * delivered only to the receivers in range, in the order in which they were
+ * added, while the receivers move.
+ */
+class MultiModelSpectrumChannelRangeTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     * \param maxRange The MaxRange attribute of the channel.
+     */
+    MultiModelSpectrumChannelRangeTestCase(double maxRange);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Transmit from the first PHY and check the receivers.
+     * \param expected The expected receivers, in order.
+     */
+    void Transmit(std::vector<uint32_t> expected);
+
+    double m_maxRange;                        //!< MaxRange attribute
+    Ptr<MultiModelSpectrumChannel> m_channel; //!< Channel
+    Ptr<SpectrumModel> m_model;               //!< Spectrum model
+    std::vector<Ptr<RangeTestPhy>> m_phys;    //!< PHYs
+    std::vector<uint32_t> m_receptions;       //!< Receivers of the last transmission
+};
+
+MultiModelSpectrumChannelRangeTestCase::MultiModelSpectrumChannelRangeTestCase(double maxRange)
+    : TestCase("Receivers of a MultiModelSpectrumChannel with MaxRange=" +
+               std::to_string(static_cast<uint32_t>(maxRange)) + " m"),
+      m_maxRange(maxRange)
+{
+}
+
+void
+MultiModelSpectrumChannelRangeTestCase::Transmit(std::vector<uint32_t> expected)
+{
+    m_receptions.clear();
+    Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters>();
+    params->txPhy = m_phys[0];
+    params->psd = Create<SpectrumValue>(m_model);
+    params->duration = MilliSeconds(1);
+    m_channel->StartTx(params);
+    Simulator::Schedule(NanoSeconds(1), [this, expected]() {
+        NS_TEST_EXPECT_MSG_EQ((m_receptions == expected),
+                              true,
+                              "Wrong receivers at " << Simulator::Now().As(Time::S));
+    });
+}
+
+void
+MultiModelSpectrumChannelRangeTestCase::DoRun()
+{
+    m_channel = CreateObject<MultiModelSpectrumChannel>();
+    m_channel->SetAttribute("MaxRange", DoubleValue(m_maxRange));
+    m_model = Create<SpectrumModel>(std::vector<double>{2.4e9, 2.41e9});
+
+    // transmitter, static receivers, a moving receiver and a receiver without mobility
+    std::vector<Vector> positions{Vector(0, 0, 0),
+                                  Vector(50, 0, 0),
+                                  Vector(150, 0, 0),
+                                  Vector(-99, 0, 0),
+                                  Vector(300, 0, 0),
+                                  Vector(0, 0, 0)};
+    for (uint32_t i = 0; i < positions.size(); i++)
+    {
+        Ptr<RangeTestPhy> phy = CreateObject<RangeTestPhy>(i, m_model, &m_receptions);
+        if (i == 4)
+        {
+            Ptr<ConstantVelocityMobilityModel> mobility =
+                CreateObject<ConstantVelocityMobilityModel>();
+            mobility->SetPosition(positions[i]);
+            mobility->SetVelocity(Vector(-100, 0, 0));
+            phy->SetMobility(mobility);
+        }
+        else if (i != 5)
+        {
+            Ptr<ConstantPositionMobilityModel> mobility =
+                CreateObject<ConstantPositionMobilityModel>();
+            mobility->SetPosition(positions[i]);
+            phy->SetMobility(mobility);
+        }
+        m_phys.push_back(phy);
+        m_channel->AddRx(phy);
+    }
+
+    bool isCulled = m_maxRange > 0;
+    Simulator::Schedule(Seconds(0), [this, isCulled]() {
+        Transmit(isCulled ? std::vector<uint32_t>{1, 3, 5}
+                          : std::vector<uint32_t>{1, 2, 3, 4, 5});
+    });
+    // the static receiver 2 gets in range, the receiver 1 gets out of range
+    Simulator::Schedule(Seconds(1), [this]() {
+        m_phys[2]->GetMobility()->SetPosition(Vector(80, 0, 0));
+        m_phys[1]->GetMobility()->SetPosition(Vector(0, 1000, 0));
+    });
+    // the moving receiver 4 gets in range at 2 s, and is still in range at 3 s
+    Simulator::Schedule(Seconds(2), [this, isCulled]() {
+        Transmit(isCulled ? std::vector<uint32_t>{2, 3, 4, 5}
+                          : std::vector<uint32_t>{1, 2, 3, 4, 5});
+    });
+    // the receiver 3 is removed and added again, after the others
+    Simulator::Schedule(Seconds(3), [this, isCulled]() {
+        m_channel->RemoveRx(m_phys[3]);
+        m_channel->AddRx(m_phys[3]);
+        Transmit(isCulled ? std::vector<uint32_t>{2, 4, 5, 3}
+                          : std::vector<uint32_t>{1, 2, 4, 5, 3});
+    });
+    Simulator::Run();
+    Simulator::Destroy();
+
+    m_channel->Dispose();
+    m_channel = nullptr;
+    for (auto& phy : m_phys)
+    {
+        phy->Dispose();
+    }
+    m_phys.clear();
+}
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief MultiModelSpectrumChannel TestSuite
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+  public:
+    MultiModelSpectrumChannelTestSuite();
+};
+
+MultiModelSpectrumChannelTestSuite::MultiModelSpectrumChannelTestSuite()
+    : TestSuite("multi-model-spectrum-channel", UNIT)
+{
+    AddTestCase(new MultiModelSpectrumChannelRangeTestCase(0), TestCase::QUICK);
+    AddTestCase(new MultiModelSpectrumChannelRangeTestCase(100), TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite;
@@ -268,6 +268,17 @@ SpectrumValueTestSuite::SpectrumValueTestSuite()
     v1rs3[4] = v1[1];
     tv1rs3 = v1 >> 3;
     AddTestCase(new SpectrumValueTestCase(tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
+
+    SpectrumValue tv3c(f);
+    SpectrumValue tv9c(f);
+    tv3c = v3;
+    tv3c.AddProduct(v1, v2);
+    tv9c = v3;
+    tv9c.AddScaled(v1, doubleValue);
+    AddTestCase(new SpectrumValueTestCase(tv3c, v3 + v1 * v2, "tv3c = v3; tv3c += v1 * v2"),
+                TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv9c, v3 + v9, "tv9c = v3; tv9c += v1 * doubleValue"),
+                TestCase::QUICK);
 }
 
 /**
@@ -682,6 +682,137 @@ ThreeGppSpectrumPropagationLossModelTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup spectrum-tests
+ *
+ * Test case for the batched generation of the ThreeGppChannelModel class.
+ * It checks that the channel matrices generated by GetChannels on several
+ * threads are the same as those generated by successive calls of GetChannel.
+ */
+class ThreeGppChannelBatchTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    ThreeGppChannelBatchTest();
+
+  private:
+    /**
+     * Build the test scenario
+     */
+    void DoRun() override;
+
+    /**
+     * Generate the channel matrices of the links with both channel models and
+     * compare them
+     */
+    void CompareChannels();
+
+    Ptr<ThreeGppChannelModel> m_sequentialModel;            //!< the model used with GetChannel
+    Ptr<ThreeGppChannelModel> m_batchModel;                 //!< the model used with GetChannels
+    std::vector<ThreeGppChannelModel::ChannelLink> m_links; //!< the links
+};
+
+ThreeGppChannelBatchTest::ThreeGppChannelBatchTest()
+    : TestCase("Check that the channel matrices generated in parallel are the same as the "
+               "sequential ones")
+{
+}
+
+void
+ThreeGppChannelBatchTest::CompareChannels()
+{
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>> batch =
+        m_batchModel->GetChannels(m_links);
+    NS_TEST_ASSERT_MSG_EQ(batch.size(), m_links.size(), "Wrong number of channel matrices");
+    for (std::size_t i = 0; i < m_links.size(); i++)
+    {
+        const auto& link = m_links[i];
+        Ptr<const ThreeGppChannelModel::ChannelMatrix> sequential =
+            m_sequentialModel->GetChannel(link.aMob, link.bMob, link.aAntenna, link.bAntenna);
+        NS_TEST_EXPECT_MSG_EQ((batch[i]->m_nodeIds == sequential->m_nodeIds),
+                              true,
+                              "Wrong node ids of link " << i);
+        NS_TEST_EXPECT_MSG_EQ((batch[i]->m_antennaPair == sequential->m_antennaPair),
+                              true,
+                              "Wrong antenna pair of link " << i);
+        NS_TEST_EXPECT_MSG_EQ((batch[i]->m_channel == sequential->m_channel),
+                              true,
+                              "Different channel coefficients of link " << i << " at "
+                                                                        << Simulator::Now());
+    }
+    // the last link is the reverse of the first one, which shares its channel matrix
+    NS_TEST_EXPECT_MSG_EQ(batch.back(), batch.front(), "The channel matrix is not shared");
+}
+
+void
+ThreeGppChannelBatchTest::DoRun()
+{
+    // the two models use the same random streams
+    for (auto model : {&m_sequentialModel, &m_batchModel})
+    {
+        Ptr<ChannelConditionModel> channelConditionModel =
+            CreateObject<ThreeGppUmaChannelConditionModel>();
+        channelConditionModel->AssignStreams(1);
+        *model = CreateObject<ThreeGppChannelModel>();
+        (*model)->SetAttribute("Frequency", DoubleValue(28.0e9));
+        (*model)->SetAttribute("Scenario", StringValue("UMa"));
+        (*model)->SetAttribute("ChannelConditionModel", PointerValue(channelConditionModel));
+        (*model)->SetAttribute("UpdatePeriod", TimeValue(MilliSeconds(10)));
+        (*model)->AssignStreams(100);
+    }
+    m_sequentialModel->SetAttribute("Threads", UintegerValue(1));
+    m_batchModel->SetAttribute("Threads", UintegerValue(4));
+
+    // two base stations and several user terminals, with their own antennas
+    std::vector<Vector> bsPositions{Vector(0, 0, 25), Vector(300, 0, 25)};
+    std::vector<Vector> utPositions{Vector(20, 10, 1.5),
+                                    Vector(100, -50, 1.5),
+                                    Vector(150, 80, 1.5),
+                                    Vector(250, 20, 1.5),
+                                    Vector(400, -100, 1.5)};
+    NodeContainer nodes;
+    nodes.Create(bsPositions.size() + utPositions.size());
+    std::vector<Ptr<MobilityModel>> mobilities;
+    std::vector<Ptr<PhasedArrayModel>> antennas;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        bool isBs = i < bsPositions.size();
+        Ptr<MobilityModel> mob = CreateObject<ConstantPositionMobilityModel>();
+        mob->SetPosition(isBs ? bsPositions[i] : utPositions[i - bsPositions.size()]);
+        nodes.Get(i)->AggregateObject(mob);
+        mobilities.push_back(mob);
+        antennas.push_back(CreateObjectWithAttributes<UniformPlanarArray>(
+            "NumColumns",
+            UintegerValue(isBs ? 4 : 2),
+            "NumRows",
+            UintegerValue(isBs ? 2 : 1),
+            "AntennaElement",
+            PointerValue(CreateObject<IsotropicAntennaModel>())));
+    }
+    for (uint32_t bs = 0; bs < bsPositions.size(); bs++)
+    {
+        for (uint32_t ut = bsPositions.size(); ut < nodes.GetN(); ut++)
+        {
+            m_links.push_back({mobilities[bs], mobilities[ut], antennas[bs], antennas[ut]});
+        }
+    }
+    m_links.push_back(
+        {m_links[0].bMob, m_links[0].aMob, m_links[0].bAntenna, m_links[0].aAntenna});
+
+    // the channel matrices are generated, then reused, then updated
+    Simulator::Schedule(MilliSeconds(0), &ThreeGppChannelBatchTest::CompareChannels, this);
+    Simulator::Schedule(MilliSeconds(5), &ThreeGppChannelBatchTest::CompareChannels, this);
+    Simulator::Schedule(MilliSeconds(20), &ThreeGppChannelBatchTest::CompareChannels, this);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    m_links.clear();
+    m_sequentialModel = nullptr;
+    m_batchModel = nullptr;
+}
+
 /**
  * \ingroup spectrum-tests
  *
@@ -702,6 +833,7 @@ ThreeGppChannelTestSuite::ThreeGppChannelTestSuite()
     AddTestCase(new ThreeGppChannelMatrixComputationTest, TestCase::QUICK);
     AddTestCase(new ThreeGppChannelMatrixUpdateTest, TestCase::QUICK);
     AddTestCase(new ThreeGppSpectrumPropagationLossModelTest, TestCase::QUICK);
+    AddTestCase(new ThreeGppChannelBatchTest, TestCase::QUICK);
 }
 
 /// Static variable for test initialization
@@ -78,7 +78,7 @@ Histogram::GetBinCount(uint32_t index)
 }
 
 void
-Histogram::AddValue(double value)
+Histogram::AddValue(double value, uint32_t count)
 {
     uint32_t index = (uint32_t)std::floor(value / m_binWidth);
 
@@ -89,7 +89,7 @@ Histogram::AddValue(double value)
     {
         m_histogram.resize(index + 1, 0);
     }
-    m_histogram[index]++;
+    m_histogram[index] += count;
 }
 
 Histogram::Histogram(double binWidth)
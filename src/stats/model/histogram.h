@@ -99,8 +99,9 @@ class Histogram
     /**
      * \brief Add a value to the histogram
      * \param value the value to add
+     * \param count the number of times the value is added
      */
-    void AddValue(double value);
+    void AddValue(double value, uint32_t count = 1);
 
     /**
      * \brief Serializes the results to an std::ostream in XML format.
@@ -69,6 +69,13 @@ HistogramTestCase::DoRun()
         NS_TEST_EXPECT_MSG_EQ(h0.GetNBins(), 22, "");
         NS_TEST_EXPECT_MSG_EQ(h0.GetBinCount(21), 1, "");
     }
+
+    {
+        // Testing values added several times
+        h0.AddValue(3.4, 4);
+        NS_TEST_EXPECT_MSG_EQ(h0.GetBinCount(0), 14, "");
+        NS_TEST_EXPECT_MSG_EQ(h0.GetNBins(), 22, "");
+    }
 }
 
 /**
@@ -399,7 +399,7 @@ InterferenceHelper::CalculateSnr(double signal,
 
 double
 InterferenceHelper::CalculateNoiseInterferenceW(Ptr<Event> event,
-                                                NiChangesPerBand* nis,
+                                                NiChangesRange* ni,
                                                 WifiSpectrumBand band) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second);
@@ -408,30 +408,54 @@ InterferenceHelper::CalculateNoiseInterferenceW(Ptr<Event> event,
     double noiseInterferenceW = firstPower_it->second;
     auto niIt = m_niChangesPerBand.find(band);
     NS_ASSERT(niIt != m_niChangesPerBand.end());
-    auto it = niIt->second.find(event->GetStartTime());
-    for (; it != niIt->second.end() && it->first < Simulator::Now(); ++it)
+    const NiChanges& niChanges = niIt->second;
+    // The noise and interference is given by the last NiChange before now
+    Time now = Simulator::Now();
+    if (event->GetStartTime() < now)
     {
-        noiseInterferenceW = it->second.GetPower() - event->GetRxPowerW(band);
+        noiseInterferenceW =
+            std::prev(niChanges.lower_bound(now))->second.GetPower() - event->GetRxPowerW(band);
     }
-    it = niIt->second.find(event->GetStartTime());
-    NS_ASSERT(it != niIt->second.end());
-    for (; it != niIt->second.end() && it->second.GetEvent() != event; ++it)
+    auto it = niChanges.find(event->GetStartTime());
+    NS_ASSERT(it != niChanges.end());
+    for (; it != niChanges.end() && it->second.GetEvent() != event; ++it)
     {
         ;
     }
-    NiChanges ni;
-    ni.emplace(event->GetStartTime(), NiChange(0, event));
-    while (++it != niIt->second.end() && it->second.GetEvent() != event)
+    NS_ASSERT(it != niChanges.end());
+    ni->niChanges = &niChanges;
+    ni->first = std::next(it);
+    // the NiChange of the end of the event is among those at its end time
+    it = (event->GetEndTime() > event->GetStartTime()) ? niChanges.lower_bound(event->GetEndTime())
+                                                       : ni->first;
+    for (; it != niChanges.end() && it->second.GetEvent() != event; ++it)
     {
-        ni.insert(*it);
+        ;
     }
-    ni.emplace(event->GetEndTime(), NiChange(0, event));
-    nis->insert({band, ni});
+    ni->last = it;
+    ni->start = event->GetStartTime();
+    ni->end = event->GetEndTime();
     NS_ASSERT_MSG(noiseInterferenceW >= 0,
                   "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
     return noiseInterferenceW;
 }
 
+InterferenceHelper::NiChanges::const_iterator
+InterferenceHelper::FindNiChange(const NiChangesRange& ni, Time moment)
+{
+    if (ni.first == ni.last || moment <= ni.first->first)
+    {
+        return ni.first;
+    }
+    if (moment > ni.end)
+    {
+        return ni.last;
+    }
+    // the NiChanges of the range are sorted, and those after the first one
+    // which are at or before the end of the event are in the range
+    return ni.niChanges->lower_bound(moment);
+}
+
 double
 InterferenceHelper::CalculateChunkSuccessRate(double snir,
                                               Time duration,
@@ -478,7 +502,7 @@ InterferenceHelper::CalculatePayloadChunkSuccessRate(double snir,
 double
 InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
                                         uint16_t channelWidth,
-                                        NiChangesPerBand* nis,
+                                        const NiChangesRange& ni,
                                         WifiSpectrumBand band,
                                         uint16_t staId,
                                         std::pair<Time, Time> window) const
@@ -486,25 +510,31 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
     NS_LOG_FUNCTION(this << channelWidth << band.first << band.second << staId << window.first
                          << window.second);
     double psr = 1.0; /* Packet Success Rate */
-    const auto& niIt = nis->find(band)->second;
-    auto j = niIt.cbegin();
-    Time previous = j->first;
     WifiMode payloadMode = event->GetTxVector().GetMode(staId);
-    Time phyPayloadStart = j->first;
+    Time phyPayloadStart = ni.start;
     if (event->GetPpdu()->GetType() != WIFI_PPDU_TYPE_UL_MU &&
         event->GetPpdu()->GetType() !=
-            WIFI_PPDU_TYPE_DL_MU) // j->first corresponds to the start of the OFDMA payload
+            WIFI_PPDU_TYPE_DL_MU) // ni.start corresponds to the start of the OFDMA payload
     {
         phyPayloadStart =
-            j->first + WifiPhy::CalculatePhyPreambleAndHeaderDuration(event->GetTxVector());
+            ni.start + WifiPhy::CalculatePhyPreambleAndHeaderDuration(event->GetTxVector());
     }
     Time windowStart = phyPayloadStart + window.first;
     Time windowEnd = phyPayloadStart + window.second;
-    double noiseInterferenceW = m_firstPowerPerBand.find(band)->second;
     double powerW = event->GetRxPowerW(band);
-    while (++j != niIt.cend())
+    // The chunks which end before the windowed payload do not contribute to
+    // the PER, hence start from the chunk which ends at or after its start
+    auto j = FindNiChange(ni, windowStart);
+    Time previous = ni.start;
+    double noiseInterferenceW = m_firstPowerPerBand.find(band)->second;
+    if (j != ni.first)
+    {
+        previous = std::prev(j)->first;
+        noiseInterferenceW = std::prev(j)->second.GetPower() - powerW;
+    }
+    while (true)
     {
-        Time current = j->first;
+        Time current = (j == ni.last) ? ni.end : j->first;
         NS_LOG_DEBUG("previous= " << previous << ", current=" << current);
         NS_ASSERT(current >= previous);
         double snr = CalculateSnr(powerW,
@@ -532,8 +562,13 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
                 "previous is before windowed payload and current is in the windowed payload: mode="
                 << payloadMode << ", psr=" << psr);
         }
+        if (j == ni.last)
+        {
+            break;
+        }
         noiseInterferenceW = j->second.GetPower() - powerW;
-        previous = j->first;
+        previous = current;
+        ++j;
         if (previous > windowEnd)
         {
             NS_LOG_DEBUG("Stop: new previous=" << previous
@@ -548,15 +583,13 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
 double
 InterferenceHelper::CalculatePhyHeaderSectionPsr(
     Ptr<const Event> event,
-    NiChangesPerBand* nis,
+    const NiChangesRange& ni,
     uint16_t channelWidth,
     WifiSpectrumBand band,
     PhyEntity::PhyHeaderSections phyHeaderSections) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second);
     double psr = 1.0; /* Packet Success Rate */
-    auto niIt = nis->find(band)->second;
-    auto j = niIt.begin();
 
     NS_ASSERT(!phyHeaderSections.empty());
     Time stopLastSection = Seconds(0);
@@ -565,12 +598,12 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
         stopLastSection = Max(stopLastSection, section.second.first.second);
     }
 
-    Time previous = j->first;
+    Time previous = ni.start;
     double noiseInterferenceW = m_firstPowerPerBand.find(band)->second;
     double powerW = event->GetRxPowerW(band);
-    while (++j != niIt.end())
+    for (auto j = ni.first;; ++j)
     {
-        Time current = j->first;
+        Time current = (j == ni.last) ? ni.end : j->first;
         NS_LOG_DEBUG("previous= " << previous << ", current=" << current);
         NS_ASSERT(current >= previous);
         double snr = CalculateSnr(powerW, noiseInterferenceW, channelWidth, 1);
@@ -596,8 +629,12 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
                 }
             }
         }
+        if (j == ni.last)
+        {
+            break;
+        }
         noiseInterferenceW = j->second.GetPower() - powerW;
-        previous = j->first;
+        previous = current;
         if (previous > stopLastSection)
         {
             NS_LOG_DEBUG("Stop: new previous=" << previous << " after stop of last section="
@@ -610,18 +647,16 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
 
 double
 InterferenceHelper::CalculatePhyHeaderPer(Ptr<const Event> event,
-                                          NiChangesPerBand* nis,
+                                          const NiChangesRange& ni,
                                           uint16_t channelWidth,
                                           WifiSpectrumBand band,
                                           WifiPpduField header) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second << header);
-    auto niIt = nis->find(band)->second;
     auto phyEntity = WifiPhy::GetStaticPhyEntity(event->GetTxVector().GetModulationClass());
 
     PhyEntity::PhyHeaderSections sections;
-    for (const auto& section :
-         phyEntity->GetPhyHeaderSections(event->GetTxVector(), niIt.begin()->first))
+    for (const auto& section : phyEntity->GetPhyHeaderSections(event->GetTxVector(), ni.start))
     {
         if (section.first == header)
         {
@@ -632,7 +667,7 @@ InterferenceHelper::CalculatePhyHeaderPer(Ptr<const Event> event,
     double psr = 1.0;
     if (!sections.empty())
     {
-        psr = CalculatePhyHeaderSectionPsr(event, nis, channelWidth, band, sections);
+        psr = CalculatePhyHeaderSectionPsr(event, ni, channelWidth, band, sections);
     }
     return 1 - psr;
 }
@@ -646,7 +681,7 @@ InterferenceHelper::CalculatePayloadSnrPer(Ptr<Event> event,
 {
     NS_LOG_FUNCTION(this << channelWidth << band.first << band.second << staId
                          << relativeMpduStartStop.first << relativeMpduStartStop.second);
-    NiChangesPerBand ni;
+    NiChangesRange ni;
     double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
     double snr = CalculateSnr(event->GetRxPowerW(band),
                               noiseInterferenceW,
@@ -656,7 +691,7 @@ InterferenceHelper::CalculatePayloadSnrPer(Ptr<Event> event,
     /* calculate the SNIR at the start of the MPDU (located through windowing) and accumulate
      * all SNIR changes in the SNIR vector.
      */
-    double per = CalculatePayloadPer(event, channelWidth, &ni, band, staId, relativeMpduStartStop);
+    double per = CalculatePayloadPer(event, channelWidth, ni, band, staId, relativeMpduStartStop);
 
     return PhyEntity::SnrPer(snr, per);
 }
@@ -667,7 +702,7 @@ InterferenceHelper::CalculateSnr(Ptr<Event> event,
                                  uint8_t nss,
                                  WifiSpectrumBand band) const
 {
-    NiChangesPerBand ni;
+    NiChangesRange ni;
     double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
     double snr = CalculateSnr(event->GetRxPowerW(band), noiseInterferenceW, channelWidth, nss);
     return snr;
@@ -680,14 +715,14 @@ InterferenceHelper::CalculatePhyHeaderSnrPer(Ptr<Event> event,
                                              WifiPpduField header) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second << header);
-    NiChangesPerBand ni;
+    NiChangesRange ni;
     double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
     double snr = CalculateSnr(event->GetRxPowerW(band), noiseInterferenceW, channelWidth, 1);
 
     /* calculate the SNIR at the start of the PHY header and accumulate
      * all SNIR changes in the SNIR vector.
      */
-    double per = CalculatePhyHeaderPer(event, &ni, channelWidth, band, header);
+    double per = CalculatePhyHeaderPer(event, ni, channelWidth, band, header);
 
     return PhyEntity::SnrPer(snr, per);
 }
@@ -393,6 +393,21 @@ class InterferenceHelper : public Object
      */
     typedef std::map<WifiSpectrumBand, NiChanges> NiChangesPerBand;
 
+    /**
+     * The NiChanges of a band during an event, i.e. the NiChanges between the
+     * NiChange of the start and the NiChange of the end of the event, which are
+     * not copied. The power before the first NiChange is the first power of
+     * the band.
+     */
+    struct NiChangesRange
+    {
+        const NiChanges* niChanges;      //!< the NiChanges of the band
+        NiChanges::const_iterator first; //!< the first NiChange after the start of the event
+        NiChanges::const_iterator last;  //!< the NiChange of the end of the event
+        Time start;                      //!< the start time of the event
+        Time end;                        //!< the end time of the event
+    };
+
     /**
      * Append the given Event.
      *
@@ -406,14 +421,24 @@ class InterferenceHelper : public Object
      * Calculate noise and interference power in W.
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param ni the NiChanges of the band during the event
      * \param band the band
      *
      * \return noise and interference power
      */
     double CalculateNoiseInterferenceW(Ptr<Event> event,
-                                       NiChangesPerBand* nis,
+                                       NiChangesRange* ni,
                                        WifiSpectrumBand band) const;
+    /**
+     * Return the first NiChange of a range at or after the given time, i.e.
+     * the end of the first chunk which ends at or after that time.
+     *
+     * \param ni the NiChanges of the band during the event
+     * \param moment the time
+     *
+     * \return the first NiChange at or after moment, or the last NiChange of the range
+     */
+    static NiChanges::const_iterator FindNiChange(const NiChangesRange& ni, Time moment);
     /**
      * Calculate the error rate of the given PHY payload only in the provided time
      * window (thus enabling per MPDU PER information). The PHY payload can be divided into
@@ -421,7 +446,7 @@ class InterferenceHelper : public Object
      *
      * \param event the event
      * \param channelWidth the channel width used to transmit the PSDU (in MHz)
-     * \param nis the NiChanges
+     * \param ni the NiChanges of the band during the event
      * \param band identify the band used by the PSDU
      * \param staId the station ID of the PSDU (only used for MU)
      * \param window time window (pair of start and end times) of PHY payload to focus on
@@ -430,7 +455,7 @@ class InterferenceHelper : public Object
      */
     double CalculatePayloadPer(Ptr<const Event> event,
                                uint16_t channelWidth,
-                               NiChangesPerBand* nis,
+                               const NiChangesRange& ni,
                                WifiSpectrumBand band,
                                uint16_t staId,
                                std::pair<Time, Time> window) const;
@@ -439,7 +464,7 @@ class InterferenceHelper : public Object
      * can be divided into multiple chunks (e.g. due to interference from other transmissions).
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param ni the NiChanges of the band during the event
      * \param channelWidth the channel width (in MHz) for header measurement
      * \param band the band
      * \param header the PHY header to consider
@@ -447,7 +472,7 @@ class InterferenceHelper : public Object
      * \return the error rate of the HT PHY header
      */
     double CalculatePhyHeaderPer(Ptr<const Event> event,
-                                 NiChangesPerBand* nis,
+                                 const NiChangesRange& ni,
                                  uint16_t channelWidth,
                                  WifiSpectrumBand band,
                                  WifiPpduField header) const;
@@ -455,7 +480,7 @@ class InterferenceHelper : public Object
      * Calculate the success rate of the PHY header sections for the provided event.
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param ni the NiChanges of the band during the event
      * \param channelWidth the channel width (in MHz) for header measurement
      * \param band the band
      * \param phyHeaderSections the map of PHY header sections (\see PhyEntity::PhyHeaderSections)
@@ -463,7 +488,7 @@ class InterferenceHelper : public Object
      * \return the success rate of the PHY header sections
      */
     double CalculatePhyHeaderSectionPsr(Ptr<const Event> event,
-                                        NiChangesPerBand* nis,
+                                        const NiChangesRange& ni,
                                         uint16_t channelWidth,
                                         WifiSpectrumBand band,
                                         PhyEntity::PhyHeaderSections phyHeaderSections) const;
@@ -21,7 +21,9 @@
 #include "nist-error-rate-model.h"
 
 #include "wifi-tx-vector.h"
+#include "wifi-utils.h"
 
+#include "ns3/double.h"
 #include "ns3/log.h"
 
 #include <bitset>
@@ -34,18 +36,45 @@ NS_LOG_COMPONENT_DEFINE("NistErrorRateModel");
 
 NS_OBJECT_ENSURE_REGISTERED(NistErrorRateModel);
 
+static const double CODED_BER_TABLE_MIN_SNR = -10; //!< lowest SNR of the tables of coded BER (dB)
+static const double CODED_BER_TABLE_MAX_SNR = 50;  //!< highest SNR of the tables of coded BER (dB)
+
 TypeId
 NistErrorRateModel::GetTypeId()
 {
     static TypeId tid = TypeId("ns3::NistErrorRateModel")
                             .SetParent<ErrorRateModel>()
                             .SetGroupName("Wifi")
-                            .AddConstructor<NistErrorRateModel>();
+                            .AddConstructor<NistErrorRateModel>()
+                            .AddAttribute("SnrResolution",
+                                          "The resolution, in dB, of the tables of coded BER "
+                                          "versus SNR in which the chunk success rates are "
+                                          "interpolated. 0 disables the tables: the closed-form "
+                                          "expressions are evaluated for each chunk.",
+                                          DoubleValue(0),
+                                          MakeDoubleAccessor(&NistErrorRateModel::SetSnrResolution,
+                                                             &NistErrorRateModel::GetSnrResolution),
+                                          MakeDoubleChecker<double>(0, 1));
     return tid;
 }
 
 NistErrorRateModel::NistErrorRateModel()
+    : m_snrResolution(0)
+{
+}
+
+void
+NistErrorRateModel::SetSnrResolution(double resolution)
+{
+    NS_LOG_FUNCTION(this << resolution);
+    m_snrResolution = resolution;
+    m_codedBerTables.clear();
+}
+
+double
+NistErrorRateModel::GetSnrResolution() const
 {
+    return m_snrResolution;
 }
 
 double
@@ -180,6 +209,65 @@ NistErrorRateModel::GetFecQamBer(uint16_t constellationSize,
     return pms;
 }
 
+double
+NistErrorRateModel::GetCodedBer(uint16_t constellationSize, uint8_t bValue, double snr) const
+{
+    double ber;
+    if (constellationSize == 2)
+    {
+        ber = GetBpskBer(snr);
+    }
+    else if (constellationSize == 4)
+    {
+        ber = GetQpskBer(snr);
+    }
+    else
+    {
+        ber = GetQamBer(constellationSize, snr);
+    }
+    if (ber == 0.0)
+    {
+        return 0.0;
+    }
+    return std::min(CalculatePe(ber, bValue), 1.0);
+}
+
+double
+NistErrorRateModel::GetTabulatedChunkSuccessRate(uint16_t constellationSize,
+                                                 uint8_t bValue,
+                                                 double snr,
+                                                 uint64_t nbits) const
+{
+    auto& table = m_codedBerTables[{constellationSize, bValue}];
+    if (table.empty())
+    {
+        auto size = static_cast<std::size_t>(
+                        (CODED_BER_TABLE_MAX_SNR - CODED_BER_TABLE_MIN_SNR) / m_snrResolution) +
+                    1;
+        NS_LOG_DEBUG("Build the table of coded BER of " << constellationSize << "-point with b="
+                                                        << +bValue << " (" << size << " SNRs)");
+        table.reserve(size);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            double snrDb = CODED_BER_TABLE_MIN_SNR + i * m_snrResolution;
+            table.push_back(GetCodedBer(constellationSize, bValue, DbToRatio(snrDb)));
+        }
+    }
+
+    double pe;
+    double position = (RatioToDb(snr) - CODED_BER_TABLE_MIN_SNR) / m_snrResolution;
+    if (position >= 0 && position < table.size() - 1)
+    {
+        auto index = static_cast<std::size_t>(position);
+        pe = table[index] + (position - index) * (table[index + 1] - table[index]);
+    }
+    else
+    {
+        pe = GetCodedBer(constellationSize, bValue, snr);
+    }
+    return std::pow(1 - pe, nbits);
+}
+
 uint8_t
 NistErrorRateModel::GetBValue(WifiCodeRate codeRate) const
 {
@@ -213,6 +301,13 @@ NistErrorRateModel::DoGetChunkSuccessRate(WifiMode mode,
     NS_LOG_FUNCTION(this << mode << snr << nbits << +numRxAntennas << field << staId);
     if (mode.GetModulationClass() >= WIFI_MOD_CLASS_ERP_OFDM)
     {
+        if (m_snrResolution > 0)
+        {
+            return GetTabulatedChunkSuccessRate(mode.GetConstellationSize(),
+                                                GetBValue(mode.GetCodeRate()),
+                                                snr,
+                                                nbits);
+        }
         if (mode.GetConstellationSize() == 2)
         {
             return GetFecBpskBer(snr, nbits, GetBValue(mode.GetCodeRate()));
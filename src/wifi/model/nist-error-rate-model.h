@@ -23,6 +23,9 @@
 #include "error-rate-model.h"
 #include "wifi-mode.h"
 
+#include <map>
+#include <vector>
+
 namespace ns3
 {
 
@@ -33,6 +36,13 @@ namespace ns3
  * the model description and validation can be found in
  * http://www.nsnam.org/~pei/80211ofdm.pdf.  For DSSS modulations (802.11b),
  * the model uses the DsssErrorRateModel.
+ *
+ * When the SnrResolution attribute is positive, the coded BER of a
+ * constellation and coding rate is tabulated versus the SNR in dB, with that
+ * resolution, the first time a mode using them is seen.  The chunk success
+ * rates are then interpolated linearly in the tables instead of evaluating the
+ * closed-form expressions, which makes them much cheaper at the cost of a
+ * small approximation error.
  */
 class NistErrorRateModel : public ErrorRateModel
 {
@@ -53,6 +63,44 @@ class NistErrorRateModel : public ErrorRateModel
                                  uint8_t numRxAntennas,
                                  WifiPpduField field,
                                  uint16_t staId) const override;
+    /**
+     * Set the resolution of the tables of coded BER, and discard the tables
+     * built so far.
+     *
+     * \param resolution the resolution in dB, or 0 to disable the tables
+     */
+    void SetSnrResolution(double resolution);
+    /**
+     * \return the resolution of the tables of coded BER, in dB
+     */
+    double GetSnrResolution() const;
+    /**
+     * Return the chunk success rate obtained by interpolating the table of
+     * coded BER of the given constellation size and bValue, which is built if
+     * needed.  SNRs outside of the table use the closed-form expressions.
+     *
+     * \param constellationSize the constellation size (M)
+     * \param bValue the bValue such that coding rate = bValue / (bValue + 1)
+     * \param snr SNR ratio (in linear scale)
+     * \param nbits the number of bits in the chunk
+     *
+     * \return the chunk success rate
+     */
+    double GetTabulatedChunkSuccessRate(uint16_t constellationSize,
+                                        uint8_t bValue,
+                                        double snr,
+                                        uint64_t nbits) const;
+    /**
+     * Return the coded BER for the given constellation size, bValue and SNR,
+     * that is the BER used by the GetFec*Ber methods.
+     *
+     * \param constellationSize the constellation size (M)
+     * \param bValue the bValue such that coding rate = bValue / (bValue + 1)
+     * \param snr SNR ratio (in linear scale)
+     *
+     * \return the coded BER
+     */
+    double GetCodedBer(uint16_t constellationSize, uint8_t bValue, double snr) const;
     /**
      * Return the bValue such that coding rate = bValue / (bValue + 1).
      *
@@ -128,6 +176,11 @@ class NistErrorRateModel : public ErrorRateModel
                         double snr,
                         uint64_t nbits,
                         uint8_t bValue) const;
+
+    double m_snrResolution; //!< resolution of the tables of coded BER, in dB (0 if disabled)
+
+    /// Tables of coded BER, indexed by constellation size and bValue
+    mutable std::map<std::pair<uint16_t, uint8_t>, std::vector<double>> m_codedBerTables;
 };
 
 } // namespace ns3
@@ -189,51 +189,35 @@ TableBasedErrorRateModel::DoGetChunkSuccessRate(WifiMode mode,
     auto errorTable = (ldpc ? AwgnErrorTableLdpc1458
                             : (size < m_threshold ? AwgnErrorTableBcc32 : AwgnErrorTableBcc1458));
     const auto& itVector = errorTable[mcs];
-    auto itTable = std::find_if(itVector.cbegin(),
-                                itVector.cend(),
-                                [&roundedSnr](const std::pair<double, double>& element) {
-                                    return element.first == roundedSnr;
-                                });
-    double minSnr = itVector.cbegin()->first;
-    double maxSnr = (--itVector.cend())->first;
+    // the tables are sorted by increasing SNR
+    auto itTable = std::lower_bound(itVector.cbegin(),
+                                    itVector.cend(),
+                                    roundedSnr,
+                                    [](const std::pair<double, double>& element, double value) {
+                                        return element.first < value;
+                                    });
     double per;
     if (itTable == itVector.cend())
     {
-        if (roundedSnr < minSnr)
-        {
-            per = 1.0;
-        }
-        else if (roundedSnr > maxSnr)
-        {
-            per = 0.0;
-        }
-        else
-        {
-            double a = 0.0;
-            double b = 0.0;
-            double previousSnr = 0.0;
-            double nextSnr = 0.0;
-            for (auto i = itVector.cbegin(); i != itVector.cend(); ++i)
-            {
-                if (i->first < roundedSnr)
-                {
-                    previousSnr = i->first;
-                    a = i->second;
-                }
-                else
-                {
-                    nextSnr = i->first;
-                    b = i->second;
-                    break;
-                }
-            }
-            per = a + (roundedSnr - previousSnr) * (b - a) / (nextSnr - previousSnr);
-        }
+        per = 0.0;
     }
-    else
+    else if (itTable->first == roundedSnr)
     {
         per = itTable->second;
     }
+    else if (itTable == itVector.cbegin())
+    {
+        per = 1.0;
+    }
+    else
+    {
+        auto itPrevious = std::prev(itTable);
+        double a = itPrevious->second;
+        double b = itTable->second;
+        double previousSnr = itPrevious->first;
+        double nextSnr = itTable->first;
+        per = a + (roundedSnr - previousSnr) * (b - a) / (nextSnr - previousSnr);
+    }
 
     uint16_t tableSize = (ldpc ? ERROR_TABLE_LDPC_FRAME_SIZE
                                : (size < m_threshold ? ERROR_TABLE_BCC_SMALL_FRAME_SIZE
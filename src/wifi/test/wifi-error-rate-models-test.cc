@@ -25,6 +25,7 @@
 #include <gsl/gsl_sf_bessel.h>
 #endif
 
+#include "ns3/double.h"
 #include "ns3/dsss-error-rate-model.h"
 #include "ns3/he-phy.h" //includes HT and VHT
 #include "ns3/interference-helper.h"
@@ -161,6 +162,75 @@ WifiErrorRateModelsTestCaseDsss::DoRun()
 #endif
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi Error Rate Models Test Case NIST with tables: the chunk success
+ * rates interpolated in the tables of coded BER match the closed-form ones.
+ */
+class WifiErrorRateModelsTestCaseNistTables : public TestCase
+{
+  public:
+    WifiErrorRateModelsTestCaseNistTables();
+
+  private:
+    void DoRun() override;
+};
+
+WifiErrorRateModelsTestCaseNistTables::WifiErrorRateModelsTestCaseNistTables()
+    : TestCase("WifiErrorRateModel test case NIST with tables")
+{
+}
+
+void
+WifiErrorRateModelsTestCaseNistTables::DoRun()
+{
+    Ptr<NistErrorRateModel> nist = CreateObject<NistErrorRateModel>();
+    Ptr<NistErrorRateModel> tables = CreateObject<NistErrorRateModel>();
+    tables->SetAttribute("SnrResolution", DoubleValue(0.01));
+    const double tolerance = 1e-4;
+
+    // HE MCSs cover all the constellation sizes and coding rates, the SNRs
+    // below and above the tables use the closed-form expressions
+    for (uint8_t mcs = 0; mcs <= 11; mcs++)
+    {
+        WifiMode mode = HePhy::GetHeMcs(mcs);
+        WifiTxVector txVector;
+        txVector.SetMode(mode);
+        for (uint64_t nbits : {8, 8 * 1500, 8 * 65535})
+        {
+            for (double snr = -15; snr <= 55; snr += 0.0731)
+            {
+                double snrRatio = std::pow(10.0, snr / 10.0);
+                double expected = nist->GetChunkSuccessRate(mode, txVector, snrRatio, nbits);
+                double ps = tables->GetChunkSuccessRate(mode, txVector, snrRatio, nbits);
+                NS_TEST_ASSERT_MSG_EQ_TOL(ps,
+                                          expected,
+                                          tolerance,
+                                          "Wrong chunk success rate for " << mode << " at " << snr
+                                                                          << " dB and " << nbits
+                                                                          << " bits");
+            }
+        }
+    }
+
+    // a coarser resolution is less accurate
+    tables->SetAttribute("SnrResolution", DoubleValue(0.5));
+    double maxError = 0;
+    WifiTxVector txVector;
+    txVector.SetMode(HePhy::GetHeMcs(4));
+    for (double snr = 5; snr <= 20; snr += 0.0731)
+    {
+        double snrRatio = std::pow(10.0, snr / 10.0);
+        maxError = std::max(
+            maxError,
+            std::abs(tables->GetChunkSuccessRate(HePhy::GetHeMcs(4), txVector, snrRatio, 8000) -
+                     nist->GetChunkSuccessRate(HePhy::GetHeMcs(4), txVector, snrRatio, 8000)));
+    }
+    NS_TEST_EXPECT_MSG_GT(maxError, tolerance, "The resolution of the tables is not used");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1056,6 +1126,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite()
 {
     AddTestCase(new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
     AddTestCase(new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+    AddTestCase(new WifiErrorRateModelsTestCaseNistTables, TestCase::QUICK);
     AddTestCase(new WifiErrorRateModelsTestCaseMimo, TestCase::QUICK);
     AddTestCase(new TableBasedErrorRateTestCase("DefaultTableBasedHtMcs0-1458bytes",
                                                 HtPhy::GetHtMcs0(),
@@ -0,0 +1,111 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the Wi-Fi error rate models: the
+// success rate of a chunk is computed 'n' times for each HE MCS, at SNRs
+// spread over the range in which the receptions are decided.  The NIST model
+// is run with and without its tables of coded BER.
+// Sample usage:  ./ns3 run 'bench-error-rate-models --n=100000'
+
+#include "ns3/command-line.h"
+#include "ns3/double.h"
+#include "ns3/he-phy.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/table-based-error-rate-model.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/yans-error-rate-model.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Run an error rate model.
+ * \param name The name of the model.
+ * \param model The error rate model.
+ * \param n The number of chunks per MCS.
+ * \param nbits The number of bits of the chunks.
+ */
+static void
+Bench(const std::string& name, Ptr<ErrorRateModel> model, uint32_t n, uint64_t nbits)
+{
+    std::vector<double> snrs;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        // from 0 to 40 dB
+        snrs.push_back(std::pow(10.0, (i % 4000) / 1000.0));
+    }
+
+    double check = 0;
+    SystemWallClockMs time;
+    time.Start();
+    for (uint8_t mcs = 0; mcs <= 11; mcs++)
+    {
+        WifiMode mode = HePhy::GetHeMcs(mcs);
+        WifiTxVector txVector;
+        txVector.SetMode(mode);
+        txVector.SetChannelWidth(20);
+        for (double snr : snrs)
+        {
+            check += model->GetChunkSuccessRate(mode, txVector, snr, nbits);
+        }
+    }
+    int64_t ms = time.End();
+    std::cout << "  " << std::left << std::setw(30) << name << std::right << std::setw(8) << ms
+              << " ms  " << std::setw(8) << ms * 1e6 / (12.0 * n) << " ns/chunk  (" << check << ")"
+              << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 0;
+    uint64_t nbits = 8 * 1500;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the Wi-Fi error rate models");
+    cmd.AddValue("n", "number of chunks per MCS", n);
+    cmd.AddValue("nbits", "number of bits of the chunks", nbits);
+    cmd.Parse(argc, argv);
+
+    if (n == 0)
+    {
+        std::cerr << "Error-- number of chunks must be specified "
+                  << "by command-line argument --n=(number of chunks)" << std::endl;
+        exit(1);
+    }
+    std::cout << "Running bench-error-rate-models with n=" << n << ", nbits=" << nbits
+              << std::endl;
+
+    Bench("NistErrorRateModel", CreateObject<NistErrorRateModel>(), n, nbits);
+    for (double resolution : {0.01, 0.1})
+    {
+        Ptr<NistErrorRateModel> nist = CreateObject<NistErrorRateModel>();
+        nist->SetAttribute("SnrResolution", DoubleValue(resolution));
+        Bench("NistErrorRateModel (" + std::to_string(resolution).substr(0, 4) + " dB)",
+              nist,
+              n,
+              nbits);
+    }
+    Bench("YansErrorRateModel", CreateObject<YansErrorRateModel>(), n, nbits);
+    Bench("TableBasedErrorRateModel", CreateObject<TableBasedErrorRateModel>(), n, nbits);
+    return 0;
+}
@@ -20,6 +20,7 @@
 // This program can be used to benchmark packet serialization/deserialization
 // operations using Headers and Tags, for various numbers of packets 'n'
 // Sample usage:  ./ns3 run 'bench-packets --n=10000'
+// The cost of the packet metadata is included with --enable-printing.
 
 #include "ns3/command-line.h"
 #include "ns3/packet-metadata.h"
@@ -350,6 +351,34 @@ benchByteTags(uint32_t n)
     }
 }
 
+static void
+benchItems(uint32_t n)
+{
+    BenchHeader<14> ethernet;
+    BenchHeader<25> ipv4;
+    BenchHeader<8> udp;
+    BenchHeader<12> rtp;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(1200);
+        p->AddHeader(rtp);
+        p->AddHeader(udp);
+        p->AddHeader(ipv4);
+        Ptr<Packet> o = p->Copy();
+        o->AddHeader(ethernet);
+
+        // Walk the metadata, as done when printing a packet
+        uint32_t size = 0;
+        PacketMetadata::ItemIterator j = o->BeginItem();
+        while (j.HasNext())
+        {
+            size += j.Next().currentSize;
+        }
+        NS_ASSERT(size == 0 || size == o->GetSize());
+    }
+}
+
 static uint64_t
 runBenchOneIteration(void (*bench)(uint32_t), uint32_t n)
 {
@@ -382,6 +411,7 @@ main(int argc, char* argv[])
     uint32_t n = 0;
     uint32_t minIterations = 1;
     bool enablePrinting = false;
+    bool enableChecking = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark Packet class");
@@ -390,8 +420,18 @@ main(int argc, char* argv[])
                  "number of subiterations to minimize iteration time over",
                  minIterations);
     cmd.AddValue("enable-printing", "enable packet printing", enablePrinting);
+    cmd.AddValue("enable-checking", "enable packet metadata checking", enableChecking);
     cmd.Parse(argc, argv);
 
+    if (enableChecking)
+    {
+        Packet::EnableChecking();
+    }
+    else if (enablePrinting)
+    {
+        Packet::EnablePrinting();
+    }
+
     if (n == 0)
     {
         std::cerr << "Error-- number of packets must be specified "
@@ -407,6 +447,7 @@ main(int argc, char* argv[])
     runBench(&benchD, n, minIterations, "Intermixed add/remove headers and tags");
     runBench(&benchFragment, n, minIterations, "Fragmentation and concatenation");
     runBench(&benchByteTags, n, minIterations, "Benchmark byte tags");
+    runBench(&benchItems, n, minIterations, "Copy, add headers and iterate the metadata");
 
     return 0;
 }
@@ -0,0 +1,188 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the SpectrumValue arithmetic on
+// the spectrum models of a 100-RB LTE carrier and of a 996-tone 80 MHz
+// Wi-Fi channel.  Each kernel runs 'n' times, written with the binary
+// operators and with the in-place operations.
+// Sample usage:  ./ns3 run 'bench-spectrum-value --n=100000'
+
+#include "ns3/command-line.h"
+#include "ns3/spectrum-model.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <string>
+
+using namespace ns3;
+
+/**
+ * Create a spectrum model of contiguous bands.
+ * \param fc The center frequency of the first band, in Hz.
+ * \param width The width of the bands, in Hz.
+ * \param nBands The number of bands.
+ * \return The spectrum model.
+ */
+static Ptr<SpectrumModel>
+CreateModel(double fc, double width, uint32_t nBands)
+{
+    Bands bands;
+    for (uint32_t i = 0; i < nBands; i++)
+    {
+        BandInfo band;
+        band.fc = fc + i * width;
+        band.fl = band.fc - width / 2;
+        band.fh = band.fc + width / 2;
+        bands.push_back(band);
+    }
+    return Create<SpectrumModel>(bands);
+}
+
+/**
+ * Print the time of a kernel.
+ * \param name The name of the kernel.
+ * \param ms The elapsed time, in milliseconds.
+ * \param check A result of the kernel, such that it is not optimized out.
+ */
+static void
+Report(const std::string& name, int64_t ms, double check)
+{
+    std::cout << "  " << std::left << std::setw(40) << name << std::right << std::setw(8) << ms
+              << " ms  (" << check << ")" << std::endl;
+}
+
+/**
+ * Run the kernels on a spectrum model.
+ * \param name The name of the spectrum model.
+ * \param model The spectrum model.
+ * \param n The number of iterations.
+ */
+static void
+Bench(const std::string& name, Ptr<const SpectrumModel> model, uint32_t n)
+{
+    std::cout << name << " (" << model->GetNumBands() << " bands):" << std::endl;
+
+    SpectrumValue psd(model);
+    SpectrumValue noise(model);
+    SpectrumValue all(model);
+    for (uint32_t i = 0; i < model->GetNumBands(); i++)
+    {
+        psd[i] = 1e-12 * (1 + i % 7);
+        noise[i] = 1e-17;
+        all[i] = 1e-13;
+    }
+    const double gain = 1e-3;
+    SystemWallClockMs time;
+
+    // Interference accumulation: all += psd * gain
+    SpectrumValue acc = all;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        acc = acc + psd * gain;
+    }
+    Report("all = all + psd * gain", time.End(), Sum(acc));
+
+    acc = all;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        acc.AddScaled(psd, gain);
+    }
+    Report("all.AddScaled (psd, gain)", time.End(), Sum(acc));
+
+    // Path gain applied to a received PSD
+    SpectrumValue rx = psd;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        rx = rx * 1.0000001;
+    }
+    Report("rx = rx * gain", time.End(), Sum(rx));
+
+    rx = psd;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        rx *= 1.0000001;
+    }
+    Report("rx *= gain", time.End(), Sum(rx));
+
+    // SINR of a chunk
+    double check = 0;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        SpectrumValue sinr = psd / (all - psd + noise);
+        check += sinr[0];
+    }
+    Report("sinr = rx / (all - rx + noise)", time.End(), check);
+
+    check = 0;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        SpectrumValue interf = all;
+        interf -= psd;
+        interf += noise;
+        SpectrumValue sinr = psd;
+        sinr /= interf;
+        check += sinr[0];
+    }
+    Report("sinr (in-place)", time.End(), check);
+
+    // Reductions
+    check = 0;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        check += Integral(psd);
+    }
+    Report("Integral (psd)", time.End(), check);
+
+    check = 0;
+    time.Start();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        check += Sum(psd);
+    }
+    Report("Sum (psd)", time.End(), check);
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the SpectrumValue arithmetic");
+    cmd.AddValue("n", "number of iterations of each kernel", n);
+    cmd.Parse(argc, argv);
+
+    if (n == 0)
+    {
+        std::cerr << "Error-- number of iterations must be specified "
+                  << "by command-line argument --n=(number of iterations)" << std::endl;
+        exit(1);
+    }
+    std::cout << "Running bench-spectrum-value with n=" << n << std::endl;
+
+    Bench("LTE 20 MHz, 100 RB", CreateModel(2.12e9, 180e3, 100), n);
+    Bench("Wi-Fi 80 MHz, 996 tones", CreateModel(5.21e9, 78125, 996), n);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the TCP scoreboard: a TcpTxBuffer
+// sends 'n' segments to a TcpRxBuffer through a network that reorders and
+// drops them, and the SACK blocks of the receiver drive the retransmissions.
+// Large windows with heavy reordering stress the SACK processing.
+// Sample usage:  ./ns3 run 'bench-tcp-buffers --n=100000 --window=5000'
+
+#include "ns3/command-line.h"
+#include "ns3/packet.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/tcp-tx-buffer.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/// Segment in the network
+struct Segment
+{
+    SequenceNumber32 seq; //!< Sequence number
+    Ptr<Packet> packet;   //!< Payload
+};
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 0;
+    uint32_t window = 1000;
+    uint32_t segmentSize = 536;
+    uint32_t reorder = 100;
+    double loss = 0.01;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the TCP transmission and reception buffers");
+    cmd.AddValue("n", "number of segments to transfer", n);
+    cmd.AddValue("window", "window, in segments", window);
+    cmd.AddValue("segment-size", "segment size, in bytes", segmentSize);
+    cmd.AddValue("reorder", "number of segments among which the next delivered is drawn", reorder);
+    cmd.AddValue("loss", "probability to drop a segment", loss);
+    cmd.Parse(argc, argv);
+
+    if (n == 0 || window == 0 || reorder == 0)
+    {
+        std::cerr << "Error-- number of segments must be specified "
+                  << "by command-line argument --n=(number of segments)" << std::endl;
+        exit(1);
+    }
+    std::cout << "Running bench-tcp-buffers with n=" << n << ", window=" << window
+              << ", reorder=" << reorder << ", loss=" << loss << std::endl;
+
+    SequenceNumber32 isn(1);
+    uint32_t windowBytes = window * segmentSize;
+    SequenceNumber32 end = isn + n * segmentSize;
+
+    Ptr<TcpTxBuffer> tx = CreateObject<TcpTxBuffer>();
+    tx->SetHeadSequence(isn);
+    tx->SetMaxBufferSize(2 * windowBytes);
+    tx->SetSegmentSize(segmentSize);
+    tx->SetDupAckThresh(3);
+    tx->SetRWndCallback(MakeCallback(&TcpTxBuffer::MaxBufferSize, PeekPointer(tx)));
+
+    Ptr<TcpRxBuffer> rx = CreateObject<TcpRxBuffer>();
+    rx->SetNextRxSequence(isn);
+    rx->SetMaxBufferSize(2 * windowBytes);
+
+    std::mt19937 rng(RngSeedManager::GetSeed() + RngSeedManager::GetRun());
+    std::uniform_real_distribution<double> uniform;
+    std::deque<Segment> network;
+    SequenceNumber32 appTail = isn;
+    uint64_t acks = 0;
+    uint64_t sent = 0;
+    uint64_t timeouts = 0;
+
+    SystemWallClockMs time;
+    time.Start();
+    while (tx->HeadSequence() < end)
+    {
+        // Keep the application data flowing
+        while (appTail < end && tx->Available() >= segmentSize)
+        {
+            tx->Add(Create<Packet>(segmentSize));
+            appTail += segmentSize;
+        }
+
+        // Send what the scoreboard allows
+        SequenceNumber32 seq;
+        SequenceNumber32 seqHigh;
+        while (tx->BytesInFlight() < windowBytes && tx->NextSeg(&seq, &seqHigh, false))
+        {
+            TcpTxItem* item = tx->CopyFromSequence(seqHigh - seq, seq);
+            if (item == nullptr)
+            {
+                break;
+            }
+            network.push_back({seq, item->GetPacketCopy()});
+            sent++;
+        }
+
+        if (network.empty())
+        {
+            // Retransmission timeout
+            tx->SetSentListLost();
+            timeouts++;
+            continue;
+        }
+
+        // Deliver one of the first segments of the network
+        std::size_t index =
+            std::min<std::size_t>(uniform(rng) * std::min<std::size_t>(reorder, network.size()),
+                                  network.size() - 1);
+        Segment segment = network[index];
+        network.erase(network.begin() + index);
+        if (uniform(rng) < loss)
+        {
+            continue;
+        }
+
+        TcpHeader header;
+        header.SetSequenceNumber(segment.seq);
+        rx->Add(segment.packet, header);
+        rx->Extract(rx->Available());
+
+        // Process the ACK
+        tx->Update(rx->GetSackList());
+        tx->DiscardUpTo(rx->NextRxSequence());
+        acks++;
+    }
+    uint64_t deltaMs = time.End();
+
+    std::cout << acks << " acks, " << sent << " segments sent, " << timeouts
+              << " timeouts (" << deltaMs << " ms elapsed)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the generation of the channel
+// matrices of ThreeGppChannelModel: 'n' user terminals are linked to a base
+// station, both with uniform planar arrays, and the channel matrices of all
+// the links are generated 'updates' times, by successive calls of GetChannel
+// and by GetChannels on 'threads' threads.
+// Sample usage:  ./ns3 run 'bench-three-gpp-channel --n=100 --threads=4'
+
+#include "ns3/channel-condition-model.h"
+#include "ns3/command-line.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/isotropic-antenna-model.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/three-gpp-channel-model.h"
+#include "ns3/uinteger.h"
+#include "ns3/uniform-planar-array.h"
+
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Create a channel model.
+ * \param threads The number of threads.
+ * \return The channel model.
+ */
+static Ptr<ThreeGppChannelModel>
+CreateChannelModel(uint32_t threads)
+{
+    Ptr<ChannelConditionModel> condition =
+        CreateObject<ThreeGppUmiStreetCanyonChannelConditionModel>();
+    condition->AssignStreams(1);
+    Ptr<ThreeGppChannelModel> model = CreateObject<ThreeGppChannelModel>();
+    model->SetAttribute("Frequency", DoubleValue(28.0e9));
+    model->SetAttribute("Scenario", StringValue("UMi-StreetCanyon"));
+    model->SetAttribute("ChannelConditionModel", PointerValue(condition));
+    model->SetAttribute("Threads", UintegerValue(threads));
+    model->AssignStreams(2);
+    return model;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 0;
+    uint32_t updates = 1;
+    uint32_t threads = 0;
+    uint32_t bsElements = 8;
+    uint32_t utElements = 8;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the channel matrix generation of ThreeGppChannelModel");
+    cmd.AddValue("n", "number of user terminals", n);
+    cmd.AddValue("updates", "number of generations of the channel matrices", updates);
+    cmd.AddValue("threads", "number of threads of GetChannels (0 for one per core)", threads);
+    cmd.AddValue("bs-elements",
+                 "number of rows and columns of the base station array",
+                 bsElements);
+    cmd.AddValue("ut-elements",
+                 "number of rows and columns of the user terminal arrays",
+                 utElements);
+    cmd.Parse(argc, argv);
+
+    if (n == 0)
+    {
+        std::cerr << "Error-- number of user terminals must be specified "
+                  << "by command-line argument --n=(number of user terminals)" << std::endl;
+        exit(1);
+    }
+    std::cout << "Running bench-three-gpp-channel with n=" << n << ", updates=" << updates
+              << ", threads=" << threads << std::endl;
+
+    NodeContainer nodes;
+    nodes.Create(n + 1);
+    std::vector<ThreeGppChannelModel::ChannelLink> links;
+    Ptr<MobilityModel> bsMob = CreateObject<ConstantPositionMobilityModel>();
+    bsMob->SetPosition(Vector(0, 0, 10));
+    nodes.Get(0)->AggregateObject(bsMob);
+    Ptr<PhasedArrayModel> bsAntenna = CreateObjectWithAttributes<UniformPlanarArray>(
+        "NumColumns",
+        UintegerValue(bsElements),
+        "NumRows",
+        UintegerValue(bsElements),
+        "AntennaElement",
+        PointerValue(CreateObject<IsotropicAntennaModel>()));
+    for (uint32_t i = 1; i <= n; i++)
+    {
+        Ptr<MobilityModel> utMob = CreateObject<ConstantPositionMobilityModel>();
+        utMob->SetPosition(Vector(10 + 5 * (i % 40), 5 * (i / 40.0), 1.5));
+        nodes.Get(i)->AggregateObject(utMob);
+        Ptr<PhasedArrayModel> utAntenna = CreateObjectWithAttributes<UniformPlanarArray>(
+            "NumColumns",
+            UintegerValue(utElements),
+            "NumRows",
+            UintegerValue(utElements),
+            "AntennaElement",
+            PointerValue(CreateObject<IsotropicAntennaModel>()));
+        links.push_back({bsMob, utMob, bsAntenna, utAntenna});
+    }
+
+    SystemWallClockMs time;
+    for (uint32_t mode = 0; mode < 2; mode++)
+    {
+        double check = 0;
+        time.Start();
+        for (uint32_t u = 0; u < updates; u++)
+        {
+            // a new model for each update, such that all the matrices are generated
+            Ptr<ThreeGppChannelModel> model = CreateChannelModel(mode == 0 ? 1 : threads);
+            if (mode == 0)
+            {
+                for (const auto& link : links)
+                {
+                    check += std::abs(
+                        model->GetChannel(link.aMob, link.bMob, link.aAntenna, link.bAntenna)
+                            ->m_channel(0, 0, 0));
+                }
+            }
+            else
+            {
+                for (const auto& channel : model->GetChannels(links))
+                {
+                    check += std::abs(channel->m_channel(0, 0, 0));
+                }
+            }
+            model->Dispose();
+        }
+        std::cout << (mode == 0 ? "GetChannel:  " : "GetChannels: ") << time.End()
+                  << " ms elapsed (" << check << ")" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program converts an ASCII fading trace, as generated by
+// src/lte/model/fading-traces/fading_trace_generator.m, to the binary format
+// of FadingTrace, which TraceFadingLossModel memory-maps and shares between
+// the links and the processes using it.
+// Sample usage:
+//   ./ns3 run 'convert-fading-trace --input=fading_trace_EPA_3kmph.fad
+//              --output=fading_trace_EPA_3kmph.bin --rbs=100 --samples=10000'
+
+#include "ns3/command-line.h"
+#include "ns3/fading-trace.h"
+
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <string>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+    uint32_t rbNum = 100;
+    uint32_t samplesNum = 10000;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Convert an ASCII fading trace to the binary format");
+    cmd.AddValue("input", "ASCII fading trace", input);
+    cmd.AddValue("output", "binary fading trace to write", output);
+    cmd.AddValue("rbs", "number of RBs of the trace", rbNum);
+    cmd.AddValue("samples", "number of samples per RB", samplesNum);
+    cmd.Parse(argc, argv);
+
+    if (input.empty() || output.empty())
+    {
+        std::cerr << "Error-- the input and output files must be specified "
+                  << "by command-line arguments --input=(file) --output=(file)" << std::endl;
+        exit(1);
+    }
+
+    Ptr<const FadingTrace> trace = FadingTrace::Load(input, rbNum, samplesNum);
+    trace->WriteBinary(output);
+    std::cout << "Converted " << rbNum << " RBs of " << samplesNum << " samples from " << input
+              << " to " << output << std::endl;
+    return 0;
+}